@@ -19,6 +19,7 @@
 #include "util/path.h"
 #include "util/progress.h"
 #include "util/string.h"
+#include "util/thread.h"
 #include "util/time.h"
 #include "util/transform.h"
 #include "util/unique_ptr.h"
@@ -42,6 +43,7 @@ struct Options {
   Session *session;
   Scene *scene;
   string filepath;
+  vector<string> filepaths;
   int width, height;
   SceneParams scene_params;
   SessionParams session_params;
@@ -49,6 +51,9 @@ struct Options {
   bool show_help, interactive, pause;
   string output_filepath;
   string output_pass;
+  string stats_filepath;
+  bool persistent_data;
+  XMLSceneCache xml_cache;
 } options;
 
 static void session_print(const string &str)
@@ -95,19 +100,60 @@ static BufferParams &session_buffer_params()
   return buffer_params;
 }
 
+static bool scene_is_xml(const string &filepath)
+{
+#ifdef WITH_USD
+  return string_endswith(string_to_lower(filepath), ".xml");
+#else
+  (void)filepath;
+  return true;
+#endif
+}
+
+/* Output file path for the given frame of a sequence. A run of '#' in the path is replaced with
+ * the zero padded frame number, otherwise the frame number is appended to the file name. */
+static string output_filepath_for_frame(const string &filepath, int frame)
+{
+  if (filepath.empty() || options.filepaths.size() <= 1) {
+    return filepath;
+  }
+
+  const size_t hash_start = filepath.find('#');
+  if (hash_start != string::npos) {
+    size_t hash_end = hash_start;
+    while (hash_end < filepath.size() && filepath[hash_end] == '#') {
+      hash_end++;
+    }
+    const int num_digits = int(hash_end - hash_start);
+    return filepath.substr(0, hash_start) + string_printf("%0*d", num_digits, frame) +
+           filepath.substr(hash_end);
+  }
+
+  const size_t dot = filepath.rfind('.');
+  const size_t slash = filepath.find_last_of("/\\");
+  if (dot == string::npos || (slash != string::npos && dot < slash)) {
+    return filepath + string_printf("_%04d", frame);
+  }
+  return filepath.substr(0, dot) + string_printf("_%04d", frame) + filepath.substr(dot);
+}
+
 static void scene_init()
 {
   options.scene = options.session->scene;
 
   /* Read XML or USD */
 #ifdef WITH_USD
-  if (!string_endswith(string_to_lower(options.filepath), ".xml")) {
+  if (!scene_is_xml(options.filepath)) {
     HD_CYCLES_NS::HdCyclesFileReader::read(options.session, options.filepath.c_str());
   }
   else
 #endif
   {
-    xml_read_file(options.scene, options.filepath.c_str());
+    /* With persistent data the scene of the previous frame is updated in place, so that
+     * unchanged shaders, images, BVHs and the light tree are kept. */
+    xml_read_file(options.scene,
+                  options.filepath.c_str(),
+                  options.persistent_data ? &options.xml_cache : NULL);
   }
 
   /* Camera width/height override? */
@@ -122,12 +168,34 @@ static void scene_init()
 
   /* Calculate Viewplane */
   options.scene->camera->compute_auto_viewplane();
+
+  if (!options.stats_filepath.empty()) {
+    options.scene->enable_update_stats(false);
+  }
+}
+
+/* Write render statistics of the finished render, as CSV or JSON depending on the extension. */
+static void session_write_stats(const string &filepath)
+{
+  if (filepath.empty()) {
+    return;
+  }
+
+  RenderStats stats;
+  options.session->collect_statistics(&stats);
+
+  string text = string_endswith(string_to_lower(filepath), ".csv") ? stats.csv_report() :
+                                                                     stats.json_report() + "\n";
+  if (!path_write_text(filepath, text)) {
+    fprintf(stderr, "Failed to write render statistics to %s\n", filepath.c_str());
+  }
 }
 
 static void session_init()
 {
   options.output_pass = "combined";
   options.session = new Session(options.session_params, options.scene_params);
+  options.xml_cache = XMLSceneCache();
 
 #ifdef WITH_CYCLES_STANDALONE_GUI
   if (!options.session_params.background) {
@@ -160,6 +228,24 @@ static void session_init()
   options.session->start();
 }
 
+/* Render the next file of a sequence with the existing session and scene. */
+static void session_render_next_file(const string &output_filepath)
+{
+  {
+    thread_scoped_lock scene_lock(options.scene->mutex);
+    scene_init();
+  }
+
+  if (!output_filepath.empty()) {
+    options.session->set_output_driver(
+        make_unique<OIIOOutputDriver>(output_filepath, options.output_pass, session_print));
+  }
+
+  options.session->progress.reset();
+  options.session->reset(options.session_params, session_buffer_params());
+  options.session->start();
+}
+
 static void session_exit()
 {
   if (options.session) {
@@ -347,8 +433,11 @@ static void keyboard(unsigned char key)
 
 static int files_parse(int argc, const char *argv[])
 {
-  if (argc > 0)
-    options.filepath = argv[0];
+  for (int i = 0; i < argc; i++)
+    options.filepaths.push_back(argv[i]);
+
+  if (!options.filepaths.empty())
+    options.filepath = options.filepaths.front();
 
   return 0;
 }
@@ -360,6 +449,7 @@ static void options_parse(int argc, const char **argv)
   options.filepath = "";
   options.session = NULL;
   options.quiet = false;
+  options.persistent_data = false;
   options.session_params.use_auto_tile = false;
   options.session_params.tile_size = 0;
 
@@ -384,8 +474,9 @@ static void options_parse(int argc, const char **argv)
   ArgParse ap;
   bool help = false, profile = false, debug = false, version = false;
   int verbosity = 1;
+  int texture_cache_size = 0;
 
-  ap.options("Usage: cycles [options] file.xml",
+  ap.options("Usage: cycles [options] file.xml [file.xml ...]",
              "%*",
              files_parse,
              "",
@@ -408,7 +499,16 @@ static void options_parse(int argc, const char **argv)
              "Number of samples to render",
              "--output %s",
              &options.output_filepath,
-             "File path to write output image",
+             "File path to write output image, with '#' replaced by the frame number when "
+             "rendering multiple files",
+             "--stats %s",
+             &options.stats_filepath,
+             "File path to write render statistics to after rendering, as CSV if the file name "
+             "ends in .csv and as JSON otherwise. Use --profile to include kernel, shader and "
+             "object times (CPU only)",
+             "--persistent-data",
+             &options.persistent_data,
+             "Keep render data in memory between files, to speed up rendering of sequences",
              "--threads %d",
              &options.session_params.threads,
              "CPU Rendering Threads",
@@ -421,6 +521,10 @@ static void options_parse(int argc, const char **argv)
              "--tile-size %d",
              &options.session_params.tile_size,
              "Tile size in pixels",
+             "--texture-cache %d",
+             &texture_cache_size,
+             "Read image textures on demand through a texture cache of this size in megabytes, "
+             "instead of loading them fully (CPU only)",
              "--list-devices",
              &list,
              "List information about all available devices",
@@ -491,6 +595,11 @@ static void options_parse(int argc, const char **argv)
     options.session_params.use_auto_tile = true;
   }
 
+  if (texture_cache_size > 0) {
+    options.scene_params.use_texture_cache = true;
+    options.scene_params.texture_cache_size = texture_cache_size;
+  }
+
   /* find matching device */
   DeviceType device_type = Device::type_from_string(devicename.c_str());
   vector<DeviceInfo> devices = Device::available_devices(DEVICE_MASK(device_type));
@@ -541,8 +650,31 @@ int main(int argc, const char **argv)
 #ifdef WITH_CYCLES_STANDALONE_GUI
   if (options.session_params.background) {
 #endif
-    session_init();
-    options.session->wait();
+    const string output_filepath = options.output_filepath;
+
+    for (int frame = 0; frame < (int)options.filepaths.size(); frame++) {
+      options.filepath = options.filepaths[frame];
+      const string frame_output_filepath = output_filepath_for_frame(output_filepath, frame + 1);
+
+      if (frame > 0 && options.persistent_data && scene_is_xml(options.filepath) &&
+          scene_is_xml(options.filepaths[frame - 1]))
+      {
+        session_render_next_file(frame_output_filepath);
+      }
+      else {
+        /* USD files are read into a new session, as the file reader always creates new nodes. */
+        if (frame > 0) {
+          session_exit();
+        }
+        options.output_filepath = frame_output_filepath;
+        session_init();
+        options.output_filepath = output_filepath;
+      }
+
+      options.session->wait();
+      session_write_stats(output_filepath_for_frame(options.stats_filepath, frame + 1));
+    }
+
     session_exit();
 #ifdef WITH_CYCLES_STANDALONE_GUI
   }
@@ -28,6 +28,7 @@
 #include "subd/split.h"
 
 #include "util/foreach.h"
+#include "util/md5.h"
 #include "util/path.h"
 #include "util/projection.h"
 #include "util/transform.h"
@@ -47,7 +48,9 @@ struct XMLReadState : public XMLReader {
   string base;       /* Base path to current file. */
   float dicing_rate; /* Current dicing rate. */
 
-  XMLReadState() : scene(NULL), smooth(false), shader(NULL), dicing_rate(1.0f)
+  XMLSceneCache *cache; /* Nodes of the previous file of a sequence. */
+
+  XMLReadState() : scene(NULL), smooth(false), shader(NULL), dicing_rate(1.0f), cache(NULL)
   {
     tfm = transform_identity();
   }
@@ -163,6 +166,16 @@ static bool xml_read_string(string *str, xml_node node, const char *name)
   return false;
 }
 
+/* Hash of the XML of a node along with the reading state it depends on, used to detect changes
+ * between files of a sequence. */
+static string xml_node_hash(const XMLReadState &state, xml_node node, const string &extra = "")
+{
+  std::ostringstream stream;
+  node.print(stream, "");
+  stream << state.base << extra;
+  return util_md5_string(stream.str());
+}
+
 static bool xml_equal_string(xml_node node, const char *name, const char *value)
 {
   xml_attribute attr = node.attribute(name);
@@ -199,6 +212,29 @@ static void xml_read_camera(XMLReadState &state, xml_node node)
 #ifdef WITH_ALEMBIC
 static void xml_read_alembic(XMLReadState &state, xml_node graph_node)
 {
+  XMLSceneCache *cache = state.cache;
+  string hash;
+
+  if (cache) {
+    /* The frame is not part of the hash, so that the procedural of an animation is kept and only
+     * loads the data of the new frame. */
+    xml_document doc;
+    xml_node hash_node = doc.append_copy(graph_node);
+    hash_node.remove_attribute("frame");
+    hash = xml_node_hash(state, hash_node, string_printf("%p", (void *)state.shader));
+
+    if (cache->num_procedurals_read < cache->procedurals.size()) {
+      XMLSceneCache::CachedProcedural &cached = cache->procedurals[cache->num_procedurals_read];
+      if (cached.hash == hash) {
+        xml_read_node(state, cached.procedural, graph_node);
+        cache->num_procedurals_read++;
+        return;
+      }
+
+      state.scene->delete_node(cached.procedural);
+    }
+  }
+
   AlembicProcedural *proc = state.scene->create_node<AlembicProcedural>();
   xml_read_node(state, proc, graph_node);
 
@@ -216,13 +252,49 @@ static void xml_read_alembic(XMLReadState &state, xml_node graph_node)
       }
     }
   }
+
+  if (cache) {
+    if (cache->num_procedurals_read < cache->procedurals.size()) {
+      cache->procedurals[cache->num_procedurals_read] = {proc, hash};
+    }
+    else {
+      cache->procedurals.push_back({proc, hash});
+    }
+    cache->num_procedurals_read++;
+  }
 }
 #endif
 
 /* Shader */
 
+/* Shaders of the previous file of a sequence which are not in the current one can not be
+ * referenced, the same as when the file is read into a new scene. */
+static bool xml_shader_is_visible(const XMLReadState &state, const Shader *shader)
+{
+  const XMLSceneCache *cache = state.cache;
+
+  if (cache == NULL || cache->shaders_read.count(shader)) {
+    return true;
+  }
+
+  return std::find(cache->shaders.begin(), cache->shaders.end(), shader) == cache->shaders.end();
+}
+
 static void xml_read_shader_graph(XMLReadState &state, Shader *shader, xml_node graph_node)
 {
+  if (state.cache) {
+    /* Keep the graph and compiled shader when it did not change since the previous file. */
+    const string hash = xml_node_hash(state, graph_node);
+    string &cached_hash = state.cache->shader_hashes[shader];
+    if (cached_hash == hash) {
+      if (!shader->name.empty()) {
+        state.node_map[shader->name] = shader;
+      }
+      return;
+    }
+    cached_hash = hash;
+  }
+
   xml_read_node(state, shader, graph_node);
 
   ShaderGraph *graph = new ShaderGraph();
@@ -375,9 +447,32 @@ static void xml_read_shader_graph(XMLReadState &state, Shader *shader, xml_node
 
 static void xml_read_shader(XMLReadState &state, xml_node node)
 {
-  Shader *shader = new Shader();
+  Shader *shader = NULL;
+
+  /* Update the shader of the same name when reading a sequence. */
+  string shadername;
+  if (state.cache && xml_read_string(&shadername, node, "name")) {
+    foreach (Shader *cached_shader, state.cache->shaders) {
+      if (cached_shader->name == shadername && !state.cache->shaders_read.count(cached_shader)) {
+        shader = cached_shader;
+        break;
+      }
+    }
+  }
+
+  if (shader == NULL) {
+    shader = state.scene->create_node<Shader>();
+
+    if (state.cache) {
+      state.cache->shaders.push_back(shader);
+    }
+  }
+
+  if (state.cache) {
+    state.cache->shaders_read.insert(shader);
+  }
+
   xml_read_shader_graph(state, shader, node);
-  state.scene->shaders.push_back(shader);
 }
 
 /* Background */
@@ -394,25 +489,21 @@ static void xml_read_background(XMLReadState &state, xml_node node)
 
 /* Mesh */
 
-static Mesh *xml_add_mesh(Scene *scene, const Transform &tfm)
+static Object *xml_add_mesh(Scene *scene, const Transform &tfm)
 {
   /* create mesh */
-  Mesh *mesh = new Mesh();
-  scene->geometry.push_back(mesh);
+  Mesh *mesh = scene->create_node<Mesh>();
 
   /* Create object. */
-  Object *object = new Object();
+  Object *object = scene->create_node<Object>();
   object->set_geometry(mesh);
   object->set_tfm(tfm);
-  scene->objects.push_back(object);
 
-  return mesh;
+  return object;
 }
 
-static void xml_read_mesh(const XMLReadState &state, xml_node node)
+static void xml_read_mesh_data(const XMLReadState &state, xml_node node, Mesh *mesh)
 {
-  /* add mesh */
-  Mesh *mesh = xml_add_mesh(state.scene, state.tfm);
   array<Node *> used_shaders = mesh->get_used_shaders();
   used_shaders.push_back_slow(state.shader);
   mesh->set_used_shaders(used_shaders);
@@ -554,16 +645,116 @@ static void xml_read_mesh(const XMLReadState &state, xml_node node)
   }
 }
 
+static void xml_read_mesh(const XMLReadState &state, xml_node node)
+{
+  XMLSceneCache *cache = state.cache;
+
+  if (cache == NULL || cache->num_objects_read == cache->objects.size()) {
+    /* add mesh */
+    Object *object = xml_add_mesh(state.scene, state.tfm);
+    xml_read_mesh_data(state, node, static_cast<Mesh *>(object->get_geometry()));
+
+    if (cache) {
+      const string hash = xml_node_hash(
+          state,
+          node,
+          string_printf("%p %d %f", (void *)state.shader, state.smooth, state.dicing_rate));
+      cache->objects.push_back({object, state.tfm, hash});
+      cache->num_objects_read++;
+    }
+    return;
+  }
+
+  XMLSceneCache::CachedObject &cached = cache->objects[cache->num_objects_read++];
+  Object *object = cached.object;
+  Mesh *mesh = static_cast<Mesh *>(object->get_geometry());
+
+  const string hash = xml_node_hash(
+      state, node, string_printf("%p %d %f", (void *)state.shader, state.smooth, state.dicing_rate));
+
+  /* Vertices of a mesh with applied transform are stored in world space, and subdivision depends
+   * on the transform as well, so such meshes are read again when moved. */
+  const bool need_read = (cached.hash != hash) ||
+                         (cached.tfm != state.tfm &&
+                          (mesh->transform_applied ||
+                           mesh->get_subdivision_type() != Mesh::SUBDIVISION_NONE));
+
+  if (cached.tfm != state.tfm) {
+    object->set_tfm(state.tfm);
+    object->tag_update(state.scene);
+    cached.tfm = state.tfm;
+  }
+
+  if (!need_read) {
+    return;
+  }
+
+  cached.hash = hash;
+
+  /* Read into a new mesh and copy its sockets, so that only data which actually changed is
+   * tagged for update. A deforming mesh keeps its topology, which allows refitting its BVH. */
+  Mesh new_mesh;
+  xml_read_mesh_data(state, node, &new_mesh);
+
+  mesh->clear_non_sockets();
+
+  for (const SocketType &socket : new_mesh.type->inputs) {
+    mesh->set_value(socket, new_mesh, socket);
+  }
+
+  mesh->attributes.update(std::move(new_mesh.attributes));
+  mesh->subd_attributes.update(std::move(new_mesh.subd_attributes));
+
+  mesh->set_num_subd_faces(new_mesh.get_num_subd_faces());
+
+  const bool rebuild = (mesh->triangles_is_modified()) || (mesh->subd_num_corners_is_modified()) ||
+                       (mesh->subd_shader_is_modified()) || (mesh->subd_smooth_is_modified()) ||
+                       (mesh->subd_ptex_offset_is_modified()) ||
+                       (mesh->subd_start_corner_is_modified()) ||
+                       (mesh->subd_face_corners_is_modified());
+
+  mesh->tag_update(state.scene, rebuild);
+}
+
 /* Light */
 
 static void xml_read_light(XMLReadState &state, xml_node node)
 {
-  Light *light = new Light();
+  XMLSceneCache *cache = state.cache;
+  string hash;
+
+  if (cache) {
+    hash = xml_node_hash(state, node, string_printf("%p", (void *)state.shader));
+
+    if (cache->num_lights_read < cache->lights.size()) {
+      XMLSceneCache::CachedLight &cached = cache->lights[cache->num_lights_read];
+      if (cached.hash == hash) {
+        if (!cached.light->name.empty()) {
+          state.node_map[cached.light->name] = cached.light;
+        }
+        cache->num_lights_read++;
+        return;
+      }
+
+      /* A changed light is created again, the light tree needs to be rebuilt anyway. */
+      state.scene->delete_node(cached.light);
+    }
+  }
+
+  Light *light = state.scene->create_node<Light>();
 
   light->set_shader(state.shader);
   xml_read_node(state, light, node);
 
-  state.scene->lights.push_back(light);
+  if (cache) {
+    if (cache->num_lights_read < cache->lights.size()) {
+      cache->lights[cache->num_lights_read] = {light, hash};
+    }
+    else {
+      cache->lights.push_back({light, hash});
+    }
+    cache->num_lights_read++;
+  }
 }
 
 /* Transform */
@@ -608,7 +799,7 @@ static void xml_read_state(XMLReadState &state, xml_node node)
     bool found = false;
 
     foreach (Shader *shader, state.scene->shaders) {
-      if (shader->name == shadername) {
+      if (shader->name == shadername && xml_shader_is_visible(state, shader)) {
         state.shader = shader;
         found = true;
         break;
@@ -710,7 +901,7 @@ static void xml_read_include(XMLReadState &state, const string &src)
 
 /* File */
 
-void xml_read_file(Scene *scene, const char *filepath)
+void xml_read_file(Scene *scene, const char *filepath, XMLSceneCache *cache)
 {
   XMLReadState state;
 
@@ -720,9 +911,48 @@ void xml_read_file(Scene *scene, const char *filepath)
   state.smooth = false;
   state.dicing_rate = 1.0f;
   state.base = path_dirname(filepath);
+  state.cache = cache;
+
+  if (cache) {
+    cache->shaders_read.clear();
+    cache->num_objects_read = 0;
+    cache->num_lights_read = 0;
+    cache->num_procedurals_read = 0;
+  }
 
   xml_read_include(state, path_filename(filepath));
 
+  if (cache) {
+    /* Remove nodes of the previous file which are not in this one. */
+    while (cache->objects.size() > cache->num_objects_read) {
+      Object *object = cache->objects.back().object;
+      Mesh *mesh = static_cast<Mesh *>(object->get_geometry());
+      scene->delete_node(object);
+      scene->delete_node(mesh);
+      cache->objects.pop_back();
+    }
+
+    while (cache->lights.size() > cache->num_lights_read) {
+      scene->delete_node(cache->lights.back().light);
+      cache->lights.pop_back();
+    }
+
+#ifdef WITH_ALEMBIC
+    while (cache->procedurals.size() > cache->num_procedurals_read) {
+      scene->delete_node(cache->procedurals.back().procedural);
+      cache->procedurals.pop_back();
+    }
+#endif
+
+    /* Shaders can not be freed while the scene exists, they are only marked as unused. They are
+     * kept in the cache to be reused when a later file has a shader of the same name again. */
+    foreach (Shader *shader, cache->shaders) {
+      if (!cache->shaders_read.count(shader)) {
+        scene->delete_node(shader);
+      }
+    }
+  }
+
   scene->params.bvh_type = BVH_TYPE_STATIC;
 }
 
@@ -5,11 +5,57 @@
 #ifndef __CYCLES_XML_H__
 #define __CYCLES_XML_H__
 
+#include "util/map.h"
+#include "util/set.h"
+#include "util/string.h"
+#include "util/transform.h"
+#include "util/vector.h"
+
 CCL_NAMESPACE_BEGIN
 
+class AlembicProcedural;
+class Light;
+class Object;
 class Scene;
+class Shader;
+
+/* Nodes created by reading a file, used to update the scene in place when the next file of a
+ * sequence is read into the same scene.
+ *
+ * Shaders are matched by name, meshes, lights and Alembic procedurals by their order in the file.
+ * Nodes whose XML did not change are left untouched, so their compiled shaders, images, BVHs and
+ * the light tree are kept in memory between frames. */
+struct XMLSceneCache {
+  struct CachedObject {
+    Object *object;
+    Transform tfm;
+    string hash;
+  };
+
+  struct CachedLight {
+    Light *light;
+    string hash;
+  };
+
+  struct CachedProcedural {
+    AlembicProcedural *procedural;
+    string hash;
+  };
+
+  map<const Shader *, string> shader_hashes;
+  vector<Shader *> shaders;
+  vector<CachedObject> objects;
+  vector<CachedLight> lights;
+  vector<CachedProcedural> procedurals;
+
+  /* Shaders, meshes, lights and procedurals read from the current file. */
+  set<const Shader *> shaders_read;
+  size_t num_objects_read = 0;
+  size_t num_lights_read = 0;
+  size_t num_procedurals_read = 0;
+};
 
-void xml_read_file(Scene *scene, const char *filepath);
+void xml_read_file(Scene *scene, const char *filepath, XMLSceneCache *cache = nullptr);
 
 /* macros for importing */
 #define RAD2DEGF(_rad) ((_rad) * (float)(180.0 / M_PI))
@@ -977,6 +977,30 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         description="",
         min=8, max=8192,
     )
+    use_streaming_finalize: BoolProperty(
+        name="Low Memory Finalize",
+        description="Denoise and write the result of a tiled render one tile at a time, instead of loading the full frame into memory after rendering. "
+        "Reduces peak memory usage of high resolution renders with many passes",
+        default=False,
+    )
+    use_texture_cache: BoolProperty(
+        name="Texture Cache",
+        description="Read image textures from disk on demand, one tile and mipmap level at a time, instead of loading full images into memory. "
+        "Only supported on the CPU, works best with tiled and mipmapped files generated with maketx",
+        default=False,
+    )
+    texture_cache_size: IntProperty(
+        name="Cache Size",
+        description="Maximum memory used by the texture cache, in megabytes",
+        default=4096,
+        min=64, max=1048576,
+    )
+    use_statistics_metadata: BoolProperty(
+        name="Statistics Metadata",
+        description="Store render statistics as JSON in the render result metadata, including synchronization times, "
+        "peak device memory and, when rendering on the CPU, per kernel, shader and object render times",
+        default=False,
+    )
 
     # Various fine-tuning debug flags
 
@@ -993,6 +1017,12 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         items=enum_bvh_layouts,
         default='EMBREE',
     )
+    debug_use_cpu_wavefront: BoolProperty(
+        name="Wavefront",
+        description="Schedule CPU paths kernel by kernel and sort them by shader, instead of tracing "
+        "each path from start to end",
+        default=False,
+    )
 
     debug_use_cuda_adaptive_compile: BoolProperty(name="Adaptive Compile", default=False)
 
@@ -328,6 +328,19 @@ void BlenderSession::stamp_view_layer_metadata(Scene *scene, const string &view_
                             time_human_readable_from_seconds(render_time).c_str());
   b_rr.stamp_data_add_field((prefix + "synchronization_time").c_str(),
                             time_human_readable_from_seconds(total_time - render_time).c_str());
+
+  /* Store machine-readable render statistics. */
+  if (use_statistics_metadata()) {
+    RenderStats stats;
+    session->collect_statistics(&stats);
+    b_rr.stamp_data_add_field((prefix + "statistics").c_str(), stats.json_report().c_str());
+  }
+}
+
+bool BlenderSession::use_statistics_metadata()
+{
+  PointerRNA cscene = RNA_pointer_get(&b_scene.ptr, "cycles");
+  return !b_engine.is_preview() && background && get_boolean(cscene, "use_statistics_metadata");
 }
 
 void BlenderSession::render(BL::Depsgraph &b_depsgraph_)
@@ -436,6 +449,9 @@ void BlenderSession::render(BL::Depsgraph &b_depsgraph_)
     if (!b_engine.is_preview() && background && print_render_stats) {
       scene->enable_update_stats();
     }
+    else if (use_statistics_metadata()) {
+      scene->enable_update_stats(false);
+    }
 
     session->start();
     session->wait();
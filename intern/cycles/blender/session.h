@@ -123,6 +123,9 @@ class BlenderSession {
  protected:
   void stamp_view_layer_metadata(Scene *scene, const string &view_layer_name);
 
+  /* Whether render statistics are stored in the render result metadata. */
+  bool use_statistics_metadata();
+
   /* Check whether session error happened.
    * If so, it is reported to the render engine and true is returned.
    * Otherwise false is returned. */
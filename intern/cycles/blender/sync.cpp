@@ -828,6 +828,9 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene,
     params.texture_limit = 0;
   }
 
+  params.use_texture_cache = RNA_boolean_get(&cscene, "use_texture_cache");
+  params.texture_cache_size = RNA_int_get(&cscene, "texture_cache_size");
+
   params.bvh_layout = DebugFlags().cpu.bvh_layout;
 
   params.background = background;
@@ -923,11 +926,13 @@ SessionParams BlenderSync::get_session_params(BL::RenderEngine &b_engine,
 
   /* Profiling. */
   params.use_profiling = params.device.has_profiling && !b_engine.is_preview() && background &&
-                         BlenderSession::print_render_stats;
+                         (BlenderSession::print_render_stats ||
+                          get_boolean(cscene, "use_statistics_metadata"));
 
   if (background) {
     params.use_auto_tile = RNA_boolean_get(&cscene, "use_auto_tile");
     params.tile_size = max(get_int(cscene, "tile_size"), 8);
+    params.use_streaming_finalize = RNA_boolean_get(&cscene, "use_streaming_finalize");
   }
   else {
     params.use_auto_tile = false;
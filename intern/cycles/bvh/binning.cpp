@@ -13,6 +13,7 @@
 
 #include "util/algorithm.h"
 #include "util/boundbox.h"
+#include "util/tbb.h"
 #include "util/types.h"
 
 CCL_NAMESPACE_BEGIN
@@ -49,6 +50,35 @@ __forceinline int get_best_dimension(const float4 &bestSAH)
     return 2;
 }
 
+/* Geometry and centroid bounds of primitives, computed with multiple threads. */
+static void parallel_bounds(const BVHReference *prims,
+                            const size_t num,
+                            BoundBox &geom_bounds,
+                            BoundBox &cent_bounds)
+{
+  struct ThreadBounds {
+    BoundBox geom = BoundBox::empty;
+    BoundBox cent = BoundBox::empty;
+  };
+  enumerable_thread_specific<ThreadBounds> thread_bounds;
+
+  parallel_for(blocked_range<size_t>(0, num, 4096), [&](const blocked_range<size_t> &r) {
+    ThreadBounds &bounds = thread_bounds.local();
+    for (size_t i = r.begin(); i < r.end(); i++) {
+      const BoundBox prim_bounds = prims[i].bounds();
+      bounds.geom.grow(prim_bounds);
+      bounds.cent.grow(prim_bounds.center2());
+    }
+  });
+
+  geom_bounds = BoundBox::empty;
+  cent_bounds = BoundBox::empty;
+  for (const ThreadBounds &bounds : thread_bounds) {
+    geom_bounds.grow(bounds.geom);
+    cent_bounds.grow(bounds.cent);
+  }
+}
+
 /* BVH Object Binning */
 
 BVHObjectBinning::BVHObjectBinning(const BVHRange &job,
@@ -87,63 +117,39 @@ BVHObjectBinning::BVHObjectBinning(const BVHRange &job,
     bin_bounds[i][0] = bin_bounds[i][1] = bin_bounds[i][2] = BoundBox::empty;
   }
 
-  /* map geometry to bins, unrolled once */
-  {
-    int64_t i;
-
-    for (i = 0; i < int64_t(size()) - 1; i += 2) {
-      prefetch_L2(&prims[start() + i + 8]);
-
-      /* map even and odd primitive to bin */
-      const BVHReference &prim0 = prims[start() + i + 0];
-      const BVHReference &prim1 = prims[start() + i + 1];
-
-      BoundBox bounds0 = get_prim_bounds(prim0);
-      BoundBox bounds1 = get_prim_bounds(prim1);
-
-      int4 bin0 = get_bin(bounds0);
-      int4 bin1 = get_bin(bounds1);
-
-      /* increase bounds for bins for even primitive */
-      int b00 = (int)extract<0>(bin0);
-      bin_count[b00][0]++;
-      bin_bounds[b00][0].grow(bounds0);
-      int b01 = (int)extract<1>(bin0);
-      bin_count[b01][1]++;
-      bin_bounds[b01][1].grow(bounds0);
-      int b02 = (int)extract<2>(bin0);
-      bin_count[b02][2]++;
-      bin_bounds[b02][2].grow(bounds0);
-
-      /* increase bounds of bins for odd primitive */
-      int b10 = (int)extract<0>(bin1);
-      bin_count[b10][0]++;
-      bin_bounds[b10][0].grow(bounds1);
-      int b11 = (int)extract<1>(bin1);
-      bin_count[b11][1]++;
-      bin_bounds[b11][1].grow(bounds1);
-      int b12 = (int)extract<2>(bin1);
-      bin_count[b12][2]++;
-      bin_bounds[b12][2].grow(bounds1);
-    }
-
-    /* for uneven number of primitives */
-    if (i < int64_t(size())) {
-      /* map primitive to bin */
-      const BVHReference &prim0 = prims[start() + i];
-      BoundBox bounds0 = get_prim_bounds(prim0);
-      int4 bin0 = get_bin(bounds0);
-
-      /* increase bounds of bins */
-      int b00 = (int)extract<0>(bin0);
-      bin_count[b00][0]++;
-      bin_bounds[b00][0].grow(bounds0);
-      int b01 = (int)extract<1>(bin0);
-      bin_count[b01][1]++;
-      bin_bounds[b01][1].grow(bounds0);
-      int b02 = (int)extract<2>(bin0);
-      bin_count[b02][2]++;
-      bin_bounds[b02][2].grow(bounds0);
+  /* map geometry to bins */
+  if (size() < PARALLEL_MIN_SIZE) {
+    bin_primitives(prims, 0, size(), bin_bounds, bin_count);
+  }
+  else {
+    /* Bin chunks into per-thread bins and merge them afterwards. */
+    struct ThreadBins {
+      BoundBox bounds[MAX_BINS][4];
+      int4 count[MAX_BINS];
+    };
+
+    enumerable_thread_specific<ThreadBins> thread_bins([this]() {
+      ThreadBins bins;
+      for (size_t i = 0; i < num_bins; i++) {
+        bins.count[i] = make_int4(0);
+        bins.bounds[i][0] = bins.bounds[i][1] = bins.bounds[i][2] = BoundBox::empty;
+      }
+      return bins;
+    });
+
+    parallel_for(blocked_range<size_t>(0, size(), PARALLEL_GRAIN_SIZE),
+                 [&](const blocked_range<size_t> &r) {
+                   ThreadBins &bins = thread_bins.local();
+                   bin_primitives(prims, r.begin(), r.end(), bins.bounds, bins.count);
+                 });
+
+    for (const ThreadBins &bins : thread_bins) {
+      for (size_t i = 0; i < num_bins; i++) {
+        bin_count[i] = bin_count[i] + bins.count[i];
+        for (int dim = 0; dim < 3; dim++) {
+          bin_bounds[i][dim].grow(bins.bounds[i][dim]);
+        }
+      }
     }
   }
 
@@ -208,6 +214,73 @@ BVHObjectBinning::BVHObjectBinning(const BVHRange &job,
   leafSAH = bounds_.half_area() * blocks(size());
 }
 
+void BVHObjectBinning::bin_primitives(const BVHReference *prims,
+                                      const size_t begin,
+                                      const size_t end,
+                                      BoundBox bin_bounds[MAX_BINS][4],
+                                      int4 bin_count[MAX_BINS]) const
+{
+  /* map geometry to bins, unrolled once */
+  {
+    int64_t i;
+
+    for (i = begin; i < int64_t(end) - 1; i += 2) {
+      prefetch_L2(&prims[start() + i + 8]);
+
+      /* map even and odd primitive to bin */
+      const BVHReference &prim0 = prims[start() + i + 0];
+      const BVHReference &prim1 = prims[start() + i + 1];
+
+      BoundBox bounds0 = get_prim_bounds(prim0);
+      BoundBox bounds1 = get_prim_bounds(prim1);
+
+      int4 bin0 = get_bin(bounds0);
+      int4 bin1 = get_bin(bounds1);
+
+      /* increase bounds for bins for even primitive */
+      int b00 = (int)extract<0>(bin0);
+      bin_count[b00][0]++;
+      bin_bounds[b00][0].grow(bounds0);
+      int b01 = (int)extract<1>(bin0);
+      bin_count[b01][1]++;
+      bin_bounds[b01][1].grow(bounds0);
+      int b02 = (int)extract<2>(bin0);
+      bin_count[b02][2]++;
+      bin_bounds[b02][2].grow(bounds0);
+
+      /* increase bounds of bins for odd primitive */
+      int b10 = (int)extract<0>(bin1);
+      bin_count[b10][0]++;
+      bin_bounds[b10][0].grow(bounds1);
+      int b11 = (int)extract<1>(bin1);
+      bin_count[b11][1]++;
+      bin_bounds[b11][1].grow(bounds1);
+      int b12 = (int)extract<2>(bin1);
+      bin_count[b12][2]++;
+      bin_bounds[b12][2].grow(bounds1);
+    }
+
+    /* for uneven number of primitives */
+    if (i < int64_t(end)) {
+      /* map primitive to bin */
+      const BVHReference &prim0 = prims[start() + i];
+      BoundBox bounds0 = get_prim_bounds(prim0);
+      int4 bin0 = get_bin(bounds0);
+
+      /* increase bounds of bins */
+      int b00 = (int)extract<0>(bin0);
+      bin_count[b00][0]++;
+      bin_bounds[b00][0].grow(bounds0);
+      int b01 = (int)extract<1>(bin0);
+      bin_count[b01][1]++;
+      bin_bounds[b01][1].grow(bounds0);
+      int b02 = (int)extract<2>(bin0);
+      bin_count[b02][2]++;
+      bin_bounds[b02][2].grow(bounds0);
+    }
+  }
+}
+
 void BVHObjectBinning::split(BVHReference *prims,
                              BVHObjectBinning &left_o,
                              BVHObjectBinning &right_o) const
@@ -219,34 +292,52 @@ void BVHObjectBinning::split(BVHReference *prims,
   BoundBox lcent_bounds = BoundBox::empty;
   BoundBox rcent_bounds = BoundBox::empty;
 
-  int64_t l = 0, r = N - 1;
-
-  while (l <= r) {
-    prefetch_L2(&prims[start() + l + 8]);
-    prefetch_L2(&prims[start() + r - 8]);
-
-    BVHReference prim = prims[start() + l];
-    BoundBox unaligned_bounds = get_prim_bounds(prim);
-    float3 unaligned_center = unaligned_bounds.center2();
-    float3 center = prim.bounds().center2();
-
-    if (get_bin(unaligned_center)[dim] < pos) {
-      lgeom_bounds.grow(prim.bounds());
-      lcent_bounds.grow(center);
-      l++;
-    }
-    else {
-      rgeom_bounds.grow(prim.bounds());
-      rcent_bounds.grow(center);
-      swap(prims[start() + l], prims[start() + r]);
-      r--;
+  size_t num_left;
+
+  if (N < PARALLEL_MIN_SIZE) {
+    int64_t l = 0, r = N - 1;
+
+    while (l <= r) {
+      prefetch_L2(&prims[start() + l + 8]);
+      prefetch_L2(&prims[start() + r - 8]);
+
+      BVHReference prim = prims[start() + l];
+      BoundBox unaligned_bounds = get_prim_bounds(prim);
+      float3 unaligned_center = unaligned_bounds.center2();
+      float3 center = prim.bounds().center2();
+
+      if (get_bin(unaligned_center)[dim] < pos) {
+        lgeom_bounds.grow(prim.bounds());
+        lcent_bounds.grow(center);
+        l++;
+      }
+      else {
+        rgeom_bounds.grow(prim.bounds());
+        rcent_bounds.grow(center);
+        swap(prims[start() + l], prims[start() + r]);
+        r--;
+      }
     }
+
+    num_left = l;
+  }
+  else {
+    /* Partition in place, then compute the bounds of both sides in parallel. */
+    BVHReference *begin = prims + start();
+    BVHReference *mid = std::partition(begin, begin + N, [this](const BVHReference &prim) {
+      return get_bin(get_prim_bounds(prim).center2())[dim] < pos;
+    });
+
+    num_left = mid - begin;
+    parallel_bounds(begin, num_left, lgeom_bounds, lcent_bounds);
+    parallel_bounds(mid, N - num_left, rgeom_bounds, rcent_bounds);
   }
+
   /* finish */
-  if (l != 0 && N - 1 - r != 0) {
-    right_o = BVHObjectBinning(BVHRange(rgeom_bounds, rcent_bounds, start() + l, N - 1 - r),
-                               prims);
-    left_o = BVHObjectBinning(BVHRange(lgeom_bounds, lcent_bounds, start(), l), prims);
+  if (num_left != 0 && num_left != N) {
+    right_o = BVHObjectBinning(
+        BVHRange(rgeom_bounds, rcent_bounds, start() + num_left, N - num_left), prims);
+    left_o = BVHObjectBinning(BVHRange(lgeom_bounds, lcent_bounds, start(), num_left), prims);
     return;
   }
 
@@ -17,12 +17,16 @@ CCL_NAMESPACE_BEGIN
 
 class BVHBuild;
 
-/* Single threaded object binner. Finds the split with the best SAH heuristic
+/* Object binner. Finds the split with the best SAH heuristic
  * by testing for each dimension multiple partitionings for regular spaced
  * partition locations. A partitioning for a partition location is computed,
  * by putting primitives whose centroid is on the left and right of the split
  * location to different sets. The SAH is evaluated by computing the number of
- * blocks occupied by the primitives in the partitions. */
+ * blocks occupied by the primitives in the partitions.
+ *
+ * Large ranges, like the root of a big mesh, are binned and bounded using
+ * multiple threads, smaller ranges are handled by a single thread since the
+ * builder already processes them in parallel. */
 
 class BVHObjectBinning : public BVHRange {
  public:
@@ -58,6 +62,16 @@ class BVHObjectBinning : public BVHRange {
 
   enum { MAX_BINS = 32 };
   enum { LOG_BLOCK_SIZE = 2 };
+  /* Minimum number of primitives to bin and split using multiple threads. */
+  enum { PARALLEL_MIN_SIZE = 1 << 16 };
+  enum { PARALLEL_GRAIN_SIZE = 4096 };
+
+  /* Map primitives in [begin, end[ of the range to bins. */
+  void bin_primitives(const BVHReference *prims,
+                      size_t begin,
+                      size_t end,
+                      BoundBox bin_bounds[MAX_BINS][4],
+                      int4 bin_count[MAX_BINS]) const;
 
   /* computes the bin numbers for each dimension for a box. */
   __forceinline int4 get_bin(const BoundBox &box) const
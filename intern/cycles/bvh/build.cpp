@@ -47,6 +47,8 @@ BVHBuild::BVHBuild(const vector<Object *> &objects_,
       params(params_),
       progress(progress_),
       progress_start_time(0.0),
+      spatial_max_duplicates(0),
+      spatial_num_duplicates(0),
       unaligned_heuristic(objects_)
 {
   spatial_min_overlap = 0.0f;
@@ -469,7 +471,9 @@ BVHNode *BVHBuild::run()
   BVHRange root;
 
   /* add references */
+  double start_time = time_dt();
   add_references(root);
+  times.add_references = time_dt() - start_time;
 
   if (progress.get_cancel())
     return NULL;
@@ -487,6 +491,13 @@ BVHNode *BVHBuild::run()
   spatial_min_overlap = root.bounds().safe_area() * params.spatial_split_alpha;
   spatial_free_index = 0;
 
+  /* Duplicated references are what makes spatial split builds of large meshes
+   * run out of memory, so cap their number. */
+  spatial_max_duplicates = (params.spatial_split_memory_budget != 0) ?
+                               params.spatial_split_memory_budget / sizeof(BVHReference) :
+                               references.size() / 2;
+  spatial_num_duplicates = 0;
+
   need_prim_time = params.use_motion_steps();
 
   /* init progress updates */
@@ -522,9 +533,17 @@ BVHNode *BVHBuild::run()
     task_pool.wait_work();
   }
 
+  times.build_nodes = time_dt() - build_start_time;
+
   /* clean up temporary memory usage by threads */
   spatial_storage.clear();
 
+  if (params.use_spatial_split && spatial_split_budget_exhausted()) {
+    VLOG_WORK << "BVH spatial split memory budget of "
+              << string_human_readable_size(spatial_max_duplicates * sizeof(BVHReference))
+              << " reached, used object splits for the remaining nodes.";
+  }
+
   /* delete if we canceled */
   if (rootnode) {
     if (progress.get_cancel()) {
@@ -557,7 +576,9 @@ BVHNode *BVHBuild::run()
                                                   1.0f)
                 << "\n"
                 << "  Maximum depth: "
-                << string_human_readable_number(rootnode->getSubtreeSize(BVH_STAT_DEPTH)) << "\n";
+                << string_human_readable_number(rootnode->getSubtreeSize(BVH_STAT_DEPTH)) << "\n"
+                << "  Spatial split duplicates: "
+                << string_human_readable_number(spatial_num_duplicates) << "\n";
     }
   }
 
@@ -624,6 +645,26 @@ void BVHBuild::thread_build_spatial_split_node(InnerNode *inner,
   inner->children[child] = node;
 }
 
+size_t BVHBuild::spatial_split_reserve(const size_t num)
+{
+  size_t num_duplicates = spatial_num_duplicates.load(std::memory_order_relaxed);
+  size_t num_reserved;
+  do {
+    num_reserved = (num_duplicates < spatial_max_duplicates) ?
+                       min(num, spatial_max_duplicates - num_duplicates) :
+                       0;
+  } while (num_reserved != 0 && !spatial_num_duplicates.compare_exchange_weak(
+                                    num_duplicates, num_duplicates + num_reserved));
+  return num_reserved;
+}
+
+void BVHBuild::spatial_split_release(const size_t num)
+{
+  if (num != 0) {
+    spatial_num_duplicates -= num;
+  }
+}
+
 bool BVHBuild::range_within_max_leaf_size(const BVHRange &range,
                                           const vector<BVHReference> &references) const
 {
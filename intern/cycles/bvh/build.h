@@ -8,6 +8,7 @@
 #ifndef __BVH_BUILD_H__
 #define __BVH_BUILD_H__
 
+#include <atomic>
 #include <float.h>
 
 #include "bvh/params.h"
@@ -48,6 +49,9 @@ class BVHBuild {
 
   BVHNode *run();
 
+  /* Time spent adding references and building nodes. */
+  BVHBuildTimes times;
+
  protected:
   friend class BVHMixedSplit;
   friend class BVHObjectSplit;
@@ -122,6 +126,19 @@ class BVHBuild {
   size_t spatial_free_index;
   thread_spin_lock spatial_spin_lock;
 
+  /* Spatial split memory budget, in number of duplicated references. */
+  size_t spatial_max_duplicates;
+  std::atomic<size_t> spatial_num_duplicates;
+
+  /* Reserve up to num duplicated references from the budget, returns how many were granted.
+   * Unused references must be returned with spatial_split_release(). */
+  size_t spatial_split_reserve(size_t num);
+  void spatial_split_release(size_t num);
+  bool spatial_split_budget_exhausted() const
+  {
+    return spatial_num_duplicates.load(std::memory_order_relaxed) >= spatial_max_duplicates;
+  }
+
   /* Threads. */
   TaskPool task_pool;
 
@@ -51,13 +51,20 @@ struct PackedBVH {
   array<int> prim_object;
   /* Time range of BVH primitive. */
   array<float2> prim_time;
+  /* Wide BVH nodes, collapsed from the BVH2 nodes and sharing their leaf nodes. */
+  array<int4> wide_nodes;
+  /* object index to wide BVH node index mapping for instances */
+  array<int> object_wide_node;
 
   /* index of the root node. */
   int root_index;
+  /* index of the wide BVH root node. */
+  int wide_root_index;
 
   PackedBVH()
   {
     root_index = 0;
+    wide_root_index = 0;
   }
 };
 
@@ -17,7 +17,9 @@
 #include "bvh/unaligned.h"
 
 #include "util/foreach.h"
+#include "util/log.h"
 #include "util/progress.h"
+#include "util/time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -31,7 +33,7 @@ int BVHStackEntry::encodeIdx() const
 BVH2::BVH2(const BVHParams &params_,
            const vector<Geometry *> &geometry_,
            const vector<Object *> &objects_)
-    : BVH(params_, geometry_, objects_)
+    : BVH(params_, geometry_, objects_), build_sah_cost(0.0f), sah_cost(0.0f)
 {
 }
 
@@ -39,6 +41,8 @@ void BVH2::build(Progress &progress, Stats *)
 {
   progress.set_substatus("Building BVH");
 
+  build_times = BVHBuildTimes();
+
   /* build nodes */
   BVHBuild bvh_build(objects,
                      pack.prim_type,
@@ -48,6 +52,7 @@ void BVH2::build(Progress &progress, Stats *)
                      params,
                      progress);
   BVHNode *bvh2_root = bvh_build.run();
+  build_times = bvh_build.times;
 
   if (progress.get_cancel()) {
     if (bvh2_root != NULL) {
@@ -72,7 +77,9 @@ void BVH2::build(Progress &progress, Stats *)
 
   /* pack triangles */
   progress.set_substatus("Packing BVH triangles and strands");
+  double start_time = time_dt();
   pack_primitives();
+  build_times.pack_primitives = time_dt() - start_time;
 
   if (progress.get_cancel()) {
     root->deleteSubtree();
@@ -81,7 +88,14 @@ void BVH2::build(Progress &progress, Stats *)
 
   /* pack nodes */
   progress.set_substatus("Packing BVH nodes");
+  start_time = time_dt();
   pack_nodes(root);
+  build_times.pack_nodes = time_dt() - start_time;
+
+  /* Measure the packed tree with full primitive bounds, the same way refit does, so the
+   * costs compared in refit() are not skewed by the clipped bounds of spatial splits.
+   * Only bottom level BVHs are refitted. */
+  build_sah_cost = sah_cost = (params.top_level) ? 0.0f : compute_sah_cost(false);
 
   /* free build nodes */
   root->deleteSubtree();
@@ -89,14 +103,31 @@ void BVH2::build(Progress &progress, Stats *)
 
 void BVH2::refit(Progress &progress)
 {
+  build_times = BVHBuildTimes();
+
   progress.set_substatus("Packing BVH primitives");
+  double start_time = time_dt();
   pack_primitives();
+  build_times.pack_primitives = time_dt() - start_time;
 
   if (progress.get_cancel())
     return;
 
   progress.set_substatus("Refitting BVH nodes");
-  refit_nodes();
+  start_time = time_dt();
+  sah_cost = compute_sah_cost(true);
+  build_times.refit_nodes = time_dt() - start_time;
+
+  /* Rebuild when deformation made the tree too expensive to traverse, the
+   * refit is cheap enough compared to a build to not be a wasted effort. */
+  if (build_sah_cost > 0.0f && sah_cost > build_sah_cost * params.refit_max_sah_increase) {
+    VLOG_WORK << "BVH refit increased SAH cost from " << build_sah_cost << " to " << sah_cost
+              << ", rebuilding.";
+
+    const BVHBuildTimes refit_times = build_times;
+    build(progress, NULL);
+    build_times += refit_times;
+  }
 }
 
 BVHNode *BVH2::widen_children_nodes(const BVHNode *root)
@@ -300,18 +331,36 @@ void BVH2::pack_nodes(const BVHNode *root)
   assert(node_size == nextNodeIdx);
   /* root index to start traversal at, to handle case of single leaf node */
   pack.root_index = (root->is_leaf()) ? -1 : 0;
+
+  if (params.top_level && params.use_wide_nodes) {
+    pack_wide_nodes();
+  }
 }
 
-void BVH2::refit_nodes()
+float BVH2::compute_sah_cost(bool update_nodes)
 {
   assert(!params.top_level);
 
   BoundBox bbox = BoundBox::empty;
   uint visibility = 0;
-  refit_node(0, (pack.root_index == -1) ? true : false, bbox, visibility);
+  float sah_area_cost = 0.0f;
+  refit_node(0,
+             (pack.root_index == -1) ? true : false,
+             update_nodes,
+             bbox,
+             visibility,
+             sah_area_cost);
+
+  const float root_area = bbox.safe_area();
+  return (root_area > 0.0f) ? sah_area_cost / root_area : 0.0f;
 }
 
-void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
+void BVH2::refit_node(int idx,
+                      bool leaf,
+                      bool update_nodes,
+                      BoundBox &bbox,
+                      uint &visibility,
+                      float &sah_area_cost)
 {
   if (leaf) {
     /* refit leaf node */
@@ -321,6 +370,11 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     const int c1 = data[0].y;
 
     refit_primitives(c0, c1, bbox, visibility);
+    sah_area_cost += bbox.safe_area() * params.cost(0, c1 - c0);
+
+    if (!update_nodes) {
+      return;
+    }
 
     /* TODO(sergey): De-duplicate with pack_leaf(). */
     float4 leaf_data[BVH_NODE_LEAF_SIZE];
@@ -341,21 +395,26 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     BoundBox bbox0 = BoundBox::empty, bbox1 = BoundBox::empty;
     uint visibility0 = 0, visibility1 = 0;
 
-    refit_node((c0 < 0) ? -c0 - 1 : c0, (c0 < 0), bbox0, visibility0);
-    refit_node((c1 < 0) ? -c1 - 1 : c1, (c1 < 0), bbox1, visibility1);
+    refit_node(
+        (c0 < 0) ? -c0 - 1 : c0, (c0 < 0), update_nodes, bbox0, visibility0, sah_area_cost);
+    refit_node(
+        (c1 < 0) ? -c1 - 1 : c1, (c1 < 0), update_nodes, bbox1, visibility1, sah_area_cost);
 
-    if (is_unaligned) {
-      Transform aligned_space = transform_identity();
-      pack_unaligned_node(
-          idx, aligned_space, aligned_space, bbox0, bbox1, c0, c1, visibility0, visibility1);
-    }
-    else {
-      pack_aligned_node(idx, bbox0, bbox1, c0, c1, visibility0, visibility1);
+    if (update_nodes) {
+      if (is_unaligned) {
+        Transform aligned_space = transform_identity();
+        pack_unaligned_node(
+            idx, aligned_space, aligned_space, bbox0, bbox1, c0, c1, visibility0, visibility1);
+      }
+      else {
+        pack_aligned_node(idx, bbox0, bbox1, c0, c1, visibility0, visibility1);
+      }
     }
 
     bbox.grow(bbox0);
     bbox.grow(bbox1);
     visibility = visibility0 | visibility1;
+    sah_area_cost += bbox.safe_area() * params.cost(2, 0);
   }
 }
 
@@ -647,4 +706,157 @@ void BVH2::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
   }
 }
 
+/* Pack Wide Nodes
+ *
+ * Collapse the final BVH2, including merged instances, into nodes with up to four children so
+ * the CPU can intersect all child bounds of a node at once with SIMD. Leaf nodes are shared with
+ * the BVH2, so wide nodes only store child bounds, visibility and addresses. */
+
+struct BVHWideChild {
+  int addr;
+  uint visibility;
+  BoundBox bounds;
+};
+
+static void bvh2_node_children(const int4 *nodes, const int node_addr, BVHWideChild children[2])
+{
+  const int4 data = nodes[node_addr];
+  children[0].addr = data.z;
+  children[1].addr = data.w;
+  children[0].visibility = data.x & ~PATH_RAY_NODE_UNALIGNED;
+  children[1].visibility = data.y & ~PATH_RAY_NODE_UNALIGNED;
+
+  if (data.x & PATH_RAY_NODE_UNALIGNED) {
+    /* Wide nodes only store axis aligned bounds, use the box around the oriented bounds. The
+     * node space maps the child bounds to the unit cube. */
+    for (int i = 0; i < 2; i++) {
+      Transform space;
+      space.x = __int4_as_float4(nodes[node_addr + i * 3 + 1]);
+      space.y = __int4_as_float4(nodes[node_addr + i * 3 + 2]);
+      space.z = __int4_as_float4(nodes[node_addr + i * 3 + 3]);
+      const Transform ispace = transform_inverse(space);
+
+      children[i].bounds = BoundBox::empty;
+      for (int corner = 0; corner < 8; corner++) {
+        const float3 P = make_float3(corner & 1, (corner >> 1) & 1, (corner >> 2) & 1);
+        children[i].bounds.grow(transform_point(&ispace, P));
+      }
+    }
+  }
+  else {
+    for (int i = 0; i < 2; i++) {
+      children[i].bounds.min = make_float3(__int_as_float(nodes[node_addr + 1][i]),
+                                           __int_as_float(nodes[node_addr + 2][i]),
+                                           __int_as_float(nodes[node_addr + 3][i]));
+      children[i].bounds.max = make_float3(__int_as_float(nodes[node_addr + 1][i + 2]),
+                                           __int_as_float(nodes[node_addr + 2][i + 2]),
+                                           __int_as_float(nodes[node_addr + 3][i + 2]));
+    }
+  }
+}
+
+int BVH2::pack_wide_node(const int node_addr, vector<int4> &wide_nodes)
+{
+  BVHWideChild children[BVH_WIDE_NODE_CHILDREN];
+  bvh2_node_children(&pack.nodes[0], node_addr, children);
+  int num_children = 2;
+
+  /* Pull up the grandchildren of the inner child with the largest surface area until the node is
+   * full, large children are the most likely to be intersected. */
+  while (num_children < BVH_WIDE_NODE_CHILDREN) {
+    int best_child = -1;
+    float best_area = -FLT_MAX;
+    for (int i = 0; i < num_children; i++) {
+      if (children[i].addr >= 0 && children[i].bounds.safe_area() > best_area) {
+        best_child = i;
+        best_area = children[i].bounds.safe_area();
+      }
+    }
+    if (best_child == -1) {
+      break;
+    }
+
+    BVHWideChild grandchildren[2];
+    bvh2_node_children(&pack.nodes[0], children[best_child].addr, grandchildren);
+    /* BVH2 traversal tests the visibility of both levels. */
+    grandchildren[0].visibility &= children[best_child].visibility;
+    grandchildren[1].visibility &= children[best_child].visibility;
+    children[best_child] = grandchildren[0];
+    children[num_children++] = grandchildren[1];
+  }
+
+  /* Allocate the node before its children, so traversal walks the array mostly forward. */
+  const int idx = wide_nodes.size();
+  wide_nodes.resize(idx + BVH_WIDE_NODE_SIZE);
+
+  int4 data[BVH_WIDE_NODE_SIZE];
+  for (int i = 0; i < BVH_WIDE_NODE_CHILDREN; i++) {
+    if (i < num_children) {
+      const BVHWideChild &child = children[i];
+      const int child_addr = (child.addr >= 0) ? pack_wide_node(child.addr, wide_nodes) :
+                                                 child.addr;
+      data[0][i] = child.visibility;
+      data[1][i] = __float_as_int(child.bounds.min.x);
+      data[2][i] = __float_as_int(child.bounds.max.x);
+      data[3][i] = __float_as_int(child.bounds.min.y);
+      data[4][i] = __float_as_int(child.bounds.max.y);
+      data[5][i] = __float_as_int(child.bounds.min.z);
+      data[6][i] = __float_as_int(child.bounds.max.z);
+      data[7][i] = child_addr;
+    }
+    else {
+      /* Empty slot, the inverted bounds are never intersected. */
+      data[0][i] = 0;
+      data[1][i] = __float_as_int(FLT_MAX);
+      data[2][i] = __float_as_int(-FLT_MAX);
+      data[3][i] = __float_as_int(FLT_MAX);
+      data[4][i] = __float_as_int(-FLT_MAX);
+      data[5][i] = __float_as_int(FLT_MAX);
+      data[6][i] = __float_as_int(-FLT_MAX);
+      data[7][i] = 0;
+    }
+  }
+
+  memcpy(&wide_nodes[idx], data, sizeof(int4) * BVH_WIDE_NODE_SIZE);
+  return idx;
+}
+
+void BVH2::pack_wide_nodes()
+{
+  assert(params.top_level);
+
+  vector<int4> wide_nodes;
+  wide_nodes.reserve(pack.nodes.size() / BVH_NODE_SIZE * BVH_WIDE_NODE_SIZE / 2);
+
+  /* Leaf addresses index the shared BVH2 leaf nodes and are kept as is. */
+  pack.wide_root_index = (pack.root_index == -1) ? -1 : pack_wide_node(0, wide_nodes);
+
+  /* Instanced geometry BVH2 roots, converted once per geometry. */
+  pack.object_wide_node.resize(objects.size());
+  unordered_map<int, int> wide_node_map;
+
+  for (size_t i = 0; i < objects.size(); i++) {
+    const int node_addr = pack.object_node[i];
+    if (!objects[i]->get_geometry()->need_build_bvh(params.bvh_layout) || node_addr < 0) {
+      pack.object_wide_node[i] = node_addr;
+      continue;
+    }
+
+    unordered_map<int, int>::iterator it = wide_node_map.find(node_addr);
+    if (it != wide_node_map.end()) {
+      pack.object_wide_node[i] = it->second;
+      continue;
+    }
+
+    const int wide_addr = pack_wide_node(node_addr, wide_nodes);
+    wide_node_map[node_addr] = wide_addr;
+    pack.object_wide_node[i] = wide_addr;
+  }
+
+  pack.wide_nodes.resize(wide_nodes.size());
+  if (wide_nodes.size()) {
+    memcpy(pack.wide_nodes.data(), wide_nodes.data(), sizeof(int4) * wide_nodes.size());
+  }
+}
+
 CCL_NAMESPACE_END
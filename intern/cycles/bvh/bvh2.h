@@ -19,6 +19,8 @@ CCL_NAMESPACE_BEGIN
 #define BVH_NODE_SIZE 4
 #define BVH_NODE_LEAF_SIZE 1
 #define BVH_UNALIGNED_NODE_SIZE 7
+#define BVH_WIDE_NODE_SIZE 8
+#define BVH_WIDE_NODE_CHILDREN 4
 
 /* Pack Utility */
 struct BVHStackEntry {
@@ -40,6 +42,14 @@ class BVH2 : public BVH {
 
   PackedBVH pack;
 
+  /* Time spent in the phases of the last build() or refit(). */
+  BVHBuildTimes build_times;
+
+  /* SAH cost of the tree relative to the area of its root, after the last full
+   * build and after the last build or refit. */
+  float build_sah_cost;
+  float sah_cost;
+
  protected:
   /* constructor */
   friend class BVH;
@@ -81,8 +91,15 @@ class BVH2 : public BVH {
                            uint visibility1);
 
   /* refit */
-  void refit_nodes();
-  void refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility);
+  /* Traverse the packed nodes computing bounds from the primitives, and return the SAH cost of
+   * the tree. When update_nodes is set the packed node bounds are refitted as well. */
+  float compute_sah_cost(bool update_nodes);
+  void refit_node(int idx,
+                  bool leaf,
+                  bool update_nodes,
+                  BoundBox &bbox,
+                  uint &visibility,
+                  float &sah_area_cost);
 
   /* Refit range of primitives. */
   void refit_primitives(int start, int end, BoundBox &bbox, uint &visibility);
@@ -93,6 +110,10 @@ class BVH2 : public BVH {
 
   /* merge instance BVH's */
   void pack_instances(size_t nodes_size, size_t leaf_nodes_size);
+
+  /* wide nodes */
+  void pack_wide_nodes();
+  int pack_wide_node(int node_addr, vector<int4> &wide_nodes);
 };
 
 CCL_NAMESPACE_END
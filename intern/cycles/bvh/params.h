@@ -60,6 +60,12 @@ class BVHParams {
   bool use_spatial_split;
   float spatial_split_alpha;
 
+  /* Maximum memory in bytes for references duplicated by spatial splits. Once
+   * reached, remaining nodes are built with object splits only. Zero uses half
+   * the memory of the original references.
+   */
+  size_t spatial_split_memory_budget;
+
   /* Unaligned nodes creation threshold */
   float unaligned_split_threshold;
 
@@ -67,6 +73,12 @@ class BVHParams {
   float sah_node_cost;
   float sah_primitive_cost;
 
+  /* Refitting keeps the topology of the tree, which degrades as the geometry
+   * deforms away from the shape it was built for. A full rebuild is done when
+   * the SAH cost after refit exceeds the cost after the last build by this factor.
+   */
+  float refit_max_sah_increase;
+
   /* number of primitives in leaf */
   int min_leaf_size;
   int max_triangle_leaf_size;
@@ -90,6 +102,11 @@ class BVHParams {
   /* Use compact acceleration structure (Embree)*/
   bool use_compact_structure;
 
+  /* Also pack BVH2 into 4-wide nodes for SIMD traversal on the CPU.
+   * Only used for the top level BVH2, after instances were merged.
+   */
+  bool use_wide_nodes;
+
   /* Split time range to this number of steps and create leaf node for each
    * of this time steps.
    *
@@ -114,6 +131,7 @@ class BVHParams {
   {
     use_spatial_split = true;
     spatial_split_alpha = 1e-5f;
+    spatial_split_memory_budget = 0;
 
     unaligned_split_threshold = 0.7f;
 
@@ -122,6 +140,8 @@ class BVHParams {
     sah_node_cost = 1.0f;
     sah_primitive_cost = 1.0f;
 
+    refit_max_sah_increase = 1.5f;
+
     min_leaf_size = 1;
     max_triangle_leaf_size = 8;
     max_motion_triangle_leaf_size = 8;
@@ -134,6 +154,7 @@ class BVHParams {
     bvh_layout = BVH_LAYOUT_BVH2;
     use_compact_structure = false;
     use_unaligned_nodes = false;
+    use_wide_nodes = false;
 
     num_motion_curve_steps = 0;
     num_motion_triangle_steps = 0;
@@ -179,6 +200,28 @@ class BVHParams {
   static BVHLayout best_bvh_layout(BVHLayout requested_layout, BVHLayoutMask supported_layouts);
 };
 
+/* BVH Build Times
+ *
+ * Time in seconds spent in the phases of building or refitting a BVH2. */
+
+struct BVHBuildTimes {
+  double add_references = 0.0;
+  double build_nodes = 0.0;
+  double pack_primitives = 0.0;
+  double pack_nodes = 0.0;
+  double refit_nodes = 0.0;
+
+  BVHBuildTimes &operator+=(const BVHBuildTimes &other)
+  {
+    add_references += other.add_references;
+    build_nodes += other.build_nodes;
+    pack_primitives += other.pack_primitives;
+    pack_nodes += other.pack_nodes;
+    refit_nodes += other.refit_nodes;
+    return *this;
+  }
+};
+
 /* BVH Reference
  *
  * Reference to a primitive. Primitive index and object are sneakily packed
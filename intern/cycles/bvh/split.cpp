@@ -265,6 +265,11 @@ void BVHSpatialSplit::split(BVHBuild *builder,
   vector<BVHReference> &new_refs = storage_->new_references;
   new_refs.clear();
   new_refs.reserve(right_start - left_end);
+
+  /* Only duplicate as many references as the remaining memory budget allows,
+   * other references straddling the plane are unsplit. */
+  const size_t num_reserved = builder->spatial_split_reserve(right_start - left_end);
+
   while (left_end < right_start) {
     /* split reference. */
     BVHReference curr_ref(get_prim_bounds(refs[left_end]),
@@ -292,7 +297,9 @@ void BVHSpatialSplit::split(BVHBuild *builder,
 
     float unsplitLeftSAH = lub.safe_area() * lbc + right_bounds.safe_area() * rac;
     float unsplitRightSAH = left_bounds.safe_area() * lac + rub.safe_area() * rbc;
-    float duplicateSAH = ldb.safe_area() * lbc + rdb.safe_area() * rbc;
+    float duplicateSAH = (new_refs.size() < num_reserved) ?
+                             ldb.safe_area() * lbc + rdb.safe_area() * rbc :
+                             FLT_MAX;
     float minSAH = min(min(unsplitLeftSAH, unsplitRightSAH), duplicateSAH);
 
     if (minSAH == unsplitLeftSAH) {
@@ -314,6 +321,8 @@ void BVHSpatialSplit::split(BVHBuild *builder,
       right_end++;
     }
   }
+  builder->spatial_split_release(num_reserved - new_refs.size());
+
   /* Insert duplicated references into actual array in one go. */
   if (new_refs.size() != 0) {
     refs.insert(refs.begin() + (right_end - new_refs.size()), new_refs.begin(), new_refs.end());
@@ -206,7 +206,9 @@ class BVHMixedSplit {
     object = BVHObjectSplit(
         builder, storage, range, references, nodeSAH, unaligned_heuristic, aligned_space);
 
-    if (builder->params.use_spatial_split && level < BVHParams::MAX_SPATIAL_DEPTH) {
+    if (builder->params.use_spatial_split && level < BVHParams::MAX_SPATIAL_DEPTH &&
+        !builder->spatial_split_budget_exhausted())
+    {
       BoundBox overlap = object.left_bounds;
       overlap.intersect(object.right_bounds);
 
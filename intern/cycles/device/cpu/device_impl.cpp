@@ -131,7 +131,7 @@ void CPUDevice::mem_alloc(device_memory &mem)
     }
 
     mem.device_size = mem.memory_size();
-    stats.mem_alloc(mem.device_size);
+    stats.mem_alloc(mem.device_size, mem.type);
   }
 }
 
@@ -184,7 +184,7 @@ void CPUDevice::mem_free(device_memory &mem)
       util_aligned_free((void *)mem.device_pointer);
     }
     mem.device_pointer = 0;
-    stats.mem_free(mem.device_size);
+    stats.mem_free(mem.device_size, mem.type);
     mem.device_size = 0;
   }
 }
@@ -218,14 +218,14 @@ void CPUDevice::global_alloc(device_memory &mem)
 
   mem.device_pointer = (device_ptr)mem.host_pointer;
   mem.device_size = mem.memory_size();
-  stats.mem_alloc(mem.device_size);
+  stats.mem_alloc(mem.device_size, mem.type);
 }
 
 void CPUDevice::global_free(device_memory &mem)
 {
   if (mem.device_pointer) {
     mem.device_pointer = 0;
-    stats.mem_free(mem.device_size);
+    stats.mem_free(mem.device_size, mem.type);
     mem.device_size = 0;
   }
 }
@@ -238,7 +238,7 @@ void CPUDevice::tex_alloc(device_texture &mem)
 
   mem.device_pointer = (device_ptr)mem.host_pointer;
   mem.device_size = mem.memory_size();
-  stats.mem_alloc(mem.device_size);
+  stats.mem_alloc(mem.device_size, mem.type);
 
   const uint slot = mem.slot;
   if (slot >= texture_info.size()) {
@@ -255,7 +255,7 @@ void CPUDevice::tex_free(device_texture &mem)
 {
   if (mem.device_pointer) {
     mem.device_pointer = 0;
-    stats.mem_free(mem.device_size);
+    stats.mem_free(mem.device_size, mem.type);
     mem.device_size = 0;
     need_texture_info = true;
   }
@@ -13,6 +13,7 @@ CCL_NAMESPACE_BEGIN
 struct KernelGlobalsCPU;
 struct KernelFilmConvert;
 struct IntegratorStateCPU;
+struct IntegratorShadowStateCPU;
 struct TileInfo;
 
 class CPUKernels {
@@ -43,6 +44,23 @@ class CPUKernels {
   IntegratorShadeFunction integrator_shade_dedicated_light;
   IntegratorShadeFunction integrator_megakernel;
 
+  /* Execute a single kernel for a batch of paths, for wavefront path tracing. */
+  using IntegratorWavefrontFunction =
+      CPUKernelFunction<void (*)(const KernelGlobalsCPU *kg,
+                                 IntegratorStateCPU *const *states,
+                                 const int num_states,
+                                 const int kernel,
+                                 ccl_global float *render_buffer)>;
+  using IntegratorWavefrontShadowFunction =
+      CPUKernelFunction<void (*)(const KernelGlobalsCPU *kg,
+                                 IntegratorShadowStateCPU *const *states,
+                                 const int num_states,
+                                 const int kernel,
+                                 ccl_global float *render_buffer)>;
+
+  IntegratorWavefrontFunction integrator_wavefront_paths;
+  IntegratorWavefrontShadowFunction integrator_wavefront_shadow_paths;
+
   /* Shader evaluation. */
 
   using ShaderEvalFunction = CPUKernelFunction<void (*)(
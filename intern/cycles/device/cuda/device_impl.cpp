@@ -794,7 +794,7 @@ void CUDADevice::tex_alloc(device_texture &mem)
 
     mem.device_pointer = (device_ptr)array_3d;
     mem.device_size = size;
-    stats.mem_alloc(size);
+    stats.mem_alloc(size, mem.type);
 
     thread_scoped_lock lock(device_mem_map_mutex);
     cmem = &device_mem_map[&mem];
@@ -916,7 +916,7 @@ void CUDADevice::tex_free(device_texture &mem)
     else if (cmem.array) {
       /* Free array. */
       cuArrayDestroy(reinterpret_cast<CUarray>(cmem.array));
-      stats.mem_free(mem.device_size);
+      stats.mem_free(mem.device_size, mem.type);
       mem.device_pointer = 0;
       mem.device_size = 0;
 
@@ -693,7 +693,7 @@ GPUDevice::Mem *GPUDevice::generic_alloc(device_memory &mem, size_t pitch_paddin
 
   mem.device_pointer = (device_ptr)device_pointer;
   mem.device_size = size;
-  stats.mem_alloc(size);
+  stats.mem_alloc(size, mem.type);
 
   if (!mem.device_pointer) {
     return NULL;
@@ -764,7 +764,7 @@ void GPUDevice::generic_free(device_memory &mem)
       device_mem_in_use -= mem.device_size;
     }
 
-    stats.mem_free(mem.device_size);
+    stats.mem_free(mem.device_size, mem.type);
     mem.device_pointer = 0;
     mem.device_size = 0;
 
@@ -650,7 +650,7 @@ void MetalDevice::load_texture_info()
 
 void MetalDevice::erase_allocation(device_memory &mem)
 {
-  stats.mem_free(mem.device_size);
+  stats.mem_free(mem.device_size, mem.type);
   mem.device_pointer = 0;
   mem.device_size = 0;
 
@@ -710,7 +710,7 @@ MetalDevice::MetalMem *MetalDevice::generic_alloc(device_memory &mem)
   }
 
   mem.device_size = metal_buffer.allocatedSize;
-  stats.mem_alloc(mem.device_size);
+  stats.mem_alloc(mem.device_size, mem.type);
 
   metal_buffer.label = [[NSString alloc] initWithFormat:@"%s", mem.name];
 
@@ -1244,7 +1244,7 @@ void MetalDevice::tex_alloc(device_texture &mem)
 
   mem.device_pointer = (device_ptr)mtlTexture;
   mem.device_size = size;
-  stats.mem_alloc(size);
+  stats.mem_alloc(size, mem.type);
 
   std::lock_guard<std::recursive_mutex> lock(metal_mem_map_mutex);
   MetalMem *mmem = new MetalMem;
@@ -317,7 +317,7 @@ class MultiDevice : public Device {
 
     mem.device = this;
     mem.device_pointer = key;
-    stats.mem_alloc(mem.device_size);
+    stats.mem_alloc(mem.device_size, mem.type);
   }
 
   void mem_copy_to(device_memory &mem) override
@@ -348,7 +348,7 @@ class MultiDevice : public Device {
 
     mem.device = this;
     mem.device_pointer = key;
-    stats.mem_alloc(mem.device_size - existing_size);
+    stats.mem_alloc(mem.device_size - existing_size, mem.type);
   }
 
   void mem_copy_from(device_memory &mem, size_t y, size_t w, size_t h, size_t elem) override
@@ -390,7 +390,7 @@ class MultiDevice : public Device {
 
     mem.device = this;
     mem.device_pointer = key;
-    stats.mem_alloc(mem.device_size - existing_size);
+    stats.mem_alloc(mem.device_size - existing_size, mem.type);
   }
 
   void mem_free(device_memory &mem) override
@@ -421,7 +421,7 @@ class MultiDevice : public Device {
     mem.device = this;
     mem.device_pointer = 0;
     mem.device_size = 0;
-    stats.mem_free(existing_size);
+    stats.mem_free(existing_size, mem.type);
   }
 
   void const_copy_to(const char *name, void *host, size_t size) override
@@ -237,7 +237,7 @@ void OneapiDevice::generic_alloc(device_memory &mem)
   mem.device_pointer = reinterpret_cast<ccl::device_ptr>(device_pointer);
   mem.device_size = memory_size;
 
-  stats.mem_alloc(memory_size);
+  stats.mem_alloc(memory_size, mem.type);
 }
 
 void OneapiDevice::generic_copy_to(device_memory &mem)
@@ -280,7 +280,7 @@ void OneapiDevice::generic_free(device_memory &mem)
     return;
   }
 
-  stats.mem_free(mem.device_size);
+  stats.mem_free(mem.device_size, mem.type);
   mem.device_size = 0;
 
   assert(device_queue_);
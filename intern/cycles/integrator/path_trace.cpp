@@ -951,46 +951,56 @@ bool PathTrace::copy_render_tile_from_device()
   return success;
 }
 
-static string get_layer_view_name(const RenderBuffers &buffers)
+static string get_layer_view_name(const BufferParams &buffer_params)
 {
   string result;
 
-  if (buffers.params.layer.size()) {
-    result += string(buffers.params.layer);
+  if (buffer_params.layer.size()) {
+    result += string(buffer_params.layer);
   }
 
-  if (buffers.params.view.size()) {
+  if (buffer_params.view.size()) {
     if (!result.empty()) {
       result += ", ";
     }
-    result += string(buffers.params.view);
+    result += string(buffer_params.view);
   }
 
   return result;
 }
 
-void PathTrace::process_full_buffer_from_disk(string_view filename)
+void PathTrace::full_buffer_read_error()
+{
+  const string error_message = "Error reading tiles from file";
+  if (progress_) {
+    progress_->set_error(error_message);
+    progress_->set_cancel(error_message);
+  }
+  else {
+    LOG(ERROR) << error_message;
+  }
+}
+
+void PathTrace::process_full_buffer_from_disk(string_view filename, const bool use_streaming)
 {
   VLOG_WORK << "Processing full frame buffer file " << filename;
 
+  if (use_streaming) {
+    process_full_buffer_from_disk_streaming(filename);
+    return;
+  }
+
   progress_set_status("Reading full buffer from disk");
 
   RenderBuffers full_frame_buffers(cpu_device_.get());
 
   DenoiseParams denoise_params;
   if (!tile_manager_.read_full_buffer_from_disk(filename, &full_frame_buffers, &denoise_params)) {
-    const string error_message = "Error reading tiles from file";
-    if (progress_) {
-      progress_->set_error(error_message);
-      progress_->set_cancel(error_message);
-    }
-    else {
-      LOG(ERROR) << error_message;
-    }
+    full_buffer_read_error();
     return;
   }
 
-  const string layer_view_name = get_layer_view_name(full_frame_buffers);
+  const string layer_view_name = get_layer_view_name(full_frame_buffers.params);
 
   render_state_.has_denoised_result = false;
 
@@ -1022,6 +1032,88 @@ void PathTrace::process_full_buffer_from_disk(string_view filename)
   full_frame_state_.render_buffers = nullptr;
 }
 
+/* Number of pixels around every region which are read and denoised together with the region
+ * in the streaming mode. The denoiser looks at the neighborhood of a pixel, without the overlap
+ * seams between regions would be visible. */
+static const int FULL_BUFFER_REGION_OVERLAP = TileManager::IMAGE_TILE_SIZE;
+
+void PathTrace::process_full_buffer_from_disk_streaming(string_view filename)
+{
+  BufferParams full_frame_params;
+  DenoiseParams denoise_params;
+  if (!tile_manager_.read_full_buffer_params_from_disk(
+          filename, &full_frame_params, &denoise_params))
+  {
+    full_buffer_read_error();
+    return;
+  }
+
+  const string layer_view_name = get_layer_view_name(full_frame_params);
+
+  int2 region_size = tile_manager_.get_tile_size();
+  if (region_size.x == 0 || region_size.y == 0) {
+    region_size = make_int2(full_frame_params.width, full_frame_params.height);
+  }
+
+  const int num_regions_x = divide_up(full_frame_params.width, region_size.x);
+  const int num_regions_y = divide_up(full_frame_params.height, region_size.y);
+  const int num_regions = num_regions_x * num_regions_y;
+
+  render_state_.has_denoised_result = false;
+
+  if (denoise_params.use) {
+    /* See process_full_buffer_from_disk() for why the denoiser can be re-used here. */
+    set_denoiser_params(denoise_params);
+  }
+
+  /* Only one region is kept in memory at a time: it is read from disk, denoised and written to
+   * the software before the next one is read. Cancellation is not checked per region, so that
+   * the finalized result matches the non-streaming path which always writes the full frame. */
+  for (int region_index = 0; region_index < num_regions; ++region_index) {
+    const int region_x = (region_index % num_regions_x) * region_size.x;
+    const int region_y = (region_index / num_regions_x) * region_size.y;
+    const int region_width = min(region_size.x, full_frame_params.width - region_x);
+    const int region_height = min(region_size.y, full_frame_params.height - region_y);
+
+    const string region_status = string_printf(
+        "%s %d/%d", layer_view_name.c_str(), region_index + 1, num_regions);
+
+    progress_set_status(region_status, "Reading from disk");
+
+    RenderBuffers region_buffers(cpu_device_.get());
+    if (!tile_manager_.read_buffer_region_from_disk(filename,
+                                                    region_x,
+                                                    region_y,
+                                                    region_width,
+                                                    region_height,
+                                                    FULL_BUFFER_REGION_OVERLAP,
+                                                    &region_buffers))
+    {
+      full_buffer_read_error();
+      return;
+    }
+
+    if (denoise_params.use) {
+      progress_set_status(region_status, "Denoising");
+
+      /* The overlap is denoised as well, but only the window of the region is written. */
+      denoiser_->denoise_buffer(region_buffers.params, &region_buffers, 0, false);
+
+      render_state_.has_denoised_result = true;
+    }
+
+    full_frame_state_.render_buffers = &region_buffers;
+    full_frame_state_.render_tile_offset = make_int2(region_x, region_y);
+
+    progress_set_status(region_status, "Finishing");
+
+    tile_buffer_write();
+
+    full_frame_state_.render_buffers = nullptr;
+    full_frame_state_.render_tile_offset = make_int2(0, 0);
+  }
+}
+
 int PathTrace::get_num_render_tile_samples() const
 {
   if (full_frame_state_.render_buffers) {
@@ -1092,7 +1184,7 @@ int2 PathTrace::get_render_tile_size() const
 int2 PathTrace::get_render_tile_offset() const
 {
   if (full_frame_state_.render_buffers) {
-    return make_int2(0, 0);
+    return full_frame_state_.render_tile_offset;
   }
 
   const Tile &tile = tile_manager_.get_current_tile();
@@ -135,8 +135,11 @@ class PathTrace {
   bool copy_render_tile_from_device();
 
   /* Read given full-frame file from disk, perform needed processing and write it to the software
-   * via the write callback. */
-  void process_full_buffer_from_disk(string_view filename);
+   * via the write callback.
+   *
+   * With streaming the frame is read, denoised and written in regions of the render tile size,
+   * so that the peak memory usage does not depend on the resolution of the frame. */
+  void process_full_buffer_from_disk(string_view filename, bool use_streaming = false);
 
   /* Get number of samples in the current big tile render buffers. */
   int get_num_render_tile_samples() const;
@@ -214,6 +217,9 @@ class PathTrace {
   void write_tile_buffer(const RenderWork &render_work);
   void finalize_full_buffer_on_disk(const RenderWork &render_work);
 
+  void process_full_buffer_from_disk_streaming(string_view filename);
+  void full_buffer_read_error();
+
   /* Updates/initializes the guiding structures after a rendering iteration.
    * The structures are updated using the training data/samples generated during the previous
    * rendering iteration */
@@ -349,6 +355,10 @@ class PathTrace {
   /* State of the full frame processing and writing to the software. */
   struct {
     RenderBuffers *render_buffers = nullptr;
+
+    /* Offset of the render buffers window in the full frame, non-zero when the frame is written
+     * in regions. */
+    int2 render_tile_offset = make_int2(0, 0);
   } full_frame_state_;
 };
 
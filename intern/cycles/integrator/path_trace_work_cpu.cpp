@@ -16,7 +16,10 @@
 #include "scene/scene.h"
 #include "session/buffers.h"
 
+#include "util/algorithm.h"
+#include "util/array.h"
 #include "util/atomic.h"
+#include "util/debug.h"
 #include "util/log.h"
 #include "util/tbb.h"
 
@@ -31,6 +34,10 @@ static inline tbb::task_arena local_tbb_arena_create(const Device *device)
   return tbb::task_arena(device->info.cpu_threads);
 }
 
+/* Number of pixels rendered together by a thread in wavefront mode. Each pixel has one path in
+ * flight, plus its shadow catcher split path. */
+static constexpr int WAVEFRONT_SPAN_SIZE = 64;
+
 /* Get CPUKernelThreadGlobals for the current thread. */
 static inline CPUKernelThreadGlobals *kernel_thread_globals_get(
     vector<CPUKernelThreadGlobals> &kernel_thread_globals)
@@ -56,6 +63,7 @@ void PathTraceWorkCPU::init_execution()
 {
   /* Cache per-thread kernel globals. */
   device_->get_cpu_kernel_thread_globals(kernel_thread_globals_);
+  wavefront_thread_states_.resize(kernel_thread_globals_.size());
 }
 
 void PathTraceWorkCPU::render_samples(RenderStatistics &statistics,
@@ -74,31 +82,68 @@ void PathTraceWorkCPU::render_samples(RenderStatistics &statistics,
   }
 
   tbb::task_arena local_arena = local_tbb_arena_create(device_);
-  local_arena.execute([&]() {
-    parallel_for(int64_t(0), total_pixels_num, [&](int64_t work_index) {
-      if (is_cancel_requested()) {
-        return;
-      }
 
-      const int y = work_index / image_width;
-      const int x = work_index - y * image_width;
+  /* Wavefront mode is not used with path guiding, which records path segments in per-thread
+   * storage and so requires the paths of a thread to be traced one after the other. */
+  if (DebugFlags().cpu.use_wavefront && !device_scene_->data.integrator.use_guiding) {
+    const int64_t spans_per_row = divide_up(image_width, WAVEFRONT_SPAN_SIZE);
+    local_arena.execute([&]() {
+      parallel_for(int64_t(0), image_height * spans_per_row, [&](int64_t work_index) {
+        if (is_cancel_requested()) {
+          return;
+        }
+
+        const int y = work_index / spans_per_row;
+        const int x = (work_index - y * spans_per_row) * WAVEFRONT_SPAN_SIZE;
+
+        KernelWorkTile work_tile;
+        work_tile.x = effective_buffer_params_.full_x + x;
+        work_tile.y = effective_buffer_params_.full_y + y;
+        work_tile.w = min(WAVEFRONT_SPAN_SIZE, int(image_width - x));
+        work_tile.h = 1;
+        work_tile.start_sample = start_sample;
+        work_tile.sample_offset = sample_offset;
+        work_tile.num_samples = 1;
+        work_tile.offset = effective_buffer_params_.offset;
+        work_tile.stride = effective_buffer_params_.stride;
+
+        CPUKernelThreadGlobals *kernel_globals = kernel_thread_globals_get(
+            kernel_thread_globals_);
+        array<IntegratorStateCPU> &states =
+            wavefront_thread_states_[kernel_globals - kernel_thread_globals_.data()];
+
+        render_samples_wavefront(kernel_globals, states, work_tile, samples_num);
+      });
+    });
+  }
+  else {
+    local_arena.execute([&]() {
+      parallel_for(int64_t(0), total_pixels_num, [&](int64_t work_index) {
+        if (is_cancel_requested()) {
+          return;
+        }
+
+        const int y = work_index / image_width;
+        const int x = work_index - y * image_width;
 
-      KernelWorkTile work_tile;
-      work_tile.x = effective_buffer_params_.full_x + x;
-      work_tile.y = effective_buffer_params_.full_y + y;
-      work_tile.w = 1;
-      work_tile.h = 1;
-      work_tile.start_sample = start_sample;
-      work_tile.sample_offset = sample_offset;
-      work_tile.num_samples = 1;
-      work_tile.offset = effective_buffer_params_.offset;
-      work_tile.stride = effective_buffer_params_.stride;
+        KernelWorkTile work_tile;
+        work_tile.x = effective_buffer_params_.full_x + x;
+        work_tile.y = effective_buffer_params_.full_y + y;
+        work_tile.w = 1;
+        work_tile.h = 1;
+        work_tile.start_sample = start_sample;
+        work_tile.sample_offset = sample_offset;
+        work_tile.num_samples = 1;
+        work_tile.offset = effective_buffer_params_.offset;
+        work_tile.stride = effective_buffer_params_.stride;
 
-      CPUKernelThreadGlobals *kernel_globals = kernel_thread_globals_get(kernel_thread_globals_);
+        CPUKernelThreadGlobals *kernel_globals = kernel_thread_globals_get(
+            kernel_thread_globals_);
 
-      render_samples_full_pipeline(kernel_globals, work_tile, samples_num);
+        render_samples_full_pipeline(kernel_globals, work_tile, samples_num);
+      });
     });
-  });
+  }
   if (device_->profiler.active()) {
     for (CPUKernelThreadGlobals &kernel_globals : kernel_thread_globals_) {
       kernel_globals.stop_profiling();
@@ -162,6 +207,188 @@ void PathTraceWorkCPU::render_samples_full_pipeline(KernelGlobalsCPU *kernel_glo
   }
 }
 
+/* Whether the path or any of its shadow paths still has kernels to execute. */
+static inline bool wavefront_path_is_active(const IntegratorStateCPU *state)
+{
+  return INTEGRATOR_STATE(state, path, queued_kernel) ||
+         INTEGRATOR_STATE(&state->shadow, shadow_path, queued_kernel) ||
+         INTEGRATOR_STATE(&state->ao, shadow_path, queued_kernel);
+}
+
+/* Key for sorting rays by direction octant, so that consecutive rays in a batch traverse similar
+ * BVH nodes. */
+static inline uint ray_direction_sort_key(const float3 D)
+{
+  return (D.x < 0.0f ? 1 : 0) | (D.y < 0.0f ? 2 : 0) | (D.z < 0.0f ? 4 : 0);
+}
+
+void PathTraceWorkCPU::render_samples_wavefront(KernelGlobalsCPU *kernel_globals,
+                                                array<IntegratorStateCPU> &states,
+                                                const KernelWorkTile &work_tile,
+                                                const int samples_num)
+{
+  const bool has_bake = device_scene_->data.bake.use;
+  const int num_pixels = work_tile.w;
+  float *render_buffer = buffers_->buffer.data();
+
+  /* Main path of every pixel, directly followed by the state it is split into for the shadow
+   * catcher, as expected by #integrator_state_shadow_catcher_split. The states are reused by all
+   * spans the thread renders, only allocated for the first one. */
+  if (states.size() != WAVEFRONT_SPAN_SIZE * 2) {
+    states.resize(WAVEFRONT_SPAN_SIZE * 2);
+  }
+  for (int i = 0; i < num_pixels * 2; i++) {
+    path_state_init_queues(&states[i]);
+  }
+
+  /* Work tile of the next sample of every pixel, or zero samples once the pixel is done. */
+  KernelWorkTile pixel_work_tiles[WAVEFRONT_SPAN_SIZE];
+  for (int i = 0; i < num_pixels; i++) {
+    KernelWorkTile &pixel_work_tile = pixel_work_tiles[i];
+    pixel_work_tile = work_tile;
+    pixel_work_tile.x = work_tile.x + i;
+    pixel_work_tile.w = 1;
+    pixel_work_tile.num_samples = samples_num;
+  }
+
+  /* Same layout as the GPU queues: the kernel every path is queued for is gathered, and the
+   * kernel with the most queued paths is executed. */
+  IntegratorQueueCounter queue_counter;
+  DeviceKernel queued_kernels[WAVEFRONT_SPAN_SIZE * 2 * 3];
+  IntegratorStateCPU *batch_states[WAVEFRONT_SPAN_SIZE * 2];
+  IntegratorShadowStateCPU *batch_shadow_states[WAVEFRONT_SPAN_SIZE * 2 * 2];
+  std::pair<uint, int> sort_keys[WAVEFRONT_SPAN_SIZE * 2 * 2];
+
+  while (true) {
+    /* Start the next sample for pixels which finished all of their paths. */
+    const bool cancel = is_cancel_requested();
+    for (int i = 0; i < num_pixels; i++) {
+      KernelWorkTile &pixel_work_tile = pixel_work_tiles[i];
+      IntegratorStateCPU *state = &states[i * 2];
+      while (pixel_work_tile.num_samples > 0 && !wavefront_path_is_active(state) &&
+             !wavefront_path_is_active(state + 1))
+      {
+        if (cancel) {
+          pixel_work_tile.num_samples = 0;
+          break;
+        }
+
+        const bool pixel_active = has_bake ?
+                                      kernels_.integrator_init_from_bake(
+                                          kernel_globals, state, &pixel_work_tile, render_buffer) :
+                                      kernels_.integrator_init_from_camera(
+                                          kernel_globals, state, &pixel_work_tile, render_buffer);
+        if (!pixel_active) {
+          /* Converged pixel. */
+          pixel_work_tile.num_samples = 0;
+          break;
+        }
+
+        ++pixel_work_tile.start_sample;
+        --pixel_work_tile.num_samples;
+      }
+    }
+
+    /* Gather kernels the paths are queued for. Shadow paths are handled before their main path
+     * continues, since it may create new shadow paths which would overwrite them. */
+    memset(&queue_counter, 0, sizeof(queue_counter));
+    for (int i = 0; i < num_pixels * 2; i++) {
+      IntegratorStateCPU *state = &states[i];
+      const uint32_t shadow_kernel = INTEGRATOR_STATE(&state->shadow, shadow_path, queued_kernel);
+      const uint32_t ao_kernel = INTEGRATOR_STATE(&state->ao, shadow_path, queued_kernel);
+      const uint32_t path_kernel = (shadow_kernel || ao_kernel) ?
+                                       0 :
+                                       INTEGRATOR_STATE(state, path, queued_kernel);
+      queued_kernels[i * 3 + 0] = DeviceKernel(path_kernel);
+      queued_kernels[i * 3 + 1] = DeviceKernel(shadow_kernel);
+      queued_kernels[i * 3 + 2] = DeviceKernel(ao_kernel);
+      for (int j = 0; j < 3; j++) {
+        if (queued_kernels[i * 3 + j]) {
+          queue_counter.num_queued[queued_kernels[i * 3 + j]]++;
+        }
+      }
+    }
+
+    DeviceKernel kernel = DEVICE_KERNEL_NUM;
+    int max_num_queued = 0;
+    for (int i = 0; i < DEVICE_KERNEL_INTEGRATOR_NUM; i++) {
+      if (queue_counter.num_queued[i] > max_num_queued) {
+        kernel = DeviceKernel(i);
+        max_num_queued = queue_counter.num_queued[i];
+      }
+    }
+
+    if (kernel == DEVICE_KERNEL_NUM) {
+      /* All paths of all pixels are finished. */
+      break;
+    }
+
+    /* Collect the batch, sorted by the object hit for shading and by direction for intersection.
+     * Objects mostly share their shaders, and unlike a shader sort key the intersection is already
+     * in the path state, so the kernels don't need extra state writes for sorting. */
+    const bool is_shadow_kernel = (kernel == DEVICE_KERNEL_INTEGRATOR_INTERSECT_SHADOW ||
+                                   kernel == DEVICE_KERNEL_INTEGRATOR_SHADE_SHADOW);
+    const bool sort_by_object = (kernel == DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE ||
+                                 kernel == DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE_RAYTRACE ||
+                                 kernel == DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE_MNEE);
+    const bool sort_by_direction = (kernel == DEVICE_KERNEL_INTEGRATOR_INTERSECT_CLOSEST ||
+                                    kernel == DEVICE_KERNEL_INTEGRATOR_INTERSECT_SHADOW);
+
+    int num_batch = 0;
+    for (int i = 0; i < num_pixels * 2; i++) {
+      IntegratorStateCPU *state = &states[i];
+      if (is_shadow_kernel) {
+        for (int j = 1; j < 3; j++) {
+          if (queued_kernels[i * 3 + j] != kernel) {
+            continue;
+          }
+          IntegratorShadowStateCPU *shadow_state = (j == 1) ? &state->shadow : &state->ao;
+          const uint key = sort_by_direction ?
+                               ray_direction_sort_key(
+                                   INTEGRATOR_STATE(shadow_state, shadow_ray, D)) :
+                               0;
+          batch_shadow_states[num_batch] = shadow_state;
+          sort_keys[num_batch] = {key, num_batch};
+          num_batch++;
+        }
+      }
+      else if (queued_kernels[i * 3] == kernel) {
+        uint key = 0;
+        if (sort_by_object) {
+          key = uint(INTEGRATOR_STATE(state, isect, object));
+        }
+        else if (sort_by_direction) {
+          key = ray_direction_sort_key(INTEGRATOR_STATE(state, ray, D));
+        }
+        batch_states[num_batch] = state;
+        sort_keys[num_batch] = {key, num_batch};
+        num_batch++;
+      }
+    }
+
+    if (sort_by_object || sort_by_direction) {
+      std::sort(sort_keys, sort_keys + num_batch);
+    }
+
+    if (is_shadow_kernel) {
+      IntegratorShadowStateCPU *sorted_states[WAVEFRONT_SPAN_SIZE * 2 * 2];
+      for (int i = 0; i < num_batch; i++) {
+        sorted_states[i] = batch_shadow_states[sort_keys[i].second];
+      }
+      kernels_.integrator_wavefront_shadow_paths(
+          kernel_globals, sorted_states, num_batch, kernel, render_buffer);
+    }
+    else {
+      IntegratorStateCPU *sorted_states[WAVEFRONT_SPAN_SIZE * 2];
+      for (int i = 0; i < num_batch; i++) {
+        sorted_states[i] = batch_states[sort_keys[i].second];
+      }
+      kernels_.integrator_wavefront_paths(
+          kernel_globals, sorted_states, num_batch, kernel, render_buffer);
+    }
+  }
+}
+
 void PathTraceWorkCPU::copy_to_display(PathTraceDisplay *display,
                                        PassMode pass_mode,
                                        int num_samples)
@@ -11,6 +11,7 @@
 
 #include "integrator/path_trace_work.h"
 
+#include "util/array.h"
 #include "util/vector.h"
 
 CCL_NAMESPACE_BEGIN
@@ -74,6 +75,14 @@ class PathTraceWorkCPU : public PathTraceWork {
                                     const KernelWorkTile &work_tile,
                                     const int samples_num);
 
+  /* Wavefront alternative to the full pipeline. Renders all samples of a horizontal span of
+   * pixels given by the work tile, keeping one path per pixel in flight and executing kernels
+   * for all paths queued for them at once. */
+  void render_samples_wavefront(KernelGlobalsCPU *kernel_globals,
+                                array<IntegratorStateCPU> &states,
+                                const KernelWorkTile &work_tile,
+                                const int samples_num);
+
   /* CPU kernels. */
   const CPUKernels &kernels_;
 
@@ -83,6 +92,10 @@ class PathTraceWorkCPU : public PathTraceWork {
    * accessing it, but some "localization" is required to decouple from kernel globals stored
    * on the device level. */
   vector<CPUKernelThreadGlobals> kernel_thread_globals_;
+
+  /* Path states of the wavefront mode, per thread like the kernel globals. Kept between work
+   * items to avoid allocating them for every span of pixels. */
+  vector<array<IntegratorStateCPU>> wavefront_thread_states_;
 };
 
 CCL_NAMESPACE_END
@@ -63,6 +63,11 @@ CCL_NAMESPACE_BEGIN
  * the code has been extended and modified to support more primitives and work
  * with CPU and various GPU kernel languages. */
 
+/* Wide BVH nodes built from BVH2 for SIMD traversal on the CPU. */
+#  ifndef __KERNEL_GPU__
+#    define __BVH_WIDE__
+#  endif
+
 #  include "kernel/bvh/nodes.h"
 
 /* Regular BVH traversal */
@@ -89,6 +94,30 @@ CCL_NAMESPACE_BEGIN
 #    include "kernel/bvh/traversal.h"
 #  endif
 
+#  ifdef __BVH_WIDE__
+#    define BVH_FUNCTION_NAME bvh_intersect_wide
+#    define BVH_FUNCTION_FEATURES BVH_POINTCLOUD | BVH_WIDE
+#    include "kernel/bvh/traversal.h"
+
+#    if defined(__HAIR__)
+#      define BVH_FUNCTION_NAME bvh_intersect_hair_wide
+#      define BVH_FUNCTION_FEATURES BVH_HAIR | BVH_POINTCLOUD | BVH_WIDE
+#      include "kernel/bvh/traversal.h"
+#    endif
+
+#    if defined(__OBJECT_MOTION__)
+#      define BVH_FUNCTION_NAME bvh_intersect_motion_wide
+#      define BVH_FUNCTION_FEATURES BVH_MOTION | BVH_POINTCLOUD | BVH_WIDE
+#      include "kernel/bvh/traversal.h"
+#    endif
+
+#    if defined(__HAIR__) && defined(__OBJECT_MOTION__)
+#      define BVH_FUNCTION_NAME bvh_intersect_hair_motion_wide
+#      define BVH_FUNCTION_FEATURES BVH_HAIR | BVH_MOTION | BVH_POINTCLOUD | BVH_WIDE
+#      include "kernel/bvh/traversal.h"
+#    endif
+#  endif /* __BVH_WIDE__ */
+
 ccl_device_intersect bool scene_intersect(KernelGlobals kg,
                                           ccl_private const Ray *ray,
                                           const uint visibility,
@@ -109,6 +138,30 @@ ccl_device_intersect bool scene_intersect(KernelGlobals kg,
 
   IF_NOT_USING_EMBREE
   {
+#  ifdef __BVH_WIDE__
+    if (kernel_data.bvh.use_wide_nodes) {
+#    ifdef __OBJECT_MOTION__
+      if (kernel_data.bvh.have_motion) {
+#      ifdef __HAIR__
+        if (kernel_data.bvh.have_curves) {
+          return bvh_intersect_hair_motion_wide(kg, ray, isect, visibility);
+        }
+#      endif /* __HAIR__ */
+
+        return bvh_intersect_motion_wide(kg, ray, isect, visibility);
+      }
+#    endif /* __OBJECT_MOTION__ */
+
+#    ifdef __HAIR__
+      if (kernel_data.bvh.have_curves) {
+        return bvh_intersect_hair_wide(kg, ray, isect, visibility);
+      }
+#    endif /* __HAIR__ */
+
+      return bvh_intersect_wide(kg, ray, isect, visibility);
+    }
+#  endif /* __BVH_WIDE__ */
+
 #  ifdef __OBJECT_MOTION__
     if (kernel_data.bvh.have_motion) {
 #    ifdef __HAIR__
@@ -213,6 +266,30 @@ ccl_device_intersect bool scene_intersect_local(KernelGlobals kg,
 #      include "kernel/bvh/shadow_all.h"
 #    endif
 
+#    ifdef __BVH_WIDE__
+#      define BVH_FUNCTION_NAME bvh_intersect_shadow_all_wide
+#      define BVH_FUNCTION_FEATURES BVH_POINTCLOUD | BVH_WIDE
+#      include "kernel/bvh/shadow_all.h"
+
+#      if defined(__HAIR__)
+#        define BVH_FUNCTION_NAME bvh_intersect_shadow_all_hair_wide
+#        define BVH_FUNCTION_FEATURES BVH_HAIR | BVH_POINTCLOUD | BVH_WIDE
+#        include "kernel/bvh/shadow_all.h"
+#      endif
+
+#      if defined(__OBJECT_MOTION__)
+#        define BVH_FUNCTION_NAME bvh_intersect_shadow_all_motion_wide
+#        define BVH_FUNCTION_FEATURES BVH_MOTION | BVH_POINTCLOUD | BVH_WIDE
+#        include "kernel/bvh/shadow_all.h"
+#      endif
+
+#      if defined(__HAIR__) && defined(__OBJECT_MOTION__)
+#        define BVH_FUNCTION_NAME bvh_intersect_shadow_all_hair_motion_wide
+#        define BVH_FUNCTION_FEATURES BVH_HAIR | BVH_MOTION | BVH_POINTCLOUD | BVH_WIDE
+#        include "kernel/bvh/shadow_all.h"
+#      endif
+#    endif /* __BVH_WIDE__ */
+
 ccl_device_intersect bool scene_intersect_shadow_all(KernelGlobals kg,
                                                      IntegratorShadowState state,
                                                      ccl_private const Ray *ray,
@@ -239,6 +316,34 @@ ccl_device_intersect bool scene_intersect_shadow_all(KernelGlobals kg,
 
   IF_NOT_USING_EMBREE
   {
+#    ifdef __BVH_WIDE__
+    if (kernel_data.bvh.use_wide_nodes) {
+#      ifdef __OBJECT_MOTION__
+      if (kernel_data.bvh.have_motion) {
+#        ifdef __HAIR__
+        if (kernel_data.bvh.have_curves) {
+          return bvh_intersect_shadow_all_hair_motion_wide(
+              kg, ray, state, visibility, max_hits, num_recorded_hits, throughput);
+        }
+#        endif /* __HAIR__ */
+
+        return bvh_intersect_shadow_all_motion_wide(
+            kg, ray, state, visibility, max_hits, num_recorded_hits, throughput);
+      }
+#      endif /* __OBJECT_MOTION__ */
+
+#      ifdef __HAIR__
+      if (kernel_data.bvh.have_curves) {
+        return bvh_intersect_shadow_all_hair_wide(
+            kg, ray, state, visibility, max_hits, num_recorded_hits, throughput);
+      }
+#      endif /* __HAIR__ */
+
+      return bvh_intersect_shadow_all_wide(
+          kg, ray, state, visibility, max_hits, num_recorded_hits, throughput);
+    }
+#    endif /* __BVH_WIDE__ */
+
 #    ifdef __OBJECT_MOTION__
     if (kernel_data.bvh.have_motion) {
 #      ifdef __HAIR__
@@ -143,3 +143,106 @@ ccl_device_forceinline int bvh_node_intersect(KernelGlobals kg,
     return bvh_aligned_node_intersect(kg, P, idir, tmin, tmax, node_addr, visibility, dist);
   }
 }
+
+#ifdef __BVH_WIDE__
+/* Wide nodes, CPU only.
+ *
+ * Four children per node with bounds stored per axis, so all children are tested with SIMD at
+ * once. Unaligned BVH2 nodes are converted to their axis aligned bounds. */
+
+ccl_device_forceinline int bvh_wide_movemask(const int4 a)
+{
+#  ifdef __KERNEL_SSE__
+  return _mm_movemask_ps(_mm_castsi128_ps(a.m128));
+#  else
+  return (a.x != 0) | ((a.y != 0) << 1) | ((a.z != 0) << 2) | ((a.w != 0) << 3);
+#  endif
+}
+
+ccl_device_forceinline int bvh_wide_node_intersect(KernelGlobals kg,
+                                                   const float3 P,
+                                                   const float3 idir,
+                                                   const float tmin,
+                                                   const float tmax,
+                                                   const int node_addr,
+                                                   const uint visibility,
+                                                   ccl_private float4 *dist)
+{
+  /* Select near and far planes from the ray direction instead of sorting the distances, this
+   * way the inverted bounds of empty child slots are never intersected. */
+  const int near_x = (idir.x >= 0.0f) ? 1 : 2;
+  const int near_y = (idir.y >= 0.0f) ? 3 : 4;
+  const int near_z = (idir.z >= 0.0f) ? 5 : 6;
+
+  const float4 tnear_x = (kernel_data_fetch(bvh_wide_nodes, node_addr + near_x) - P.x) * idir.x;
+  const float4 tnear_y = (kernel_data_fetch(bvh_wide_nodes, node_addr + near_y) - P.y) * idir.y;
+  const float4 tnear_z = (kernel_data_fetch(bvh_wide_nodes, node_addr + near_z) - P.z) * idir.z;
+  const float4 tfar_x = (kernel_data_fetch(bvh_wide_nodes, node_addr + 3 - near_x) - P.x) *
+                        idir.x;
+  const float4 tfar_y = (kernel_data_fetch(bvh_wide_nodes, node_addr + 7 - near_y) - P.y) *
+                        idir.y;
+  const float4 tfar_z = (kernel_data_fetch(bvh_wide_nodes, node_addr + 11 - near_z) - P.z) *
+                        idir.z;
+
+  const float4 tnear = max(max(tnear_x, tnear_y), max(tnear_z, make_float4(tmin)));
+  const float4 tfar = min(min(tfar_x, tfar_y), min(tfar_z, make_float4(tmax)));
+
+  *dist = tnear;
+
+#  ifdef __VISIBILITY_FLAG__
+  const int4 child_visibility = __float4_as_int4(kernel_data_fetch(bvh_wide_nodes, node_addr)) &
+                                (int)visibility;
+  return bvh_wide_movemask(tnear <= tfar) & ~bvh_wide_movemask(child_visibility == 0);
+#  else
+  return bvh_wide_movemask(tnear <= tfar);
+#  endif
+}
+
+/* Intersect the children of a wide node and return the closest intersected child to continue
+ * traversal with, the other intersected children are pushed to the stack from far to near.
+ * When no child is intersected the stack is popped. */
+ccl_device_forceinline int bvh_wide_node_traverse(KernelGlobals kg,
+                                                  const float3 P,
+                                                  const float3 idir,
+                                                  const float tmin,
+                                                  const float tmax,
+                                                  const int node_addr,
+                                                  const uint visibility,
+                                                  ccl_private int *traversal_stack,
+                                                  ccl_private int *stack_ptr)
+{
+  float4 dist;
+  const int traverse_mask = bvh_wide_node_intersect(
+      kg, P, idir, tmin, tmax, node_addr, visibility, &dist);
+
+  if (traverse_mask == 0) {
+    return traversal_stack[(*stack_ptr)--];
+  }
+
+  const int4 cnodes = __float4_as_int4(kernel_data_fetch(bvh_wide_nodes, node_addr + 7));
+
+  /* Insertion sort of the intersected children by decreasing distance. */
+  int child_addr[4];
+  float child_dist[4];
+  int num_children = 0;
+  for (int i = 0; i < 4; i++) {
+    if (traverse_mask & (1 << i)) {
+      int j = num_children++;
+      for (; j > 0 && child_dist[j - 1] < dist[i]; j--) {
+        child_dist[j] = child_dist[j - 1];
+        child_addr[j] = child_addr[j - 1];
+      }
+      child_dist[j] = dist[i];
+      child_addr[j] = cnodes[i];
+    }
+  }
+
+  for (int i = 0; i < num_children - 1; i++) {
+    ++(*stack_ptr);
+    kernel_assert(*stack_ptr < BVH_WIDE_STACK_SIZE);
+    traversal_stack[*stack_ptr] = child_addr[i];
+  }
+
+  return child_addr[num_children - 1];
+}
+#endif /* __BVH_WIDE__ */
@@ -12,6 +12,16 @@
 #  define NODE_INTERSECT bvh_aligned_node_intersect
 #endif
 
+#if BVH_FEATURE(BVH_WIDE)
+#  define TRAVERSAL_STACK_SIZE BVH_WIDE_STACK_SIZE
+#  define TRAVERSAL_ROOT kernel_data.bvh.wide_root
+#  define TRAVERSAL_OBJECT_NODE object_wide_node
+#else
+#  define TRAVERSAL_STACK_SIZE BVH_STACK_SIZE
+#  define TRAVERSAL_ROOT kernel_data.bvh.root
+#  define TRAVERSAL_OBJECT_NODE object_node
+#endif
+
 /* This is a template BVH traversal function, where various features can be
  * enabled/disabled. This way we can compile optimized versions for each case
  * without new features slowing things down.
@@ -19,6 +29,7 @@
  * BVH_HAIR: hair curve rendering
  * BVH_POINTCLOUD: point cloud rendering
  * BVH_MOTION: motion blur rendering
+ * BVH_WIDE: traverse wide nodes with SIMD, CPU only
  */
 
 ccl_device_noinline bool BVH_FUNCTION_FULL_NAME(BVH)(KernelGlobals kg,
@@ -34,12 +45,12 @@ ccl_device_noinline bool BVH_FUNCTION_FULL_NAME(BVH)(KernelGlobals kg,
    */
 
   /* traversal stack in CUDA thread-local memory */
-  int traversal_stack[BVH_STACK_SIZE];
+  int traversal_stack[TRAVERSAL_STACK_SIZE];
   traversal_stack[0] = ENTRYPOINT_SENTINEL;
 
   /* traversal variables in registers */
   int stack_ptr = 0;
-  int node_addr = kernel_data.bvh.root;
+  int node_addr = TRAVERSAL_ROOT;
 
   /* ray parameters in registers */
   float3 P = ray->P;
@@ -58,6 +69,12 @@ ccl_device_noinline bool BVH_FUNCTION_FULL_NAME(BVH)(KernelGlobals kg,
   do {
     do {
       /* traverse internal nodes */
+#if BVH_FEATURE(BVH_WIDE)
+      while (node_addr >= 0 && node_addr != ENTRYPOINT_SENTINEL) {
+        node_addr = bvh_wide_node_traverse(
+            kg, P, idir, tmin, isect->t, node_addr, visibility, traversal_stack, &stack_ptr);
+      }
+#else
       while (node_addr >= 0 && node_addr != ENTRYPOINT_SENTINEL) {
         int node_addr_child1, traverse_mask;
         float dist[2];
@@ -90,7 +107,7 @@ ccl_device_noinline bool BVH_FUNCTION_FULL_NAME(BVH)(KernelGlobals kg,
           }
 
           ++stack_ptr;
-          kernel_assert(stack_ptr < BVH_STACK_SIZE);
+          kernel_assert(stack_ptr < TRAVERSAL_STACK_SIZE);
           traversal_stack[stack_ptr] = node_addr_child1;
         }
         else {
@@ -105,6 +122,7 @@ ccl_device_noinline bool BVH_FUNCTION_FULL_NAME(BVH)(KernelGlobals kg,
           }
         }
       }
+#endif
 
       /* if node is leaf, fetch triangle list */
       if (node_addr < 0) {
@@ -235,10 +253,10 @@ ccl_device_noinline bool BVH_FUNCTION_FULL_NAME(BVH)(KernelGlobals kg,
 #endif
 
           ++stack_ptr;
-          kernel_assert(stack_ptr < BVH_STACK_SIZE);
+          kernel_assert(stack_ptr < TRAVERSAL_STACK_SIZE);
           traversal_stack[stack_ptr] = ENTRYPOINT_SENTINEL;
 
-          node_addr = kernel_data_fetch(object_node, object);
+          node_addr = kernel_data_fetch(TRAVERSAL_OBJECT_NODE, object);
         }
       }
     } while (node_addr != ENTRYPOINT_SENTINEL);
@@ -269,3 +287,6 @@ ccl_device_inline bool BVH_FUNCTION_NAME(KernelGlobals kg,
 #undef BVH_FUNCTION_NAME
 #undef BVH_FUNCTION_FEATURES
 #undef NODE_INTERSECT
+#undef TRAVERSAL_STACK_SIZE
+#undef TRAVERSAL_ROOT
+#undef TRAVERSAL_OBJECT_NODE
@@ -18,11 +18,14 @@ CCL_NAMESPACE_BEGIN
 
 /* 64 object BVH + 64 mesh BVH + 64 object node splitting */
 #define BVH_STACK_SIZE 192
+/* Wide nodes push up to 3 children per level instead of 1. */
+#define BVH_WIDE_STACK_SIZE (BVH_STACK_SIZE * 3)
 /* BVH intersection function variations */
 
 #define BVH_MOTION 1
 #define BVH_HAIR 2
 #define BVH_POINTCLOUD 4
+#define BVH_WIDE 8
 
 #define BVH_NAME_JOIN(x, y) x##_##y
 #define BVH_NAME_EVAL(x, y) BVH_NAME_JOIN(x, y)
@@ -15,6 +15,9 @@ KERNEL_DATA_ARRAY(uint, prim_index)
 KERNEL_DATA_ARRAY(uint, prim_object)
 KERNEL_DATA_ARRAY(uint, object_node)
 KERNEL_DATA_ARRAY(float2, prim_time)
+/* Wide BVH nodes built alongside BVH2 for CPU traversal, sharing its leaf nodes. */
+KERNEL_DATA_ARRAY(float4, bvh_wide_nodes)
+KERNEL_DATA_ARRAY(uint, object_wide_node)
 
 /* objects */
 KERNEL_DATA_ARRAY(KernelObject, objects)
@@ -10,6 +10,8 @@
 #  include <nanovdb/util/SampleFromVoxels.h>
 #endif
 
+#include "util/texture_cache.h"
+
 CCL_NAMESPACE_BEGIN
 
 /* Make template functions private so symbols don't conflict between kernels with different
@@ -795,6 +797,17 @@ template<typename TexT, typename OutT = float4> struct NanoVDBInterpolator {
 
 #undef SET_CUBIC_SPLINE_WEIGHTS
 
+ccl_device float4 kernel_tex_image_interp_texture_cache(const TextureInfo &info,
+                                                       float x,
+                                                       float y,
+                                                       float2 duv_dx,
+                                                       float2 duv_dy)
+{
+  float result[4];
+  texture_cache_lookup(info, x, y, duv_dx, duv_dy, result);
+  return make_float4(result[0], result[1], result[2], result[3]);
+}
+
 ccl_device float4 kernel_tex_image_interp(KernelGlobals kg, int id, float x, float y)
 {
   const TextureInfo &info = kernel_data_fetch(texture_info, id);
@@ -803,6 +816,10 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals kg, int id, float x, flo
     return zero_float4();
   }
 
+  if (info.use_texture_cache) {
+    return kernel_tex_image_interp_texture_cache(info, x, y, zero_float2(), zero_float2());
+  }
+
   switch (info.data_type) {
     case IMAGE_DATA_TYPE_HALF: {
       const float f = TextureInterpolator<half, float>::interp(info, x, y);
@@ -835,6 +852,20 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals kg, int id, float x, flo
   }
 }
 
+/* Lookup with derivatives of the texture coordinates, which select the mipmap level for images
+ * in the texture cache. Other images have no mipmaps and ignore them. */
+ccl_device float4 kernel_tex_image_interp(
+    KernelGlobals kg, int id, float x, float y, float2 duv_dx, float2 duv_dy)
+{
+  const TextureInfo &info = kernel_data_fetch(texture_info, id);
+
+  if (info.use_texture_cache && info.data) {
+    return kernel_tex_image_interp_texture_cache(info, x, y, duv_dx, duv_dy);
+  }
+
+  return kernel_tex_image_interp(kg, id, x, y);
+}
+
 ccl_device float4 kernel_tex_image_interp_3d(KernelGlobals kg,
                                              int id,
                                              float3 P,
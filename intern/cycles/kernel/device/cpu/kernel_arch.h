@@ -42,6 +42,18 @@ KERNEL_INTEGRATOR_SHADE_FUNCTION(megakernel);
 #undef KERNEL_INTEGRATOR_INIT_FUNCTION
 #undef KERNEL_INTEGRATOR_SHADE_FUNCTION
 
+void KERNEL_FUNCTION_FULL_NAME(integrator_wavefront_paths)(const KernelGlobalsCPU *ccl_restrict kg,
+                                                           IntegratorStateCPU *const *states,
+                                                           const int num_states,
+                                                           const int kernel,
+                                                           ccl_global float *render_buffer);
+void KERNEL_FUNCTION_FULL_NAME(integrator_wavefront_shadow_paths)(
+    const KernelGlobalsCPU *ccl_restrict kg,
+    IntegratorShadowStateCPU *const *states,
+    const int num_states,
+    const int kernel,
+    ccl_global float *render_buffer);
+
 #define KERNEL_FILM_CONVERT_FUNCTION(name) \
   void KERNEL_FUNCTION_FULL_NAME(film_convert_##name)(const KernelFilmConvert *kfilm_convert, \
                                                       const float *buffer, \
@@ -33,6 +33,7 @@
 #    include "kernel/integrator/shade_surface.h"
 #    include "kernel/integrator/shade_volume.h"
 #    include "kernel/integrator/megakernel.h"
+#    include "kernel/integrator/wavefront.h"
 
 #    include "kernel/film/adaptive_sampling.h"
 #    include "kernel/film/cryptomatte_passes.h"
@@ -113,6 +114,33 @@ DEFINE_INTEGRATOR_SHADE_KERNEL(megakernel)
 DEFINE_INTEGRATOR_SHADOW_KERNEL(intersect_shadow)
 DEFINE_INTEGRATOR_SHADOW_SHADE_KERNEL(shade_shadow)
 
+void KERNEL_FUNCTION_FULL_NAME(integrator_wavefront_paths)(const KernelGlobalsCPU *kg,
+                                                           IntegratorStateCPU *const *states,
+                                                           const int num_states,
+                                                           const int kernel,
+                                                           ccl_global float *render_buffer)
+{
+#ifdef KERNEL_STUB
+  STUB_ASSERT(KERNEL_ARCH, integrator_wavefront_paths);
+#else
+  integrator_wavefront_paths(kg, states, num_states, (DeviceKernel)kernel, render_buffer);
+#endif
+}
+
+void KERNEL_FUNCTION_FULL_NAME(integrator_wavefront_shadow_paths)(
+    const KernelGlobalsCPU *kg,
+    IntegratorShadowStateCPU *const *states,
+    const int num_states,
+    const int kernel,
+    ccl_global float *render_buffer)
+{
+#ifdef KERNEL_STUB
+  STUB_ASSERT(KERNEL_ARCH, integrator_wavefront_shadow_paths);
+#else
+  integrator_wavefront_shadow_paths(kg, states, num_states, (DeviceKernel)kernel, render_buffer);
+#endif
+}
+
 /* --------------------------------------------------------------------
  * Shader evaluation.
  */
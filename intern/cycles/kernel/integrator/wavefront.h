@@ -0,0 +1,110 @@
+/* SPDX-FileCopyrightText: 2011-2023 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+/* Wavefront execution of integrator kernels on the CPU.
+ *
+ * Instead of following a single path through all of its kernels as the megakernel does, the
+ * scheduler on the host gathers paths queued for the same kernel, sorts them for coherence and
+ * executes the kernel for the whole batch. This way consecutive paths run the same shader program
+ * and traverse nearby BVH nodes, and the switch over kernels is done once per batch. */
+
+#pragma once
+
+#include "kernel/integrator/megakernel.h"
+
+CCL_NAMESPACE_BEGIN
+
+ccl_device void integrator_wavefront_paths(KernelGlobals kg,
+                                           IntegratorStateCPU *const *states,
+                                           const int num_states,
+                                           const DeviceKernel kernel,
+                                           ccl_global float *ccl_restrict render_buffer)
+{
+  switch (kernel) {
+    case DEVICE_KERNEL_INTEGRATOR_INTERSECT_CLOSEST:
+      for (int i = 0; i < num_states; i++) {
+        integrator_intersect_closest(kg, states[i], render_buffer);
+      }
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_BACKGROUND:
+      for (int i = 0; i < num_states; i++) {
+        integrator_shade_background(kg, states[i], render_buffer);
+      }
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE:
+      for (int i = 0; i < num_states; i++) {
+        integrator_shade_surface(kg, states[i], render_buffer);
+      }
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_VOLUME:
+      for (int i = 0; i < num_states; i++) {
+        integrator_shade_volume(kg, states[i], render_buffer);
+      }
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE_RAYTRACE:
+      for (int i = 0; i < num_states; i++) {
+        integrator_shade_surface_raytrace(kg, states[i], render_buffer);
+      }
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE_MNEE:
+      for (int i = 0; i < num_states; i++) {
+        integrator_shade_surface_mnee(kg, states[i], render_buffer);
+      }
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_LIGHT:
+      for (int i = 0; i < num_states; i++) {
+        integrator_shade_light(kg, states[i], render_buffer);
+      }
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_DEDICATED_LIGHT:
+      for (int i = 0; i < num_states; i++) {
+        integrator_shade_dedicated_light(kg, states[i], render_buffer);
+      }
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_INTERSECT_SUBSURFACE:
+      for (int i = 0; i < num_states; i++) {
+        integrator_intersect_subsurface(kg, states[i]);
+      }
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_INTERSECT_VOLUME_STACK:
+      for (int i = 0; i < num_states; i++) {
+        integrator_intersect_volume_stack(kg, states[i]);
+      }
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_INTERSECT_DEDICATED_LIGHT:
+      for (int i = 0; i < num_states; i++) {
+        integrator_intersect_dedicated_light(kg, states[i]);
+      }
+      break;
+    default:
+      kernel_assert(0);
+      break;
+  }
+}
+
+/* Shadow and AO paths share the same kernels, a batch may contain both. */
+ccl_device void integrator_wavefront_shadow_paths(KernelGlobals kg,
+                                                  IntegratorShadowStateCPU *const *states,
+                                                  const int num_states,
+                                                  const DeviceKernel kernel,
+                                                  ccl_global float *ccl_restrict render_buffer)
+{
+  switch (kernel) {
+    case DEVICE_KERNEL_INTEGRATOR_INTERSECT_SHADOW:
+      for (int i = 0; i < num_states; i++) {
+        integrator_intersect_shadow(kg, states[i]);
+      }
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_SHADOW:
+      for (int i = 0; i < num_states; i++) {
+        integrator_shade_shadow(kg, states[i], render_buffer);
+      }
+      break;
+    default:
+      kernel_assert(0);
+      break;
+  }
+}
+
+CCL_NAMESPACE_END
@@ -12,6 +12,8 @@ DeviceScene::DeviceScene(Device *device)
     : bvh_nodes(device, "bvh_nodes", MEM_GLOBAL),
       bvh_leaf_nodes(device, "bvh_leaf_nodes", MEM_GLOBAL),
       object_node(device, "object_node", MEM_GLOBAL),
+      bvh_wide_nodes(device, "bvh_wide_nodes", MEM_GLOBAL),
+      object_wide_node(device, "object_wide_node", MEM_GLOBAL),
       prim_type(device, "prim_type", MEM_GLOBAL),
       prim_visibility(device, "prim_visibility", MEM_GLOBAL),
       prim_index(device, "prim_index", MEM_GLOBAL),
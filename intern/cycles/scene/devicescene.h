@@ -19,6 +19,8 @@ class DeviceScene {
   device_vector<int4> bvh_nodes;
   device_vector<int4> bvh_leaf_nodes;
   device_vector<int> object_node;
+  device_vector<int4> bvh_wide_nodes;
+  device_vector<int> object_wide_node;
   device_vector<int> prim_type;
   device_vector<uint> prim_visibility;
   device_vector<int> prim_index;
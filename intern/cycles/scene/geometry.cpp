@@ -510,6 +510,8 @@ void GeometryManager::device_update_preprocess(Device *device, Scene *scene, Pro
     dscene->bvh_nodes.tag_realloc();
     dscene->bvh_leaf_nodes.tag_realloc();
     dscene->object_node.tag_realloc();
+    dscene->bvh_wide_nodes.tag_realloc();
+    dscene->object_wide_node.tag_realloc();
     dscene->prim_type.tag_realloc();
     dscene->prim_visibility.tag_realloc();
     dscene->prim_index.tag_realloc();
@@ -935,6 +937,7 @@ void GeometryManager::device_update(Device *device,
     });
     TaskPool pool;
 
+    vector<Geometry *> bvh_geometry;
     size_t i = 0;
     foreach (Geometry *geom, scene->geometry) {
       if (geom->is_modified() || geom->need_update_bvh_for_offset) {
@@ -942,6 +945,7 @@ void GeometryManager::device_update(Device *device,
         pool.push(function_bind(
             &Geometry::compute_bvh, geom, device, dscene, &scene->params, &progress, i, num_bvh));
         if (geom->need_build_bvh(bvh_layout)) {
+          bvh_geometry.push_back(geom);
           i++;
         }
       }
@@ -950,6 +954,17 @@ void GeometryManager::device_update(Device *device,
     TaskPool::Summary summary;
     pool.wait_work(&summary);
     VLOG_WORK << "Objects BVH build pool statistics:\n" << summary.full_report();
+
+    /* Object BVHs are built in parallel, the sum of their phases is reported. */
+    if (scene->update_stats && bvh_layout == BVH_LAYOUT_BVH2 && !bvh_geometry.empty()) {
+      BVHBuildTimes build_times;
+      foreach (Geometry *geom, bvh_geometry) {
+        if (geom->bvh) {
+          build_times += static_cast<BVH2 *>(geom->bvh)->build_times;
+        }
+      }
+      scene->update_stats->bvh.add_bvh_build_times("object BVHs", build_times);
+    }
   }
 
   foreach (Shader *shader, scene->shaders) {
@@ -1034,6 +1049,8 @@ void GeometryManager::device_update(Device *device,
   dscene->bvh_nodes.clear_modified();
   dscene->bvh_leaf_nodes.clear_modified();
   dscene->object_node.clear_modified();
+  dscene->bvh_wide_nodes.clear_modified();
+  dscene->object_wide_node.clear_modified();
   dscene->prim_type.clear_modified();
   dscene->prim_visibility.clear_modified();
   dscene->prim_index.clear_modified();
@@ -1064,6 +1081,8 @@ void GeometryManager::device_free(Device *device, DeviceScene *dscene, bool forc
   dscene->bvh_nodes.free_if_need_realloc(force_free);
   dscene->bvh_leaf_nodes.free_if_need_realloc(force_free);
   dscene->object_node.free_if_need_realloc(force_free);
+  dscene->bvh_wide_nodes.free_if_need_realloc(force_free);
+  dscene->object_wide_node.free_if_need_realloc(force_free);
   dscene->prim_type.free_if_need_realloc(force_free);
   dscene->prim_visibility.free_if_need_realloc(force_free);
   dscene->prim_index.free_if_need_realloc(force_free);
@@ -26,6 +26,7 @@
 
 #include "kernel/osl/globals.h"
 
+#include "util/debug.h"
 #include "util/foreach.h"
 #include "util/log.h"
 #include "util/progress.h"
@@ -119,6 +120,8 @@ void GeometryManager::device_update_bvh(Device *device,
   bparams.num_motion_curve_steps = scene->params.num_bvh_time_steps;
   bparams.num_motion_point_steps = scene->params.num_bvh_time_steps;
   bparams.bvh_type = scene->params.bvh_type;
+  bparams.use_wide_nodes = bparams.bvh_layout == BVH_LAYOUT_BVH2 &&
+                           device->info.type == DEVICE_CPU && DebugFlags().cpu.use_wide_bvh;
   bparams.curve_subdivisions = scene->params.curve_subdivisions();
 
   VLOG_INFO << "Using " << bvh_layout_name(bparams.bvh_layout) << " layout.";
@@ -142,7 +145,11 @@ void GeometryManager::device_update_bvh(Device *device,
 
   PackedBVH pack;
   if (has_bvh2_layout) {
-    pack = std::move(static_cast<BVH2 *>(bvh)->pack);
+    BVH2 *bvh2 = static_cast<BVH2 *>(bvh);
+    if (scene->update_stats) {
+      scene->update_stats->bvh.add_bvh_build_times("scene BVH", bvh2->build_times);
+    }
+    pack = std::move(bvh2->pack);
   }
   else {
     pack.root_index = -1;
@@ -186,8 +193,18 @@ void GeometryManager::device_update_bvh(Device *device,
     dscene->prim_time.steal_data(pack.prim_time);
     dscene->prim_time.copy_to_device();
   }
+  if (pack.wide_nodes.size()) {
+    dscene->bvh_wide_nodes.steal_data(pack.wide_nodes);
+    dscene->bvh_wide_nodes.copy_to_device();
+  }
+  if (pack.object_wide_node.size()) {
+    dscene->object_wide_node.steal_data(pack.object_wide_node);
+    dscene->object_wide_node.copy_to_device();
+  }
 
   dscene->data.bvh.root = pack.root_index;
+  dscene->data.bvh.wide_root = pack.wide_root_index;
+  dscene->data.bvh.use_wide_nodes = has_bvh2_layout && bvh->params.use_wide_nodes;
   dscene->data.bvh.use_bvh_steps = (scene->params.num_bvh_time_steps != 0);
   dscene->data.bvh.curve_subdivisions = scene->params.curve_subdivisions();
   /* The scene handle is set in 'CPUDevice::const_copy_to' and 'OptiXDevice::const_copy_to' */
@@ -18,6 +18,7 @@
 #include "util/progress.h"
 #include "util/task.h"
 #include "util/texture.h"
+#include "util/texture_cache.h"
 #include "util/unique_ptr.h"
 
 #ifdef WITH_OSL
@@ -326,6 +327,9 @@ ImageManager::ImageManager(const DeviceInfo &info)
 
   /* Set image limits */
   features.has_nanovdb = info.has_nanovdb;
+
+  /* The kernel reads from the texture cache on the host, so only the CPU device can use it. */
+  texture_cache_supported = (info.type == DEVICE_CPU);
 }
 
 ImageManager::~ImageManager()
@@ -339,6 +343,12 @@ void ImageManager::set_osl_texture_system(void *texture_system)
   osl_texture_system = texture_system;
 }
 
+bool ImageManager::use_texture_cache(const Scene *scene) const
+{
+  return texture_cache_supported && scene->params.use_texture_cache &&
+         scene->params.texture_cache_size > 0;
+}
+
 bool ImageManager::set_animation_frame_update(int frame)
 {
   if (frame != animation_frame) {
@@ -527,6 +537,37 @@ static bool image_associate_alpha(ImageManager::Image *img)
            img->params.alpha_type == IMAGE_ALPHA_CHANNEL_PACKED);
 }
 
+static bool image_use_texture_cache(ImageManager::Image *img, const int texture_limit)
+{
+  const ImageMetaData &metadata = img->metadata;
+
+  /* Only image files can be read on demand, and a texture limit asks for images to be loaded at
+   * lower resolution. */
+  if (img->builtin || img->loader->osl_filepath().empty() || texture_limit > 0) {
+    return false;
+  }
+
+  /* 3D images, color space conversion other than sRGB and CMYK to RGB conversion are done while
+   * loading the full image, and are not supported by the texture cache. */
+  if (metadata.channels == 0 || metadata.depth > 1) {
+    return false;
+  }
+  if (!(metadata.colorspace == u_colorspace_raw || metadata.compress_as_srgb)) {
+    return false;
+  }
+  if (strcmp(metadata.colorspace_file_format, "jpeg") == 0 && metadata.channels == 4) {
+    return false;
+  }
+
+  /* The texture cache always associates alpha. */
+  const bool has_alpha = (metadata.channels == 2 || metadata.channels >= 4);
+  if (has_alpha && !image_associate_alpha(img)) {
+    return false;
+  }
+
+  return true;
+}
+
 template<TypeDesc::BASETYPE FileFormat, typename StorageType>
 bool ImageManager::file_load_image(Image *img, int texture_limit)
 {
@@ -698,6 +739,15 @@ void ImageManager::device_load_image(Device *device, Scene *scene, size_t slot,
   load_image_metadata(img);
   ImageDataType type = img->metadata.type;
 
+  /* Images in the texture cache only store a reference to the cache in device memory. */
+  TextureCacheImage cache_image;
+  const bool use_texture_cache = texture_cache && image_use_texture_cache(img, texture_limit) &&
+                                 texture_cache->get_image(img->loader->osl_filepath().string(),
+                                                          &cache_image);
+  if (use_texture_cache) {
+    type = IMAGE_DATA_TYPE_BYTE;
+  }
+
   /* Name for debugging. */
   img->mem_name = string_printf("tex_image_%s_%03d", name_from_type(type), (int)slot);
 
@@ -714,7 +764,13 @@ void ImageManager::device_load_image(Device *device, Scene *scene, size_t slot,
   img->mem->info.transform_3d = img->metadata.transform_3d;
 
   /* Create new texture. */
-  if (type == IMAGE_DATA_TYPE_FLOAT4) {
+  if (use_texture_cache) {
+    thread_scoped_lock device_lock(device_mutex);
+    TextureCacheImage *data = (TextureCacheImage *)img->mem->alloc(sizeof(TextureCacheImage), 1);
+    *data = cache_image;
+    img->mem->info.use_texture_cache = true;
+  }
+  else if (type == IMAGE_DATA_TYPE_FLOAT4) {
     if (!file_load_image<TypeDesc::FLOAT, float>(img, texture_limit)) {
       /* on failure to load, we set a 1x1 pixels pink image */
       thread_scoped_lock device_lock(device_mutex);
@@ -839,6 +895,9 @@ void ImageManager::device_free_image(Device *, size_t slot)
 
   if (img->mem) {
     thread_scoped_lock device_lock(device_mutex);
+    if (img->mem->info.use_texture_cache && texture_cache) {
+      texture_cache->invalidate(img->loader->osl_filepath().string());
+    }
     delete img->mem;
   }
 
@@ -859,6 +918,15 @@ void ImageManager::device_update(Device *device, Scene *scene, Progress &progres
     }
   });
 
+  if (use_texture_cache(scene)) {
+    if (!texture_cache) {
+      texture_cache = make_unique<TextureCache>(scene->params.texture_cache_size);
+    }
+    else {
+      texture_cache->set_max_memory(scene->params.texture_cache_size);
+    }
+  }
+
   TaskPool pool;
   for (size_t slot = 0; slot < images.size(); slot++) {
     Image *img = images[slot];
@@ -928,6 +996,11 @@ void ImageManager::device_free(Device *device)
     device_free_image(device, slot);
   }
   images.clear();
+
+  if (texture_cache) {
+    VLOG_INFO << "Texture cache statistics:\n" << texture_cache->full_report();
+    texture_cache.reset();
+  }
 }
 
 void ImageManager::collect_statistics(RenderStats *stats)
@@ -940,6 +1013,11 @@ void ImageManager::collect_statistics(RenderStats *stats)
     stats->image.textures.add_entry(
         NamedSizeEntry(image->loader->name(), image->mem->memory_size()));
   }
+
+  if (texture_cache) {
+    stats->image.textures.add_entry(
+        NamedSizeEntry("Texture cache", texture_cache->memory_used()));
+  }
 }
 
 void ImageManager::tag_update()
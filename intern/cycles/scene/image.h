@@ -26,6 +26,7 @@ class ImageManager;
 class Progress;
 class RenderStats;
 class Scene;
+class TextureCache;
 class ColorSpaceProcessor;
 class VDBImageLoader;
 
@@ -189,6 +190,9 @@ class ImageManager {
   void set_osl_texture_system(void *texture_system);
   bool set_animation_frame_update(int frame);
 
+  /* Image files are read on demand through the texture cache instead of being fully loaded. */
+  bool use_texture_cache(const Scene *scene) const;
+
   void collect_statistics(RenderStats *stats);
 
   void tag_update();
@@ -216,6 +220,8 @@ class ImageManager {
   bool need_update_;
 
   ImageDeviceFeatures features;
+  bool texture_cache_supported;
+  unique_ptr<TextureCache> texture_cache;
 
   thread_mutex device_mutex;
   thread_mutex images_mutex;
@@ -16,12 +16,14 @@
 #include "util/ies.h"
 #include "util/thread.h"
 #include "util/types.h"
+#include "util/unique_ptr.h"
 #include "util/vector.h"
 
 CCL_NAMESPACE_BEGIN
 
 class Device;
 class DeviceScene;
+class LightTree;
 class Progress;
 class Scene;
 class Shader;
@@ -162,6 +164,9 @@ class LightManager {
   bool last_background_enabled;
   int last_background_resolution;
 
+  /* Light tree of the last update, kept to be refitted when only lights changed. */
+  unique_ptr<LightTree> light_tree;
+
   uint32_t update_flags;
 };
 
@@ -7,6 +7,8 @@
 #include "scene/object.h"
 
 #include "util/progress.h"
+#include "util/tbb.h"
+#include "util/time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -226,6 +228,18 @@ LightTreeEmitter::LightTreeEmitter(Scene *scene,
   }
 }
 
+static LightTreeLightClass light_tree_light_class(const Light *light)
+{
+  if (!light->get_is_enabled()) {
+    return LIGHT_TREE_LIGHT_DISABLED;
+  }
+  const LightType type = light->get_light_type();
+  if (type == LIGHT_BACKGROUND || type == LIGHT_DISTANT) {
+    return LIGHT_TREE_LIGHT_DISTANT;
+  }
+  return LIGHT_TREE_LIGHT_LOCAL;
+}
+
 static void sort_leaf(const int start, const int end, LightTreeEmitter *emitters)
 {
   /* Sort primitive by light link mask so that specialized trees can use a subset of these. */
@@ -266,6 +280,8 @@ LightTree::LightTree(Scene *scene,
                      uint max_lights_in_leaf)
     : progress_(progress), max_lights_in_leaf_(max_lights_in_leaf)
 {
+  const double start_time = time_dt();
+
   KernelIntegrator *kintegrator = &dscene->data.integrator;
 
   local_lights_.reserve(kintegrator->num_lights - kintegrator->num_distant_lights);
@@ -276,21 +292,25 @@ LightTree::LightTree(Scene *scene,
    * However, we also need the light's index in the scene when we're constructing the tree. */
   int device_light_index = 0;
   int scene_light_index = 0;
+  light_classes_.reserve(scene->lights.size());
   for (Light *light : scene->lights) {
-    if (light->is_enabled) {
-      if (light->light_type == LIGHT_BACKGROUND || light->light_type == LIGHT_DISTANT) {
-        distant_lights_.emplace_back(scene, ~device_light_index, scene_light_index);
-      }
-      else {
-        local_lights_.emplace_back(scene, ~device_light_index, scene_light_index);
-      }
-
+    const LightTreeLightClass light_class = light_tree_light_class(light);
+    if (light_class == LIGHT_TREE_LIGHT_DISTANT) {
+      distant_lights_.emplace_back(scene, ~device_light_index, scene_light_index);
+      device_light_index++;
+    }
+    else if (light_class == LIGHT_TREE_LIGHT_LOCAL) {
+      local_lights_.emplace_back(scene, ~device_light_index, scene_light_index);
       device_light_index++;
     }
 
+    light_classes_.push_back(light_class);
     scene_light_index++;
   }
 
+  objects_ = scene->objects;
+  object_geometry_.reserve(scene->objects.size());
+
   /* Similarly, we also want to keep track of the index of triangles of emissive objects. */
   int object_id = 0;
   for (Object *object : scene->objects) {
@@ -299,6 +319,7 @@ LightTree::LightTree(Scene *scene,
     }
 
     light_link_receiver_used |= (uint64_t(1) << object->get_receiver_light_set());
+    object_geometry_.push_back(object->get_geometry());
 
     if (!object->usable_as_light()) {
       object_id++;
@@ -316,6 +337,8 @@ LightTree::LightTree(Scene *scene,
       num_triangles += mesh->num_triangles();
     }
   }
+
+  build_times.add_emitters += time_dt() - start_time;
 }
 
 LightTreeNode *LightTree::build(Scene *scene, DeviceScene *dscene)
@@ -328,9 +351,12 @@ LightTreeNode *LightTree::build(Scene *scene, DeviceScene *dscene)
   int num_local_lights = local_lights_.size() + num_mesh_lights;
   const int num_distant_lights = distant_lights_.size();
 
+  double start_time = time_dt();
+
   /* Create a node for each mesh light, and keep track of unique mesh lights. */
   std::unordered_map<Mesh *, std::tuple<LightTreeNode *, int, int>> unique_mesh;
-  uint *object_offsets = dscene->object_lookup_offset.alloc(scene->objects.size());
+  object_offsets_.clear();
+  object_offsets_.resize(scene->objects.size(), 0);
   emitters_.reserve(num_triangles + num_local_lights + num_distant_lights);
   for (LightTreeEmitter &emitter : mesh_lights_) {
     Object *object = scene->objects[emitter.object_id];
@@ -349,9 +375,12 @@ LightTreeNode *LightTree::build(Scene *scene, DeviceScene *dscene)
     else {
       emitter.root->make_instance(std::get<0>(map_it->second), emitter.object_id);
     }
-    object_offsets[emitter.object_id] = offset_map_[mesh];
+    object_offsets_[emitter.object_id] = offset_map_[mesh];
   }
 
+  build_times.add_emitters += time_dt() - start_time;
+  start_time = time_dt();
+
   /* Build a subtree for each unique mesh light. */
   parallel_for_each(unique_mesh, [this](auto &map_it) {
     LightTreeNode *node = std::get<0>(map_it.second);
@@ -362,6 +391,9 @@ LightTreeNode *LightTree::build(Scene *scene, DeviceScene *dscene)
   });
   task_pool.wait_work();
 
+  build_times.build_nodes += time_dt() - start_time;
+  start_time = time_dt();
+
   /* Update measure. */
   parallel_for_each(mesh_lights_, [&](LightTreeEmitter &emitter) {
     Object *object = scene->objects[emitter.object_id];
@@ -392,9 +424,13 @@ LightTreeNode *LightTree::build(Scene *scene, DeviceScene *dscene)
     emitter.root->measure = emitter.measure;
   }
 
+  build_times.add_emitters += time_dt() - start_time;
+  start_time = time_dt();
+
   /* Could be different from `num_triangles` if only some triangles of an object are emissive. */
   const int num_emissive_triangles = emitters_.size();
   num_local_lights += num_emissive_triangles;
+  num_triangle_emitters_ = num_emissive_triangles;
 
   /* Build the top level tree. */
   root_ = create_node(LightTreeMeasure::empty, 0);
@@ -427,9 +463,124 @@ LightTreeNode *LightTree::build(Scene *scene, DeviceScene *dscene)
 
   std::move(distant_lights_.begin(), distant_lights_.end(), std::back_inserter(emitters_));
 
+  build_cost_ = compute_cost();
+  build_times.build_nodes += time_dt() - start_time;
+
   return root_.get();
 }
 
+bool LightTree::update(Scene *scene)
+{
+  if (!root_ || scene->objects != objects_) {
+    return false;
+  }
+
+  /* Specialized trees for light linking depend on the order of emitters in leaves, which is not
+   * maintained by a refit. */
+  uint64_t receiver_used = 1;
+  for (size_t i = 0; i < scene->objects.size(); i++) {
+    const Object *object = scene->objects[i];
+    receiver_used |= (uint64_t(1) << object->get_receiver_light_set());
+
+    /* Assigning other geometry to an object is not tagged as an emissive mesh change when the new
+     * geometry is not emissive. */
+    if (object->get_geometry() != object_geometry_[i]) {
+      return false;
+    }
+  }
+  if (receiver_used != 1 || light_link_receiver_used != 1) {
+    return false;
+  }
+
+  /* Enabling, disabling or changing the type of a light changes the device light indices. */
+  if (scene->lights.size() != light_classes_.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < scene->lights.size(); i++) {
+    if (light_tree_light_class(scene->lights[i]) != light_classes_[i]) {
+      return false;
+    }
+  }
+
+  const double start_time = time_dt();
+
+  /* Lights keep their place in the tree, only their measure is computed again. Triangles and mesh
+   * lights are left untouched. */
+  parallel_for(blocked_range<size_t>(num_triangle_emitters_, emitters_.size(), 64),
+               [&](const blocked_range<size_t> &r) {
+                 for (size_t i = r.begin(); i < r.end(); i++) {
+                   LightTreeEmitter &emitter = emitters_[i];
+                   if (emitter.is_light()) {
+                     emitter = LightTreeEmitter(scene, emitter.light_id, emitter.object_id);
+                   }
+                 }
+               });
+
+  refit_node(root_.get());
+  root_->light_link.shareable = false;
+
+  build_times.refit_nodes += time_dt() - start_time;
+
+  const float cost = compute_cost();
+  if (build_cost_ > 0.0f && cost > build_cost_ * MAX_REFIT_COST_INCREASE) {
+    VLOG_WORK << "Light tree refit increased cost from " << build_cost_ << " to " << cost
+              << ", rebuilding.";
+    return false;
+  }
+
+  return true;
+}
+
+void LightTree::refit_node(LightTreeNode *node)
+{
+  node->measure.reset();
+  node->light_link = LightTreeLightLink();
+
+  if (node->is_leaf() || node->is_distant()) {
+    const LightTreeNode::Leaf &leaf = node->get_leaf();
+    for (int i = 0; i < leaf.num_emitters; i++) {
+      node->add(emitters_[leaf.first_emitter_index + i]);
+    }
+    return;
+  }
+
+  LightTreeNode *left_node = node->get_inner().children[left].get();
+  LightTreeNode *right_node = node->get_inner().children[right].get();
+  refit_node(left_node);
+  refit_node(right_node);
+
+  node->measure = left_node->measure + right_node->measure;
+  node->light_link = left_node->light_link + right_node->light_link;
+}
+
+float LightTree::compute_cost() const
+{
+  if (!root_) {
+    return 0.0f;
+  }
+
+  const float root_cost = root_->measure.calculate();
+  if (root_cost == 0.0f) {
+    return 0.0f;
+  }
+
+  /* Sampling a light traverses the top level tree, weighted by how much each node is visited. */
+  float cost = 0.0f;
+  vector<const LightTreeNode *> stack = {root_.get()};
+  while (!stack.empty()) {
+    const LightTreeNode *node = stack.back();
+    stack.pop_back();
+
+    cost += node->measure.calculate();
+    if (node->is_inner()) {
+      stack.push_back(node->get_inner().children[left].get());
+      stack.push_back(node->get_inner().children[right].get());
+    }
+  }
+
+  return cost / root_cost;
+}
+
 void LightTree::recursive_build(const Child child,
                                 LightTreeNode *inner,
                                 const int start,
@@ -512,14 +663,91 @@ bool LightTree::should_split(LightTreeEmitter *emitters,
 
   middle = (start + end) / 2;
 
+  /* Large ranges of emitters are split in chunks of fixed size that are processed in parallel.
+   * Results are merged in the order of the chunks, so the tree does not depend on scheduling. */
+  const int num_chunks = (num_emitters > MIN_EMITTERS_PER_THREAD) ?
+                             divide_up(num_emitters, MIN_EMITTERS_PER_THREAD) :
+                             1;
+  auto chunk_range = [&](const int chunk) {
+    const int chunk_start = start + chunk * MIN_EMITTERS_PER_THREAD;
+    return std::make_pair(chunk_start,
+                          (chunk == num_chunks - 1) ? end :
+                                                      chunk_start + MIN_EMITTERS_PER_THREAD);
+  };
+
   BoundBox centroid_bbox = BoundBox::empty;
-  for (int i = start; i < end; i++) {
-    centroid_bbox.grow((emitters + i)->centroid);
+  if (num_chunks == 1) {
+    for (int i = start; i < end; i++) {
+      centroid_bbox.grow((emitters + i)->centroid);
+    }
+  }
+  else {
+    vector<BoundBox> chunk_bbox(num_chunks, BoundBox::empty);
+    parallel_for(0, num_chunks, [&](const int chunk) {
+      const auto [chunk_start, chunk_end] = chunk_range(chunk);
+      for (int i = chunk_start; i < chunk_end; i++) {
+        chunk_bbox[chunk].grow((emitters + i)->centroid);
+      }
+    });
+    for (const BoundBox &bbox : chunk_bbox) {
+      centroid_bbox.grow(bbox);
+    }
   }
 
   const float3 extent = centroid_bbox.size();
   const float max_extent = max4(extent.x, extent.y, extent.z, 0.0f);
 
+  /* Dimensions to fill buckets for. The first dimension is always used to compute the measure of
+   * the node, other dimensions only if emitters can be split along them. */
+  bool use_dim[3];
+  float inv_extent[3];
+  for (int dim = 0; dim < 3; dim++) {
+    use_dim[dim] = (dim == 0) || (extent[dim] != 0.0f);
+    inv_extent[dim] = (extent[dim] != 0.0f) ? 1.0f / extent[dim] : 0.0f;
+  }
+
+  /* Fill in buckets with emitters, for all dimensions in a single pass over the emitters. */
+  auto fill_buckets = [&](const int bucket_start, const int bucket_end, LightTreeBuckets *buckets) {
+    for (int i = bucket_start; i < bucket_end; i++) {
+      const LightTreeEmitter *emitter = emitters + i;
+      for (int dim = 0; dim < 3; dim++) {
+        if (!use_dim[dim]) {
+          continue;
+        }
+
+        /* Place emitter into the appropriate bucket, where the centroid box is split into equal
+         * partitions. */
+        int bucket_idx = 0;
+        if (extent[dim] != 0.0f) {
+          bucket_idx = LightTreeBucket::num_buckets *
+                       (emitter->centroid[dim] - centroid_bbox.min[dim]) * inv_extent[dim];
+          bucket_idx = clamp(bucket_idx, 0, LightTreeBucket::num_buckets - 1);
+        }
+
+        buckets[dim][bucket_idx].add(*emitter);
+      }
+    }
+  };
+
+  LightTreeBuckets dim_buckets[3];
+  if (num_chunks == 1) {
+    fill_buckets(start, end, dim_buckets);
+  }
+  else {
+    vector<std::array<LightTreeBuckets, 3>> chunk_buckets(num_chunks);
+    parallel_for(0, num_chunks, [&](const int chunk) {
+      const auto [chunk_start, chunk_end] = chunk_range(chunk);
+      fill_buckets(chunk_start, chunk_end, chunk_buckets[chunk].data());
+    });
+    for (const std::array<LightTreeBuckets, 3> &buckets : chunk_buckets) {
+      for (int dim = 0; dim < 3; dim++) {
+        for (int i = 0; i < LightTreeBucket::num_buckets; i++) {
+          dim_buckets[dim][i] = dim_buckets[dim][i] + buckets[dim][i];
+        }
+      }
+    }
+  }
+
   /* Check each dimension to find the minimum splitting cost. */
   float total_cost = 0.0f;
   float min_cost = FLT_MAX;
@@ -530,21 +758,7 @@ bool LightTree::should_split(LightTreeEmitter *emitters,
       continue;
     }
 
-    const float inv_extent = 1 / (centroid_bbox.size()[dim]);
-
-    /* Fill in buckets with emitters. */
-    std::array<LightTreeBucket, LightTreeBucket::num_buckets> buckets;
-    for (int i = start; i < end; i++) {
-      const LightTreeEmitter *emitter = emitters + i;
-
-      /* Place emitter into the appropriate bucket, where the centroid box is split into equal
-       * partitions. */
-      int bucket_idx = LightTreeBucket::num_buckets *
-                       (emitter->centroid[dim] - centroid_bbox.min[dim]) * inv_extent;
-      bucket_idx = clamp(bucket_idx, 0, LightTreeBucket::num_buckets - 1);
-
-      buckets[bucket_idx].add(*emitter);
-    }
+    const LightTreeBuckets &buckets = dim_buckets[dim];
 
     /* Precompute the left bucket measure cumulatively. */
     std::array<LightTreeBucket, LightTreeBucket::num_buckets - 1> left_buckets;
@@ -582,7 +796,7 @@ bool LightTree::should_split(LightTreeEmitter *emitters,
     }
 
     /* Calculate the cost of splitting at each point between partitions. */
-    const float regularization = max_extent * inv_extent;
+    const float regularization = max_extent * inv_extent[dim];
     for (int split = 0; split < LightTreeBucket::num_buckets - 1; split++) {
       const float left_cost = left_buckets[split].measure.calculate();
       const float right_cost = right_buckets[split].measure.calculate();
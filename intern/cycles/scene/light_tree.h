@@ -13,6 +13,7 @@
 #include "util/types.h"
 #include "util/vector.h"
 
+#include <array>
 #include <variant>
 
 CCL_NAMESPACE_BEGIN
@@ -99,7 +100,7 @@ struct LightTreeMeasure {
   }
 
   /* Taken from Eq. 2 in the paper. */
-  __forceinline float calculate()
+  __forceinline float calculate() const
   {
     if (is_zero()) {
       return 0.0f;
@@ -132,6 +133,13 @@ LightTreeMeasure operator+(const LightTreeMeasure &a, const LightTreeMeasure &b)
 
 struct LightTreeNode;
 
+/* Where a scene light ends up in the tree, used to detect changes that need a rebuild. */
+enum LightTreeLightClass : uint8_t {
+  LIGHT_TREE_LIGHT_DISABLED = 0,
+  LIGHT_TREE_LIGHT_LOCAL,
+  LIGHT_TREE_LIGHT_DISTANT,
+};
+
 /* Light Linking. */
 struct LightTreeLightLink {
   /* Bitmask for membership of primitives in this node. */
@@ -237,6 +245,8 @@ struct LightTreeBucket {
 
 LightTreeBucket operator+(const LightTreeBucket &a, const LightTreeBucket &b);
 
+using LightTreeBuckets = std::array<LightTreeBucket, LightTreeBucket::num_buckets>;
+
 /* Light Tree Node */
 struct LightTreeNode {
   LightTreeMeasure measure;
@@ -370,6 +380,23 @@ struct LightTreeNode {
   }
 };
 
+/* Time spent in each phase of building or updating the light tree, in seconds. */
+struct LightTreeBuildTimes {
+  double add_emitters = 0.0;
+  double build_nodes = 0.0;
+  double refit_nodes = 0.0;
+  double flatten = 0.0;
+
+  LightTreeBuildTimes &operator+=(const LightTreeBuildTimes &other)
+  {
+    add_emitters += other.add_emitters;
+    build_nodes += other.build_nodes;
+    refit_nodes += other.refit_nodes;
+    flatten += other.flatten;
+    return *this;
+  }
+};
+
 /* Light BVH
  *
  * BVH-like data structure that keeps track of lights
@@ -386,6 +413,18 @@ class LightTree {
 
   std::unordered_map<Mesh *, int> offset_map_;
 
+  /* Offset of the triangles of each object in the triangle to tree lookup. */
+  vector<uint> object_offsets_;
+
+  /* Scene state the tree was built for, to detect when it can be updated in place. */
+  vector<Object *> objects_;
+  vector<Geometry *> object_geometry_;
+  vector<LightTreeLightClass> light_classes_;
+  int num_triangle_emitters_ = 0;
+
+  /* Cost of the top level tree after the last build. */
+  float build_cost_ = 0.0f;
+
   Progress &progress_;
 
   uint max_lights_in_leaf_;
@@ -404,11 +443,24 @@ class LightTree {
     right = 1,
   };
 
+  LightTreeBuildTimes build_times;
+
   LightTree(Scene *scene, DeviceScene *dscene, Progress &progress, uint max_lights_in_leaf);
 
   /* Returns a pointer to the root node. */
   LightTreeNode *build(Scene *scene, DeviceScene *dscene);
 
+  /* Update the tree in place when only the transform or strength of lights changed, keeping its
+   * topology and the subtrees of mesh lights. Returns false when the tree must be built again,
+   * because lights were enabled or disabled, objects changed, light linking is used or the
+   * refitted tree got too expensive to sample. */
+  bool update(Scene *scene);
+
+  LightTreeNode *get_root() const
+  {
+    return root_.get();
+  }
+
   /* NOTE: Always use this function to create a new node so the number of nodes is in sync. */
   unique_ptr<LightTreeNode> create_node(const LightTreeMeasure &measure, const uint &bit_trial)
   {
@@ -426,12 +478,22 @@ class LightTree {
     return emitters_.data();
   }
 
+  const vector<uint> &get_object_offsets() const
+  {
+    return object_offsets_;
+  }
+
  private:
   /* Thread. */
   TaskPool task_pool;
   /* Do not spawn a thread if less than this amount of emitters are to be processed. */
   enum { MIN_EMITTERS_PER_THREAD = 4096 };
 
+  /* Refitting keeps the topology of the tree, which degrades as lights move away from where they
+   * were when the tree was built. The tree is built again when the cost after refit exceeds the
+   * cost after the last build by this factor. */
+  static constexpr float MAX_REFIT_COST_INCREASE = 1.5f;
+
   void recursive_build(Child child,
                        LightTreeNode *inner,
                        int start,
@@ -440,6 +502,12 @@ class LightTree {
                        uint bit_trail,
                        int depth);
 
+  /* Recompute measures and light links of the top level tree from the emitters. */
+  void refit_node(LightTreeNode *node);
+
+  /* Sum of the measure of all top level nodes, relative to the root. */
+  float compute_cost() const;
+
   bool should_split(LightTreeEmitter *emitters,
                     const int start,
                     int &middle,
@@ -47,6 +47,7 @@ Scene::Scene(const SceneParams &params_, Device *device)
       dscene(device),
       params(params_),
       update_stats(NULL),
+      print_update_stats(false),
       kernels_loaded(false),
       /* TODO(sergey): Check if it's indeed optimal value for the split kernel. */
       max_closure_global(1)
@@ -186,7 +187,7 @@ void Scene::device_update(Device *device_, Progress &progress)
     if (update_stats) {
       update_stats->scene.times.add_entry({"device_update", time});
 
-      if (print_stats) {
+      if (print_stats && print_update_stats) {
         printf("Update statistics:\n%s\n", update_stats->full_report().c_str());
       }
     }
@@ -430,11 +431,12 @@ void Scene::collect_statistics(RenderStats *stats)
   image_manager->collect_statistics(stats);
 }
 
-void Scene::enable_update_stats()
+void Scene::enable_update_stats(bool print)
 {
   if (!update_stats) {
     update_stats = new SceneUpdateStats();
   }
+  print_update_stats |= print;
 }
 
 void Scene::update_kernel_features()
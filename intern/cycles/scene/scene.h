@@ -73,6 +73,10 @@ class SceneParams {
   CurveShapeType hair_shape;
   int texture_limit;
 
+  /* Read image files on demand through a texture cache on the CPU, with its size in MB. */
+  bool use_texture_cache;
+  int texture_cache_size;
+
   bool background;
 
   SceneParams()
@@ -87,6 +91,8 @@ class SceneParams {
     hair_subdivisions = 3;
     hair_shape = CURVE_RIBBON;
     texture_limit = 0;
+    use_texture_cache = false;
+    texture_cache_size = 4096;
     background = true;
   }
 
@@ -99,7 +105,9 @@ class SceneParams {
              use_bvh_unaligned_nodes == params.use_bvh_unaligned_nodes &&
              num_bvh_time_steps == params.num_bvh_time_steps &&
              hair_subdivisions == params.hair_subdivisions && hair_shape == params.hair_shape &&
-             texture_limit == params.texture_limit);
+             texture_limit == params.texture_limit &&
+             use_texture_cache == params.use_texture_cache &&
+             texture_cache_size == params.texture_cache_size);
   }
 
   int curve_subdivisions()
@@ -166,6 +174,7 @@ class Scene : public NodeOwner {
 
   /* scene update statistics */
   SceneUpdateStats *update_stats;
+  bool print_update_stats;
 
   Scene(const SceneParams &params, Device *device);
   ~Scene();
@@ -187,7 +196,9 @@ class Scene : public NodeOwner {
 
   void collect_statistics(RenderStats *stats);
 
-  void enable_update_stats();
+  /* Record timings of scene updates, and print them after every update that changed data when
+   * requested. */
+  void enable_update_stats(bool print = true);
 
   bool load_kernels(Progress &progress);
   bool update(Progress &progress);
@@ -5,6 +5,7 @@
 #include "scene/shader_graph.h"
 #include "scene/attribute.h"
 #include "scene/constant_fold.h"
+#include "scene/image.h"
 #include "scene/scene.h"
 #include "scene/shader.h"
 #include "scene/shader_nodes.h"
@@ -372,6 +373,9 @@ void ShaderGraph::finalize(Scene *scene, bool do_bump, bool bump_in_object_space
     if (do_bump)
       bump_from_displacement(bump_in_object_space);
 
+    if (scene->image_manager->use_texture_cache(scene) && !scene->shader_manager->use_osl())
+      image_texture_derivatives();
+
     ShaderInput *surface_in = output()->input("Surface");
     ShaderInput *volume_in = output()->input("Volume");
 
@@ -940,6 +944,66 @@ void ShaderGraph::refine_bump_nodes()
   }
 }
 
+void ShaderGraph::image_texture_derivatives()
+{
+  /* Images in the texture cache select their mipmap level from the derivatives of the texture
+   * coordinates. Like for bump mapping, we copy the sub-graph defining the texture coordinate
+   * twice and shift any texture coordinates by the ray differentials dx and dy. */
+
+  vector<ShaderNode *> image_nodes;
+  foreach (ShaderNode *node, nodes) {
+    /* Samples shifted for bump mapping are close enough to the center to share its filter. */
+    if (node->bump == SHADER_BUMP_DX || node->bump == SHADER_BUMP_DY) {
+      continue;
+    }
+
+    ShaderInput *vector_in = node->input("Vector");
+    if (node->special_type == SHADER_SPECIAL_TYPE_IMAGE_SLOT && node->input("VectorDx") &&
+        vector_in && vector_in->link)
+    {
+      image_nodes.push_back(node);
+    }
+  }
+
+  foreach (ShaderNode *node, image_nodes) {
+    ShaderInput *vector_in = node->input("Vector");
+    ShaderNodeSet nodes_vector;
+    find_dependencies(nodes_vector, vector_in);
+
+    /* Evaluating other images twice more to filter this one is not worth it. */
+    bool has_image_dependency = false;
+    foreach (ShaderNode *dependency, nodes_vector) {
+      if (dependency->special_type == SHADER_SPECIAL_TYPE_IMAGE_SLOT) {
+        has_image_dependency = true;
+        break;
+      }
+    }
+    if (has_image_dependency) {
+      continue;
+    }
+
+    ShaderNodeMap nodes_dx;
+    ShaderNodeMap nodes_dy;
+
+    copy_nodes(nodes_vector, nodes_dx);
+    copy_nodes(nodes_vector, nodes_dy);
+
+    foreach (NodePair &pair, nodes_dx)
+      pair.second->bump = SHADER_BUMP_DX;
+    foreach (NodePair &pair, nodes_dy)
+      pair.second->bump = SHADER_BUMP_DY;
+
+    ShaderOutput *out = vector_in->link;
+    connect(nodes_dx[out->parent]->output(out->name()), node->input("VectorDx"));
+    connect(nodes_dy[out->parent]->output(out->name()), node->input("VectorDy"));
+
+    foreach (NodePair &pair, nodes_dx)
+      add(pair.second);
+    foreach (NodePair &pair, nodes_dy)
+      add(pair.second);
+  }
+}
+
 void ShaderGraph::bump_from_displacement(bool use_object_space)
 {
   /* generate bump mapping automatically from displacement. bump mapping is
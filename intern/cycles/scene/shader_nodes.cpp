@@ -242,6 +242,11 @@ NODE_DEFINE(ImageTextureNode)
 
   SOCKET_IN_POINT(vector, "Vector", zero_float3(), SocketType::LINK_TEXTURE_UV);
 
+  /* Texture coordinate shifted by ray differentials, connected for images in the texture cache
+   * when the graph is finalized. */
+  SOCKET_IN_POINT(vector_dx, "VectorDx", zero_float3(), SocketType::SVM_INTERNAL);
+  SOCKET_IN_POINT(vector_dy, "VectorDy", zero_float3(), SocketType::SVM_INTERNAL);
+
   SOCKET_OUT_COLOR(color, "Color");
   SOCKET_OUT_FLOAT(alpha, "Alpha");
 
@@ -353,6 +358,8 @@ void ImageTextureNode::attributes(Shader *shader, AttributeRequestSet *attribute
 void ImageTextureNode::compile(SVMCompiler &compiler)
 {
   ShaderInput *vector_in = input("Vector");
+  ShaderInput *vector_dx_in = input("VectorDx");
+  ShaderInput *vector_dy_in = input("VectorDy");
   ShaderOutput *color_out = output("Color");
   ShaderOutput *alpha_out = output("Alpha");
 
@@ -383,6 +390,16 @@ void ImageTextureNode::compile(SVMCompiler &compiler)
     }
   }
 
+  const bool use_derivatives = projection != NODE_IMAGE_PROJ_BOX && vector_dx_in->link &&
+                               vector_dy_in->link;
+  int vector_dx_offset = SVM_STACK_INVALID;
+  int vector_dy_offset = SVM_STACK_INVALID;
+  if (use_derivatives) {
+    vector_dx_offset = tex_mapping.compile_begin(compiler, vector_dx_in);
+    vector_dy_offset = tex_mapping.compile_begin(compiler, vector_dy_in);
+    flags |= NODE_IMAGE_DERIVATIVES;
+  }
+
   if (projection != NODE_IMAGE_PROJ_BOX) {
     /* If there only is one image (a very common case), we encode it as a negative value. */
     int num_nodes;
@@ -401,6 +418,10 @@ void ImageTextureNode::compile(SVMCompiler &compiler)
                                              flags),
                       projection);
 
+    if (use_derivatives) {
+      compiler.add_node(vector_dx_offset, vector_dy_offset, 0, 0);
+    }
+
     if (num_nodes > 0) {
       for (int i = 0; i < num_nodes; i++) {
         int4 node;
@@ -430,6 +451,10 @@ void ImageTextureNode::compile(SVMCompiler &compiler)
   }
 
   tex_mapping.compile_end(compiler, vector_in, vector_offset);
+  if (use_derivatives) {
+    tex_mapping.compile_end(compiler, vector_dx_in, vector_dx_offset);
+    tex_mapping.compile_end(compiler, vector_dy_in, vector_dy_offset);
+  }
 }
 
 void ImageTextureNode::compile(OSLCompiler &compiler)
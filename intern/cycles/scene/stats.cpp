@@ -3,11 +3,17 @@
  * SPDX-License-Identifier: Apache-2.0 */
 
 #include "scene/stats.h"
+#include "bvh/params.h"
+#include "device/memory.h"
+#include "scene/light_tree.h"
 #include "scene/object.h"
 #include "util/algorithm.h"
 #include "util/foreach.h"
+#include "util/progress.h"
 #include "util/string.h"
 
+#include <cmath>
+
 CCL_NAMESPACE_BEGIN
 
 static int kIndentNumSpaces = 2;
@@ -39,6 +45,95 @@ bool namedSampleCountPairComparator(const NamedSampleCountPair &a, const NamedSa
   return a.samples > b.samples;
 }
 
+/* Quote a string for use in JSON. */
+string json_string(const string &str)
+{
+  string result = "\"";
+  for (const char c : str) {
+    switch (c) {
+      case '"':
+        result += "\\\"";
+        break;
+      case '\\':
+        result += "\\\\";
+        break;
+      case '\n':
+        result += "\\n";
+        break;
+      case '\t':
+        result += "\\t";
+        break;
+      default:
+        if ((unsigned char)c < 0x20) {
+          result += string_printf("\\u%04x", (unsigned char)c);
+        }
+        else {
+          result += c;
+        }
+        break;
+    }
+  }
+  return result + "\"";
+}
+
+/* Quote a string for use as CSV field, if needed. */
+string csv_string(const string &str)
+{
+  if (str.find_first_of(",\"\n") == string::npos) {
+    return str;
+  }
+  string result = "\"";
+  for (const char c : str) {
+    if (c == '"') {
+      result += '"';
+    }
+    result += c;
+  }
+  return result + "\"";
+}
+
+void csv_row(string &result,
+             const string &section,
+             const string &name,
+             const string &metric,
+             const string &value)
+{
+  result += section + "," + csv_string(name) + "," + metric + "," + value + "\n";
+}
+
+string json_number(const double value)
+{
+  /* JSON has no representation for NaN and infinity, which "%f" prints as "nan" and "inf". They
+   * can come from divisions by a zero render time or sample count. */
+  if (!std::isfinite(value)) {
+    return "null";
+  }
+  return string_printf("%.6f", value);
+}
+
+string json_number(const uint64_t value)
+{
+  return string_printf("%llu", (unsigned long long)value);
+}
+
+/* Name of the device memory category, as passed by devices to Stats::mem_alloc(). */
+const char *device_memory_category_name(const int category)
+{
+  switch (category) {
+    case MEM_READ_ONLY:
+      return "read_only";
+    case MEM_READ_WRITE:
+      return "read_write";
+    case MEM_DEVICE_ONLY:
+      return "device_only";
+    case MEM_GLOBAL:
+      return "global";
+    case MEM_TEXTURE:
+      return "texture";
+  }
+  return nullptr;
+}
+
 }  // namespace
 
 NamedSizeEntry::NamedSizeEntry() : name(""), size(0) {}
@@ -79,6 +174,18 @@ string NamedSizeStats::full_report(int indent_level)
   return result;
 }
 
+string NamedSizeStats::json_report() const
+{
+  string result = "[";
+  for (size_t i = 0; i < entries.size(); i++) {
+    result += string_printf("%s{\"name\": %s, \"size\": %s}",
+                            (i == 0) ? "" : ", ",
+                            json_string(entries[i].name).c_str(),
+                            json_number((uint64_t)entries[i].size).c_str());
+  }
+  return result + "]";
+}
+
 string NamedTimeStats::full_report(int indent_level)
 {
   const string indent(indent_level * kIndentNumSpaces, ' ');
@@ -93,6 +200,18 @@ string NamedTimeStats::full_report(int indent_level)
   return result;
 }
 
+string NamedTimeStats::json_report() const
+{
+  string result = "[";
+  for (size_t i = 0; i < entries.size(); i++) {
+    result += string_printf("%s{\"name\": %s, \"time\": %s}",
+                            (i == 0) ? "" : ", ",
+                            json_string(entries[i].name).c_str(),
+                            json_number(entries[i].time).c_str());
+  }
+  return result + "]";
+}
+
 /* Named time sample statistics. */
 
 NamedNestedSampleStats::NamedNestedSampleStats() : name(""), self_samples(0), sum_samples(0) {}
@@ -146,6 +265,36 @@ string NamedNestedSampleStats::full_report(int indent_level, uint64_t total_samp
   return result;
 }
 
+string NamedNestedSampleStats::json_report()
+{
+  update_sum();
+
+  string result = string_printf("{\"name\": %s, \"time\": %s, \"self_time\": %s",
+                                json_string(name).c_str(),
+                                json_number(sum_samples * 0.001).c_str(),
+                                json_number(self_samples * 0.001).c_str());
+  if (!entries.empty()) {
+    result += ", \"entries\": [";
+    for (size_t i = 0; i < entries.size(); i++) {
+      result += ((i == 0) ? "" : ", ") + entries[i].json_report();
+    }
+    result += "]";
+  }
+  return result + "}";
+}
+
+void NamedNestedSampleStats::csv_report(const string &parent_path, string &result)
+{
+  update_sum();
+
+  const string path = parent_path.empty() ? name : parent_path + "/" + name;
+  csv_row(result, "kernel", path, "time", json_number(sum_samples * 0.001));
+  csv_row(result, "kernel", path, "self_time", json_number(self_samples * 0.001));
+  foreach (NamedNestedSampleStats &entry, entries) {
+    entry.csv_report(path, result);
+  }
+}
+
 /* Named sample count pairs. */
 
 NamedSampleCountPair::NamedSampleCountPair(const ustring &name, uint64_t samples, uint64_t hits)
@@ -166,12 +315,11 @@ void NamedSampleCountStats::add(const ustring &name, uint64_t samples, uint64_t
   entries.emplace(name, NamedSampleCountPair(name, samples, hits));
 }
 
-string NamedSampleCountStats::full_report(int indent_level)
+vector<NamedSampleCountPair> NamedSampleCountStats::sorted_entries(
+    vector<double> &relative_cost) const
 {
-  const string indent(indent_level * kIndentNumSpaces, ' ');
-
-  vector<NamedSampleCountPair> sorted_entries;
-  sorted_entries.reserve(entries.size());
+  vector<NamedSampleCountPair> result;
+  result.reserve(entries.size());
 
   uint64_t total_hits = 0, total_samples = 0;
   foreach (entry_map::const_reference entry, entries) {
@@ -180,24 +328,73 @@ string NamedSampleCountStats::full_report(int indent_level)
     total_hits += pair.hits;
     total_samples += pair.samples;
 
-    sorted_entries.push_back(pair);
+    result.push_back(pair);
   }
   const double avg_samples_per_hit = ((double)total_samples) / total_hits;
 
-  sort(sorted_entries.begin(), sorted_entries.end(), namedSampleCountPairComparator);
+  sort(result.begin(), result.end(), namedSampleCountPairComparator);
+
+  relative_cost.clear();
+  relative_cost.reserve(result.size());
+  foreach (const NamedSampleCountPair &pair, result) {
+    relative_cost.push_back(((double)pair.samples) / (pair.hits * avg_samples_per_hit));
+  }
+
+  return result;
+}
+
+string NamedSampleCountStats::full_report(int indent_level)
+{
+  const string indent(indent_level * kIndentNumSpaces, ' ');
+
+  vector<double> relative_cost;
+  const vector<NamedSampleCountPair> sorted = sorted_entries(relative_cost);
 
   string result = "";
-  foreach (const NamedSampleCountPair &entry, sorted_entries) {
+  for (size_t i = 0; i < sorted.size(); i++) {
+    const NamedSampleCountPair &entry = sorted[i];
     const double seconds = entry.samples * 0.001;
-    const double relative = ((double)entry.samples) / (entry.hits * avg_samples_per_hit);
 
-    result += indent +
-              string_printf(
-                  "%-32s: %.2fs (Relative cost: %.2f)\n", entry.name.c_str(), seconds, relative);
+    result += indent + string_printf("%-32s: %.2fs (Relative cost: %.2f)\n",
+                                     entry.name.c_str(),
+                                     seconds,
+                                     relative_cost[i]);
   }
   return result;
 }
 
+string NamedSampleCountStats::json_report() const
+{
+  vector<double> relative_cost;
+  const vector<NamedSampleCountPair> sorted = sorted_entries(relative_cost);
+
+  string result = "[";
+  for (size_t i = 0; i < sorted.size(); i++) {
+    const NamedSampleCountPair &entry = sorted[i];
+    result += string_printf(
+        "%s{\"name\": %s, \"time\": %s, \"hits\": %s, \"relative_cost\": %s}",
+        (i == 0) ? "" : ", ",
+        json_string(entry.name.string()).c_str(),
+        json_number(entry.samples * 0.001).c_str(),
+        json_number(entry.hits).c_str(),
+        json_number(relative_cost[i]).c_str());
+  }
+  return result + "]";
+}
+
+void NamedSampleCountStats::csv_report(const string &section, string &result) const
+{
+  vector<double> relative_cost;
+  const vector<NamedSampleCountPair> sorted = sorted_entries(relative_cost);
+
+  for (size_t i = 0; i < sorted.size(); i++) {
+    const NamedSampleCountPair &entry = sorted[i];
+    csv_row(result, section, entry.name.string(), "time", json_number(entry.samples * 0.001));
+    csv_row(result, section, entry.name.string(), "hits", json_number(entry.hits));
+    csv_row(result, section, entry.name.string(), "relative_cost", json_number(relative_cost[i]));
+  }
+}
+
 /* Mesh statistics. */
 
 MeshStats::MeshStats() {}
@@ -227,6 +424,12 @@ string ImageStats::full_report(int indent_level)
 RenderStats::RenderStats()
 {
   has_profiling = false;
+  has_render_time = false;
+  has_update_stats = false;
+  total_time = 0.0;
+  render_time = 0.0;
+  pixel_samples = 0;
+  device_memory_peak = 0;
 }
 
 void RenderStats::collect_profiling(Scene *scene, Profiler &prof)
@@ -282,6 +485,123 @@ void RenderStats::collect_profiling(Scene *scene, Profiler &prof)
   }
 }
 
+void RenderStats::collect_device_memory(const Stats &stats)
+{
+  device_memory_peak = stats.mem_peak;
+
+  device_memory = NamedSizeStats();
+  for (int category = 0; category < Stats::MEM_CATEGORY_NUM; category++) {
+    const char *name = device_memory_category_name(category);
+    if (name) {
+      device_memory.add_entry(NamedSizeEntry(name, stats.category_peak[category]));
+    }
+  }
+}
+
+void RenderStats::collect_render_time(Progress &progress)
+{
+  has_render_time = true;
+  progress.get_time(total_time, render_time);
+  pixel_samples = progress.get_pixel_samples();
+}
+
+void RenderStats::collect_update_stats(const SceneUpdateStats &update_stats)
+{
+  has_update_stats = true;
+  update = update_stats;
+}
+
+string RenderStats::json_report()
+{
+  string result = "{";
+
+  if (has_render_time) {
+    /* Every pixel sample traces one camera ray, the number of secondary rays is not counted. */
+    const double camera_rays_per_second = (render_time > 0.0) ? pixel_samples / render_time :
+                                                                0.0;
+    result += string_printf(
+        "\"render\": {\"total_time\": %s, \"render_time\": %s, \"synchronization_time\": %s, "
+        "\"pixel_samples\": %s, \"camera_rays_per_second\": %s}, ",
+        json_number(total_time).c_str(),
+        json_number(render_time).c_str(),
+        json_number(total_time - render_time).c_str(),
+        json_number(pixel_samples).c_str(),
+        json_number(camera_rays_per_second).c_str());
+  }
+
+  if (has_update_stats) {
+    result += "\"synchronization\": {";
+    bool first = true;
+    update.foreach_category([&](const char *name, const UpdateTimeStats &stats) {
+      result += string_printf(
+          "%s\"%s\": %s", first ? "" : ", ", name, stats.times.json_report().c_str());
+      first = false;
+    });
+    result += "}, ";
+  }
+
+  result += string_printf(
+      "\"memory\": {\"device_peak\": %s, \"device\": %s, \"geometry\": %s, \"images\": %s}",
+      json_number((uint64_t)device_memory_peak).c_str(),
+      device_memory.json_report().c_str(),
+      mesh.geometry.json_report().c_str(),
+      image.textures.json_report().c_str());
+
+  if (has_profiling) {
+    result += ", \"kernel\": " + kernel.json_report();
+    result += ", \"shaders\": " + shaders.json_report();
+    result += ", \"objects\": " + objects.json_report();
+  }
+
+  return result + "}";
+}
+
+string RenderStats::csv_report()
+{
+  string result = "section,name,metric,value\n";
+
+  if (has_render_time) {
+    const double camera_rays_per_second = (render_time > 0.0) ? pixel_samples / render_time :
+                                                                0.0;
+    csv_row(result, "render", "", "total_time", json_number(total_time));
+    csv_row(result, "render", "", "render_time", json_number(render_time));
+    csv_row(result, "render", "", "synchronization_time", json_number(total_time - render_time));
+    csv_row(result, "render", "", "pixel_samples", json_number(pixel_samples));
+    csv_row(result, "render", "", "camera_rays_per_second", json_number(camera_rays_per_second));
+  }
+
+  if (has_update_stats) {
+    update.foreach_category([&](const char *name, const UpdateTimeStats &stats) {
+      foreach (const NamedTimeEntry &entry, stats.times.entries) {
+        csv_row(result,
+                "synchronization",
+                string(name) + "/" + entry.name,
+                "time",
+                json_number(entry.time));
+      }
+    });
+  }
+
+  csv_row(result, "memory", "device", "peak", json_number((uint64_t)device_memory_peak));
+  foreach (const NamedSizeEntry &entry, device_memory.entries) {
+    csv_row(result, "memory", "device/" + entry.name, "peak", json_number((uint64_t)entry.size));
+  }
+  foreach (const NamedSizeEntry &entry, mesh.geometry.entries) {
+    csv_row(result, "memory", "geometry/" + entry.name, "size", json_number((uint64_t)entry.size));
+  }
+  foreach (const NamedSizeEntry &entry, image.textures.entries) {
+    csv_row(result, "memory", "images/" + entry.name, "size", json_number((uint64_t)entry.size));
+  }
+
+  if (has_profiling) {
+    kernel.csv_report("", result);
+    shaders.csv_report("shaders", result);
+    objects.csv_report("objects", result);
+  }
+
+  return result;
+}
+
 string RenderStats::full_report()
 {
   string result = "";
@@ -305,6 +625,23 @@ string UpdateTimeStats::full_report(int indent_level)
   return times.full_report(indent_level + 1);
 }
 
+void UpdateTimeStats::add_bvh_build_times(const string &prefix, const BVHBuildTimes &build_times)
+{
+  times.add_entry({prefix + " (add references)", build_times.add_references});
+  times.add_entry({prefix + " (build nodes)", build_times.build_nodes});
+  times.add_entry({prefix + " (pack primitives)", build_times.pack_primitives});
+  times.add_entry({prefix + " (pack nodes)", build_times.pack_nodes});
+  times.add_entry({prefix + " (refit nodes)", build_times.refit_nodes});
+}
+
+void UpdateTimeStats::add_light_tree_build_times(const LightTreeBuildTimes &build_times)
+{
+  times.add_entry({"light tree (add emitters)", build_times.add_emitters});
+  times.add_entry({"light tree (build nodes)", build_times.build_nodes});
+  times.add_entry({"light tree (refit nodes)", build_times.refit_nodes});
+  times.add_entry({"light tree (flatten)", build_times.flatten});
+}
+
 SceneUpdateStats::SceneUpdateStats() {}
 
 string SceneUpdateStats::full_report()
@@ -312,6 +649,7 @@ string SceneUpdateStats::full_report()
   string result = "";
   result += "Scene:\n" + scene.full_report(1);
   result += "Geometry:\n" + geometry.full_report(1);
+  result += "BVH:\n" + bvh.full_report(1);
   result += "Light:\n" + light.full_report(1);
   result += "Object:\n" + object.full_report(1);
   result += "Image:\n" + image.full_report(1);
@@ -331,6 +669,7 @@ string SceneUpdateStats::full_report()
 void SceneUpdateStats::clear()
 {
   geometry.times.clear();
+  bvh.times.clear();
   image.times.clear();
   light.times.clear();
   object.times.clear();
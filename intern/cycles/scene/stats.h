@@ -13,6 +13,9 @@
 
 CCL_NAMESPACE_BEGIN
 
+struct BVHBuildTimes;
+struct LightTreeBuildTimes;
+
 /* Named statistics entry, which corresponds to a size. There is no real
  * semantic around the units of size, it just should be the same for all
  * entries.
@@ -52,6 +55,9 @@ class NamedSizeStats {
   /* Generate full human-readable report. */
   string full_report(int indent_level = 0);
 
+  /* Generate report as JSON array of entries. */
+  string json_report() const;
+
   /* Total size of all entries. */
   size_t total_size;
 
@@ -75,6 +81,9 @@ class NamedTimeStats {
   /* Generate full human-readable report. */
   string full_report(int indent_level = 0);
 
+  /* Generate report as JSON array of entries. */
+  string json_report() const;
+
   /* Total time of all entries. */
   double total_time;
 
@@ -102,6 +111,11 @@ class NamedNestedSampleStats {
 
   string full_report(int indent_level = 0, uint64_t total_samples = 0);
 
+  /* Generate report as JSON object with nested entries, and as CSV rows with the names of the
+   * parent entries as path. Times are in seconds. */
+  string json_report();
+  void csv_report(const string &parent_path, string &result);
+
   string name;
 
   /* self_samples contains only the samples that this specific event got,
@@ -131,6 +145,14 @@ class NamedSampleCountStats {
   string full_report(int indent_level = 0);
   void add(const ustring &name, uint64_t samples, uint64_t hits);
 
+  /* Entries sorted by descending sample count, with the relative cost of every entry compared
+   * to the average cost per hit. */
+  vector<NamedSampleCountPair> sorted_entries(vector<double> &relative_cost) const;
+
+  /* Generate report as JSON array, and as CSV rows in the given section. */
+  string json_report() const;
+  void csv_report(const string &section, string &result) const;
+
   typedef unordered_map<ustring, NamedSampleCountPair, ustringHash> entry_map;
   entry_map entries;
 };
@@ -161,31 +183,17 @@ class ImageStats {
   NamedSizeStats textures;
 };
 
-/* Render process statistics. */
-class RenderStats {
- public:
-  RenderStats();
-
-  /* Return full report as string. */
-  string full_report();
-
-  /* Collect kernel sampling information from Stats. */
-  void collect_profiling(Scene *scene, Profiler &prof);
-
-  bool has_profiling;
-
-  MeshStats mesh;
-  ImageStats image;
-  NamedNestedSampleStats kernel;
-  NamedSampleCountStats shaders;
-  NamedSampleCountStats objects;
-};
-
 class UpdateTimeStats {
  public:
   /* Generate full human-readable report. */
   string full_report(int indent_level = 0);
 
+  /* Add an entry for every phase of a BVH build, named after the given prefix. */
+  void add_bvh_build_times(const string &prefix, const BVHBuildTimes &build_times);
+
+  /* Add an entry for every phase of a light tree build or refit. */
+  void add_light_tree_build_times(const LightTreeBuildTimes &build_times);
+
   NamedTimeStats times;
 };
 
@@ -194,6 +202,7 @@ class SceneUpdateStats {
   SceneUpdateStats();
 
   UpdateTimeStats geometry;
+  UpdateTimeStats bvh;
   UpdateTimeStats image;
   UpdateTimeStats light;
   UpdateTimeStats object;
@@ -211,9 +220,76 @@ class SceneUpdateStats {
 
   string full_report();
 
+  /* Call the callback for every category of update times, with the category name as used in
+   * machine-readable reports. */
+  template<typename Func> void foreach_category(const Func &func) const
+  {
+    func("scene", scene);
+    func("geometry", geometry);
+    func("bvh", bvh);
+    func("light", light);
+    func("object", object);
+    func("image", image);
+    func("background", background);
+    func("bake", bake);
+    func("camera", camera);
+    func("film", film);
+    func("integrator", integrator);
+    func("osl", osl);
+    func("particles", particles);
+    func("svm", svm);
+    func("tables", tables);
+    func("procedurals", procedurals);
+  }
+
   void clear();
 };
 
+/* Render process statistics. */
+class RenderStats {
+ public:
+  RenderStats();
+
+  /* Return full report as string. */
+  string full_report();
+
+  /* Return full report in a machine-readable format, as a JSON object or as CSV rows of
+   * `section,name,metric,value`. */
+  string json_report();
+  string csv_report();
+
+  /* Collect kernel sampling information from Stats. */
+  void collect_profiling(Scene *scene, Profiler &prof);
+
+  /* Collect peak device memory usage per memory category. */
+  void collect_device_memory(const Stats &stats);
+
+  /* Collect render and synchronization times, and the number of rendered pixel samples. */
+  void collect_render_time(Progress &progress);
+
+  /* Copy timings of the last scene synchronization. */
+  void collect_update_stats(const SceneUpdateStats &update_stats);
+
+  bool has_profiling;
+  bool has_render_time;
+  bool has_update_stats;
+
+  double total_time;
+  double render_time;
+  uint64_t pixel_samples;
+
+  /* Peak device memory usage, in total and per memory category. */
+  size_t device_memory_peak;
+  NamedSizeStats device_memory;
+
+  MeshStats mesh;
+  ImageStats image;
+  NamedNestedSampleStats kernel;
+  NamedSampleCountStats shaders;
+  NamedSampleCountStats objects;
+  SceneUpdateStats update;
+};
+
 CCL_NAMESPACE_END
 
 #endif /* __RENDER_STATS_H__ */
@@ -743,6 +743,11 @@ void Session::collect_statistics(RenderStats *render_stats)
   if (params.use_profiling && (params.device.type == DEVICE_CPU)) {
     render_stats->collect_profiling(scene, profiler);
   }
+  render_stats->collect_device_memory(stats);
+  render_stats->collect_render_time(progress);
+  if (scene->update_stats) {
+    render_stats->collect_update_stats(*scene->update_stats);
+  }
 }
 
 /* --------------------------------------------------------------------
@@ -751,7 +756,7 @@ void Session::collect_statistics(RenderStats *render_stats)
 
 void Session::process_full_buffer_from_disk(string_view filename)
 {
-  path_trace_->process_full_buffer_from_disk(filename);
+  path_trace_->process_full_buffer_from_disk(filename, params.use_streaming_finalize);
 }
 
 CCL_NAMESPACE_END
@@ -55,6 +55,10 @@ class SessionParams {
   bool use_auto_tile;
   int tile_size;
 
+  /* Process the tiles file written during tiled rendering one tile at a time instead of reading
+   * the full frame into memory for denoising and output. */
+  bool use_streaming_finalize;
+
   bool use_resolution_divider;
 
   ShadingSystem shadingsystem;
@@ -78,6 +82,7 @@ class SessionParams {
 
     use_auto_tile = true;
     tile_size = 2048;
+    use_streaming_finalize = false;
 
     use_resolution_divider = true;
 
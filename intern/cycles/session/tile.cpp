@@ -662,4 +662,100 @@ bool TileManager::read_full_buffer_from_disk(const string_view filename,
   return true;
 }
 
+bool TileManager::read_full_buffer_params_from_disk(const string_view filename,
+                                                    BufferParams *buffer_params,
+                                                    DenoiseParams *denoise_params)
+{
+  unique_ptr<ImageInput> in(ImageInput::open(filename));
+  if (!in) {
+    LOG(ERROR) << "Error opening tile file " << filename;
+    return false;
+  }
+
+  const ImageSpec &image_spec = in->spec();
+
+  if (!buffer_params_from_image_spec_atttributes(buffer_params, image_spec)) {
+    return false;
+  }
+
+  if (!node_from_image_spec_atttributes(denoise_params, image_spec, ATTR_DENOISE_SOCKET_PREFIX)) {
+    return false;
+  }
+
+  return true;
+}
+
+bool TileManager::read_buffer_region_from_disk(const string_view filename,
+                                               const int x,
+                                               const int y,
+                                               const int width,
+                                               const int height,
+                                               const int overlap,
+                                               RenderBuffers *buffers)
+{
+  unique_ptr<ImageInput> in(ImageInput::open(filename));
+  if (!in) {
+    LOG(ERROR) << "Error opening tile file " << filename;
+    return false;
+  }
+
+  const ImageSpec &image_spec = in->spec();
+
+  if (image_spec.tile_width == 0 || image_spec.tile_height == 0) {
+    LOG(ERROR) << "Tile file " << filename << " is not tiled.";
+    return false;
+  }
+
+  BufferParams buffer_params;
+  if (!buffer_params_from_image_spec_atttributes(&buffer_params, image_spec)) {
+    return false;
+  }
+
+  /* Only whole tiles of the file can be read, so align the region with the overlap outwards to
+   * the tile boundaries. The end of the region is allowed to be the edge of the image. */
+  const int x_begin = max(x - overlap, 0) / image_spec.tile_width * image_spec.tile_width;
+  const int y_begin = max(y - overlap, 0) / image_spec.tile_height * image_spec.tile_height;
+  const int x_end = min(int(align_up(x + width + overlap, image_spec.tile_width)),
+                        image_spec.width);
+  const int y_end = min(int(align_up(y + height + overlap, image_spec.tile_height)),
+                        image_spec.height);
+
+  buffer_params.full_x += x_begin;
+  buffer_params.full_y += y_begin;
+  buffer_params.width = x_end - x_begin;
+  buffer_params.height = y_end - y_begin;
+  buffer_params.window_x = x - x_begin;
+  buffer_params.window_y = y - y_begin;
+  buffer_params.window_width = width;
+  buffer_params.window_height = height;
+  buffer_params.update_offset_stride();
+
+  buffers->reset(buffer_params);
+
+  const int num_channels = image_spec.nchannels;
+  if (!in->read_tiles(0,
+                      0,
+                      x_begin,
+                      x_end,
+                      y_begin,
+                      y_end,
+                      0,
+                      1,
+                      0,
+                      num_channels,
+                      TypeDesc::FLOAT,
+                      buffers->buffer.data()))
+  {
+    LOG(ERROR) << "Error reading pixels from the tile file " << in->geterror();
+    return false;
+  }
+
+  if (!in->close()) {
+    LOG(ERROR) << "Error closing tile file " << in->geterror();
+    return false;
+  }
+
+  return true;
+}
+
 CCL_NAMESPACE_END
@@ -80,6 +80,11 @@ class TileManager {
   const Tile &get_current_tile() const;
   const int2 get_size() const;
 
+  inline int2 get_tile_size() const
+  {
+    return tile_size_;
+  }
+
   /* Write render buffer of a tile to a file on disk.
    *
    * Opens file for write when first tile is written.
@@ -104,6 +109,28 @@ class TileManager {
                                   RenderBuffers *buffers,
                                   DenoiseParams *denoise_params);
 
+  /* Read parameters of the full frame render buffer from tiles file on disk, without reading any
+   * pixels.
+   *
+   * Returns true on success. */
+  bool read_full_buffer_params_from_disk(string_view filename,
+                                         BufferParams *buffer_params,
+                                         DenoiseParams *denoise_params);
+
+  /* Read a region of the full frame render buffer from tiles file on disk.
+   *
+   * The region is given in pixels of the full frame. It is extended by the overlap on every side
+   * and aligned to the tiles of the file, the buffer window is set to the region itself.
+   *
+   * Returns true on success. */
+  bool read_buffer_region_from_disk(string_view filename,
+                                    int x,
+                                    int y,
+                                    int width,
+                                    int height,
+                                    int overlap,
+                                    RenderBuffers *buffers);
+
   /* Compute valid tile size compatible with image saving. */
   int compute_render_tile_size(const int suggested_tile_size) const;
 
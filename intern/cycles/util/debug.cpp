@@ -37,6 +37,10 @@ void DebugFlags::CPU::reset()
 #undef CHECK_CPU_FLAGS
 
   bvh_layout = BVH_LAYOUT_AUTO;
+
+  use_wide_bvh = (getenv("CYCLES_CPU_WIDE_BVH") != NULL);
+
+  use_wavefront = (getenv("CYCLES_CPU_WAVEFRONT") != NULL);
 }
 
 DebugFlags::CUDA::CUDA()
@@ -52,6 +52,14 @@ class DebugFlags {
      * CPUs and GPUs can be selected here instead.
      */
     BVHLayout bvh_layout = BVH_LAYOUT_AUTO;
+
+    /* Traverse BVH2 with 4-wide nodes and SIMD bounds tests, used when Embree is not.
+     * Off by default: traversal is still one ray at a time, without ray packets. */
+    bool use_wide_bvh = false;
+
+    /* Use wavefront path tracing instead of the megakernel. Paths of a block of pixels are
+     * scheduled kernel by kernel and sorted by shader, similar to GPU rendering. */
+    bool use_wavefront = false;
   };
 
   /* Descriptor of CUDA feature-set to be used. */
@@ -238,6 +238,12 @@ class Progress {
     }
   }
 
+  uint64_t get_pixel_samples() const
+  {
+    thread_scoped_lock lock(progress_mutex);
+    return pixel_samples;
+  }
+
   int get_current_sample() const
   {
     thread_scoped_lock lock(progress_mutex);
@@ -14,7 +14,11 @@ class Stats {
  public:
   enum static_init_t { static_init = 0 };
 
-  Stats() : mem_used(0), mem_peak(0) {}
+  /* Number of memory categories tracked separately. Devices use the MemoryType of the
+   * allocation as category. */
+  static constexpr int MEM_CATEGORY_NUM = 8;
+
+  Stats() : mem_used(0), mem_peak(0), category_used{0}, category_peak{0} {}
   explicit Stats(static_init_t) {}
 
   void mem_alloc(size_t size)
@@ -23,14 +27,36 @@ class Stats {
     atomic_fetch_and_update_max_z(&mem_peak, mem_used);
   }
 
+  void mem_alloc(size_t size, int category)
+  {
+    mem_alloc(size);
+
+    assert(category >= 0 && category < MEM_CATEGORY_NUM);
+    const size_t used = atomic_add_and_fetch_z(&category_used[category], size);
+    atomic_fetch_and_update_max_z(&category_peak[category], used);
+  }
+
   void mem_free(size_t size)
   {
     assert(mem_used >= size);
     atomic_sub_and_fetch_z(&mem_used, size);
   }
 
+  void mem_free(size_t size, int category)
+  {
+    mem_free(size);
+
+    assert(category >= 0 && category < MEM_CATEGORY_NUM);
+    assert(category_used[category] >= size);
+    atomic_sub_and_fetch_z(&category_used[category], size);
+  }
+
   size_t mem_used;
   size_t mem_peak;
+
+  /* Per-category usage, indexed by the category passed to mem_alloc(). */
+  size_t category_used[MEM_CATEGORY_NUM];
+  size_t category_peak[MEM_CATEGORY_NUM];
 };
 
 CCL_NAMESPACE_END
@@ -0,0 +1,156 @@
+/* SPDX-FileCopyrightText: 2011-2023 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include <OpenImageIO/texture.h>
+
+#include "util/texture_cache.h"
+
+CCL_NAMESPACE_BEGIN
+
+OIIO_NAMESPACE_USING
+
+TextureCache::TextureCache(const int max_memory_mb)
+{
+  /* Not shared with the OSL texture system, so that the memory limit applies to this render. */
+  TextureSystem *ts = TextureSystem::create(false);
+
+  /* Generate tiles and mipmaps on the fly for images that don't have them, for the best
+   * performance images should be converted to tiled and mipmapped files with maketx. */
+  ts->attribute("automip", 1);
+  ts->attribute("autotile", 64);
+  ts->attribute("gray_to_rgb", 1);
+  ts->attribute("max_memory_MB", float(max_memory_mb));
+
+  texture_system = ts;
+}
+
+TextureCache::~TextureCache()
+{
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  ts->invalidate_all(true);
+  TextureSystem::destroy(ts);
+}
+
+void TextureCache::set_max_memory(const int max_memory_mb)
+{
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  ts->attribute("max_memory_MB", float(max_memory_mb));
+}
+
+bool TextureCache::get_image(const string &filepath, TextureCacheImage *image)
+{
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  TextureSystem::TextureHandle *handle = ts->get_texture_handle(ustring(filepath));
+
+  if (handle == NULL || !ts->good(handle)) {
+    /* Clear error so it doesn't leak into later lookups. */
+    ts->geterror();
+    return false;
+  }
+
+  image->texture_system = ts;
+  image->handle = handle;
+  return true;
+}
+
+void TextureCache::invalidate(const string &filepath)
+{
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  ts->invalidate(ustring(filepath));
+}
+
+size_t TextureCache::memory_used() const
+{
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  long long value = 0;
+  ts->getattribute("stat:cache_memory_used", TypeDesc::INT64, &value);
+  return (size_t)value;
+}
+
+size_t TextureCache::bytes_read() const
+{
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  long long value = 0;
+  ts->getattribute("stat:bytes_read", TypeDesc::INT64, &value);
+  return (size_t)value;
+}
+
+string TextureCache::full_report() const
+{
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  return ts->getstats(1);
+}
+
+void texture_cache_lookup(const TextureInfo &info,
+                          const float x,
+                          const float y,
+                          const float2 duv_dx,
+                          const float2 duv_dy,
+                          float result[4])
+{
+  const TextureCacheImage *image = (const TextureCacheImage *)info.data;
+  TextureSystem *ts = (TextureSystem *)image->texture_system;
+  TextureSystem::TextureHandle *handle = (TextureSystem::TextureHandle *)image->handle;
+
+  TextureOpt options;
+
+  switch (info.interpolation) {
+    case INTERPOLATION_CLOSEST:
+      options.interpmode = TextureOpt::InterpClosest;
+      options.mipmode = TextureOpt::MipModeOneLevel;
+      break;
+    case INTERPOLATION_CUBIC:
+      options.interpmode = TextureOpt::InterpBicubic;
+      break;
+    case INTERPOLATION_SMART:
+      options.interpmode = TextureOpt::InterpSmartBicubic;
+      break;
+    case INTERPOLATION_LINEAR:
+    default:
+      options.interpmode = TextureOpt::InterpBilinear;
+      break;
+  }
+
+  switch (info.extension) {
+    case EXTENSION_REPEAT:
+      options.swrap = options.twrap = TextureOpt::WrapPeriodic;
+      break;
+    case EXTENSION_EXTEND:
+      options.swrap = options.twrap = TextureOpt::WrapClamp;
+      break;
+    case EXTENSION_MIRROR:
+      options.swrap = options.twrap = TextureOpt::WrapMirror;
+      break;
+    case EXTENSION_CLIP:
+    default:
+      options.swrap = options.twrap = TextureOpt::WrapBlack;
+      break;
+  }
+
+  /* Alpha of images without alpha channel. */
+  options.fill = 1.0f;
+
+  /* Images are stored bottom to top in Cycles, while OpenImageIO uses top to bottom. */
+  const bool ok = ts->texture(handle,
+                              NULL,
+                              options,
+                              x,
+                              1.0f - y,
+                              duv_dx.x,
+                              -duv_dx.y,
+                              duv_dy.x,
+                              -duv_dy.y,
+                              4,
+                              result);
+
+  if (!ok) {
+    ts->geterror();
+    result[0] = TEX_IMAGE_MISSING_R;
+    result[1] = TEX_IMAGE_MISSING_G;
+    result[2] = TEX_IMAGE_MISSING_B;
+    result[3] = TEX_IMAGE_MISSING_A;
+  }
+}
+
+CCL_NAMESPACE_END
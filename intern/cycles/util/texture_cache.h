@@ -0,0 +1,64 @@
+/* SPDX-FileCopyrightText: 2011-2023 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#ifndef __UTIL_TEXTURE_CACHE_H__
+#define __UTIL_TEXTURE_CACHE_H__
+
+/* Texture Cache
+ *
+ * Images read on demand through the OpenImageIO texture system on the CPU. Instead of loading
+ * the full image into memory, tiles of the image and its mipmap levels are read from disk as the
+ * kernel accesses them, with the mipmap level chosen from the texture coordinate derivatives.
+ * Tiles that were not accessed recently are evicted once the cache exceeds its memory limit.
+ *
+ * This header is included by the kernel, so OpenImageIO types are kept out of it. */
+
+#include "util/string.h"
+#include "util/texture.h"
+#include "util/types.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Image in the texture cache. On the CPU the data of the TextureInfo of the image points to it. */
+struct TextureCacheImage {
+  void *texture_system;
+  void *handle;
+};
+
+class TextureCache {
+ public:
+  explicit TextureCache(const int max_memory_mb);
+  ~TextureCache();
+
+  void set_max_memory(const int max_memory_mb);
+
+  /* Open image file, returns false if it can not be read. */
+  bool get_image(const string &filepath, TextureCacheImage *image);
+
+  /* Drop cached tiles of the image, to read it again from disk. */
+  void invalidate(const string &filepath);
+
+  /* Memory used by tiles in the cache, and total bytes read from disk. */
+  size_t memory_used() const;
+  size_t bytes_read() const;
+
+  /* Human readable report of cache statistics. */
+  string full_report() const;
+
+ protected:
+  void *texture_system;
+};
+
+/* Filtered lookup of an image in the texture cache, at texture coordinates with the same
+ * conventions as regular image textures. */
+void texture_cache_lookup(const TextureInfo &info,
+                          const float x,
+                          const float y,
+                          const float2 duv_dx,
+                          const float2 duv_dy,
+                          float result[4]);
+
+CCL_NAMESPACE_END
+
+#endif /* __UTIL_TEXTURE_CACHE_H__ */
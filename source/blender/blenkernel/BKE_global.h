@@ -208,11 +208,14 @@ enum {
 
   G_DEBUG_GHOST = (1 << 23),  /* Debug GHOST module. */
   G_DEBUG_WINTAB = (1 << 24), /* Debug Wintab. */
+
+  G_DEBUG_COMPOSITOR = (1 << 25), /* Compositor timing and memory statistics. */
 };
 
 #define G_DEBUG_ALL \
   (G_DEBUG | G_DEBUG_FFMPEG | G_DEBUG_PYTHON | G_DEBUG_EVENTS | G_DEBUG_WM | G_DEBUG_JOBS | \
-   G_DEBUG_FREESTYLE | G_DEBUG_DEPSGRAPH | G_DEBUG_IO | G_DEBUG_GHOST | G_DEBUG_WINTAB)
+   G_DEBUG_FREESTYLE | G_DEBUG_DEPSGRAPH | G_DEBUG_IO | G_DEBUG_GHOST | G_DEBUG_WINTAB | \
+   G_DEBUG_COMPOSITOR)
 
 /** #Global.fileflags */
 enum {
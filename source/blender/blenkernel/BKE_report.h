@@ -39,6 +39,12 @@ void BKE_reportf(ReportList *reports, eReportType type, const char *format, ...)
 
 void BKE_reports_prepend(ReportList *reports, const char *prepend);
 void BKE_reports_prependf(ReportList *reports, const char *prepend, ...) ATTR_PRINTF_FORMAT(2, 3);
+/**
+ * Add the reports of \a reports_src to \a reports_dst (printing them if \a reports_dst prints
+ * reports), leaving \a reports_src empty. Used to gather the reports of work done on other
+ * threads in a deterministic order.
+ */
+void BKE_reports_move_to_reports(ReportList *reports_dst, ReportList *reports_src);
 
 eReportType BKE_report_print_level(ReportList *reports);
 void BKE_report_print_level_set(ReportList *reports, eReportType level);
@@ -25,13 +25,16 @@
 #include "DNA_screen_types.h"
 #include "DNA_space_types.h"
 
+#include "BLI_array.hh"
 #include "BLI_bitmap.h"
 #include "BLI_blenlib.h"
 #include "BLI_ghash.h"
 #include "BLI_linklist.h"
 #include "BLI_math.h"
 #include "BLI_memarena.h"
+#include "BLI_task.hh"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BLT_translation.h"
 
@@ -196,6 +199,53 @@ static BlendHandle *link_append_context_library_blohandle_ensure(
   return blo_handle;
 }
 
+/**
+ * Open the blend file handles of all libraries at once using multiple threads, since opening
+ * a file (decompression, reading its header, DNA and block headers) is independent from any
+ * other data. Reports are moved to `reports` in the order of the libraries.
+ */
+static void link_append_context_libraries_blohandle_ensure_parallel(
+    BlendfileLinkAppendContext *lapp_context, ReportList *reports)
+{
+  using namespace blender;
+
+  Vector<BlendfileLinkAppendContextLibrary *> lib_contexts;
+  for (LinkNode *liblink = lapp_context->libraries.list; liblink; liblink = liblink->next) {
+    BlendfileLinkAppendContextLibrary *lib_context =
+        static_cast<BlendfileLinkAppendContextLibrary *>(liblink->link);
+    if (lib_context->blo_handle == nullptr &&
+        !STREQ(lib_context->path, BLO_EMBEDDED_STARTUP_BLEND)) {
+      lib_contexts.append(lib_context);
+    }
+  }
+  /* Not worth the threading overhead. */
+  if (lib_contexts.size() < 2) {
+    return;
+  }
+
+  /* Report lists are not thread-safe, each library gets its own. */
+  Array<ReportList> lib_reports(lib_contexts.size());
+  for (ReportList &lib_report : lib_reports) {
+    BKE_reports_init(&lib_report, RPT_STORE | RPT_PRINT_HANDLED_BY_OWNER);
+    BKE_report_store_level_set(&lib_report, RPT_DEBUG);
+  }
+
+  threading::parallel_for(lib_contexts.index_range(), 1, [&](const IndexRange range) {
+    for (const int i : range) {
+      BlendfileLinkAppendContextLibrary *lib_context = lib_contexts[i];
+      lib_context->bf_reports.reports = &lib_reports[i];
+      lib_context->blo_handle = BLO_blendhandle_from_file(lib_context->path,
+                                                          &lib_context->bf_reports);
+      lib_context->blo_handle_is_owned = true;
+    }
+  });
+
+  for (const int i : lib_contexts.index_range()) {
+    lib_contexts[i]->bf_reports.reports = reports;
+    BKE_reports_move_to_reports(reports, &lib_reports[i]);
+  }
+}
+
 static void link_append_context_library_blohandle_release(
     BlendfileLinkAppendContext * /*lapp_context*/, BlendfileLinkAppendContextLibrary *lib_context)
 {
@@ -1388,6 +1438,8 @@ void BKE_blendfile_link(BlendfileLinkAppendContext *lapp_context, ReportList *re
   LinkNode *liblink, *itemlink;
   int lib_idx, item_idx;
 
+  link_append_context_libraries_blohandle_ensure_parallel(lapp_context, reports);
+
   for (lib_idx = 0, liblink = lapp_context->libraries.list; liblink;
        lib_idx++, liblink = liblink->next)
   {
@@ -2192,12 +2192,16 @@ static bool customdata_typemap_is_valid(const CustomData *data)
 static void *copy_layer_data(const eCustomDataType type, const void *data, const int totelem)
 {
   const LayerTypeInfo &type_info = *layerType_getInfo(type);
+  void *new_data = MEM_malloc_arrayN(size_t(totelem), type_info.size, __func__);
   if (type_info.copy) {
-    void *new_data = MEM_malloc_arrayN(size_t(totelem), type_info.size, __func__);
     type_info.copy(data, new_data, totelem);
-    return new_data;
   }
-  return MEM_dupallocN(data);
+  else {
+    /* Not #MEM_dupallocN, the data isn't always allocated with the guarded allocator (see
+     * #CustomData_blend_read). */
+    memcpy(new_data, data, size_t(totelem) * type_info.size);
+  }
+  return new_data;
 }
 
 static void free_layer_data(const eCustomDataType type, const void *data, const int totelem)
@@ -4530,7 +4534,8 @@ bool CustomData_layer_validate(CustomDataLayer *layer, const uint totitems, cons
   }
 
   BLI_assert((totitems == 0) || layer->data);
-  BLI_assert(MEM_allocN_len(layer->data) >= totitems * typeInfo->size);
+  BLI_assert(!dynamic_cast<const CustomDataLayerImplicitSharing *>(layer->sharing_info) ||
+             MEM_allocN_len(layer->data) >= totitems * typeInfo->size);
 
   if (typeInfo->validate != nullptr) {
     return typeInfo->validate(layer->data, totitems, do_fixes);
@@ -5245,6 +5250,25 @@ static void blend_read_paint_mask(BlendDataReader *reader,
   }
 }
 
+/**
+ * Whether layers of this type are plain arrays that are used as stored in the file, so they can
+ * be shared with the file's memory (see #BLO_read_shared_data).
+ */
+static bool layer_type_supports_shared_read(const eCustomDataType type)
+{
+  return ELEM(type,
+              CD_PROP_FLOAT,
+              CD_PROP_FLOAT2,
+              CD_PROP_FLOAT3,
+              CD_PROP_INT8,
+              CD_PROP_INT32,
+              CD_PROP_INT32_2D,
+              CD_PROP_BOOL,
+              CD_PROP_COLOR,
+              CD_PROP_BYTE_COLOR,
+              CD_PROP_QUATERNION);
+}
+
 void CustomData_blend_read(BlendDataReader *reader, CustomData *data, const int count)
 {
   BLO_read_data_address(reader, &data->layers);
@@ -5268,8 +5292,14 @@ void CustomData_blend_read(BlendDataReader *reader, CustomData *data, const int
     layer->sharing_info = nullptr;
 
     if (CustomData_verify_versions(data, i)) {
-      BLO_read_data_address(reader, &layer->data);
-      if (layer->data != nullptr) {
+      if (layer_type_supports_shared_read(eCustomDataType(layer->type))) {
+        /* Large arrays may be used directly from the memory-mapped file, without a copy. */
+        layer->data = BLO_read_shared_data(reader, layer->data, &layer->sharing_info);
+      }
+      else {
+        BLO_read_data_address(reader, &layer->data);
+      }
+      if (layer->data != nullptr && layer->sharing_info == nullptr) {
         /* Make layer data shareable. */
         layer->sharing_info = make_implicit_sharing_info_for_layer(
             eCustomDataType(layer->type), layer->data, count);
@@ -29,6 +29,7 @@
 
 #include "BLI_fileops.h"
 #include "BLI_ghash.h"
+#include "BLI_implicit_sharing.hh"
 #include "BLI_linklist_lockfree.h"
 #include "BLI_string.h"
 #include "BLI_threads.h"
@@ -266,6 +267,19 @@ PreviewImage *BKE_previewimg_create()
   return previewimg_create_ex(0);
 }
 
+static void previewimg_rect_free(PreviewImage *prv, const int size)
+{
+  if (prv->rect_sharing_info[size]) {
+    /* The pixels are used in place from the file they were read from. */
+    prv->rect_sharing_info[size]->remove_user_and_delete_if_last();
+    prv->rect_sharing_info[size] = nullptr;
+    prv->rect[size] = nullptr;
+  }
+  else {
+    MEM_SAFE_FREE(prv->rect[size]);
+  }
+}
+
 void BKE_previewimg_freefunc(void *link)
 {
   PreviewImage *prv = (PreviewImage *)link;
@@ -274,9 +288,7 @@ void BKE_previewimg_freefunc(void *link)
   }
 
   for (int i = 0; i < NUM_ICON_SIZES; i++) {
-    if (prv->rect[i]) {
-      MEM_freeN(prv->rect[i]);
-    }
+    previewimg_rect_free(prv, i);
     if (prv->gputexture[i]) {
       GPU_texture_free(prv->gputexture[i]);
     }
@@ -295,7 +307,7 @@ void BKE_previewimg_free(PreviewImage **prv)
 
 void BKE_previewimg_clear_single(PreviewImage *prv, enum eIconSizes size)
 {
-  MEM_SAFE_FREE(prv->rect[size]);
+  previewimg_rect_free(prv, size);
   if (prv->gputexture[size]) {
     GPU_texture_free(prv->gputexture[size]);
   }
@@ -322,8 +334,13 @@ PreviewImage *BKE_previewimg_copy(const PreviewImage *prv)
 
   for (int i = 0; i < NUM_ICON_SIZES; i++) {
     if (prv->rect[i]) {
-      prv_img->rect[i] = (uint *)MEM_dupallocN(prv->rect[i]);
+      /* Not #MEM_dupallocN, the pixels aren't always a guarded allocation (see
+       * #BKE_previewimg_blend_read). */
+      const size_t rect_size = sizeof(uint) * prv->w[i] * prv->h[i];
+      prv_img->rect[i] = (uint *)MEM_mallocN(rect_size, "prv_rect");
+      memcpy(prv_img->rect[i], prv->rect[i], rect_size);
     }
+    prv_img->rect_sharing_info[i] = nullptr;
     prv_img->gputexture[i] = nullptr;
   }
 
@@ -633,8 +650,12 @@ void BKE_previewimg_blend_read(BlendDataReader *reader, PreviewImage *prv)
   }
 
   for (int i = 0; i < NUM_ICON_SIZES; i++) {
+    prv->rect_sharing_info[i] = nullptr;
     if (prv->rect[i]) {
-      BLO_read_data_address(reader, &prv->rect[i]);
+      /* Large previews may be used directly from the memory-mapped file without a copy, so their
+       * pixels are only loaded by the system once they are displayed. */
+      prv->rect[i] = static_cast<uint *>(
+          BLO_read_shared_data(reader, prv->rect[i], &prv->rect_sharing_info[i]));
     }
     prv->gputexture[i] = nullptr;
 
@@ -3898,6 +3898,27 @@ static void image_create_multilayer(Image *ima, ImBuf *ibuf, int framenr)
   /* set proper views */
   image_init_multilayer_multiview(ima, ima->rr);
 }
+
+/* Open a file already known to be multilayer without decoding pixels, passes are read on first
+ * access through #RE_RenderPassEnsureLoaded. Returns false when it is not a multilayer file. */
+static bool image_open_multilayer(Image *ima, const char *filepath, int framenr)
+{
+  /* only load rr once for multiview */
+  if (!ima->rr) {
+    const char *colorspace = ima->colorspace_settings.name;
+    bool predivide = (ima->alpha_mode == IMA_ALPHA_PREMUL);
+    ima->rr = RE_MultilayerOpen(filepath, colorspace, predivide);
+    if (ima->rr == nullptr) {
+      return false;
+    }
+  }
+
+  ima->rr->framenr = framenr;
+
+  /* set proper views */
+  image_init_multilayer_multiview(ima, ima->rr);
+  return true;
+}
 #endif /* WITH_OPENEXR */
 
 /** Common stuff to do with images after loading. */
@@ -3981,7 +4002,7 @@ static ImBuf *image_load_sequence_multilayer(Image *ima, ImageUser *iuser, int e
   if (ima->rr) {
     RenderPass *rpass = BKE_image_multilayer_index(ima->rr, iuser);
 
-    if (rpass && rpass->ibuf) {
+    if (rpass && RE_RenderPassEnsureLoaded(rpass)) {
       ibuf = rpass->ibuf;
       IMB_refImBuf(ibuf);
 
@@ -4154,6 +4175,14 @@ static ImBuf *load_image_single(Image *ima,
 
     BKE_image_user_file_path(&iuser_t, ima, filepath);
 
+#ifdef WITH_OPENEXR
+    /* Passes of known multilayer files are read on demand, as often only a few are used. */
+    if (ima->type == IMA_TYPE_MULTILAYER && image_open_multilayer(ima, filepath, cfra)) {
+      *r_cache_ibuf = false;
+      return nullptr;
+    }
+#endif
+
     /* read ibuf */
     flag |= IB_metadata;
     flag |= imbuf_alpha_flags_for_image(ima);
@@ -4286,7 +4315,7 @@ static ImBuf *image_get_ibuf_multilayer(Image *ima, ImageUser *iuser)
   if (ima->rr) {
     RenderPass *rpass = BKE_image_multilayer_index(ima->rr, iuser);
 
-    if (rpass && rpass->ibuf) {
+    if (rpass && RE_RenderPassEnsureLoaded(rpass)) {
       ibuf = rpass->ibuf;
       IMB_refImBuf(ibuf);
 
@@ -389,6 +389,8 @@ static bool image_save_single(ReportList *reports,
 
   /* we need renderresult for exr and rendered multiview */
   rr = BKE_image_acquire_renderresult(opts->scene, ima);
+  /* Multilayer images read their passes on demand, saving needs all of them. */
+  RE_RenderResultEnsurePassesLoaded(rr);
   const bool is_mono = rr ? BLI_listbase_count_at_most(&rr->views, 2) < 2 :
                             BLI_listbase_count_at_most(&ima->views, 2) < 2;
   const bool is_exr_rr = rr && ELEM(imf->imtype, R_IMF_IMTYPE_OPENEXR, R_IMF_IMTYPE_MULTILAYER) &&
@@ -712,6 +714,10 @@ bool BKE_image_render_write_exr(ReportList *reports,
                                 const char *view,
                                 int layer)
 {
+  /* Pass buffers are accessed directly below, read the passes of lazily opened multilayer files
+   * first. This doesn't change the contents of the render result. */
+  RE_RenderResultEnsurePassesLoaded(const_cast<RenderResult *>(rr));
+
   void *exrhandle = IMB_exr_get_handle();
   const bool half_float = (imf && imf->depth == R_IMF_CHAN_DEPTH_16);
   const bool multi_layer = !(imf && imf->imtype == R_IMF_IMTYPE_OPENEXR);
@@ -337,9 +337,19 @@ static void mesh_blend_read_data(BlendDataReader *reader, ID *id)
   mesh->runtime = new blender::bke::MeshRuntime();
 
   if (mesh->poly_offset_indices) {
-    BLO_read_int32_array(reader, mesh->totpoly + 1, &mesh->poly_offset_indices);
-    mesh->runtime->poly_offsets_sharing_info = blender::implicit_sharing::info_for_mem_free(
-        mesh->poly_offset_indices);
+    const blender::ImplicitSharingInfo *sharing_info = nullptr;
+    if (BLO_read_requires_endian_switch(reader)) {
+      BLO_read_int32_array(reader, mesh->totpoly + 1, &mesh->poly_offset_indices);
+    }
+    else {
+      /* Large arrays may be used directly from the memory-mapped file, without a copy. */
+      mesh->poly_offset_indices = static_cast<int *>(
+          BLO_read_shared_data(reader, mesh->poly_offset_indices, &sharing_info));
+    }
+    if (sharing_info == nullptr && mesh->poly_offset_indices) {
+      sharing_info = blender::implicit_sharing::info_for_mem_free(mesh->poly_offset_indices);
+    }
+    mesh->runtime->poly_offsets_sharing_info = sharing_info;
   }
 
   if (mesh->mselect == nullptr) {
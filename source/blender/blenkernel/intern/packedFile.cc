@@ -6,6 +6,7 @@
  * \ingroup bke
  */
 
+#include <algorithm>
 #include <fcntl.h>
 #include <stdio.h>
 #include <sys/stat.h>
@@ -26,6 +27,7 @@
 #include "DNA_volume_types.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_implicit_sharing.hh"
 #include "BLI_utildefines.h"
 
 #include "BKE_image.h"
@@ -149,7 +151,14 @@ void BKE_packedfile_free(PackedFile *pf)
   if (pf) {
     BLI_assert(pf->data != nullptr);
 
-    MEM_SAFE_FREE(pf->data);
+    if (pf->sharing_info) {
+      /* The data is used in place from the file it was read from. */
+      pf->sharing_info->remove_user_and_delete_if_last();
+      pf->data = nullptr;
+    }
+    else {
+      MEM_SAFE_FREE(pf->data);
+    }
     MEM_freeN(pf);
   }
   else {
@@ -165,7 +174,11 @@ PackedFile *BKE_packedfile_duplicate(const PackedFile *pf_src)
   PackedFile *pf_dst;
 
   pf_dst = static_cast<PackedFile *>(MEM_dupallocN(pf_src));
-  pf_dst->data = MEM_dupallocN(pf_src->data);
+  /* Not #MEM_dupallocN, the data isn't always a guarded allocation (see
+   * #BKE_packedfile_blend_read). */
+  pf_dst->data = MEM_mallocN(std::max(size_t(pf_src->size), size_t(1)), "packFile");
+  memcpy(pf_dst->data, pf_src->data, size_t(pf_src->size));
+  pf_dst->sharing_info = nullptr;
 
   return pf_dst;
 }
@@ -896,7 +909,20 @@ void BKE_packedfile_blend_read(BlendDataReader *reader, PackedFile **pf_p)
     return;
   }
 
-  BLO_read_packed_address(reader, &pf->data);
+  if (BLO_read_data_is_undo(reader)) {
+    /* Undo keeps using the packed files of the current data, with their data and its sharing info
+     * (see #blo_make_packed_pointer_map). Packed files that don't exist anymore are read again. */
+    const void *data_old = pf->data;
+    BLO_read_packed_address(reader, &pf->data);
+    if (pf->data != data_old) {
+      pf->sharing_info = nullptr;
+    }
+  }
+  else {
+    /* Large files may be used directly from the memory-mapped file without a copy, so their data
+     * is only loaded by the system when accessed. */
+    pf->data = BLO_read_shared_data(reader, pf->data, &pf->sharing_info);
+  }
   if (pf->data == nullptr) {
     /* We cannot allow a PackedFile with a nullptr data field,
      * the whole code assumes this is not possible. See #70315. */
@@ -179,6 +179,31 @@ void BKE_reports_prependf(ReportList *reports, const char *prepend_format, ...)
   MEM_freeN(prepend);
 }
 
+void BKE_reports_move_to_reports(ReportList *reports_dst, ReportList *reports_src)
+{
+  if (!reports_src) {
+    return;
+  }
+
+  LISTBASE_FOREACH_MUTABLE (Report *, report, &reports_src->list) {
+    const eReportType type = eReportType(report->type);
+    BLI_remlink(&reports_src->list, report);
+
+    if (BKE_reports_print_test(reports_dst, type)) {
+      printf("%s: %s\n", report->typestr, report->message);
+      fflush(stdout);
+    }
+
+    if (reports_dst && (reports_dst->flag & RPT_STORE) && (type >= reports_dst->storelevel)) {
+      BLI_addtail(&reports_dst->list, report);
+    }
+    else {
+      MEM_freeN((void *)report->message);
+      MEM_freeN(report);
+    }
+  }
+}
+
 eReportType BKE_report_print_level(ReportList *reports)
 {
   if (!reports) {
@@ -29,6 +29,8 @@
 #include "BKE_main.h"
 #include "BKE_undo_system.h"
 
+#include "BLO_undofile.h"
+
 #include "RNA_access.h"
 
 #include "MEM_guardedalloc.h"
@@ -983,6 +985,13 @@ void BKE_undosys_print(UndoStack *ustack)
            us->name);
     index++;
   }
+
+  /* Memfile chunks are shared by content between steps. */
+  size_t memfile_unique_size, memfile_logical_size;
+  BLO_memfile_chunk_store_stats(&memfile_unique_size, &memfile_logical_size);
+  printf("Memfile undo memory: %zu unique bytes, %zu logical bytes\n",
+         memfile_unique_size,
+         memfile_logical_size);
 }
 
 /** \} */
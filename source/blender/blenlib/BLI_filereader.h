@@ -27,17 +27,28 @@ typedef int64_t off64_t;
 extern "C" {
 #endif
 
+struct BLI_mmap_file;
 struct FileReader;
 
 typedef ssize_t (*FileReaderReadFn)(struct FileReader *reader, void *buffer, size_t size);
 typedef off64_t (*FileReaderSeekFn)(struct FileReader *reader, off64_t offset, int whence);
 typedef void (*FileReaderCloseFn)(struct FileReader *reader);
+typedef ssize_t (*FileReaderReadAtFn)(struct FileReader *reader,
+                                      void *buffer,
+                                      size_t size,
+                                      off64_t offset);
 
 /** General structure for all #FileReaders, implementations add custom fields at the end. */
 typedef struct FileReader {
   FileReaderReadFn read;
   FileReaderSeekFn seek;
   FileReaderCloseFn close;
+  /**
+   * Optional, read from an absolute offset without changing the current #offset.
+   * Unlike the other functions, this may be called from multiple threads at the same time.
+   * NULL when the reader does not support random access.
+   */
+  FileReaderReadAtFn read_at;
 
   off64_t offset;
 } FileReader;
@@ -54,11 +65,42 @@ typedef struct FileReader {
 FileReader *BLI_filereader_new_file(int filedes) ATTR_WARN_UNUSED_RESULT;
 /** Create #FileReader from raw file descriptor using memory-mapped IO. */
 FileReader *BLI_filereader_new_mmap(int filedes) ATTR_WARN_UNUSED_RESULT;
+/**
+ * The mapping of a reader created by #BLI_filereader_new_mmap, NULL for other readers.
+ * Use #BLI_mmap_add_user to access its memory after the reader is closed.
+ */
+struct BLI_mmap_file *BLI_filereader_mmap_file(FileReader *reader) ATTR_WARN_UNUSED_RESULT
+    ATTR_NONNULL(1);
 /** Create #FileReader from a region of memory. */
 FileReader *BLI_filereader_new_memory(const void *data, size_t len) ATTR_WARN_UNUSED_RESULT
     ATTR_NONNULL();
 /** Create #FileReader from applying `Zstd` decompression on an underlying file. */
 FileReader *BLI_filereader_new_zstd(FileReader *base) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
+/**
+ * Read the payload of a `Zstd` skippable frame with the given \a magic number, which is listed
+ * after the content frames in the seek table of the file.
+ *
+ * \return The payload (free with #MEM_freeN) or NULL when \a reader isn't a seekable `Zstd`
+ * reader or there is no such frame.
+ */
+void *BLI_filereader_zstd_read_skippable_frame(FileReader *reader,
+                                               uint32_t magic,
+                                               size_t *r_size) ATTR_WARN_UNUSED_RESULT
+    ATTR_NONNULL();
+/**
+ * Decompress all frames of a seekable `Zstd` reader on multiple threads. Until
+ * #BLI_filereader_zstd_free_content, reads are served from memory and #FileReader.read_at calls
+ * don't have to wait for each other. Must not be called while other threads read.
+ *
+ * \return False when \a reader isn't a seekable `Zstd` reader or decompression failed, reads
+ * then keep decompressing one frame at a time.
+ */
+bool BLI_filereader_zstd_decompress_all(FileReader *reader) ATTR_NONNULL();
+/**
+ * Free the content decompressed by #BLI_filereader_zstd_decompress_all, does nothing for other
+ * readers. Must not be called while other threads read.
+ */
+void BLI_filereader_zstd_free_content(FileReader *reader) ATTR_NONNULL();
 /** Create #FileReader from applying `Gzip` decompression on an underlying file. */
 FileReader *BLI_filereader_new_gzip(FileReader *base) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
 
@@ -23,7 +23,9 @@ typedef struct BLI_mmap_file BLI_mmap_file;
 
 /* Prepares an opened file for memory-mapped IO.
  * May return NULL if the operation fails.
- * Note that this seeks to the end of the file to determine its length. */
+ * Note that this seeks to the end of the file to determine its length.
+ * On POSIX systems the mapping is private and writable: writes only change this process's copy
+ * of the affected pages, never the file. */
 BLI_mmap_file *BLI_mmap_open(int fd) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
 
 /* Reads length bytes from file at the given offset into dest.
@@ -32,8 +34,23 @@ BLI_mmap_file *BLI_mmap_open(int fd) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
 bool BLI_mmap_read(BLI_mmap_file *file, void *dest, size_t offset, size_t length)
     ATTR_WARN_UNUSED_RESULT ATTR_NONNULL(1);
 
+/* Whether an IO error occurred on any access to the mapped memory. */
+bool BLI_mmap_has_io_error(const BLI_mmap_file *file) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL(1);
+
+/* Whether the file is not expected to change while mapped: it is on a local file system, and
+ * either on a read-only mount or without write permissions. Writes to other files show up in the
+ * pages of the mapping that were not copied yet, and truncating them replaces the whole mapping
+ * with zeroes, so only memory of read-only files should be used beyond reading the file. */
+bool BLI_mmap_is_read_only(const BLI_mmap_file *file) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL(1);
+
 void *BLI_mmap_get_pointer(BLI_mmap_file *file) ATTR_WARN_UNUSED_RESULT;
+size_t BLI_mmap_get_length(const BLI_mmap_file *file) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL(1);
+
+/* Keeps the mapping alive until #BLI_mmap_free is called once more, for memory that points into
+ * the mapping and outlives the code that opened it. Thread-safe. */
+void BLI_mmap_add_user(BLI_mmap_file *file) ATTR_NONNULL(1);
 
+/* Removes a user, the mapping is released when it was the last one. Thread-safe. */
 void BLI_mmap_free(BLI_mmap_file *file) ATTR_NONNULL(1);
 
 #ifdef __cplusplus
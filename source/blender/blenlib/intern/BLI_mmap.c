@@ -9,16 +9,32 @@
 #include "BLI_mmap.h"
 #include "BLI_fileops.h"
 #include "BLI_listbase.h"
+#include "BLI_threads.h"
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include <string.h>
 
 #ifndef WIN32
 #  include <signal.h>
 #  include <stdlib.h>
-#  include <sys/mman.h> /* For mmap. */
-#  include <unistd.h>   /* For read close. */
-#else
+#  include <sys/mman.h>    /* For mmap. */
+#  include <sys/stat.h>    /* For fstat. */
+#  include <sys/statvfs.h> /* For fstatvfs. */
+#  include <unistd.h>      /* For read close. */
+#endif
+
+#if defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__) || \
+    defined(__DragonFly__)
+/* For fstatfs. */
+#  include <sys/mount.h>
+#  include <sys/param.h>
+#elif defined(__linux__)
+#  include <sys/vfs.h>
+#endif
+
+#ifdef WIN32
 #  include "BLI_winstuff.h"
 #  include <io.h> /* For open close read. */
 #endif
@@ -33,6 +49,12 @@ struct BLI_mmap_file {
   /* Platform-specific handle for the mapping. */
   void *handle;
 
+  /* Number of users, the mapping is released when the last one calls #BLI_mmap_free. */
+  int32_t users;
+
+  /* The file is not expected to change while mapped, see #BLI_mmap_is_read_only. */
+  bool is_read_only;
+
   /* Flag to indicate IO errors. Needs to be volatile since it's being set from
    * within the signal handler, which is not part of the normal execution flow. */
   volatile bool io_error;
@@ -58,6 +80,10 @@ static struct error_handler_data {
   void (*next_handler)(int, siginfo_t *, void *);
 } error_handler = {0};
 
+/* Files can be freed from any thread once their memory is shared with other data,
+ * see #BLI_mmap_add_user. */
+static ThreadMutex open_mmaps_mutex = BLI_MUTEX_INITIALIZER;
+
 static void sigbus_handler(int sig, siginfo_t *siginfo, void *ptr)
 {
   /* We only handle SIGBUS here for now. */
@@ -73,8 +99,12 @@ static void sigbus_handler(int sig, siginfo_t *siginfo, void *ptr)
       file->io_error = true;
 
       /* Replace the mapped memory with zeroes. */
-      const void *mapped_memory = mmap(
-          file->memory, file->length, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+      const void *mapped_memory = mmap(file->memory,
+                                       file->length,
+                                       PROT_READ | PROT_WRITE,
+                                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED,
+                                       -1,
+                                       0);
       if (mapped_memory == MAP_FAILED) {
         fprintf(stderr, "SIGBUS handler: Error replacing mapped file with zeros\n");
       }
@@ -93,9 +123,12 @@ static void sigbus_handler(int sig, siginfo_t *siginfo, void *ptr)
   }
 }
 
-/* Ensures that the error handler is set up and ready. */
+/* Ensures that the error handler is set up and ready. Files can be opened from multiple
+ * threads, so the handler is installed with the mutex locked. */
 static bool sigbus_handler_setup(void)
 {
+  bool success = true;
+  BLI_mutex_lock(&open_mmaps_mutex);
   if (!error_handler.configured) {
     struct sigaction newact = {0}, oldact = {0};
 
@@ -103,31 +136,98 @@ static bool sigbus_handler_setup(void)
     newact.sa_flags = SA_SIGINFO;
 
     if (sigaction(SIGBUS, &newact, &oldact)) {
-      return false;
+      success = false;
+    }
+    else {
+      /* Remember the previously configured handler to fall back to it if the error
+       * does not belong to any of the mapped files. */
+      error_handler.next_handler = oldact.sa_sigaction;
+      error_handler.configured = 1;
     }
-
-    /* Remember the previously configured handler to fall back to it if the error
-     * does not belong to any of the mapped files. */
-    error_handler.next_handler = oldact.sa_sigaction;
-    error_handler.configured = 1;
   }
+  BLI_mutex_unlock(&open_mmaps_mutex);
 
-  return true;
+  return success;
 }
 
 /* Adds a file to the list that the error handler checks. */
 static void sigbus_handler_add(BLI_mmap_file *file)
 {
+  BLI_mutex_lock(&open_mmaps_mutex);
   BLI_addtail(&error_handler.open_mmaps, BLI_genericNodeN(file));
+  BLI_mutex_unlock(&open_mmaps_mutex);
 }
 
 /* Removes a file from the list that the error handler checks. */
 static void sigbus_handler_remove(BLI_mmap_file *file)
 {
+  BLI_mutex_lock(&open_mmaps_mutex);
   LinkData *link = BLI_findptr(&error_handler.open_mmaps, file, offsetof(LinkData, data));
   BLI_freelinkN(&error_handler.open_mmaps, link);
+  BLI_mutex_unlock(&open_mmaps_mutex);
+}
+#endif
+
+/* File systems which can be changed by other machines while mapped, and where IO errors are more
+ * likely. Only checked on platforms where it is cheap, others are assumed to be non-local. */
+static bool mmap_fd_is_local(int fd)
+{
+#if defined(__linux__)
+  struct statfs disk;
+  if (fstatfs(fd, &disk)) {
+    return false;
+  }
+  switch ((unsigned long)disk.f_type) {
+    case 0x6969UL:     /* NFS. */
+    case 0x517BUL:     /* SMB. */
+    case 0xFE534D42UL: /* SMB2. */
+    case 0xFF534D42UL: /* CIFS. */
+    case 0x65735546UL: /* FUSE (SSHFS and most other network file systems). */
+    case 0x01021997UL: /* V9FS. */
+    case 0x00C36400UL: /* CEPH. */
+    case 0x5346414FUL: /* AFS. */
+    case 0x6B414653UL: /* KAFS. */
+    case 0x73757245UL: /* CODA. */
+    case 0x47504653UL: /* GPFS. */
+    case 0x0BD00BD0UL: /* LUSTRE. */
+      return false;
+    default:
+      return true;
+  }
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || \
+    defined(__NetBSD__) || defined(__DragonFly__)
+  struct statfs disk;
+  if (fstatfs(fd, &disk)) {
+    return false;
+  }
+  return (disk.f_flags & MNT_LOCAL) != 0;
+#else
+  UNUSED_VARS(fd);
+  return false;
+#endif
 }
+
+/* Whether nothing is expected to write to or truncate the file while it is mapped: it has to be on
+ * a local file system, and either on a read-only mount or without any write permissions. */
+static bool mmap_fd_is_read_only(int fd)
+{
+  if (!mmap_fd_is_local(fd)) {
+    return false;
+  }
+#ifndef WIN32
+  struct statvfs disk;
+  if (fstatvfs(fd, &disk) == 0 && (disk.f_flag & ST_RDONLY)) {
+    return true;
+  }
+  struct stat st;
+  if (fstat(fd, &st)) {
+    return false;
+  }
+  return (st.st_mode & (S_IWUSR | S_IWGRP | S_IWOTH)) == 0;
+#else
+  return false;
 #endif
+}
 
 BLI_mmap_file *BLI_mmap_open(int fd)
 {
@@ -140,8 +240,9 @@ BLI_mmap_file *BLI_mmap_open(int fd)
     return NULL;
   }
 
-  /* Map the given file to memory. */
-  memory = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  /* Map the given file to memory. The mapping is private and writable, so that writing to the
+   * memory makes a copy of the affected pages instead of failing (the file is never modified). */
+  memory = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
   if (memory == MAP_FAILED) {
     return NULL;
   }
@@ -167,6 +268,8 @@ BLI_mmap_file *BLI_mmap_open(int fd)
   file->memory = memory;
   file->handle = handle;
   file->length = length;
+  file->users = 1;
+  file->is_read_only = mmap_fd_is_read_only(fd);
 
 #ifndef WIN32
   /* Register the file with the error handler. */
@@ -205,13 +308,37 @@ bool BLI_mmap_read(BLI_mmap_file *file, void *dest, size_t offset, size_t length
   return !file->io_error;
 }
 
+bool BLI_mmap_has_io_error(const BLI_mmap_file *file)
+{
+  return file->io_error;
+}
+
+bool BLI_mmap_is_read_only(const BLI_mmap_file *file)
+{
+  return file->is_read_only;
+}
+
 void *BLI_mmap_get_pointer(BLI_mmap_file *file)
 {
   return file->memory;
 }
 
+size_t BLI_mmap_get_length(const BLI_mmap_file *file)
+{
+  return file->length;
+}
+
+void BLI_mmap_add_user(BLI_mmap_file *file)
+{
+  atomic_add_and_fetch_int32(&file->users, 1);
+}
+
 void BLI_mmap_free(BLI_mmap_file *file)
 {
+  if (atomic_sub_and_fetch_int32(&file->users, 1) != 0) {
+    return;
+  }
+
 #ifndef WIN32
   munmap((void *)file->memory, file->length);
   sigbus_handler_remove(file);
@@ -36,6 +36,20 @@ static ssize_t memory_read_raw(FileReader *reader, void *buffer, size_t size)
   return readsize;
 }
 
+static ssize_t memory_read_at_raw(FileReader *reader, void *buffer, size_t size, off64_t offset)
+{
+  MemoryReader *mem = (MemoryReader *)reader;
+
+  if (offset < 0 || offset > mem->length) {
+    return 0;
+  }
+  size_t readsize = MIN2(size, (size_t)(mem->length - offset));
+
+  memcpy(buffer, mem->data + offset, readsize);
+
+  return readsize;
+}
+
 static off64_t memory_seek(FileReader *reader, off64_t offset, int whence)
 {
   MemoryReader *mem = (MemoryReader *)reader;
@@ -77,6 +91,7 @@ FileReader *BLI_filereader_new_memory(const void *data, size_t len)
   mem->reader.read = memory_read_raw;
   mem->reader.seek = memory_seek;
   mem->reader.close = memory_close_raw;
+  mem->reader.read_at = memory_read_at_raw;
 
   return (FileReader *)mem;
 }
@@ -103,6 +118,22 @@ static ssize_t memory_read_mmap(FileReader *reader, void *buffer, size_t size)
   return readsize;
 }
 
+static ssize_t memory_read_at_mmap(FileReader *reader, void *buffer, size_t size, off64_t offset)
+{
+  MemoryReader *mem = (MemoryReader *)reader;
+
+  if (offset < 0 || offset > mem->length) {
+    return 0;
+  }
+  size_t readsize = MIN2(size, (size_t)(mem->length - offset));
+
+  if (!BLI_mmap_read(mem->mmap, buffer, offset, readsize)) {
+    return 0;
+  }
+
+  return readsize;
+}
+
 static void memory_close_mmap(FileReader *reader)
 {
   MemoryReader *mem = (MemoryReader *)reader;
@@ -125,6 +156,15 @@ FileReader *BLI_filereader_new_mmap(int filedes)
   mem->reader.read = memory_read_mmap;
   mem->reader.seek = memory_seek;
   mem->reader.close = memory_close_mmap;
+  mem->reader.read_at = memory_read_at_mmap;
 
   return (FileReader *)mem;
 }
+
+BLI_mmap_file *BLI_filereader_mmap_file(FileReader *reader)
+{
+  if (reader->close != memory_close_mmap) {
+    return NULL;
+  }
+  return ((MemoryReader *)reader)->mmap;
+}
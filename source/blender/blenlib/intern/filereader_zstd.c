@@ -13,6 +13,10 @@
 #include "BLI_endian_switch.h"
 #include "BLI_filereader.h"
 #include "BLI_math_base.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+#include "atomic_ops.h"
 
 #include "MEM_guardedalloc.h"
 
@@ -32,6 +36,12 @@ typedef struct {
 
     char *cached_content;
     int cached_frame;
+
+    /* Content of all frames, see #BLI_filereader_zstd_decompress_all. While it exists all reads
+     * are served from it. */
+    char *full_content;
+    /* Serializes #zstd_read_at calls which decompress frames into #cached_content. */
+    ThreadMutex read_at_mutex;
   } seek;
 } ZstdReader;
 
@@ -193,13 +203,79 @@ static const char *zstd_ensure_cache(ZstdReader *zstd, int frame)
   return uncompressed_data;
 }
 
-static ssize_t zstd_read_seekable(FileReader *reader, void *buffer, size_t size)
+typedef struct ZstdDecompressAllData {
+  ZstdReader *zstd;
+  const char *compressed_content;
+  /* Set when any frame fails to decompress. */
+  int32_t error;
+} ZstdDecompressAllData;
+
+static void zstd_decompress_frame_fn(void *__restrict userdata,
+                                     const int frame,
+                                     const TaskParallelTLS *__restrict tls)
 {
-  ZstdReader *zstd = (ZstdReader *)reader;
+  ZstdDecompressAllData *data = (ZstdDecompressAllData *)userdata;
+  ZstdReader *zstd = data->zstd;
+  ZSTD_DCtx **ctx = (ZSTD_DCtx **)tls->userdata_chunk;
+
+  if (*ctx == NULL) {
+    *ctx = ZSTD_createDCtx();
+  }
+
+  size_t compressed_size = zstd->seek.compressed_ofs[frame + 1] - zstd->seek.compressed_ofs[frame];
+  size_t uncompressed_size = zstd->seek.uncompressed_ofs[frame + 1] -
+                             zstd->seek.uncompressed_ofs[frame];
+
+  size_t res = ZSTD_decompressDCtx(*ctx,
+                                   zstd->seek.full_content + zstd->seek.uncompressed_ofs[frame],
+                                   uncompressed_size,
+                                   data->compressed_content + zstd->seek.compressed_ofs[frame],
+                                   compressed_size);
+  if (ZSTD_isError(res) || res < uncompressed_size) {
+    atomic_fetch_and_or_int32(&data->error, 1);
+  }
+}
+
+static void zstd_decompress_frame_free_fn(const void *__restrict UNUSED(userdata),
+                                          void *__restrict chunk)
+{
+  ZSTD_DCtx **ctx = (ZSTD_DCtx **)chunk;
+  if (*ctx) {
+    ZSTD_freeDCtx(*ctx);
+  }
+}
+
+static void zstd_decompress_all_isolated_fn(void *userdata)
+{
+  ZstdDecompressAllData *data = (ZstdDecompressAllData *)userdata;
+  ZSTD_DCtx *ctx = NULL;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.userdata_chunk = &ctx;
+  settings.userdata_chunk_size = sizeof(ctx);
+  settings.func_free = zstd_decompress_frame_free_fn;
+  BLI_task_parallel_range(
+      0, data->zstd->seek.frames_num, data, zstd_decompress_frame_fn, &settings);
+}
 
-  size_t end_offset = zstd->reader.offset + size, read_len = 0;
-  while (zstd->reader.offset < end_offset) {
-    int frame = zstd_frame_from_pos(zstd, zstd->reader.offset);
+/* Read from the given position in the uncompressed stream, decompressing the frames covering
+ * the range one at a time unless the whole content is already decompressed. */
+static size_t zstd_read_from(ZstdReader *zstd, void *buffer, size_t size, size_t offset)
+{
+  const size_t length = zstd->seek.uncompressed_ofs[zstd->seek.frames_num];
+  if (offset >= length) {
+    return 0;
+  }
+  size_t end_offset = offset + min_zz(size, length - offset), read_len = 0;
+
+  if (zstd->seek.full_content) {
+    memcpy(buffer, zstd->seek.full_content + offset, end_offset - offset);
+    return end_offset - offset;
+  }
+
+  while (offset < end_offset) {
+    int frame = zstd_frame_from_pos(zstd, offset);
     if (frame < 0) {
       /* EOF is reached, so return as much as we can. */
       break;
@@ -212,17 +288,45 @@ static ssize_t zstd_read_seekable(FileReader *reader, void *buffer, size_t size)
     }
 
     size_t frame_end_offset = min_zz(zstd->seek.uncompressed_ofs[frame + 1], end_offset);
-    size_t frame_read_len = frame_end_offset - zstd->reader.offset;
+    size_t frame_read_len = frame_end_offset - offset;
 
-    size_t offset_in_frame = zstd->reader.offset - zstd->seek.uncompressed_ofs[frame];
+    size_t offset_in_frame = offset - zstd->seek.uncompressed_ofs[frame];
     memcpy((char *)buffer + read_len, framedata + offset_in_frame, frame_read_len);
     read_len += frame_read_len;
-    zstd->reader.offset = frame_end_offset;
+    offset = frame_end_offset;
   }
 
   return read_len;
 }
 
+static ssize_t zstd_read_at(FileReader *reader, void *buffer, size_t size, off64_t offset)
+{
+  ZstdReader *zstd = (ZstdReader *)reader;
+
+  if (offset < 0) {
+    return 0;
+  }
+
+  /* The decompressed content is only created and freed while no other thread reads. */
+  if (zstd->seek.full_content) {
+    return zstd_read_from(zstd, buffer, size, (size_t)offset);
+  }
+
+  BLI_mutex_lock(&zstd->seek.read_at_mutex);
+  const size_t readsize = zstd_read_from(zstd, buffer, size, (size_t)offset);
+  BLI_mutex_unlock(&zstd->seek.read_at_mutex);
+  return readsize;
+}
+
+static ssize_t zstd_read_seekable(FileReader *reader, void *buffer, size_t size)
+{
+  ZstdReader *zstd = (ZstdReader *)reader;
+
+  const size_t readsize = zstd_read_from(zstd, buffer, size, zstd->reader.offset);
+  zstd->reader.offset += readsize;
+  return readsize;
+}
+
 static off64_t zstd_seek(FileReader *reader, off64_t offset, int whence)
 {
   ZstdReader *zstd = (ZstdReader *)reader;
@@ -287,6 +391,10 @@ static void zstd_close(FileReader *reader)
     if (zstd->seek.cached_content) {
       MEM_freeN(zstd->seek.cached_content);
     }
+    if (zstd->seek.full_content) {
+      MEM_freeN(zstd->seek.full_content);
+    }
+    BLI_mutex_end(&zstd->seek.read_at_mutex);
   }
   else {
     MEM_freeN((void *)zstd->in_buf.src);
@@ -296,6 +404,97 @@ static void zstd_close(FileReader *reader)
   MEM_freeN(zstd);
 }
 
+void *BLI_filereader_zstd_read_skippable_frame(FileReader *reader,
+                                               uint32_t magic,
+                                               size_t *r_size)
+{
+  *r_size = 0;
+  if (reader->close != zstd_close || reader->seek == NULL) {
+    return NULL;
+  }
+
+  ZstdReader *zstd = (ZstdReader *)reader;
+  FileReader *base = zstd->base;
+
+  /* Skippable frames have no content, they can only be found after the last content frame. */
+  for (int frame = zstd->seek.frames_num - 1; frame >= 0; frame--) {
+    if (zstd->seek.uncompressed_ofs[frame + 1] != zstd->seek.uncompressed_ofs[frame]) {
+      break;
+    }
+
+    /* The frame starts with the magic number and the size of the payload. */
+    size_t frame_size = zstd->seek.compressed_ofs[frame + 1] - zstd->seek.compressed_ofs[frame];
+    uint32_t frame_magic, payload_size;
+    if (frame_size < 8 || base->seek(base, zstd->seek.compressed_ofs[frame], SEEK_SET) < 0 ||
+        !zstd_read_u32(base, &frame_magic) || !zstd_read_u32(base, &payload_size))
+    {
+      return NULL;
+    }
+    if (frame_magic != magic || payload_size != frame_size - 8 || payload_size == 0) {
+      continue;
+    }
+
+    void *payload = MEM_mallocN(payload_size, __func__);
+    if (base->read(base, payload, payload_size) != payload_size) {
+      MEM_freeN(payload);
+      return NULL;
+    }
+    *r_size = payload_size;
+    return payload;
+  }
+
+  return NULL;
+}
+
+bool BLI_filereader_zstd_decompress_all(FileReader *reader)
+{
+  if (reader->close != zstd_close || reader->seek == NULL) {
+    return false;
+  }
+
+  ZstdReader *zstd = (ZstdReader *)reader;
+  if (zstd->seek.full_content) {
+    return true;
+  }
+
+  size_t compressed_size = zstd->seek.compressed_ofs[zstd->seek.frames_num];
+  size_t uncompressed_size = zstd->seek.uncompressed_ofs[zstd->seek.frames_num];
+
+  /* Read all compressed frames at once, then decompress them with one task per frame. */
+  char *compressed_content = MEM_mallocN(compressed_size, __func__);
+  if (zstd->base->seek(zstd->base, 0, SEEK_SET) < 0 ||
+      zstd->base->read(zstd->base, compressed_content, compressed_size) < compressed_size)
+  {
+    MEM_freeN(compressed_content);
+    return false;
+  }
+
+  zstd->seek.full_content = MEM_mallocN(uncompressed_size, __func__);
+
+  ZstdDecompressAllData data = {zstd, compressed_content, 0};
+  /* The caller may itself run in a task, isolate so that this thread doesn't pick up unrelated
+   * tasks while decompressing. */
+  BLI_task_isolate(zstd_decompress_all_isolated_fn, &data);
+  MEM_freeN(compressed_content);
+
+  if (data.error) {
+    MEM_freeN(zstd->seek.full_content);
+    zstd->seek.full_content = NULL;
+    return false;
+  }
+  return true;
+}
+
+void BLI_filereader_zstd_free_content(FileReader *reader)
+{
+  if (reader->close != zstd_close || reader->seek == NULL) {
+    return;
+  }
+
+  ZstdReader *zstd = (ZstdReader *)reader;
+  MEM_SAFE_FREE(zstd->seek.full_content);
+}
+
 FileReader *BLI_filereader_new_zstd(FileReader *base)
 {
   ZstdReader *zstd = MEM_callocN(sizeof(ZstdReader), __func__);
@@ -306,6 +505,8 @@ FileReader *BLI_filereader_new_zstd(FileReader *base)
   if (zstd_read_seek_table(zstd)) {
     zstd->reader.read = zstd_read_seekable;
     zstd->reader.seek = zstd_seek;
+    zstd->reader.read_at = zstd_read_at;
+    BLI_mutex_init(&zstd->seek.read_at_mutex);
   }
   else {
     zstd->reader.read = zstd_read;
@@ -59,3 +59,20 @@ enum {
 };
 
 #define BLEN_THUMB_MEMSIZE_FILE(_x, _y) (sizeof(int) * (2 + (size_t)(_x) * (size_t)(_y)))
+
+/**
+ * Magic number of the `Zstd` skippable frame in which compressed files store their block index,
+ * see the file format description in `writefile.cc`.
+ */
+#define BLEN_BLOCK_INDEX_ZSTD_MAGIC 0x184D2A5B
+/** Readers ignore block indices with a different version. */
+#define BLEN_BLOCK_INDEX_VERSION 1
+
+/**
+ * Magic number of the `Zstd` skippable frame in which compressed files store the keys of their
+ * frames, to reuse them when saving over the file. See the file format description in
+ * `writefile.cc`.
+ */
+#define BLEN_FRAME_HASHES_ZSTD_MAGIC 0x184D2A5C
+/** Frame keys with a different version are ignored. */
+#define BLEN_FRAME_HASHES_VERSION 2
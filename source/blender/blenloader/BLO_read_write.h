@@ -347,3 +347,27 @@ void BLO_reportf_wrap(struct BlendFileReadReport *reports,
 #ifdef __cplusplus
 }
 #endif
+
+#ifdef __cplusplus
+
+namespace blender {
+class ImplicitSharingInfo;
+}
+
+/**
+ * Like #BLO_read_get_new_data_address, but a large array that needs no conversion may be used in
+ * place from the memory-mapped file instead of being copied. In that case \a r_sharing_info is set
+ * and owns the returned data (it must not be freed with `MEM_freeN`), otherwise it is null and the
+ * caller owns the data as usual.
+ *
+ * The data can still be modified once the sharing info is mutable, the file itself is never
+ * changed. Only use this for arrays of types that need at most a 4 byte alignment.
+ *
+ * Mapped data is only loaded by the system when it is accessed. This is only done for read-only
+ * files (see #BLI_mmap_is_read_only), which can't change while they are mapped.
+ */
+void *BLO_read_shared_data(BlendDataReader *reader,
+                           const void *old_address,
+                           const blender::ImplicitSharingInfo **r_sharing_info);
+
+#endif
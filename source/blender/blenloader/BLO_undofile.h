@@ -19,7 +19,10 @@ typedef struct {
   const char *buf;
   /** Size in bytes. */
   size_t size;
-  /** When true, this chunk doesn't own the memory, it's shared with a previous #MemFileChunk */
+  /**
+   * When true, this chunk is identical to the matching chunk of the previous step.
+   * Note that the memory of all chunks is shared by content, see #BLO_memfile_chunk_store_stats.
+   */
   bool is_identical;
   /** When true, this chunk is also identical to the one in the next step (used by undo code to
    * detect unchanged IDs).
@@ -59,6 +62,11 @@ typedef struct {
   MemFile *memfile;
   int undo_direction;
 
+  /** The chunk containing the current offset (null at the end) and the offset of its start. */
+  MemFileChunk *chunk;
+  size_t chunk_offset;
+
+  /** Whether the chunks of the data read (or skipped by seeking forward) last are unchanged. */
   bool memchunk_identical;
 } UndoReader;
 
@@ -93,6 +101,14 @@ extern void BLO_memfile_merge(MemFile *first, MemFile *second);
  */
 extern void BLO_memfile_clear_future(MemFile *memfile);
 
+/**
+ * Memory used by the chunks of all memfiles.
+ *
+ * \param r_unique_size: Size of the chunk data in memory, identical data is only stored once.
+ * \param r_logical_size: Size of the chunk data if every chunk stored its own copy.
+ */
+extern void BLO_memfile_chunk_store_stats(size_t *r_unique_size, size_t *r_logical_size);
+
 /* Utilities. */
 
 extern struct Main *BLO_memfile_main_get(struct MemFile *memfile,
@@ -46,6 +46,11 @@ struct BlendFileWriteParams {
   /** On write, restore paths after editing them (see #BLO_WRITE_PATH_REMAP_RELATIVE). */
   uint use_save_as_copy : 1;
   uint use_userdef : 1;
+  /**
+   * When saving a compressed file over an existing one, copy its compressed data for everything
+   * that did not change, instead of compressing it again.
+   */
+  uint use_incremental : 1;
   const struct BlendThumbnail *thumb;
 };
 
@@ -58,6 +63,26 @@ extern bool BLO_write_file(struct Main *mainvar,
                            const struct BlendFileWriteParams *params,
                            struct ReportList *reports);
 
+/**
+ * Write the contents of a .blend file that is already in memory (e.g. a copy of an undo step),
+ * through a temporary file. It doesn't access any global data, so it can run in a worker thread.
+ * The temporary file is created without following symbolic links, so this is safe to use in
+ * shared directories (used for auto-save).
+ *
+ * \param write_rate_max: Limit writing to this many bytes of \a data per second (0 for no limit),
+ * so that it doesn't slow down other disk access.
+ * \param stop: Optional, stop writing (without changing \a filepath) when set.
+ * \param r_file_size: Optional, the size of the written file.
+ * \return Success.
+ */
+extern bool BLO_write_file_raw(const void *data,
+                               size_t data_len,
+                               const char *filepath,
+                               bool use_compress,
+                               size_t write_rate_max,
+                               const bool *stop,
+                               size_t *r_file_size);
+
 /**
  * \return Success.
  */
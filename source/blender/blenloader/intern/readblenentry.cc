@@ -129,7 +129,7 @@ LinkNode *BLO_blendhandle_get_datablock_names(BlendHandle *bh,
   BHead *bhead;
   int tot = 0;
 
-  for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
+  for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next_skip_data(fd, bhead)) {
     if (bhead->code == ofblocktype) {
       const char *idname = blo_bhead_id_name(fd, bhead);
       if (use_assets_only && blo_bhead_id_asset_data_address(fd, bhead) == nullptr) {
@@ -231,6 +231,8 @@ static BHead *blo_blendhandle_read_preview_rects(FileData *fd,
                                                  const PreviewImage *preview_from_file)
 {
   for (int preview_index = 0; preview_index < NUM_ICON_SIZES; preview_index++) {
+    /* The rects are always read as a copy here. */
+    result->rect_sharing_info[preview_index] = nullptr;
     if (preview_from_file->rect[preview_index] && preview_from_file->w[preview_index] &&
         preview_from_file->h[preview_index])
     {
@@ -362,7 +364,7 @@ LinkNode *BLO_blendhandle_get_linkable_groups(BlendHandle *bh)
   LinkNode *names = nullptr;
   BHead *bhead;
 
-  for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
+  for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next_skip_data(fd, bhead)) {
     if (bhead->code == BLO_CODE_ENDB) {
       break;
     }
@@ -6,6 +6,7 @@
  * \ingroup blenloader
  */
 
+#include <algorithm>
 #include <cctype> /* for isdigit. */
 #include <cerrno>
 #include <climits>
@@ -14,6 +15,9 @@
 #include <cstdlib> /* for atoi. */
 #include <ctime>   /* for gmtime. */
 #include <fcntl.h> /* for open flags (O_BINARY, O_RDONLY). */
+#include <memory>
+#include <mutex>
+#include <string>
 
 #include "BLI_utildefines.h"
 #ifndef WIN32
@@ -47,16 +51,21 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_array.hh"
 #include "BLI_blenlib.h"
 #include "BLI_endian_defines.h"
 #include "BLI_endian_switch.h"
 #include "BLI_ghash.h"
+#include "BLI_implicit_sharing.hh"
 #include "BLI_linklist.h"
 #include "BLI_map.hh"
 #include "BLI_math.h"
 #include "BLI_memarena.h"
 #include "BLI_mempool.h"
+#include "BLI_mmap.h"
+#include "BLI_task.hh"
 #include "BLI_threads.h"
+#include "BLI_vector.hh"
 
 #include "PIL_time.h"
 
@@ -176,6 +185,7 @@
 
 static CLG_LogRef LOG = {"blo.readfile"};
 static CLG_LogRef LOG_UNDO = {"blo.readfile.undo"};
+static CLG_LogRef LOG_PROFILE = {"blo.readfile.profile"};
 
 /* local prototypes */
 static void read_libraries(FileData *basefd, ListBase *mainlist);
@@ -191,7 +201,20 @@ struct BHeadN {
   /** When set, the remainder of this allocation is the data, otherwise it needs to be read. */
   bool has_data;
 #endif
+  /**
+   * Only for blocks created from the block index of the file (see #read_file_block_index):
+   * the #BLO_CODE_DATA blocks between this one and the next were not read yet. For ID blocks the
+   * allocation only holds the #ID struct (which is enough for #blo_bhead_id_name).
+   */
+  bool has_unread_data_blocks;
   bool is_memchunk_identical;
+  /**
+   * Set when the data of this block was already read and converted to the current DNA by
+   * #read_file_decode_parallel, #decoded_data is then what #read_struct returns (the BHeadN owns
+   * it until then).
+   */
+  bool is_decoded;
+  void *decoded_data;
   BHead bhead;
 };
 
@@ -234,6 +257,156 @@ static const char *library_parent_filepath(Library *lib)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Read Profiling
+ *
+ * Time spent in each phase of reading a file, reported with the `blo.readfile.profile` log
+ * category (e.g. `--log "blo.readfile.profile"`).
+ *
+ * The time of nested phases is only accounted to the innermost one, so e.g. the time of
+ * `direct_link` doesn't include reading the file. Library reads are the exception, they include
+ * everything done for the library. Phases running on multiple threads add up the time of all
+ * threads.
+ * \{ */
+
+struct BlendReadProfile {
+  struct Entry {
+    double time = 0.0;
+    int64_t count = 0;
+  };
+
+  std::mutex mutex;
+  blender::Map<std::string, Entry> entries;
+};
+
+class ReadProfileScope {
+  BlendReadProfile *profile_;
+  const char *phase_;
+  const char *detail_;
+  bool is_inclusive_;
+  double time_start_;
+  double time_children_ = 0.0;
+  ReadProfileScope *parent_ = nullptr;
+
+  static thread_local ReadProfileScope *active_;
+
+ public:
+  /**
+   * \param detail: Optional sub-category of the phase (e.g. the ID type).
+   * \param is_inclusive: Include the time of nested phases.
+   */
+  ReadProfileScope(const FileData *fd,
+                   const char *phase,
+                   const char *detail = nullptr,
+                   const bool is_inclusive = false)
+      : profile_(fd ? fd->profile : nullptr),
+        phase_(phase),
+        detail_(detail),
+        is_inclusive_(is_inclusive)
+  {
+    if (profile_ == nullptr) {
+      return;
+    }
+    time_start_ = PIL_check_seconds_timer();
+    if (!is_inclusive_) {
+      parent_ = active_;
+      active_ = this;
+    }
+  }
+
+  ~ReadProfileScope()
+  {
+    if (profile_ == nullptr) {
+      return;
+    }
+    const double time = PIL_check_seconds_timer() - time_start_;
+    if (!is_inclusive_) {
+      active_ = parent_;
+      if (parent_) {
+        parent_->time_children_ += time;
+      }
+    }
+
+    std::string key = phase_;
+    if (detail_) {
+      key += ": ";
+      key += detail_;
+    }
+    std::scoped_lock lock(profile_->mutex);
+    BlendReadProfile::Entry &entry = profile_->entries.lookup_or_add_default(std::move(key));
+    entry.time += is_inclusive_ ? time : time - time_children_;
+    entry.count++;
+  }
+};
+
+thread_local ReadProfileScope *ReadProfileScope::active_ = nullptr;
+
+/** Name of an ID type for profiling, only computed when profiling. */
+static const char *read_profile_idcode_name(const FileData *fd, const short idcode)
+{
+  if (fd->profile == nullptr) {
+    return nullptr;
+  }
+  if (idcode == ID_LINK_PLACEHOLDER) {
+    return "Link Placeholder";
+  }
+  const IDTypeInfo *id_type = BKE_idtype_get_info_from_idcode(idcode);
+  return id_type ? id_type->name : "Unknown";
+}
+
+/**
+ * Profiles reading a file when the log category is enabled, reporting the result when it goes out
+ * of scope.
+ */
+class ReadProfileReport {
+  FileData *fd_;
+  const char *filepath_;
+  double time_start_;
+
+ public:
+  ReadProfileReport(FileData *fd, const char *filepath) : fd_(nullptr), filepath_(filepath)
+  {
+    if (fd->profile != nullptr || !CLOG_CHECK(&LOG_PROFILE, 1)) {
+      return;
+    }
+    fd_ = fd;
+    fd_->profile = MEM_new<BlendReadProfile>(__func__);
+    time_start_ = PIL_check_seconds_timer();
+  }
+
+  ~ReadProfileReport()
+  {
+    if (fd_ == nullptr) {
+      return;
+    }
+    const double time = PIL_check_seconds_timer() - time_start_;
+    BlendReadProfile *profile = fd_->profile;
+    fd_->profile = nullptr;
+
+    blender::Vector<std::pair<std::string, BlendReadProfile::Entry>> entries;
+    for (auto item : profile->entries.items()) {
+      entries.append({item.key, item.value});
+    }
+    std::sort(entries.begin(), entries.end(), [](const auto &a, const auto &b) {
+      return a.second.time > b.second.time;
+    });
+
+    CLOG_INFO(&LOG_PROFILE, 1, "Read profile of \"%s\", total %.6f s", filepath_, time);
+    for (const auto &[key, entry] : entries) {
+      CLOG_INFO(&LOG_PROFILE,
+                1,
+                "  phase \"%s\" %.6f s (%lld times)",
+                key.c_str(),
+                entry.time,
+                (long long)entry.count);
+    }
+
+    MEM_delete(profile);
+  }
+};
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name OldNewMap API
  * \{ */
@@ -243,6 +416,15 @@ struct NewAddress {
 
   /** `nr` is "user count" for data, and ID code for libdata. */
   int nr;
+
+#ifdef USE_BHEAD_READ_ON_DEMAND
+  /**
+   * Only for the data-map: a block that was not read yet because it may be used in place from the
+   * memory-mapped file, see #blo_bhead_data_is_mappable. #newp is null until it is used.
+   */
+  BHead *mappable_bhead;
+  const char *allocname;
+#endif
 };
 
 struct OldNewMap {
@@ -306,7 +488,7 @@ static void oldnewmap_clear(OldNewMap *onm)
 {
   /* Free unused data. */
   for (NewAddress &new_addr : onm->map.values()) {
-    if (new_addr.nr == 0) {
+    if (new_addr.nr == 0 && new_addr.newp != nullptr) {
       MEM_freeN(new_addr.newp);
     }
   }
@@ -433,7 +615,7 @@ static void read_file_version(FileData *fd, Main *main)
 {
   BHead *bhead;
 
-  for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
+  for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next_skip_data(fd, bhead)) {
     if (bhead->code == BLO_CODE_GLOB) {
       FileGlobal *fg = static_cast<FileGlobal *>(read_struct(fd, bhead, "Global"));
       if (fg) {
@@ -480,7 +662,7 @@ static void read_file_bhead_idname_map_create(FileData *fd)
   int code_prev = BLO_CODE_ENDB;
   uint reserve = 0;
 
-  for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
+  for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next_skip_data(fd, bhead)) {
     if (code_prev != bhead->code) {
       code_prev = bhead->code;
       is_link = blo_bhead_is_id_valid_type(bhead) ?
@@ -497,7 +679,7 @@ static void read_file_bhead_idname_map_create(FileData *fd)
 
   fd->bhead_idname_hash = BLI_ghash_str_new_ex(__func__, reserve);
 
-  for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
+  for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next_skip_data(fd, bhead)) {
     if (code_prev != bhead->code) {
       code_prev = bhead->code;
       is_link = blo_bhead_is_id_valid_type(bhead) ?
@@ -668,8 +850,16 @@ static void bh8_from_bh4(BHead *bhead, BHead4 *bhead4)
   }
 }
 
+/** Read from the file, with decompression for compressed files. */
+static ssize_t blo_file_read(FileData *fd, void *buffer, const size_t size)
+{
+  ReadProfileScope profile_scope(fd, "file_read");
+  return fd->file->read(fd->file, buffer, size);
+}
+
 static BHeadN *get_bhead(FileData *fd)
 {
+  ReadProfileScope profile_scope(fd, "bhead_scan");
   BHeadN *new_bhead = nullptr;
   ssize_t readsize;
 
@@ -690,7 +880,7 @@ static BHeadN *get_bhead(FileData *fd)
        */
       if (fd->flags & FD_FLAGS_FILE_POINTSIZE_IS_4) {
         bhead4.code = BLO_CODE_DATA;
-        readsize = fd->file->read(fd->file, &bhead4, sizeof(bhead4));
+        readsize = blo_file_read(fd, &bhead4, sizeof(bhead4));
 
         if (readsize == sizeof(bhead4) || bhead4.code == BLO_CODE_ENDB) {
           if (fd->flags & FD_FLAGS_SWITCH_ENDIAN) {
@@ -713,7 +903,7 @@ static BHeadN *get_bhead(FileData *fd)
       }
       else {
         bhead8.code = BLO_CODE_DATA;
-        readsize = fd->file->read(fd->file, &bhead8, sizeof(bhead8));
+        readsize = blo_file_read(fd, &bhead8, sizeof(bhead8));
 
         if (readsize == sizeof(bhead8) || bhead8.code == BLO_CODE_ENDB) {
           if (fd->flags & FD_FLAGS_SWITCH_ENDIAN) {
@@ -754,7 +944,10 @@ static BHeadN *get_bhead(FileData *fd)
           new_bhead->next = new_bhead->prev = nullptr;
           new_bhead->file_offset = fd->file->offset;
           new_bhead->has_data = false;
+          new_bhead->has_unread_data_blocks = false;
           new_bhead->is_memchunk_identical = false;
+          new_bhead->is_decoded = false;
+          new_bhead->decoded_data = nullptr;
           new_bhead->bhead = bhead;
           const off64_t seek_new = fd->file->seek(fd->file, bhead.len, SEEK_CUR);
           if (UNLIKELY(seek_new == -1)) {
@@ -764,6 +957,10 @@ static BHeadN *get_bhead(FileData *fd)
           }
           else {
             BLI_assert(fd->file->offset == seek_new);
+            if (fd->flags & FD_FLAGS_IS_MEMFILE) {
+              /* Known without reading the data, so unchanged IDs never need to read it. */
+              new_bhead->is_memchunk_identical = ((UndoReader *)fd->file)->memchunk_identical;
+            }
           }
         }
         else {
@@ -780,10 +977,13 @@ static BHeadN *get_bhead(FileData *fd)
           new_bhead->file_offset = 0; /* don't seek. */
           new_bhead->has_data = true;
 #endif
+          new_bhead->has_unread_data_blocks = false;
           new_bhead->is_memchunk_identical = false;
+          new_bhead->is_decoded = false;
+          new_bhead->decoded_data = nullptr;
           new_bhead->bhead = bhead;
 
-          readsize = fd->file->read(fd->file, new_bhead + 1, size_t(bhead.len));
+          readsize = blo_file_read(fd, new_bhead + 1, size_t(bhead.len));
 
           if (readsize != bhead.len) {
             fd->is_eof = true;
@@ -840,6 +1040,42 @@ BHead *blo_bhead_prev(FileData * /*fd*/, BHead *thisblock)
   return (prev) ? &prev->bhead : nullptr;
 }
 
+#ifdef USE_BHEAD_READ_ON_DEMAND
+/**
+ * Read the headers of the data blocks between a block from the block index and the next one,
+ * and insert them in between in the list.
+ */
+static void blo_bhead_read_unread_data_blocks(FileData *fd, BHeadN *bheadn)
+{
+  BLI_assert(bheadn->has_unread_data_blocks && bheadn->next != nullptr);
+  bheadn->has_unread_data_blocks = false;
+
+  const off64_t offset_begin = bheadn->file_offset + bheadn->bhead.len;
+  const off64_t offset_end = bheadn->next->file_offset - off64_t(sizeof(BHead));
+  const off64_t offset_backup = fd->file->offset;
+  if (UNLIKELY(fd->file->seek(fd->file, offset_begin, SEEK_SET) == -1)) {
+    return;
+  }
+
+  /* #get_bhead adds to the end of the list, which is already complete with a block index. */
+  BLI_assert(fd->is_eof);
+  fd->is_eof = false;
+  BHeadN *prev = bheadn;
+  while (fd->file->offset < offset_end) {
+    BHeadN *new_bhead = get_bhead(fd);
+    if (new_bhead == nullptr) {
+      break;
+    }
+    BLI_remlink(&fd->bhead_list, new_bhead);
+    BLI_insertlinkafter(&fd->bhead_list, prev, new_bhead);
+    prev = new_bhead;
+  }
+  fd->is_eof = true;
+
+  fd->file->seek(fd->file, offset_backup, SEEK_SET);
+}
+#endif
+
 BHead *blo_bhead_next(FileData *fd, BHead *thisblock)
 {
   BHeadN *new_bhead = nullptr;
@@ -850,6 +1086,12 @@ BHead *blo_bhead_next(FileData *fd, BHead *thisblock)
      * We calculate the BHeadN pointer from the BHead pointer below */
     new_bhead = BHEADN_FROM_BHEAD(thisblock);
 
+#ifdef USE_BHEAD_READ_ON_DEMAND
+    if (new_bhead->has_unread_data_blocks) {
+      blo_bhead_read_unread_data_blocks(fd, new_bhead);
+    }
+#endif
+
     /* get the next BHeadN. If it doesn't exist we read in the next one */
     new_bhead = new_bhead->next;
     if (new_bhead == nullptr) {
@@ -866,7 +1108,40 @@ BHead *blo_bhead_next(FileData *fd, BHead *thisblock)
   return bhead;
 }
 
+BHead *blo_bhead_next_skip_data(FileData *fd, BHead *thisblock)
+{
+  BHead *bhead = thisblock;
+  do {
+    BHeadN *bheadn = BHEADN_FROM_BHEAD(bhead);
+    if (bheadn->has_unread_data_blocks) {
+      /* Blocks that were not read yet are all data blocks. */
+      bhead = &bheadn->next->bhead;
+    }
+    else {
+      bhead = blo_bhead_next(fd, bhead);
+    }
+  } while (bhead && bhead->code == BLO_CODE_DATA);
+
+  return bhead;
+}
+
 #ifdef USE_BHEAD_READ_ON_DEMAND
+/**
+ * Read the data of a block with #FileReader.read_at, which doesn't use the current file offset,
+ * so this can be called from multiple threads.
+ */
+static bool blo_bhead_read_data_at(FileData *fd, BHead *thisblock, void *buf)
+{
+  const BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
+  BLI_assert(new_bhead->has_data == false && new_bhead->file_offset != 0);
+  BLI_assert(fd->file->read_at != nullptr);
+  ReadProfileScope profile_scope(fd, "file_read");
+  return fd->file->read_at(fd->file,
+                           buf,
+                           size_t(new_bhead->bhead.len),
+                           new_bhead->file_offset) == new_bhead->bhead.len;
+}
+
 static bool blo_bhead_read_data(FileData *fd, BHead *thisblock, void *buf)
 {
   bool success = true;
@@ -877,7 +1152,7 @@ static bool blo_bhead_read_data(FileData *fd, BHead *thisblock, void *buf)
     success = false;
   }
   else {
-    if (fd->file->read(fd->file, buf, size_t(new_bhead->bhead.len)) != new_bhead->bhead.len) {
+    if (blo_file_read(fd, buf, size_t(new_bhead->bhead.len)) != new_bhead->bhead.len) {
       success = false;
     }
     if (fd->flags & FD_FLAGS_IS_MEMFILE) {
@@ -890,7 +1165,7 @@ static bool blo_bhead_read_data(FileData *fd, BHead *thisblock, void *buf)
   return success;
 }
 
-static BHead *blo_bhead_read_full(FileData *fd, BHead *thisblock)
+static BHead *blo_bhead_read_full(FileData *fd, BHead *thisblock, const bool use_read_at)
 {
   BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
   BHeadN *new_bhead_data = static_cast<BHeadN *>(
@@ -898,8 +1173,13 @@ static BHead *blo_bhead_read_full(FileData *fd, BHead *thisblock)
   new_bhead_data->bhead = new_bhead->bhead;
   new_bhead_data->file_offset = new_bhead->file_offset;
   new_bhead_data->has_data = true;
+  new_bhead_data->has_unread_data_blocks = false;
   new_bhead_data->is_memchunk_identical = false;
-  if (!blo_bhead_read_data(fd, thisblock, new_bhead_data + 1)) {
+  new_bhead_data->is_decoded = false;
+  new_bhead_data->decoded_data = nullptr;
+  if (!(use_read_at ? blo_bhead_read_data_at(fd, thisblock, new_bhead_data + 1) :
+                      blo_bhead_read_data(fd, thisblock, new_bhead_data + 1)))
+  {
     MEM_freeN(new_bhead_data);
     return nullptr;
   }
@@ -961,6 +1241,128 @@ static void decode_blender_header(FileData *fd)
   }
 }
 
+#ifdef USE_BHEAD_READ_ON_DEMAND
+/**
+ * Create the list of blocks from the block index that compressed files store at their end (see
+ * "BLOCK INDEX" in `writefile.cc`), instead of reading all block headers from the start.
+ *
+ * Only the blocks in the index are added to the list. The data blocks that follow them are read
+ * by #blo_bhead_next when they're needed, and the data of ID blocks is read on demand. So finding
+ * an ID (e.g. to link it from a library) and reading it only decompresses the parts of the file
+ * that contain it.
+ *
+ * \return false when there is no usable index, the file is then read from the start as usual.
+ */
+static bool read_file_block_index(FileData *fd)
+{
+  /* The index uses the byte order and pointer size of the file, only support the common case. */
+  if (fd->flags & (FD_FLAGS_IS_MEMFILE | FD_FLAGS_SWITCH_ENDIAN | FD_FLAGS_POINTSIZE_DIFFERS)) {
+    return false;
+  }
+  if (fd->file->seek == nullptr || fd->bhead_list.first != nullptr) {
+    return false;
+  }
+
+  size_t index_size;
+  char *index = static_cast<char *>(
+      BLI_filereader_zstd_read_skippable_frame(fd->file, BLEN_BLOCK_INDEX_ZSTD_MAGIC, &index_size));
+  if (index == nullptr) {
+    return false;
+  }
+
+  const char *index_end = index + index_size;
+  const char *pos = index;
+  uint32_t header[4];
+  bool success = index_size >= sizeof(header);
+  if (success) {
+    memcpy(header, pos, sizeof(header));
+    pos += sizeof(header);
+    success = header[0] == BLEN_BLOCK_INDEX_VERSION && header[2] == sizeof(BHead);
+  }
+  const uint32_t blocks_num = success ? header[1] : 0;
+  const size_t id_size = success ? header[3] : 0;
+
+  ListBase bhead_list = {nullptr, nullptr};
+  /* The first block directly follows the file header. */
+  off64_t expected_offset = SIZEOFBLENDERHEADER;
+
+  for (uint32_t i = 0; success && i < blocks_num; i++) {
+    uint64_t offset;
+    BHead bhead;
+    if (size_t(index_end - pos) < sizeof(offset) + sizeof(bhead)) {
+      success = false;
+      break;
+    }
+    memcpy(&offset, pos, sizeof(offset));
+    pos += sizeof(offset);
+    memcpy(&bhead, pos, sizeof(bhead));
+    pos += sizeof(bhead);
+
+    if (bhead.len < 0 || bhead.code == BLO_CODE_DATA || off64_t(offset) < expected_offset) {
+      success = false;
+      break;
+    }
+
+    /* The ID struct is stored in the index, the data of other blocks is read right away. These
+     * are only a few small blocks at the start and the end of the file. */
+    const bool is_id = blo_bhead_is_id(&bhead);
+    const size_t data_len = is_id ? min_zz(size_t(bhead.len), id_size) : size_t(bhead.len);
+    if (is_id && size_t(index_end - pos) < data_len) {
+      success = false;
+      break;
+    }
+
+    BHeadN *new_bhead = static_cast<BHeadN *>(MEM_mallocN(sizeof(BHeadN) + data_len, "new_bhead"));
+    new_bhead->next = new_bhead->prev = nullptr;
+    new_bhead->file_offset = off64_t(offset) + off64_t(sizeof(BHead));
+    new_bhead->has_data = !is_id;
+    new_bhead->has_unread_data_blocks = false;
+    new_bhead->is_memchunk_identical = false;
+    new_bhead->is_decoded = false;
+    new_bhead->decoded_data = nullptr;
+    new_bhead->bhead = bhead;
+    BLI_addtail(&bhead_list, new_bhead);
+
+    if (is_id) {
+      memcpy(new_bhead + 1, pos, data_len);
+      pos += data_len;
+    }
+    else if (data_len != 0) {
+      if (fd->file->seek(fd->file, new_bhead->file_offset, SEEK_SET) == -1 ||
+          blo_file_read(fd, new_bhead + 1, data_len) != ssize_t(data_len))
+      {
+        success = false;
+        break;
+      }
+    }
+
+    if (BHeadN *prev = new_bhead->prev) {
+      prev->has_unread_data_blocks = off64_t(offset) > expected_offset;
+    }
+    expected_offset = new_bhead->file_offset + bhead.len;
+  }
+
+  MEM_freeN(index);
+
+  /* The last block ends the file. */
+  if (success) {
+    BHeadN *last = static_cast<BHeadN *>(bhead_list.last);
+    success = last != nullptr && last->bhead.code == BLO_CODE_ENDB;
+  }
+
+  if (!success) {
+    BLI_freelistN(&bhead_list);
+    fd->file->seek(fd->file, SIZEOFBLENDERHEADER, SEEK_SET);
+    return false;
+  }
+
+  fd->bhead_list = bhead_list;
+  /* All blocks that are not in the list yet are read by #blo_bhead_next. */
+  fd->is_eof = true;
+  return true;
+}
+#endif /* USE_BHEAD_READ_ON_DEMAND */
+
 /**
  * \return Success if the file is read correctly, else set \a r_error_message.
  */
@@ -969,7 +1371,7 @@ static bool read_file_dna(FileData *fd, const char **r_error_message)
   BHead *bhead;
   int subversion = 0;
 
-  for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
+  for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next_skip_data(fd, bhead)) {
     if (bhead->code == BLO_CODE_GLOB) {
       /* Before this, the subversion didn't exist in 'FileGlobal' so the subversion
        * value isn't accessible for the purpose of DNA versioning in this case. */
@@ -1083,6 +1485,9 @@ static FileData *blo_decode_and_check(FileData *fd, ReportList *reports)
   decode_blender_header(fd);
 
   if (fd->flags & FD_FLAGS_FILE_OK) {
+#ifdef USE_BHEAD_READ_ON_DEMAND
+    read_file_block_index(fd);
+#endif
     const char *error_message = nullptr;
     if (read_file_dna(fd, &error_message) == false) {
       BKE_reportf(
@@ -1264,17 +1669,19 @@ void blo_filedata_free(FileData *fd)
   if (fd) {
 
     /* Free all BHeadN data blocks */
-#ifndef NDEBUG
-    BLI_freelistN(&fd->bhead_list);
-#else
-    /* Sanity check we're not keeping memory we don't need. */
     LISTBASE_FOREACH_MUTABLE (BHeadN *, new_bhead, &fd->bhead_list) {
+      /* Data decoded ahead of time that ended up not being used. */
+      if (new_bhead->decoded_data) {
+        MEM_freeN(new_bhead->decoded_data);
+      }
+#ifdef NDEBUG
+      /* Sanity check we're not keeping memory we don't need. */
       if (fd->file->seek != nullptr && BHEAD_USE_READ_ON_DEMAND(&new_bhead->bhead)) {
         BLI_assert(new_bhead->has_data == 0);
       }
+#endif
       MEM_freeN(new_bhead);
     }
-#endif
     fd->file->close(fd->file);
 
     if (fd->filesdna) {
@@ -1362,16 +1769,29 @@ BlendThumbnail *BLO_thumbnail_from_file(const char *filepath)
 /** \name Old/New Pointer Map
  * \{ */
 
+static void *datamap_lookup_and_inc(FileData *fd, const void *adr, bool increase_users)
+{
+#ifdef USE_BHEAD_READ_ON_DEMAND
+  NewAddress *entry = fd->datamap->map.lookup_ptr(adr);
+  if (entry != nullptr && entry->mappable_bhead != nullptr) {
+    /* Not used in place from the file mapping, read a copy as for any other block. */
+    entry->newp = read_struct(fd, entry->mappable_bhead, entry->allocname);
+    entry->mappable_bhead = nullptr;
+  }
+#endif
+  return oldnewmap_lookup_and_inc(fd->datamap, adr, increase_users);
+}
+
 /* Only direct data-blocks. */
 static void *newdataadr(FileData *fd, const void *adr)
 {
-  return oldnewmap_lookup_and_inc(fd->datamap, adr, true);
+  return datamap_lookup_and_inc(fd, adr, true);
 }
 
 /* Only direct data-blocks. */
 static void *newdataadr_no_us(FileData *fd, const void *adr)
 {
-  return oldnewmap_lookup_and_inc(fd->datamap, adr, false);
+  return datamap_lookup_and_inc(fd, adr, false);
 }
 
 void *blo_read_get_new_globaldata_address(FileData *fd, const void *adr)
@@ -1386,7 +1806,7 @@ static void *newpackedadr(FileData *fd, const void *adr)
     return oldnewmap_lookup_and_inc(fd->packedmap, adr, true);
   }
 
-  return oldnewmap_lookup_and_inc(fd->datamap, adr, true);
+  return newdataadr(fd, adr);
 }
 
 /* only lib data */
@@ -1717,9 +2137,17 @@ static void switch_endian_structs(const SDNA *filesdna, BHead *bhead)
   }
 }
 
-static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
+/**
+ * Read the data of a block into a new allocation, converted to the current DNA.
+ * This doesn't modify \a fd, so with \a use_read_at it can be called from multiple threads.
+ *
+ * \return false on read errors.
+ */
+static bool read_struct_decode(
+    FileData *fd, BHead *bh, const char *blockname, const bool use_read_at, void **r_data)
 {
   void *temp = nullptr;
+  *r_data = nullptr;
 
   if (bh->len) {
 #ifdef USE_BHEAD_READ_ON_DEMAND
@@ -1730,10 +2158,9 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
     if (bh->SDNAnr && (fd->flags & FD_FLAGS_SWITCH_ENDIAN)) {
 #ifdef USE_BHEAD_READ_ON_DEMAND
       if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
-        bh = blo_bhead_read_full(fd, bh);
+        bh = blo_bhead_read_full(fd, bh, use_read_at);
         if (UNLIKELY(bh == nullptr)) {
-          fd->flags &= ~FD_FLAGS_FILE_OK;
-          return nullptr;
+          return false;
         }
       }
 #endif
@@ -1744,13 +2171,13 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
       if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
 #ifdef USE_BHEAD_READ_ON_DEMAND
         if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
-          bh = blo_bhead_read_full(fd, bh);
+          bh = blo_bhead_read_full(fd, bh, use_read_at);
           if (UNLIKELY(bh == nullptr)) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
-            return nullptr;
+            return false;
           }
         }
 #endif
+        ReadProfileScope profile_scope(fd, "dna_reconstruct");
         temp = DNA_struct_reconstruct(fd->reconstruct_info, bh->SDNAnr, bh->nr, (bh + 1));
       }
       else {
@@ -1763,10 +2190,11 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
         else {
           /* Instead of allocating the bhead, then copying it,
            * read the data from the file directly into the memory. */
-          if (UNLIKELY(!blo_bhead_read_data(fd, bh, temp))) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
+          if (UNLIKELY(!(use_read_at ? blo_bhead_read_data_at(fd, bh, temp) :
+                                       blo_bhead_read_data(fd, bh, temp))))
+          {
             MEM_freeN(temp);
-            temp = nullptr;
+            return false;
           }
         }
 #else
@@ -1782,9 +2210,75 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
 #endif
   }
 
+  *r_data = temp;
+  return true;
+}
+
+static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
+{
+  BHeadN *bheadn = BHEADN_FROM_BHEAD(bh);
+  if (bheadn->is_decoded) {
+    void *temp = bheadn->decoded_data;
+    bheadn->is_decoded = false;
+    bheadn->decoded_data = nullptr;
+    return temp;
+  }
+
+  void *temp;
+  if (!read_struct_decode(fd, bh, blockname, false, &temp)) {
+    fd->flags &= ~FD_FLAGS_FILE_OK;
+    return nullptr;
+  }
   return temp;
 }
 
+#ifdef USE_BHEAD_READ_ON_DEMAND
+/**
+ * Data blocks smaller than this are always copied, they are cheap to read and using them in place
+ * would keep the whole file mapped for little gain.
+ */
+#  define BHEAD_MAPPED_DATA_MIN_SIZE (1 << 16)
+
+/**
+ * Whether the data of \a bhead can be used in place from the memory-mapped file, instead of being
+ * copied into a new allocation: it has to be large, not read yet and not need any conversion.
+ */
+static bool blo_bhead_data_is_mappable(FileData *fd, BHead *bhead)
+{
+#  ifdef WIN32
+  /* The file can't be replaced while a view of it is mapped, which would prevent saving over it.
+   * The view is also read-only, see #BLI_mmap_open. */
+  UNUSED_VARS(fd, bhead);
+  return false;
+#  else
+  const BHeadN *bheadn = BHEADN_FROM_BHEAD(bhead);
+  if (bhead->len < BHEAD_MAPPED_DATA_MIN_SIZE || bheadn->has_data || bheadn->is_decoded) {
+    return false;
+  }
+  if (fd->flags & (FD_FLAGS_SWITCH_ENDIAN | FD_FLAGS_IS_MEMFILE)) {
+    return false;
+  }
+  if (fd->compflags[bhead->SDNAnr] != SDNA_CMP_EQUAL) {
+    return false;
+  }
+  BLI_mmap_file *mmap_file = BLI_filereader_mmap_file(fd->file);
+  if (mmap_file == nullptr) {
+    return false;
+  }
+  /* The data stays mapped for as long as it is used, the file must not be changed or truncated in
+   * the meantime. */
+  if (!BLI_mmap_is_read_only(mmap_file)) {
+    return false;
+  }
+  /* Arrays used in place have to be aligned for their type, see #BLO_read_shared_data. */
+  if (bheadn->file_offset % 4 != 0) {
+    return false;
+  }
+  return uint64_t(bheadn->file_offset) + uint64_t(bhead->len) <= BLI_mmap_get_length(mmap_file);
+#  endif
+}
+#endif
+
 /* Like read_struct, but gets a pointer without allocating. Only works for
  * undo since DNA must match. */
 static const void *peek_struct_undo(FileData *fd, BHead *bhead)
@@ -2472,6 +2966,15 @@ static BHead *read_data_into_datamap(FileData *fd, BHead *bhead, const char *all
     }
 #endif
 
+#ifdef USE_BHEAD_READ_ON_DEMAND
+    if (bhead->old != nullptr && blo_bhead_data_is_mappable(fd, bhead)) {
+      /* Read on first use, unless #BLO_read_shared_data uses it from the file mapping. */
+      fd->datamap->map.add_overwrite(bhead->old, NewAddress{nullptr, 0, bhead, allocname});
+      bhead = blo_bhead_next(fd, bhead);
+      continue;
+    }
+#endif
+
     void *data = read_struct(fd, bhead, allocname);
     if (data) {
       oldnewmap_insert(fd->datamap, bhead->old, data, 0);
@@ -2863,6 +3366,7 @@ static BHead *read_libblock(FileData *fd,
                             const bool placeholder_set_indirect_extern,
                             ID **r_id)
 {
+  ReadProfileScope profile_scope(fd, "direct_link", read_profile_idcode_name(fd, bhead->code));
   const bool do_partial_undo = (fd->skip_flags & BLO_READ_SKIP_UNDO_OLD_MAIN) == 0;
 
   /* First attempt to restore existing datablocks for undo.
@@ -3073,7 +3577,7 @@ static void link_global(FileData *fd, BlendFileData *bfd)
 /** \name Versioning
  * \{ */
 
-static void do_versions_userdef(FileData * /*fd*/, BlendFileData *bfd)
+static void do_versions_userdef(FileData *fd, BlendFileData *bfd)
 {
   UserDef *user = bfd->user;
 
@@ -3081,6 +3585,7 @@ static void do_versions_userdef(FileData * /*fd*/, BlendFileData *bfd)
     return;
   }
 
+  ReadProfileScope profile_scope(fd, "versioning", "userdef");
   blo_do_versions_userdef(user);
 }
 
@@ -3113,27 +3618,35 @@ static void do_versions(FileData *fd, Library *lib, Main *main)
   }
 
   if (!main->is_read_invalid) {
+    ReadProfileScope profile_scope(fd, "versioning", "pre250");
     blo_do_versions_pre250(fd, lib, main);
   }
   if (!main->is_read_invalid) {
+    ReadProfileScope profile_scope(fd, "versioning", "250");
     blo_do_versions_250(fd, lib, main);
   }
   if (!main->is_read_invalid) {
+    ReadProfileScope profile_scope(fd, "versioning", "260");
     blo_do_versions_260(fd, lib, main);
   }
   if (!main->is_read_invalid) {
+    ReadProfileScope profile_scope(fd, "versioning", "270");
     blo_do_versions_270(fd, lib, main);
   }
   if (!main->is_read_invalid) {
+    ReadProfileScope profile_scope(fd, "versioning", "280");
     blo_do_versions_280(fd, lib, main);
   }
   if (!main->is_read_invalid) {
+    ReadProfileScope profile_scope(fd, "versioning", "290");
     blo_do_versions_290(fd, lib, main);
   }
   if (!main->is_read_invalid) {
+    ReadProfileScope profile_scope(fd, "versioning", "300");
     blo_do_versions_300(fd, lib, main);
   }
   if (!main->is_read_invalid) {
+    ReadProfileScope profile_scope(fd, "versioning", "400");
     blo_do_versions_400(fd, lib, main);
   }
 
@@ -3159,24 +3672,31 @@ static void do_versions_after_linking(FileData *fd, Main *main)
   main->is_locked_for_linking = true;
 
   if (!main->is_read_invalid) {
+    ReadProfileScope profile_scope(fd, "versioning", "after_linking_250");
     do_versions_after_linking_250(main);
   }
   if (!main->is_read_invalid) {
+    ReadProfileScope profile_scope(fd, "versioning", "after_linking_260");
     do_versions_after_linking_260(main);
   }
   if (!main->is_read_invalid) {
+    ReadProfileScope profile_scope(fd, "versioning", "after_linking_270");
     do_versions_after_linking_270(main);
   }
   if (!main->is_read_invalid) {
+    ReadProfileScope profile_scope(fd, "versioning", "after_linking_280");
     do_versions_after_linking_280(fd, main);
   }
   if (!main->is_read_invalid) {
+    ReadProfileScope profile_scope(fd, "versioning", "after_linking_290");
     do_versions_after_linking_290(fd, main);
   }
   if (!main->is_read_invalid) {
+    ReadProfileScope profile_scope(fd, "versioning", "after_linking_300");
     do_versions_after_linking_300(fd, main);
   }
   if (!main->is_read_invalid) {
+    ReadProfileScope profile_scope(fd, "versioning", "after_linking_400");
     do_versions_after_linking_400(fd, main);
   }
 
@@ -3196,6 +3716,7 @@ static void lib_link_all(FileData *fd, Main *bmain)
   ID *id;
   FOREACH_MAIN_ID_BEGIN (bmain, id) {
     const IDTypeInfo *id_type = BKE_idtype_get_info_from_id(id);
+    ReadProfileScope profile_scope(fd, "lib_link", fd->profile ? id_type->name : nullptr);
 
     if ((id->tag & (LIB_TAG_UNDO_OLD_ID_REUSED_UNCHANGED | LIB_TAG_UNDO_OLD_ID_REUSED_NOUNDO)) !=
         0) {
@@ -3444,6 +3965,122 @@ static void blo_read_file_checks(Main *bmain)
   UNUSED_VARS_NDEBUG(bmain);
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Parallel Block Decoding
+ * \{ */
+
+/**
+ * Read and convert the ID blocks and their data blocks to the current DNA on multiple threads,
+ * ahead of the serial pass in #blo_read_file_internal which then only does the direct-linking.
+ * Compressed files are decompressed on multiple threads up front, and the decompressed content is
+ * freed again afterwards.
+ *
+ * Direct-linking itself remains serial: it inserts into the shared maps and #Main lists, and the
+ * ID type callbacks are not written to run concurrently.
+ */
+static void read_file_decode_parallel(FileData *fd)
+{
+  using namespace blender;
+
+  /* Undo restores unchanged IDs instead of reading them. */
+  if (fd->flags & FD_FLAGS_IS_MEMFILE) {
+    return;
+  }
+  if (fd->skip_flags & BLO_READ_SKIP_DATA) {
+    return;
+  }
+
+  struct DecodeItem {
+    BHead *bhead;
+    const char *allocname;
+  };
+  Vector<DecodeItem> items;
+
+  const bool use_read_at = fd->file->read_at != nullptr;
+  /* Allocation name for the data blocks of the current ID, null for data of other blocks. */
+  const char *allocname = nullptr;
+
+  /* Index all blocks first, this reads the block headers of the whole file. */
+  for (BHead *bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
+    if (bhead->code == BLO_CODE_ENDB) {
+      break;
+    }
+    if (ELEM(bhead->code,
+             BLO_CODE_DNA1,
+             BLO_CODE_TEST,
+             BLO_CODE_REND,
+             BLO_CODE_GLOB,
+             BLO_CODE_USER))
+    {
+      allocname = nullptr;
+      continue;
+    }
+    const bool is_id = bhead->code != BLO_CODE_DATA;
+    if (is_id) {
+      /* Same names as used by #read_libblock. */
+      allocname = dataname((bhead->code == ID_SCRN) ? short(ID_SCR) : short(bhead->code));
+    }
+    else if (allocname == nullptr) {
+      continue;
+    }
+#ifdef USE_BHEAD_READ_ON_DEMAND
+    if (!BHEADN_FROM_BHEAD(bhead)->has_data && !use_read_at) {
+      /* Reading would need the shared file offset, leave it to the serial pass. */
+      continue;
+    }
+    if (!is_id && blo_bhead_data_is_mappable(fd, bhead)) {
+      /* Likely used in place from the file mapping, see #read_data_into_datamap. */
+      continue;
+    }
+#endif
+    items.append({bhead, is_id ? "lib block" : allocname});
+  }
+
+  if (items.is_empty()) {
+    return;
+  }
+
+  /* Otherwise the first #FileReader.read_at call would decompress frames while the other threads
+   * wait for it. */
+  const bool use_decompressed = use_read_at && BLI_filereader_zstd_decompress_all(fd->file);
+
+  threading::parallel_for(items.index_range(), 64, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      BHead *bhead = items[i].bhead;
+      void *data;
+      /* On failure the block is left to the serial pass, which reports the error. Only reading
+       * from the file can fail, before any conversion of the block is done in place. */
+      if (read_struct_decode(fd, bhead, items[i].allocname, use_read_at, &data)) {
+        BHeadN *bheadn = BHEADN_FROM_BHEAD(bhead);
+        bheadn->decoded_data = data;
+        bheadn->is_decoded = true;
+      }
+    }
+  });
+
+  if (use_decompressed) {
+    /* The remaining blocks are few, don't keep a second copy of the whole file around. */
+    BLI_filereader_zstd_free_content(fd->file);
+  }
+}
+
+/** \} */
+
+/**
+ * Memory-mapped files turn IO errors (e.g. the file being truncated while reading) into zeroed
+ * memory, make sure the user knows the data may be incomplete.
+ */
+static void read_file_report_io_errors(FileData *fd)
+{
+  BLI_mmap_file *mmap_file = BLI_filereader_mmap_file(fd->file);
+  if (mmap_file != nullptr && BLI_mmap_has_io_error(mmap_file)) {
+    BLO_reportf_wrap(fd->reports,
+                     RPT_ERROR,
+                     TIP_("Error reading '%s', the file was changed or truncated while loading"),
+                     fd->relabase);
+  }
+}
+
 BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 {
   BHead *bhead = blo_bhead_first(fd);
@@ -3455,6 +4092,8 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     CLOG_INFO(&LOG_UNDO, 2, "UNDO: read step");
   }
 
+  ReadProfileReport profile_report(fd, filepath);
+
   bfd = static_cast<BlendFileData *>(MEM_callocN(sizeof(BlendFileData), "blendfiledata"));
 
   bfd->main = BKE_main_new();
@@ -3500,6 +4139,8 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     read_undo_reuse_noundo_local_ids(fd);
   }
 
+  read_file_decode_parallel(fd);
+
   while (bhead) {
     switch (bhead->code) {
       case BLO_CODE_DATA:
@@ -3690,6 +4331,8 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 
   BLI_assert(bfd->main->id_map == nullptr);
 
+  read_file_report_io_errors(fd);
+
   /* Sanity checks. */
   blo_read_file_checks(bfd->main);
 
@@ -3729,7 +4372,8 @@ static void sort_bhead_old_map(FileData *fd)
   BHeadSort *bhs;
   int tot = 0;
 
-  for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
+  /* Only ID blocks are looked up by their old address (see #expand_doit_library). */
+  for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next_skip_data(fd, bhead)) {
     tot++;
   }
 
@@ -3741,7 +4385,8 @@ static void sort_bhead_old_map(FileData *fd)
   bhs = fd->bheadmap = static_cast<BHeadSort *>(
       MEM_malloc_arrayN(tot, sizeof(BHeadSort), "BHeadSort"));
 
-  for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead), bhs++) {
+  for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next_skip_data(fd, bhead), bhs++)
+  {
     bhs->bhead = bhead;
     bhs->old = bhead->old;
   }
@@ -3813,7 +4458,7 @@ static BHead *find_bhead_from_code_name(FileData *fd, const short idcode, const
 #else
   BHead *bhead;
 
-  for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
+  for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next_skip_data(fd, bhead)) {
     if (bhead->code == idcode) {
       const char *idname_test = blo_bhead_id_name(fd, bhead);
       if (STREQ(idname_test + 2, name)) {
@@ -4509,10 +5154,82 @@ static void read_library_clear_weak_links(FileData *basefd, ListBase *mainlist,
   }
 }
 
+/** A library file opened ahead of reading its linked data-blocks, see
+ * #read_libraries_open_parallel. */
+struct LibraryFileOpened {
+  FileData *fd = nullptr;
+  /** Reports generated while opening the file, moved into the base file reports once the file
+   * is used, so that they keep the same order as with sequential reading. */
+  ReportList reports;
+  BlendFileReadReport bf_reports = {};
+};
+
+using LibraryFilesOpened = blender::Map<Main *, std::unique_ptr<LibraryFileOpened>>;
+
+/**
+ * Open all library files that have linked data-blocks to read and are not opened yet, using
+ * multiple threads. Opening a library file (decompression, reading the header and DNA, and
+ * scanning all its block headers) does not depend on any shared data, unlike reading its
+ * data-blocks which must remain single threaded.
+ */
+static void read_libraries_open_parallel(Main *mainl, LibraryFilesOpened &r_opened_files)
+{
+  using namespace blender;
+
+  Vector<Main *> mainptrs;
+  for (Main *mainptr = mainl->next; mainptr; mainptr = mainptr->next) {
+    if (mainptr->curlib->filedata == nullptr && mainptr->curlib->packedfile == nullptr &&
+        !r_opened_files.contains(mainptr) && has_linked_ids_to_read(mainptr))
+    {
+      mainptrs.append(mainptr);
+    }
+  }
+  /* Not worth the threading overhead. */
+  if (mainptrs.size() < 2) {
+    return;
+  }
+
+  Array<std::unique_ptr<LibraryFileOpened>> opened_files(mainptrs.size());
+  threading::parallel_for(mainptrs.index_range(), 1, [&](const IndexRange range) {
+    for (const int i : range) {
+      std::unique_ptr<LibraryFileOpened> opened = std::make_unique<LibraryFileOpened>();
+      /* Report lists are not thread-safe, each file gets its own. Printing is done when moving
+       * them to the main reports. */
+      BKE_reports_init(&opened->reports, RPT_STORE | RPT_PRINT_HANDLED_BY_OWNER);
+      BKE_report_store_level_set(&opened->reports, RPT_DEBUG);
+      opened->bf_reports.reports = &opened->reports;
+
+      opened->fd = blo_filedata_from_file(mainptrs[i]->curlib->filepath_abs, &opened->bf_reports);
+#ifdef USE_GHASH_BHEAD
+      if (opened->fd) {
+        read_file_bhead_idname_map_create(opened->fd);
+      }
+#endif
+      opened_files[i] = std::move(opened);
+    }
+  });
+
+  for (const int i : mainptrs.index_range()) {
+    r_opened_files.add_new(mainptrs[i], std::move(opened_files[i]));
+  }
+}
+
+static void read_libraries_opened_free(LibraryFilesOpened &opened_files)
+{
+  for (std::unique_ptr<LibraryFileOpened> &opened : opened_files.values()) {
+    if (opened->fd) {
+      blo_filedata_free(opened->fd);
+    }
+    BKE_reports_clear(&opened->reports);
+  }
+  opened_files.clear();
+}
+
 static FileData *read_library_file_data(FileData *basefd,
                                         ListBase *mainlist,
                                         Main *mainl,
-                                        Main *mainptr)
+                                        Main *mainptr,
+                                        LibraryFileOpened *opened)
 {
   FileData *fd = mainptr->curlib->filedata;
 
@@ -4543,7 +5260,15 @@ static FileData *read_library_file_data(FileData *basefd,
                      mainptr->curlib->filepath_abs,
                      mainptr->curlib->filepath,
                      library_parent_filepath(mainptr->curlib));
-    fd = blo_filedata_from_file(mainptr->curlib->filepath_abs, basefd->reports);
+    if (opened) {
+      /* Already opened by #read_libraries_open_parallel. */
+      fd = opened->fd;
+      opened->fd = nullptr;
+      BKE_reports_move_to_reports(basefd->reports->reports, &opened->reports);
+    }
+    else {
+      fd = blo_filedata_from_file(mainptr->curlib->filepath_abs, basefd->reports);
+    }
   }
 
   if (fd) {
@@ -4554,6 +5279,7 @@ static FileData *read_library_file_data(FileData *basefd,
     fd->mainlist = mainlist;
 
     fd->reports = basefd->reports;
+    fd->profile = basefd->profile;
 
     if (fd->libmap) {
       oldnewmap_free(fd->libmap);
@@ -4567,7 +5293,9 @@ static FileData *read_library_file_data(FileData *basefd,
     /* subversion */
     read_file_version(fd, mainptr);
 #ifdef USE_GHASH_BHEAD
-    read_file_bhead_idname_map_create(fd);
+    if (fd->bhead_idname_hash == nullptr) {
+      read_file_bhead_idname_map_create(fd);
+    }
 #endif
   }
   else {
@@ -4602,9 +5330,15 @@ static void read_libraries(FileData *basefd, ListBase *mainlist)
    * with actual data-blocks. We loop over library mains multiple times in
    * case a library needs to link additional data-blocks from another library
    * that had been read previously. */
+  LibraryFilesOpened opened_files;
+
   while (do_it) {
     do_it = false;
 
+    /* Open the library files needed by this pass concurrently, their linked data-blocks are then
+     * read in the same order as before, so the result doesn't depend on threading. */
+    read_libraries_open_parallel(mainl, opened_files);
+
     /* Loop over mains of all library blend files encountered so far. Note
      * this list gets longer as more indirectly library blends are found. */
     for (Main *mainptr = mainl->next; mainptr; mainptr = mainptr->next) {
@@ -4616,8 +5350,12 @@ static void read_libraries(FileData *basefd, ListBase *mainlist)
                   mainptr->curlib->id.name,
                   mainptr->curlib->filepath);
 
+        ReadProfileScope profile_scope(basefd, "library", mainptr->curlib->filepath_abs, true);
+
         /* Open file if it has not been done yet. */
-        FileData *fd = read_library_file_data(basefd, mainlist, mainl, mainptr);
+        std::unique_ptr<LibraryFileOpened> *opened = opened_files.lookup_ptr(mainptr);
+        FileData *fd = read_library_file_data(
+            basefd, mainlist, mainl, mainptr, opened ? opened->get() : nullptr);
 
         if (fd) {
           do_it = true;
@@ -4638,6 +5376,9 @@ static void read_libraries(FileData *basefd, ListBase *mainlist)
     }
   }
 
+  /* All opened files have been used by now, this only frees the report lists. */
+  read_libraries_opened_free(opened_files);
+
   for (Main *mainptr = mainl->next; mainptr; mainptr = mainptr->next) {
     /* Drop weak links for which no data-block was found.
      * Since this can remap pointers in `libmap` of all libraries, it needs to be performed in its
@@ -4647,6 +5388,8 @@ static void read_libraries(FileData *basefd, ListBase *mainlist)
 
   Main *main_newid = BKE_main_new();
   for (Main *mainptr = mainl->next; mainptr; mainptr = mainptr->next) {
+    ReadProfileScope profile_scope(basefd, "library", mainptr->curlib->filepath_abs, true);
+
     /* Do versioning for newly added linked data-blocks. If no data-blocks
      * were read from a library versionfile will still be zero and we can
      * skip it. */
@@ -4678,6 +5421,7 @@ static void read_libraries(FileData *basefd, ListBase *mainlist)
 
     /* Free file data we no longer need. */
     if (mainptr->curlib->filedata) {
+      read_file_report_io_errors(mainptr->curlib->filedata);
       blo_filedata_free(mainptr->curlib->filedata);
     }
     mainptr->curlib->filedata = nullptr;
@@ -4695,6 +5439,58 @@ void *BLO_read_get_new_data_address_no_us(BlendDataReader *reader, const void *o
   return newdataadr_no_us(reader->fd, old_address);
 }
 
+#ifdef USE_BHEAD_READ_ON_DEMAND
+/** Owns data that is used in place from a memory-mapped file, by keeping the mapping alive. */
+class MappedDataSharingInfo : public blender::ImplicitSharingInfo {
+ private:
+  BLI_mmap_file *mmap_file_;
+
+ public:
+  MappedDataSharingInfo(BLI_mmap_file *mmap_file) : mmap_file_(mmap_file)
+  {
+    BLI_mmap_add_user(mmap_file_);
+  }
+
+ private:
+  void delete_self_with_data() override
+  {
+    this->delete_data_only();
+    MEM_delete(this);
+  }
+
+  void delete_data_only() override
+  {
+    if (mmap_file_ != nullptr) {
+      BLI_mmap_free(mmap_file_);
+      mmap_file_ = nullptr;
+    }
+  }
+};
+#endif
+
+void *BLO_read_shared_data(BlendDataReader *reader,
+                           const void *old_address,
+                           const blender::ImplicitSharingInfo **r_sharing_info)
+{
+  FileData *fd = reader->fd;
+  *r_sharing_info = nullptr;
+
+#ifdef USE_BHEAD_READ_ON_DEMAND
+  NewAddress *entry = fd->datamap->map.lookup_ptr(old_address);
+  if (entry != nullptr && entry->mappable_bhead != nullptr) {
+    BLI_mmap_file *mmap_file = BLI_filereader_mmap_file(fd->file);
+    const BHeadN *bheadn = BHEADN_FROM_BHEAD(entry->mappable_bhead);
+    entry->newp = POINTER_OFFSET(BLI_mmap_get_pointer(mmap_file), bheadn->file_offset);
+    entry->nr++;
+    entry->mappable_bhead = nullptr;
+    *r_sharing_info = MEM_new<MappedDataSharingInfo>(__func__, mmap_file);
+    return entry->newp;
+  }
+#endif
+
+  return newdataadr(fd, old_address);
+}
+
 void *BLO_read_get_new_packed_address(BlendDataReader *reader, const void *old_address)
 {
   return newpackedadr(reader->fd, old_address);
@@ -25,6 +25,7 @@ extern "C" {
 #endif
 
 struct BLOCacheStorage;
+struct BlendReadProfile;
 struct IDNameLib_Map;
 struct Key;
 struct MemFile;
@@ -131,6 +132,9 @@ typedef struct FileData {
   struct IDNameLib_Map *new_idmap_uuid;
 
   struct BlendFileReadReport *reports;
+
+  /** Timing of the read phases, only when profiling (shared with the library file data). */
+  struct BlendReadProfile *profile;
 } FileData;
 
 #define SIZEOFBLENDERHEADER 12
@@ -177,6 +181,11 @@ void blo_filedata_free(FileData *fd);
 
 BHead *blo_bhead_first(FileData *fd);
 BHead *blo_bhead_next(FileData *fd, BHead *thisblock);
+/**
+ * Like #blo_bhead_next, but skip #BLO_CODE_DATA blocks. When the file has a block index, the
+ * skipped blocks are not read at all.
+ */
+BHead *blo_bhead_next_skip_data(FileData *fd, BHead *thisblock);
 BHead *blo_bhead_prev(FileData *fd, BHead *thisblock);
 
 /**
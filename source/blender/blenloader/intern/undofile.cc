@@ -6,6 +6,7 @@
  * \ingroup blenloader
  */
 
+#include <algorithm>
 #include <cerrno>
 #include <cmath>
 #include <cstdio>
@@ -26,6 +27,9 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
+#include "BLI_map.hh"
+#include "BLI_set.hh"
 
 #include "BLO_readfile.h"
 #include "BLO_undofile.h"
@@ -37,6 +41,132 @@
 /* keep last */
 #include "BLI_strict_flags.h"
 
+/* -------------------------------------------------------------------- */
+/** \name Chunk Store
+ *
+ * Chunk buffers of all memfiles are stored by their content, so identical data is only kept in
+ * memory once, also when it's not at the same position as in the previous undo step (e.g. when
+ * IDs are added, removed or re-ordered). Buffers are reference counted by the chunks using them.
+ *
+ * \note Only used from the main thread, like the undo system.
+ * \{ */
+
+struct MemFileChunkBuffer {
+  /** Next buffer with the same hash and size. */
+  MemFileChunkBuffer *next;
+  size_t size;
+  uint hash;
+  int users;
+  /* The data follows. */
+};
+
+struct MemFileChunkStore {
+  blender::Map<uint64_t, MemFileChunkBuffer *> buffers;
+  /** Size of all buffers. */
+  size_t unique_size = 0;
+  /** Size of all chunks using the buffers. */
+  size_t logical_size = 0;
+};
+
+static MemFileChunkStore *chunk_store = nullptr;
+
+static uint64_t chunk_store_key(const uint hash, const size_t size)
+{
+  return (uint64_t(hash) << 32) ^ uint64_t(size);
+}
+
+static MemFileChunkBuffer *chunk_buffer_from_data(const char *buf)
+{
+  return reinterpret_cast<MemFileChunkBuffer *>(const_cast<char *>(buf)) - 1;
+}
+
+static const char *chunk_buffer_data(MemFileChunkBuffer *buffer)
+{
+  return reinterpret_cast<const char *>(buffer + 1);
+}
+
+static const char *chunk_store_add_user(const char *buf)
+{
+  MemFileChunkBuffer *buffer = chunk_buffer_from_data(buf);
+  buffer->users++;
+  chunk_store->logical_size += buffer->size;
+  return buf;
+}
+
+/**
+ * Get a buffer with a copy of \a buf, re-using an existing one with the same content.
+ *
+ * \param r_is_new: Set when a new buffer was allocated.
+ */
+static const char *chunk_store_ensure(const char *buf, const size_t size, bool *r_is_new)
+{
+  if (chunk_store == nullptr) {
+    chunk_store = MEM_new<MemFileChunkStore>(__func__);
+  }
+
+  const uint hash = BLI_hash_mm2(reinterpret_cast<const uchar *>(buf), size, 0);
+  MemFileChunkBuffer *&first = chunk_store->buffers.lookup_or_add(chunk_store_key(hash, size),
+                                                                   nullptr);
+  for (MemFileChunkBuffer *buffer = first; buffer; buffer = buffer->next) {
+    if (memcmp(chunk_buffer_data(buffer), buf, size) == 0) {
+      *r_is_new = false;
+      return chunk_store_add_user(chunk_buffer_data(buffer));
+    }
+  }
+
+  MemFileChunkBuffer *buffer = static_cast<MemFileChunkBuffer *>(
+      MEM_mallocN(sizeof(MemFileChunkBuffer) + size, "Chunk buffer"));
+  buffer->next = first;
+  buffer->size = size;
+  buffer->hash = hash;
+  buffer->users = 0;
+  memcpy(buffer + 1, buf, size);
+  first = buffer;
+  chunk_store->unique_size += size;
+
+  *r_is_new = true;
+  return chunk_store_add_user(chunk_buffer_data(buffer));
+}
+
+static void chunk_store_remove_user(const char *buf)
+{
+  MemFileChunkBuffer *buffer = chunk_buffer_from_data(buf);
+  chunk_store->logical_size -= buffer->size;
+  if (--buffer->users > 0) {
+    return;
+  }
+
+  const uint64_t key = chunk_store_key(buffer->hash, buffer->size);
+  MemFileChunkBuffer **first = chunk_store->buffers.lookup_ptr(key);
+  BLI_assert(first != nullptr);
+  for (MemFileChunkBuffer **buffer_p = first; *buffer_p; buffer_p = &(*buffer_p)->next) {
+    if (*buffer_p == buffer) {
+      *buffer_p = buffer->next;
+      break;
+    }
+  }
+  if (*first == nullptr) {
+    chunk_store->buffers.remove(key);
+  }
+  chunk_store->unique_size -= buffer->size;
+  MEM_freeN(buffer);
+
+  /* Don't keep the store around when there is no undo data (avoids reporting it as leaked). */
+  if (chunk_store->buffers.is_empty()) {
+    BLI_assert(chunk_store->unique_size == 0 && chunk_store->logical_size == 0);
+    MEM_delete(chunk_store);
+    chunk_store = nullptr;
+  }
+}
+
+void BLO_memfile_chunk_store_stats(size_t *r_unique_size, size_t *r_logical_size)
+{
+  *r_unique_size = chunk_store ? chunk_store->unique_size : 0;
+  *r_logical_size = chunk_store ? chunk_store->logical_size : 0;
+}
+
+/** \} */
+
 /* **************** support for memory-write, for undo buffers *************** */
 
 void BLO_memfile_free(MemFile *memfile)
@@ -44,9 +174,7 @@ void BLO_memfile_free(MemFile *memfile)
   MemFileChunk *chunk;
 
   while ((chunk = static_cast<MemFileChunk *>(BLI_pophead(&memfile->chunks)))) {
-    if (chunk->is_identical == false) {
-      MEM_freeN((void *)chunk->buf);
-    }
+    chunk_store_remove_user(chunk->buf);
     MEM_freeN(chunk);
   }
   memfile->size = 0;
@@ -54,41 +182,23 @@ void BLO_memfile_free(MemFile *memfile)
 
 void BLO_memfile_merge(MemFile *first, MemFile *second)
 {
-  /* We use this mapping to store the memory buffers from second memfile chunks which are not owned
-   * by it (i.e. shared with some previous memory steps). */
-  GHash *buffer_to_second_memchunk = BLI_ghash_new(
-      BLI_ghashutil_ptrhash, BLI_ghashutil_ptrcmp, __func__);
-
-  /* First, detect all memchunks in second memfile that are not owned by it. */
-  for (MemFileChunk *sc = static_cast<MemFileChunk *>(second->chunks.first); sc != nullptr;
-       sc = static_cast<MemFileChunk *>(sc->next))
-  {
-    if (sc->is_identical) {
-      BLI_ghash_insert(buffer_to_second_memchunk, (void *)sc->buf, sc);
+  /* Buffers are reference counted, so freeing the first memfile keeps the ones still used by the
+   * second memfile alive. But chunks of the second memfile sharing their buffer with a changed
+   * chunk of the first one are changed compared to the step before the first one, which becomes
+   * their previous step. */
+  blender::Set<const char *> first_changed_buffers;
+  LISTBASE_FOREACH (MemFileChunk *, fc, &first->chunks) {
+    if (!fc->is_identical) {
+      first_changed_buffers.add(fc->buf);
     }
   }
 
-  /* Now, check all chunks from first memfile (the one we are removing), and if a memchunk owned by
-   * it is also used by the second memfile, transfer the ownership. */
-  for (MemFileChunk *fc = static_cast<MemFileChunk *>(first->chunks.first); fc != nullptr;
-       fc = static_cast<MemFileChunk *>(fc->next))
-  {
-    if (!fc->is_identical) {
-      MemFileChunk *sc = static_cast<MemFileChunk *>(
-          BLI_ghash_lookup(buffer_to_second_memchunk, fc->buf));
-      if (sc != nullptr) {
-        BLI_assert(sc->is_identical);
-        sc->is_identical = false;
-        fc->is_identical = true;
-      }
-      /* Note that if the second memfile does not use that chunk, we assume that the first one
-       * fully owns it without sharing it with any other memfile, and hence it should be freed with
-       * it. */
+  LISTBASE_FOREACH (MemFileChunk *, sc, &second->chunks) {
+    if (sc->is_identical && first_changed_buffers.contains(sc->buf)) {
+      sc->is_identical = false;
     }
   }
 
-  BLI_ghash_free(buffer_to_second_memchunk, nullptr, nullptr);
-
   BLO_memfile_free(first);
 }
 
@@ -165,7 +275,7 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
     MemFileChunk *compchunk = *compchunk_step;
     if (compchunk->size == curchunk->size) {
       if (memcmp(compchunk->buf, buf, size) == 0) {
-        curchunk->buf = compchunk->buf;
+        curchunk->buf = chunk_store_add_user(compchunk->buf);
         curchunk->is_identical = true;
         compchunk->is_identical_future = true;
       }
@@ -173,12 +283,13 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
     *compchunk_step = static_cast<MemFileChunk *>(compchunk->next);
   }
 
-  /* not equal... */
+  /* Not equal, the data may still be in memory for other chunks. */
   if (curchunk->buf == nullptr) {
-    char *buf_new = static_cast<char *>(MEM_mallocN(size, "Chunk buffer"));
-    memcpy(buf_new, buf, size);
-    curchunk->buf = buf_new;
-    memfile->size += size;
+    bool is_new;
+    curchunk->buf = chunk_store_ensure(buf, size, &is_new);
+    if (is_new) {
+      memfile->size += size;
+    }
   }
 }
 
@@ -257,79 +368,98 @@ bool BLO_memfile_write_file(MemFile *memfile, const char *filepath)
   return true;
 }
 
+/** Move the current chunk of the reader to the one containing \a offset. */
+static void undo_chunk_find(UndoReader *undo, const size_t offset)
+{
+  while (undo->chunk_offset > offset) {
+    undo->chunk = static_cast<MemFileChunk *>(undo->chunk ? undo->chunk->prev :
+                                                            undo->memfile->chunks.last);
+    undo->chunk_offset -= undo->chunk->size;
+  }
+  while (undo->chunk && undo->chunk_offset + undo->chunk->size <= offset) {
+    undo->chunk_offset += undo->chunk->size;
+    undo->chunk = static_cast<MemFileChunk *>(undo->chunk->next);
+  }
+}
+
+static bool undo_chunk_is_identical(const UndoReader *undo, const MemFileChunk *chunk)
+{
+  /* `is_identical` of current chunk represents whether it changed compared to previous undo
+   * step. this is fine in redo case, but not in undo case, where we need an extra flag
+   * defined when saving the next (future) step after the one we want to restore, as we are
+   * supposed to 'come from' that future undo step, and not the one before current one. */
+  return undo->undo_direction == STEP_REDO ? chunk->is_identical : chunk->is_identical_future;
+}
+
 static ssize_t undo_read(FileReader *reader, void *buffer, size_t size)
 {
   UndoReader *undo = (UndoReader *)reader;
 
-  static size_t seek = SIZE_MAX; /* The current position. */
-  static size_t offset = 0;      /* Size of previous chunks. */
-  static MemFileChunk *chunk = nullptr;
-  size_t chunkoffset, readsize, totread;
-
   undo->memchunk_identical = true;
 
-  if (size == 0) {
-    return 0;
-  }
-
-  if (seek != size_t(undo->reader.offset)) {
-    chunk = static_cast<MemFileChunk *>(undo->memfile->chunks.first);
-    seek = 0;
-
-    while (chunk) {
-      if (seek + chunk->size > size_t(undo->reader.offset)) {
-        break;
-      }
-      seek += chunk->size;
-      chunk = static_cast<MemFileChunk *>(chunk->next);
+  size_t totread = 0;
+  while (totread < size) {
+    undo_chunk_find(undo, size_t(reader->offset));
+    const MemFileChunk *chunk = undo->chunk;
+    if (chunk == nullptr) {
+      break;
     }
-    offset = seek;
-    seek = size_t(undo->reader.offset);
-  }
 
-  if (chunk) {
-    totread = 0;
+    /* Data can be spread over multiple chunks, so clamp size
+     * to within this chunk, and then it will read further in
+     * the next chunk. */
+    const size_t chunkoffset = size_t(reader->offset) - undo->chunk_offset;
+    const size_t readsize = std::min(size - totread, chunk->size - chunkoffset);
 
-    do {
-      /* First check if it's on the end if current chunk. */
-      if (seek - offset == chunk->size) {
-        offset += chunk->size;
-        chunk = static_cast<MemFileChunk *>(chunk->next);
-      }
+    memcpy(POINTER_OFFSET(buffer, totread), chunk->buf + chunkoffset, readsize);
+    totread += readsize;
+    reader->offset += off64_t(readsize);
 
-      /* Debug, should never happen. */
-      if (chunk == nullptr) {
-        printf("illegal read, chunk zero\n");
-        return 0;
-      }
+    undo->memchunk_identical &= undo_chunk_is_identical(undo, chunk);
+  }
 
-      chunkoffset = seek - offset;
-      readsize = size - totread;
+  return ssize_t(totread);
+}
 
-      /* Data can be spread over multiple chunks, so clamp size
-       * to within this chunk, and then it will read further in
-       * the next chunk. */
-      if (chunkoffset + readsize > chunk->size) {
-        readsize = chunk->size - chunkoffset;
-      }
+static off64_t undo_seek(FileReader *reader, off64_t offset, int whence)
+{
+  UndoReader *undo = (UndoReader *)reader;
 
-      memcpy(POINTER_OFFSET(buffer, totread), chunk->buf + chunkoffset, readsize);
-      totread += readsize;
-      undo->reader.offset += (off64_t)readsize;
-      seek += readsize;
+  off64_t new_pos;
+  if (whence == SEEK_CUR) {
+    new_pos = reader->offset + offset;
+  }
+  else if (whence == SEEK_SET) {
+    new_pos = offset;
+  }
+  else {
+    return -1;
+  }
+  if (new_pos < 0) {
+    return -1;
+  }
 
-      /* `is_identical` of current chunk represents whether it changed compared to previous undo
-       * step. this is fine in redo case, but not in undo case, where we need an extra flag
-       * defined when saving the next (future) step after the one we want to restore, as we are
-       * supposed to 'come from' that future undo step, and not the one before current one. */
-      undo->memchunk_identical &= undo->undo_direction == STEP_REDO ? chunk->is_identical :
-                                                                      chunk->is_identical_future;
-    } while (totread < size);
+  /* Like for reading, tell whether the data that is skipped changed. This allows data blocks to
+   * be read on demand only when their ID changed, see #get_bhead. */
+  undo->memchunk_identical = true;
+  if (new_pos > reader->offset) {
+    undo_chunk_find(undo, size_t(reader->offset));
+    size_t chunk_offset = undo->chunk_offset;
+    for (const MemFileChunk *chunk = undo->chunk; chunk && chunk_offset < size_t(new_pos);
+         chunk = static_cast<const MemFileChunk *>(chunk->next))
+    {
+      undo->memchunk_identical &= undo_chunk_is_identical(undo, chunk);
+      chunk_offset += chunk->size;
+    }
+  }
 
-    return ssize_t(totread);
+  undo_chunk_find(undo, size_t(new_pos));
+  if (undo->chunk == nullptr && size_t(new_pos) > undo->chunk_offset) {
+    return -1;
   }
 
-  return 0;
+  reader->offset = new_pos;
+  return new_pos;
 }
 
 static void undo_close(FileReader *reader)
@@ -344,8 +474,11 @@ FileReader *BLO_memfile_new_filereader(MemFile *memfile, int undo_direction)
   undo->memfile = memfile;
   undo->undo_direction = undo_direction;
 
+  undo->chunk = static_cast<MemFileChunk *>(memfile->chunks.first);
+  undo->chunk_offset = 0;
+
   undo->reader.read = undo_read;
-  undo->reader.seek = nullptr;
+  undo->reader.seek = undo_seek;
   undo->reader.close = undo_close;
 
   return (FileReader *)undo;
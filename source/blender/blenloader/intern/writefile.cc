@@ -56,6 +56,54 @@
  * - write #BLO_CODE_USER (#UserDef struct) for file paths:
  *   - #BLENDER_STARTUP_FILE (on UNIX `~/.config/blender/X.X/config/startup.blend`).
  *   - #BLENDER_USERPREF_FILE (on UNIX `~/.config/blender/X.X/config/userpref.blend`).
+ *
+ * BLOCK INDEX
+ * ===========
+ *
+ * Compressed files are written as independent `Zstd` frames with a seek table, so that readers
+ * can decompress any part of the file. To find the blocks they need without reading all block
+ * headers, they also store an index of all blocks that are not #BLO_CODE_DATA, in a skippable
+ * frame (#BLEN_BLOCK_INDEX_ZSTD_MAGIC) listed after the content frames in the seek table.
+ * Like the rest of the file it uses the byte order and pointer size of the writer.
+ * <pre>
+ * `version`         `uint32` #BLEN_BLOCK_INDEX_VERSION.
+ * `blocks_num`      `uint32` number of blocks in the index.
+ * `bhead_size`      `uint32` size of #BHead.
+ * `id_size`         `uint32` size of the #ID struct.
+ * for each block, in file order:
+ *   `offset`        `uint64` offset of the #BHead in the uncompressed file.
+ *   `bhead`         #BHead of the block.
+ *   `id`            for ID blocks, the first `min(bhead.len, id_size)` bytes of the data.
+ * </pre>
+ *
+ * FRAME REUSE
+ * ===========
+ *
+ * Compressing is the most expensive part of saving large files. When saving over a compressed
+ * file (see #BlendFileWriteParams.use_incremental), frames of the existing file whose data did not
+ * change are copied instead of compressing the data again. To make that likely, frames end after
+ * IDs with a lot of data, and after IDs picked by the hash of their name. So frame boundaries only
+ * depend on the IDs themselves, a change in the size of one ID doesn't move the boundaries of the
+ * frames after it.
+ *
+ * Each frame gets a key from the hash of the name of the ID that is written when it ends, and the
+ * number of the frame within that ID, stored in a skippable frame (#BLEN_FRAME_HASHES_ZSTD_MAGIC)
+ * after the block index. A frame of the existing file with the same key and size is decompressed
+ * and compared with the new data, and only copied when they are equal. The data itself is never
+ * hashed, so saving costs nothing extra when there is no file to reuse frames from.
+ *
+ * Blocks contain the memory addresses of the written data, so frames are only reused when saving
+ * again in the same session. After opening a file its data is at other addresses, and the first
+ * save compresses everything again.
+ * <pre>
+ * `version`             `uint32` #BLEN_FRAME_HASHES_VERSION.
+ * `frames_num`          `uint32` number of content frames.
+ * for each content frame, in file order:
+ *   `offset`            `uint64` offset of the frame in the file.
+ *   `key`               `uint64` ID name hash in the upper and frame number in the lower bits.
+ *   `compressed_size`   `uint32`
+ *   `uncompressed_size` `uint32`
+ * </pre>
  */
 
 #include <cerrno>
@@ -90,13 +138,18 @@
 #include "BLI_blenlib.h"
 #include "BLI_endian_defines.h"
 #include "BLI_endian_switch.h"
+#include "BLI_hash_mm2a.h"
 #include "BLI_link_utils.h"
 #include "BLI_linklist.h"
+#include "BLI_map.hh"
 #include "BLI_math_base.h"
 #include "BLI_mempool.h"
 #include "BLI_threads.h"
+#include "BLI_vector.hh"
 #include "MEM_guardedalloc.h" /* MEM_freeN */
 
+#include "PIL_time.h"
+
 #include "BKE_blender_version.h"
 #include "BKE_bpath.h"
 #include "BKE_global.h" /* for G */
@@ -137,6 +190,11 @@
 
 #define ZSTD_COMPRESSION_LEVEL 3
 
+/** When reusing frames, a new frame is started after IDs that wrote at least this much data... */
+#define ZSTD_ID_FRAME_MIN_SIZE (1 << 18) /* 256kb */
+/** ...and after one in this many IDs, picked by the hash of their name. */
+#define ZSTD_ID_FRAME_NAME_INTERVAL 16
+
 static CLG_LogRef LOG = {"blo.writefile"};
 
 /** Use if we want to store how many bytes have been written to the file. */
@@ -156,16 +214,34 @@ struct ZstdFrame {
 
   uint32_t compressed_size;
   uint32_t uncompressed_size;
+  /** Key of content frames, see "FRAME REUSE" above. */
+  uint64_t key;
+};
+
+/** A frame of the file that is saved over, see "FRAME REUSE" above. */
+struct ZstdReusableFrame {
+  uint64_t offset;
+  uint32_t compressed_size;
+  uint32_t uncompressed_size;
 };
 
 struct WriteWrap {
   /* callbacks */
-  bool (*open)(WriteWrap *ww, const char *filepath);
+  /** `oflags` are the flags for #BLI_open, see #WW_OPEN_FLAGS. */
+  bool (*open)(WriteWrap *ww, const char *filepath, int oflags);
   bool (*close)(WriteWrap *ww);
   size_t (*write)(WriteWrap *ww, const char *data, size_t data_len);
+  /** Optional, store the block index (see "BLOCK INDEX" above), takes ownership of `data`. */
+  void (*write_block_index)(WriteWrap *ww, void *data, size_t data_len);
+  /** Optional, reuse unchanged parts of the existing file at `filepath` (see "FRAME REUSE"). */
+  void (*reuse_from_file)(WriteWrap *ww, const char *filepath);
 
   /* Buffer output (we only want when output isn't already buffered). */
   bool use_buf;
+  /** Flush the buffer after IDs, so that their data starts at the same place in every save. */
+  bool use_id_flush;
+  /** Key of the data of the next #write call, when #use_id_flush is set. */
+  uint64_t frame_key;
 
   /* internal */
   int file_handle;
@@ -180,16 +256,34 @@ struct WriteWrap {
     int level;
     ListBase frames;
 
+    /** Written as a skippable frame before the seek table. */
+    void *block_index;
+    size_t block_index_len;
+
+    /** Frames of the file that is saved over, see "FRAME REUSE" above. */
+    struct {
+      bool use;
+      /** The existing file, -1 when there is nothing to reuse. */
+      int file_handle;
+      /** Protects reading from #file_handle. */
+      ThreadMutex mutex;
+      blender::Map<uint64_t, ZstdReusableFrame> *frames;
+      /** Number of frames that were copied. */
+      int frames_reused;
+    } reuse;
+
     bool write_error;
   } zstd;
 };
 
+#define WW_OPEN_FLAGS (O_BINARY | O_WRONLY | O_CREAT | O_TRUNC)
+
 /* none */
-static bool ww_open_none(WriteWrap *ww, const char *filepath)
+static bool ww_open_none(WriteWrap *ww, const char *filepath, int oflags)
 {
   int file;
 
-  file = BLI_open(filepath, O_BINARY + O_WRONLY + O_CREAT + O_TRUNC, 0666);
+  file = BLI_open(filepath, oflags, 0666);
 
   if (file != -1) {
     ww->file_handle = file;
@@ -214,18 +308,64 @@ struct ZstdWriteBlockTask {
   void *data;
   size_t size;
   int frame_number;
+  uint64_t key;
   WriteWrap *ww;
 };
 
+/**
+ * Copy the frame of the existing file with the same data as \a task, see "FRAME REUSE" above.
+ * \return The compressed frame (free with #MEM_freeN) or null when there is none.
+ */
+static void *zstd_reuse_frame(WriteWrap *ww, const ZstdWriteBlockTask *task, size_t *r_size)
+{
+  const ZstdReusableFrame *frame = ww->zstd.reuse.frames->lookup_ptr(task->key);
+  if (frame == nullptr || frame->uncompressed_size != task->size) {
+    return nullptr;
+  }
+
+  void *compressed = MEM_mallocN(frame->compressed_size, "Zstd reused frame");
+  BLI_mutex_lock(&ww->zstd.reuse.mutex);
+  const bool read_ok = BLI_lseek(ww->zstd.reuse.file_handle, int64_t(frame->offset), SEEK_SET) ==
+                           int64_t(frame->offset) &&
+                       read(ww->zstd.reuse.file_handle, compressed, frame->compressed_size) ==
+                           int64_t(frame->compressed_size);
+  BLI_mutex_unlock(&ww->zstd.reuse.mutex);
+
+  /* Only reuse a frame that decompresses to exactly the new data. */
+  bool is_equal = false;
+  if (read_ok && ZSTD_getFrameContentSize(compressed, frame->compressed_size) == task->size) {
+    void *decompressed = MEM_mallocN(task->size, "Zstd reused frame check");
+    const size_t decompressed_size = ZSTD_decompress(
+        decompressed, task->size, compressed, frame->compressed_size);
+    is_equal = decompressed_size == task->size && memcmp(decompressed, task->data, task->size) == 0;
+    MEM_freeN(decompressed);
+  }
+  if (!is_equal) {
+    MEM_freeN(compressed);
+    return nullptr;
+  }
+
+  *r_size = frame->compressed_size;
+  return compressed;
+}
+
 static void *zstd_write_task(void *userdata)
 {
   ZstdWriteBlockTask *task = static_cast<ZstdWriteBlockTask *>(userdata);
   WriteWrap *ww = task->ww;
 
-  size_t out_buf_len = ZSTD_compressBound(task->size);
-  void *out_buf = MEM_mallocN(out_buf_len, "Zstd out buffer");
-  size_t out_size = ZSTD_compress(
-      out_buf, out_buf_len, task->data, task->size, ZSTD_COMPRESSION_LEVEL);
+  void *out_buf = nullptr;
+  size_t out_size = 0;
+  bool is_reused = false;
+  if (ww->zstd.reuse.frames != nullptr) {
+    out_buf = zstd_reuse_frame(ww, task, &out_size);
+    is_reused = out_buf != nullptr;
+  }
+  if (out_buf == nullptr) {
+    size_t out_buf_len = ZSTD_compressBound(task->size);
+    out_buf = MEM_mallocN(out_buf_len, "Zstd out buffer");
+    out_size = ZSTD_compress(out_buf, out_buf_len, task->data, task->size, ZSTD_COMPRESSION_LEVEL);
+  }
 
   MEM_freeN(task->data);
 
@@ -244,7 +384,11 @@ static void *zstd_write_task(void *userdata)
           MEM_mallocN(sizeof(ZstdFrame), "zstd frameinfo"));
       frameinfo->uncompressed_size = task->size;
       frameinfo->compressed_size = out_size;
+      frameinfo->key = task->key;
       BLI_addtail(&ww->zstd.frames, frameinfo);
+      if (is_reused) {
+        ww->zstd.reuse.frames_reused++;
+      }
     }
     else {
       ww->zstd.write_error = true;
@@ -260,9 +404,9 @@ static void *zstd_write_task(void *userdata)
   return nullptr;
 }
 
-static bool ww_open_zstd(WriteWrap *ww, const char *filepath)
+static bool ww_open_zstd(WriteWrap *ww, const char *filepath, int oflags)
 {
-  if (!ww_open_none(ww, filepath)) {
+  if (!ww_open_none(ww, filepath, oflags)) {
     return false;
   }
 
@@ -316,6 +460,143 @@ static void zstd_write_seekable_frames(WriteWrap *ww)
   zstd_write_u32_le(ww, 0x8F92EAB1);
 }
 
+/* The block index is listed in the seek table like the content frames, but with an uncompressed
+ * size of zero, so readers that don't know about it are not affected. */
+static void zstd_write_block_index(WriteWrap *ww)
+{
+  if (ww->zstd.write_error || ww->zstd.block_index_len > UINT32_MAX - 8) {
+    return;
+  }
+
+  zstd_write_u32_le(ww, BLEN_BLOCK_INDEX_ZSTD_MAGIC);
+  zstd_write_u32_le(ww, uint32_t(ww->zstd.block_index_len));
+  if (ww_write_none(ww, static_cast<const char *>(ww->zstd.block_index), ww->zstd.block_index_len) !=
+      ww->zstd.block_index_len)
+  {
+    ww->zstd.write_error = true;
+    return;
+  }
+
+  ZstdFrame *frameinfo = static_cast<ZstdFrame *>(MEM_mallocN(sizeof(ZstdFrame), __func__));
+  frameinfo->uncompressed_size = 0;
+  frameinfo->compressed_size = uint32_t(ww->zstd.block_index_len + 8);
+  BLI_addtail(&ww->zstd.frames, frameinfo);
+}
+
+/* Written after the block index, listed in the seek table in the same way. */
+static void zstd_write_frame_hashes(WriteWrap *ww)
+{
+  struct FrameHashEntry {
+    uint64_t offset;
+    uint64_t key;
+    uint32_t compressed_size;
+    uint32_t uncompressed_size;
+  };
+
+  if (ww->zstd.write_error) {
+    return;
+  }
+
+  blender::Vector<FrameHashEntry> entries;
+  uint64_t offset = 0;
+  LISTBASE_FOREACH (ZstdFrame *, frame, &ww->zstd.frames) {
+    if (frame->uncompressed_size != 0) {
+      entries.append({offset, frame->key, frame->compressed_size, frame->uncompressed_size});
+    }
+    offset += frame->compressed_size;
+  }
+
+  const uint32_t header[2] = {BLEN_FRAME_HASHES_VERSION, uint32_t(entries.size())};
+  const size_t data_len = sizeof(header) + entries.as_span().size_in_bytes();
+  if (data_len > UINT32_MAX - 8) {
+    return;
+  }
+
+  zstd_write_u32_le(ww, BLEN_FRAME_HASHES_ZSTD_MAGIC);
+  zstd_write_u32_le(ww, uint32_t(data_len));
+  if (ww_write_none(ww, reinterpret_cast<const char *>(header), sizeof(header)) !=
+          sizeof(header) ||
+      ww_write_none(ww,
+                    reinterpret_cast<const char *>(entries.data()),
+                    entries.as_span().size_in_bytes()) != entries.as_span().size_in_bytes())
+  {
+    ww->zstd.write_error = true;
+    return;
+  }
+
+  ZstdFrame *frameinfo = static_cast<ZstdFrame *>(MEM_callocN(sizeof(ZstdFrame), __func__));
+  frameinfo->compressed_size = uint32_t(data_len + 8);
+  BLI_addtail(&ww->zstd.frames, frameinfo);
+}
+
+static void ww_reuse_from_file_zstd(WriteWrap *ww, const char *filepath)
+{
+  ww->use_id_flush = true;
+  ww->zstd.reuse.use = true;
+  ww->zstd.reuse.file_handle = -1;
+
+  const int file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+  if (file == -1) {
+    return;
+  }
+  FileReader *rawfile = BLI_filereader_new_file(file);
+  if (rawfile == nullptr) {
+    close(file);
+    return;
+  }
+  FileReader *zstd = BLI_filereader_new_zstd(rawfile);
+  if (zstd == nullptr) {
+    rawfile->close(rawfile);
+    return;
+  }
+  size_t data_len;
+  char *data = static_cast<char *>(
+      BLI_filereader_zstd_read_skippable_frame(zstd, BLEN_FRAME_HASHES_ZSTD_MAGIC, &data_len));
+  zstd->close(zstd);
+  if (data == nullptr) {
+    return;
+  }
+
+  uint32_t header[2] = {0, 0};
+  const size_t entry_size = sizeof(uint64_t[2]) + sizeof(uint32_t[2]);
+  if (data_len >= sizeof(header)) {
+    memcpy(header, data, sizeof(header));
+  }
+  if (header[0] != BLEN_FRAME_HASHES_VERSION ||
+      data_len != sizeof(header) + size_t(header[1]) * entry_size)
+  {
+    MEM_freeN(data);
+    return;
+  }
+
+  ww->zstd.reuse.file_handle = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+  if (ww->zstd.reuse.file_handle == -1) {
+    MEM_freeN(data);
+    return;
+  }
+  BLI_mutex_init(&ww->zstd.reuse.mutex);
+  ww->zstd.reuse.frames = MEM_new<blender::Map<uint64_t, ZstdReusableFrame>>(__func__);
+
+  const char *entry = data + sizeof(header);
+  for (uint32_t i = 0; i < header[1]; i++, entry += entry_size) {
+    uint64_t key;
+    ZstdReusableFrame frame;
+    memcpy(&frame.offset, entry, sizeof(uint64_t));
+    memcpy(&key, entry + sizeof(uint64_t), sizeof(uint64_t));
+    memcpy(&frame.compressed_size, entry + sizeof(uint64_t[2]), sizeof(uint32_t));
+    memcpy(&frame.uncompressed_size, entry + sizeof(uint64_t[2]) + sizeof(uint32_t), sizeof(uint32_t));
+    ww->zstd.reuse.frames->add(key, frame);
+  }
+  MEM_freeN(data);
+}
+
+static void ww_write_block_index_zstd(WriteWrap *ww, void *data, size_t data_len)
+{
+  MEM_SAFE_FREE(ww->zstd.block_index);
+  ww->zstd.block_index = data;
+  ww->zstd.block_index_len = data_len;
+}
+
 static bool ww_close_zstd(WriteWrap *ww)
 {
   BLI_threadpool_end(&ww->zstd.threadpool);
@@ -324,6 +605,27 @@ static bool ww_close_zstd(WriteWrap *ww)
   BLI_mutex_end(&ww->zstd.mutex);
   BLI_condition_end(&ww->zstd.condition);
 
+  if (ww->zstd.block_index) {
+    zstd_write_block_index(ww);
+    MEM_freeN(ww->zstd.block_index);
+    ww->zstd.block_index = nullptr;
+  }
+
+  if (ww->zstd.reuse.use) {
+    zstd_write_frame_hashes(ww);
+  }
+  if (ww->zstd.reuse.frames) {
+    CLOG_INFO(&LOG,
+              1,
+              "Reused %d of %d frames of the existing file",
+              ww->zstd.reuse.frames_reused,
+              ww->zstd.num_frames);
+    MEM_delete(ww->zstd.reuse.frames);
+    ww->zstd.reuse.frames = nullptr;
+    BLI_mutex_end(&ww->zstd.reuse.mutex);
+    close(ww->zstd.reuse.file_handle);
+  }
+
   zstd_write_seekable_frames(ww);
   BLI_freelistN(&ww->zstd.frames);
 
@@ -342,6 +644,7 @@ static size_t ww_write_zstd(WriteWrap *ww, const char *buf, size_t buf_len)
   memcpy(task->data, buf, buf_len);
   task->size = buf_len;
   task->frame_number = ww->zstd.num_frames++;
+  task->key = ww->frame_key;
   task->ww = ww;
 
   BLI_mutex_lock(&ww->zstd.mutex);
@@ -378,6 +681,8 @@ static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
       r_ww->open = ww_open_zstd;
       r_ww->close = ww_close_zstd;
       r_ww->write = ww_write_zstd;
+      r_ww->write_block_index = ww_write_block_index_zstd;
+      r_ww->reuse_from_file = ww_reuse_from_file_zstd;
       r_ww->use_buf = true;
       break;
     }
@@ -417,6 +722,29 @@ struct WriteData {
   size_t write_len;
 #endif
 
+  /** Index of the blocks that are not #BLO_CODE_DATA, see "BLOCK INDEX" above. */
+  struct {
+    /** Only when #WriteWrap.write_block_index is set. */
+    bool use;
+    /** Offset in the uncompressed file of the next #mywrite. */
+    uint64_t file_offset;
+    uint32_t blocks_num;
+
+    char *data;
+    size_t data_len;
+    size_t data_alloc_len;
+  } block_index;
+
+  /** Key of the frames passed to #WriteWrap.write, see "FRAME REUSE" above. */
+  struct {
+    /** Hash of the name of the ID that is written, zero before the first ID. */
+    uint32_t id_hash;
+    /** Number of frames written since the start of the ID. */
+    uint32_t id_frame;
+    /** #WriteData.block_index.file_offset (counted for all writes) at the start of the ID. */
+    uint64_t id_file_offset;
+  } frame_key;
+
   /** Set on unlikely case of an error (ignores further file writing). */
   bool error;
 
@@ -457,6 +785,15 @@ static WriteData *writedata_new(WriteWrap *ww)
     wd->buffer.buf = static_cast<uchar *>(MEM_mallocN(wd->buffer.max_size, "wd->buffer.buf"));
   }
 
+  if (ww != nullptr && ww->write_block_index != nullptr) {
+    wd->block_index.use = true;
+    /* Reserve space for the header, written by #write_block_index_end. */
+    wd->block_index.data_len = sizeof(uint32_t[4]);
+    wd->block_index.data_alloc_len = MEM_CHUNK_SIZE;
+    wd->block_index.data = static_cast<char *>(
+        MEM_mallocN(wd->block_index.data_alloc_len, "wd->block_index.data"));
+  }
+
   return wd;
 }
 
@@ -480,6 +817,9 @@ static void writedata_do_write(WriteData *wd, const void *mem, size_t memlen)
     BLO_memfile_chunk_add(&wd->mem, static_cast<const char *>(mem), memlen);
   }
   else {
+    if (wd->ww->use_id_flush) {
+      wd->ww->frame_key = (uint64_t(wd->frame_key.id_hash) << 32) | wd->frame_key.id_frame++;
+    }
     if (wd->ww->write(wd->ww, static_cast<const char *>(mem), memlen) != memlen) {
       wd->error = true;
     }
@@ -491,11 +831,61 @@ static void writedata_free(WriteData *wd)
   if (wd->buffer.buf) {
     MEM_freeN(wd->buffer.buf);
   }
+  if (wd->block_index.data) {
+    MEM_freeN(wd->block_index.data);
+  }
   MEM_freeN(wd);
 }
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Block Index
+ *
+ * See "BLOCK INDEX" at the top of this file.
+ * \{ */
+
+static void write_block_index_append(WriteData *wd, const void *data, size_t len)
+{
+  if (wd->block_index.data_len + len > wd->block_index.data_alloc_len) {
+    wd->block_index.data_alloc_len = max_zz(wd->block_index.data_alloc_len * 2,
+                                            wd->block_index.data_len + len);
+    wd->block_index.data = static_cast<char *>(
+        MEM_reallocN(wd->block_index.data, wd->block_index.data_alloc_len));
+  }
+  memcpy(wd->block_index.data + wd->block_index.data_len, data, len);
+  wd->block_index.data_len += len;
+}
+
+/**
+ * Add a block that is about to be written at the current offset.
+ * \param data: The data of the block, only used for ID blocks.
+ */
+static void write_block_index_add(WriteData *wd, const BHead *bh, const void *data)
+{
+  const uint64_t offset = wd->block_index.file_offset;
+  write_block_index_append(wd, &offset, sizeof(offset));
+  write_block_index_append(wd, bh, sizeof(BHead));
+  /* Store the ID struct, so readers can look up IDs by name without reading the blocks. */
+  if (bh->code <= 0xFFFF) {
+    write_block_index_append(wd, data, min_zz(size_t(bh->len), sizeof(ID)));
+  }
+  wd->block_index.blocks_num++;
+}
+
+/** Pass the block index to the write wrapper, once all blocks have been written. */
+static void write_block_index_end(WriteData *wd)
+{
+  const uint32_t header[4] = {
+      BLEN_BLOCK_INDEX_VERSION, wd->block_index.blocks_num, sizeof(BHead), sizeof(ID)};
+  memcpy(wd->block_index.data, header, sizeof(header));
+
+  wd->ww->write_block_index(wd->ww, wd->block_index.data, wd->block_index.data_len);
+  wd->block_index.data = nullptr;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Local Writing API 'mywrite'
  * \{ */
@@ -532,6 +922,8 @@ static void mywrite(WriteData *wd, const void *adr, size_t len)
   wd->write_len += len;
 #endif
 
+  wd->block_index.file_offset += len;
+
   if (wd->buffer.buf == nullptr) {
     writedata_do_write(wd, adr, len);
   }
@@ -566,6 +958,18 @@ static void mywrite(WriteData *wd, const void *adr, size_t len)
   }
 }
 
+/**
+ * Write the header of a block, its data must be written directly after this.
+ * \param data: The data of the block, only used for the block index.
+ */
+static void mywrite_bhead(WriteData *wd, const BHead *bh, const void *data)
+{
+  if (wd->block_index.use && bh->code != BLO_CODE_DATA) {
+    write_block_index_add(wd, bh, data);
+  }
+  mywrite(wd, bh, sizeof(BHead));
+}
+
 /**
  * BeGiN initializer for mywrite
  * \param ww: File write wrapper.
@@ -602,6 +1006,10 @@ static bool mywrite_end(WriteData *wd)
     BLO_memfile_write_finalize(&wd->mem);
   }
 
+  if (wd->block_index.use && !wd->error) {
+    write_block_index_end(wd);
+  }
+
   const bool err = wd->error;
   writedata_free(wd);
 
@@ -611,11 +1019,19 @@ static bool mywrite_end(WriteData *wd)
 /**
  * Start writing of data related to a single ID.
  *
- * Only does something when storing an undo step.
+ * Only does something when storing an undo step or reusing frames (see "FRAME REUSE" above).
  */
 static void mywrite_id_begin(WriteData *wd, ID *id)
 {
-  if (wd->use_memfile) {
+  if (!wd->use_memfile) {
+    if (wd->ww->use_id_flush) {
+      wd->frame_key.id_hash = BLI_hash_mm2(
+          reinterpret_cast<const uchar *>(id->name), strlen(id->name), 0);
+      wd->frame_key.id_frame = 0;
+      wd->frame_key.id_file_offset = wd->block_index.file_offset;
+    }
+  }
+  else {
     wd->mem.current_id_session_uuid = id->session_uuid;
 
     /* If current next memchunk does not match the ID we are about to write, or is not the _first_
@@ -642,9 +1058,9 @@ static void mywrite_id_begin(WriteData *wd, ID *id)
 }
 
 /**
- * Start writing of data related to a single ID.
+ * End writing of data related to a single ID.
  *
- * Only does something when storing an undo step.
+ * Only does something when storing an undo step or reusing frames (see "FRAME REUSE" above).
  */
 static void mywrite_id_end(WriteData *wd, ID * /*id*/)
 {
@@ -654,6 +1070,15 @@ static void mywrite_id_end(WriteData *wd, ID * /*id*/)
     mywrite_flush(wd);
     wd->mem.current_id_session_uuid = MAIN_ID_SESSION_UUID_UNSET;
   }
+  else if (wd->ww->use_id_flush) {
+    /* Small IDs share frames. Whether a frame ends here only depends on this ID, so changing the
+     * size of an ID doesn't move the boundaries of the following frames. */
+    if (wd->block_index.file_offset - wd->frame_key.id_file_offset >= ZSTD_ID_FRAME_MIN_SIZE ||
+        wd->frame_key.id_hash % ZSTD_ID_FRAME_NAME_INTERVAL == 0)
+    {
+      mywrite_flush(wd);
+    }
+  }
 }
 
 /** \} */
@@ -687,7 +1112,7 @@ static void writestruct_at_address_nr(
     return;
   }
 
-  mywrite(wd, &bh, sizeof(BHead));
+  mywrite_bhead(wd, &bh, data);
   mywrite(wd, data, size_t(bh.len));
 }
 
@@ -721,7 +1146,7 @@ static void writedata(WriteData *wd, int filecode, size_t len, const void *adr)
   bh.SDNAnr = 0;
   bh.len = int(len);
 
-  mywrite(wd, &bh, sizeof(BHead));
+  mywrite_bhead(wd, &bh, adr);
   mywrite(wd, adr, len);
 }
 
@@ -1358,7 +1783,7 @@ static bool write_file_handle(Main *mainvar,
   /* end of file */
   memset(&bhead, 0, sizeof(BHead));
   bhead.code = BLO_CODE_ENDB;
-  mywrite(wd, &bhead, sizeof(BHead));
+  mywrite_bhead(wd, &bhead, nullptr);
 
   blo_join_main(&mainlist);
 
@@ -1451,12 +1876,16 @@ bool BLO_write_file(Main *mainvar,
 
   ww_handle_init((write_flags & G_FILE_COMPRESS) ? WW_WRAP_ZSTD : WW_WRAP_NONE, &ww);
 
-  if (ww.open(&ww, tempname) == false) {
+  if (ww.open(&ww, tempname, WW_OPEN_FLAGS) == false) {
     BKE_reportf(
         reports, RPT_ERROR, "Cannot open file %s for writing: %s", tempname, strerror(errno));
     return false;
   }
 
+  if (params->use_incremental && ww.reuse_from_file != nullptr) {
+    ww.reuse_from_file(&ww, filepath);
+  }
+
   if (remap_mode == BLO_WRITE_PATH_REMAP_ABSOLUTE) {
     /* Paths will already be absolute, no remapping to do. */
     if (relbase_valid == false) {
@@ -1580,6 +2009,69 @@ bool BLO_write_file(Main *mainvar,
   return true;
 }
 
+bool BLO_write_file_raw(const void *data,
+                        const size_t data_len,
+                        const char *filepath,
+                        const bool use_compress,
+                        const size_t write_rate_max,
+                        const bool *stop,
+                        size_t *r_file_size)
+{
+  char tempname[FILE_MAX + 1];
+  SNPRINTF(tempname, "%s@", filepath);
+
+  /* This is used for auto-save, which writes to the shared temporary directory. Don't follow a
+   * symbolic link placed at the temporary file name and don't write into a file created by
+   * someone else (CVE-2008-1103). A file left over by an interrupted save is removed first. */
+  int oflags = WW_OPEN_FLAGS | O_EXCL;
+#ifdef O_NOFOLLOW
+  oflags |= O_NOFOLLOW;
+#endif
+  remove(tempname);
+
+  WriteWrap ww;
+  ww_handle_init(use_compress ? WW_WRAP_ZSTD : WW_WRAP_NONE, &ww);
+  if (ww.open(&ww, tempname, oflags) == false) {
+    return false;
+  }
+
+  WriteData *wd = writedata_new(&ww);
+  /* The blocks of the data are not known here. */
+  wd->block_index.use = false;
+
+  const double time_start = PIL_check_seconds_timer();
+  size_t written_len = 0;
+  while (written_len < data_len && !(stop && *stop)) {
+    const size_t len = std::min(data_len - written_len, size_t(ZSTD_CHUNK_SIZE));
+    mywrite(wd, static_cast<const char *>(data) + written_len, len);
+    written_len += len;
+
+    if (write_rate_max != 0) {
+      const double time_expected = double(written_len) / double(write_rate_max);
+      const double time_elapsed = PIL_check_seconds_timer() - time_start;
+      if (time_elapsed < time_expected) {
+        PIL_sleep_ms(int((time_expected - time_elapsed) * 1000.0));
+      }
+    }
+  }
+
+  bool err = mywrite_end(wd);
+  err |= !ww.close(&ww);
+  if (err || written_len < data_len) {
+    remove(tempname);
+    return false;
+  }
+
+  if (r_file_size) {
+    *r_file_size = BLI_file_size(tempname);
+  }
+  if (BLI_rename_overwrite(tempname, filepath) != 0) {
+    remove(tempname);
+    return false;
+  }
+  return true;
+}
+
 bool BLO_write_file_mem(Main *mainvar, MemFile *compare, MemFile *current, int write_flags)
 {
   bool use_userdef = false;
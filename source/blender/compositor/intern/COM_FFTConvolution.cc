@@ -0,0 +1,573 @@
+/* SPDX-FileCopyrightText: 2023 Blender Foundation
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+#include "BLI_array.hh"
+#include "BLI_hash_mm2a.h"
+#include "BLI_math_base.h"
+#include "BLI_math_vector_types.hh"
+#include "BLI_task.hh"
+#include "BLI_vector.hh"
+
+#include "COM_FFTConvolution.h"
+#include "COM_MemoryBuffer.h"
+
+namespace blender::compositor {
+
+/*
+ *  2D Fast Hartley Transform, used for convolution
+ */
+
+using fREAL = float;
+
+/* Returns next highest power of 2 of x, as well its log2 in L2. */
+static uint next_pow2(uint x, uint *L2)
+{
+  uint pw, x_notpow2 = x & (x - 1);
+  *L2 = 0;
+  while (x >>= 1) {
+    ++(*L2);
+  }
+  pw = 1 << (*L2);
+  if (x_notpow2) {
+    (*L2)++;
+    pw <<= 1;
+  }
+  return pw;
+}
+
+//------------------------------------------------------------------------------
+
+/* From FXT library by Joerg Arndt, faster in order bit-reversal
+ * use: `r = revbin_upd(r, h)` where `h = N>>1`. */
+static uint revbin_upd(uint r, uint h)
+{
+  while (!((r ^= h) & h)) {
+    h >>= 1;
+  }
+  return r;
+}
+//------------------------------------------------------------------------------
+static void FHT(fREAL *data, uint M, uint inverse)
+{
+  double tt, fc, dc, fs, ds, a = M_PI;
+  fREAL t1, t2;
+  int n2, bd, bl, istep, k, len = 1 << M, n = 1;
+
+  int i, j = 0;
+  uint Nh = len >> 1;
+  for (i = 1; i < (len - 1); i++) {
+    j = revbin_upd(j, Nh);
+    if (j > i) {
+      t1 = data[i];
+      data[i] = data[j];
+      data[j] = t1;
+    }
+  }
+
+  do {
+    fREAL *data_n = &data[n];
+
+    istep = n << 1;
+    for (k = 0; k < len; k += istep) {
+      t1 = data_n[k];
+      data_n[k] = data[k] - t1;
+      data[k] += t1;
+    }
+
+    n2 = n >> 1;
+    if (n > 2) {
+      fc = dc = cos(a);
+      fs = ds = sqrt(1.0 - fc * fc);  // sin(a);
+      bd = n - 2;
+      for (bl = 1; bl < n2; bl++) {
+        fREAL *data_nbd = &data_n[bd];
+        fREAL *data_bd = &data[bd];
+        for (k = bl; k < len; k += istep) {
+          t1 = fc * double(data_n[k]) + fs * double(data_nbd[k]);
+          t2 = fs * double(data_n[k]) - fc * double(data_nbd[k]);
+          data_n[k] = data[k] - t1;
+          data_nbd[k] = data_bd[k] - t2;
+          data[k] += t1;
+          data_bd[k] += t2;
+        }
+        tt = fc * dc - fs * ds;
+        fs = fs * dc + fc * ds;
+        fc = tt;
+        bd -= 2;
+      }
+    }
+
+    if (n > 1) {
+      for (k = n2; k < len; k += istep) {
+        t1 = data_n[k];
+        data_n[k] = data[k] - t1;
+        data[k] += t1;
+      }
+    }
+
+    n = istep;
+    a *= 0.5;
+  } while (n < len);
+
+  if (inverse) {
+    fREAL sc = (fREAL)1 / (fREAL)len;
+    for (k = 0; k < len; k++) {
+      data[k] *= sc;
+    }
+  }
+}
+//------------------------------------------------------------------------------
+/* Transform rows `[0, num_rows)` of length `1 << M` in parallel. */
+static void FHT_rows(fREAL *data, uint M, uint num_rows, uint inverse)
+{
+  const uint row_len = 1 << M;
+  threading::parallel_for(IndexRange(num_rows), 16, [&](const IndexRange rows) {
+    for (const int64_t row : rows) {
+      FHT(&data[row_len * row], M, inverse);
+    }
+  });
+}
+//------------------------------------------------------------------------------
+/* 2D Fast Hartley Transform, Mx/My -> log2 of width/height,
+ * nzp -> the row where zero pad data starts,
+ * inverse -> see above. */
+static void FHT2D(fREAL *data, uint Mx, uint My, uint nzp, uint inverse)
+{
+  uint i, j, Nx, Ny, maxy;
+
+  Nx = 1 << Mx;
+  Ny = 1 << My;
+
+  /* Rows (forward transform skips 0 pad data). */
+  maxy = inverse ? Ny : nzp;
+  FHT_rows(data, Mx, maxy, inverse);
+
+  /* Transpose data. */
+  if (Nx == Ny) { /* Square. */
+    for (j = 0; j < Ny; j++) {
+      for (i = j + 1; i < Nx; i++) {
+        uint op = i + (j << Mx), np = j + (i << My);
+        std::swap(data[op], data[np]);
+      }
+    }
+  }
+  else { /* Rectangular. */
+    uint k, Nym = Ny - 1, stm = 1 << (Mx + My);
+    for (i = 0; stm > 0; i++) {
+#define PRED(k) (((k & Nym) << Mx) + (k >> My))
+      for (j = PRED(i); j > i; j = PRED(j)) {
+        /* Pass. */
+      }
+      if (j < i) {
+        continue;
+      }
+      for (k = i, j = PRED(i); j != i; k = j, j = PRED(j), stm--) {
+        std::swap(data[j], data[k]);
+      }
+#undef PRED
+      stm--;
+    }
+  }
+
+  std::swap(Nx, Ny);
+  std::swap(Mx, My);
+
+  /* Now columns == transposed rows. */
+  FHT_rows(data, Mx, Ny, inverse);
+
+  /* Finalize. */
+  for (j = 0; j <= (Ny >> 1); j++) {
+    uint jm = (Ny - j) & (Ny - 1);
+    uint ji = j << Mx;
+    uint jmi = jm << Mx;
+    for (i = 0; i <= (Nx >> 1); i++) {
+      uint im = (Nx - i) & (Nx - 1);
+      fREAL A = data[ji + i];
+      fREAL B = data[jmi + i];
+      fREAL C = data[ji + im];
+      fREAL D = data[jmi + im];
+      fREAL E = (fREAL)0.5 * ((A + D) - (B + C));
+      data[ji + i] = A - E;
+      data[jmi + i] = B + E;
+      data[ji + im] = C + E;
+      data[jmi + im] = D - E;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+/* 2D convolution calc, d1 *= d2, M/N - > log2 of width/height. */
+static void fht_convolve(fREAL *d1, const fREAL *d2, uint M, uint N)
+{
+  fREAL a, b;
+  uint i, j, k, L, mj, mL;
+  uint m = 1 << M, n = 1 << N;
+  uint m2 = 1 << (M - 1), n2 = 1 << (N - 1);
+  uint mn2 = m << (N - 1);
+
+  d1[0] *= d2[0];
+  d1[mn2] *= d2[mn2];
+  d1[m2] *= d2[m2];
+  d1[m2 + mn2] *= d2[m2 + mn2];
+  for (i = 1; i < m2; i++) {
+    k = m - i;
+    a = d1[i] * d2[i] - d1[k] * d2[k];
+    b = d1[k] * d2[i] + d1[i] * d2[k];
+    d1[i] = (b + a) * (fREAL)0.5;
+    d1[k] = (b - a) * (fREAL)0.5;
+    a = d1[i + mn2] * d2[i + mn2] - d1[k + mn2] * d2[k + mn2];
+    b = d1[k + mn2] * d2[i + mn2] + d1[i + mn2] * d2[k + mn2];
+    d1[i + mn2] = (b + a) * (fREAL)0.5;
+    d1[k + mn2] = (b - a) * (fREAL)0.5;
+  }
+  for (j = 1; j < n2; j++) {
+    L = n - j;
+    mj = j << M;
+    mL = L << M;
+    a = d1[mj] * d2[mj] - d1[mL] * d2[mL];
+    b = d1[mL] * d2[mj] + d1[mj] * d2[mL];
+    d1[mj] = (b + a) * (fREAL)0.5;
+    d1[mL] = (b - a) * (fREAL)0.5;
+    a = d1[m2 + mj] * d2[m2 + mj] - d1[m2 + mL] * d2[m2 + mL];
+    b = d1[m2 + mL] * d2[m2 + mj] + d1[m2 + mj] * d2[m2 + mL];
+    d1[m2 + mj] = (b + a) * (fREAL)0.5;
+    d1[m2 + mL] = (b - a) * (fREAL)0.5;
+  }
+  for (i = 1; i < m2; i++) {
+    k = m - i;
+    for (j = 1; j < n2; j++) {
+      L = n - j;
+      mj = j << M;
+      mL = L << M;
+      a = d1[i + mj] * d2[i + mj] - d1[k + mL] * d2[k + mL];
+      b = d1[k + mL] * d2[i + mj] + d1[i + mj] * d2[k + mL];
+      d1[i + mj] = (b + a) * (fREAL)0.5;
+      d1[k + mL] = (b - a) * (fREAL)0.5;
+      a = d1[i + mL] * d2[i + mL] - d1[k + mj] * d2[k + mj];
+      b = d1[k + mj] * d2[i + mL] + d1[i + mL] * d2[k + mj];
+      d1[i + mL] = (b + a) * (fREAL)0.5;
+      d1[k + mj] = (b - a) * (fREAL)0.5;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+/**
+ * Transformed convolution kernel, shared between all convolutions with the same kernel.
+ */
+struct KernelSpectrum {
+  int width;
+  int height;
+  int num_channels;
+  /** Copy of the kernel elements, used to match kernels exactly on cache lookup. */
+  Array<float> elements;
+  uint32_t hash;
+
+  /** Size of the transform and its log2. */
+  uint fft_width;
+  uint fft_height;
+  uint log2_width;
+  uint log2_height;
+  /** Transformed kernel, a plane of `fft_width * fft_height` elements per channel. */
+  Array<fREAL> planes;
+  /** Sum of the kernel weights per channel. */
+  Array<float> weights;
+
+  int64_t fft_size() const
+  {
+    return int64_t(fft_width) * fft_height;
+  }
+
+  const fREAL *plane(const int channel) const
+  {
+    return &planes[channel * fft_size()];
+  }
+
+  int64_t size_in_bytes() const
+  {
+    return elements.size() * sizeof(float) + planes.size() * sizeof(fREAL);
+  }
+
+  bool matches(const KernelSpectrum &other) const
+  {
+    return hash == other.hash && width == other.width && height == other.height &&
+           num_channels == other.num_channels &&
+           memcmp(elements.data(), other.elements.data(), elements.size() * sizeof(float)) == 0;
+  }
+};
+
+/** Memory budget of the kernel cache, least recently used spectra are freed first. */
+static constexpr int64_t KERNEL_CACHE_MAX_BYTES = 256 * 1024 * 1024;
+
+static struct {
+  std::mutex mutex;
+  /** Ordered from least to most recently used. */
+  Vector<std::shared_ptr<const KernelSpectrum>> spectra;
+} g_kernel_cache;
+
+static void compute_kernel_spectrum(KernelSpectrum &spectrum)
+{
+  /* Convolution result of a block with the kernel must fit the transform without wrapping. */
+  spectrum.fft_width = next_pow2(max_ii(2 * spectrum.width - 1, 4), &spectrum.log2_width);
+  spectrum.fft_height = next_pow2(max_ii(2 * spectrum.height - 1, 4), &spectrum.log2_height);
+  spectrum.planes = Array<fREAL>(spectrum.num_channels * spectrum.fft_size(), 0.0f);
+  spectrum.weights = Array<float>(spectrum.num_channels, 0.0f);
+
+  threading::parallel_for(IndexRange(spectrum.num_channels), 1, [&](const IndexRange channels) {
+    for (const int64_t channel : channels) {
+      fREAL *plane = &spectrum.planes[channel * spectrum.fft_size()];
+      float weight = 0.0f;
+      for (int y = 0; y < spectrum.height; y++) {
+        fREAL *row = &plane[y * spectrum.fft_width];
+        const float *elem = &spectrum.elements[y * spectrum.width * spectrum.num_channels];
+        for (int x = 0; x < spectrum.width; x++) {
+          row[x] = elem[channel];
+          weight += elem[channel];
+          elem += spectrum.num_channels;
+        }
+      }
+      spectrum.weights[channel] = weight;
+      FHT2D(plane, spectrum.log2_width, spectrum.log2_height, spectrum.height, 0);
+    }
+  });
+}
+
+static std::shared_ptr<const KernelSpectrum> get_kernel_spectrum(const MemoryBuffer &kernel,
+                                                                 const int num_channels)
+{
+  std::shared_ptr<KernelSpectrum> spectrum = std::make_shared<KernelSpectrum>();
+  spectrum->width = kernel.get_width();
+  spectrum->height = kernel.get_height();
+  spectrum->num_channels = num_channels;
+  spectrum->elements = Array<float>(int64_t(spectrum->width) * spectrum->height * num_channels);
+
+  const rcti &kernel_rect = kernel.get_rect();
+  float *dst = spectrum->elements.data();
+  for (int y = kernel_rect.ymin; y < kernel_rect.ymax; y++) {
+    const float *elem = kernel.get_elem(kernel_rect.xmin, y);
+    for (int x = kernel_rect.xmin; x < kernel_rect.xmax; x++) {
+      memcpy(dst, elem, sizeof(float) * num_channels);
+      dst += num_channels;
+      elem += kernel.elem_stride;
+    }
+  }
+  spectrum->hash = BLI_hash_mm2(reinterpret_cast<const uchar *>(spectrum->elements.data()),
+                                spectrum->elements.size() * sizeof(float),
+                                num_channels);
+
+  {
+    std::scoped_lock lock(g_kernel_cache.mutex);
+    Vector<std::shared_ptr<const KernelSpectrum>> &spectra = g_kernel_cache.spectra;
+    for (const int64_t i : spectra.index_range()) {
+      if (spectra[i]->matches(*spectrum)) {
+        std::shared_ptr<const KernelSpectrum> cached = spectra[i];
+        spectra.remove(i);
+        spectra.append(cached);
+        return cached;
+      }
+    }
+  }
+
+  compute_kernel_spectrum(*spectrum);
+
+  std::scoped_lock lock(g_kernel_cache.mutex);
+  Vector<std::shared_ptr<const KernelSpectrum>> &spectra = g_kernel_cache.spectra;
+  int64_t cached_bytes = spectrum->size_in_bytes();
+  for (const std::shared_ptr<const KernelSpectrum> &cached : spectra) {
+    cached_bytes += cached->size_in_bytes();
+  }
+  while (!spectra.is_empty() && cached_bytes > KERNEL_CACHE_MAX_BYTES) {
+    cached_bytes -= spectra.first()->size_in_bytes();
+    spectra.remove(0);
+  }
+  spectra.append(spectrum);
+  return spectrum;
+}
+
+void fft_convolution_free_cache()
+{
+  std::scoped_lock lock(g_kernel_cache.mutex);
+  g_kernel_cache.spectra.clear_and_shrink();
+}
+
+//------------------------------------------------------------------------------
+
+/* Convolve a zero padded block of data with one channel of the kernel, in place. */
+static void convolve_block(fREAL *data,
+                           const KernelSpectrum &spectrum,
+                           const int channel,
+                           const uint nonzero_rows)
+{
+  FHT2D(data, spectrum.log2_width, spectrum.log2_height, nonzero_rows, 0);
+  /* FHT2D transposed data, row/col now swapped. */
+  fht_convolve(data, spectrum.plane(channel), spectrum.log2_height, spectrum.log2_width);
+  FHT2D(data, spectrum.log2_height, spectrum.log2_width, 0, 1);
+  /* Data again transposed, so in order again. */
+}
+
+/* Add a convolved block with its first element at (origin_x, origin_y) to the area plane. */
+static void overlap_add(const fREAL *data,
+                        const KernelSpectrum &spectrum,
+                        const int origin_x,
+                        const int origin_y,
+                        const rcti &area,
+                        float *plane)
+{
+  const int area_width = BLI_rcti_size_x(&area);
+  const int xmin = max_ii(origin_x, area.xmin);
+  const int xmax = min_ii(origin_x + int(spectrum.fft_width), area.xmax);
+  const int ymin = max_ii(origin_y, area.ymin);
+  const int ymax = min_ii(origin_y + int(spectrum.fft_height), area.ymax);
+  for (int y = ymin; y < ymax; y++) {
+    const fREAL *src = &data[int64_t(y - origin_y) * spectrum.fft_width];
+    float *dst = &plane[int64_t(y - area.ymin) * area_width - area.xmin];
+    for (int x = xmin; x < xmax; x++) {
+      dst[x] += src[x - origin_x];
+    }
+  }
+}
+
+void fft_convolve(const MemoryBuffer &image,
+                  const MemoryBuffer &kernel,
+                  const int num_channels,
+                  const bool normalize_by_coverage,
+                  MemoryBuffer &output,
+                  const rcti &area)
+{
+  BLI_assert(!image.is_a_single_elem() && !kernel.is_a_single_elem());
+  BLI_assert(num_channels <= image.get_num_channels());
+  BLI_assert(num_channels <= kernel.get_num_channels());
+
+  const std::shared_ptr<const KernelSpectrum> spectrum_ptr = get_kernel_spectrum(kernel,
+                                                                                 num_channels);
+  const KernelSpectrum &spectrum = *spectrum_ptr;
+
+  const rcti &image_rect = image.get_rect();
+  const int image_width = BLI_rcti_size_x(&image_rect);
+  const int image_height = BLI_rcti_size_y(&image_rect);
+  const int area_width = BLI_rcti_size_x(&area);
+  const int area_height = BLI_rcti_size_y(&area);
+  const int64_t area_size = int64_t(area_width) * area_height;
+  const int center_x = spectrum.width >> 1;
+  const int center_y = spectrum.height >> 1;
+
+  /* Block overlap-add, each block convolved with the kernel fills the whole transform. */
+  const int block_width = spectrum.fft_width + 1 - spectrum.width;
+  const int block_height = spectrum.fft_height + 1 - spectrum.height;
+  const int num_blocks_x = divide_ceil_u(image_width, block_width);
+  const int num_blocks_y = divide_ceil_u(image_height, block_height);
+
+  Array<float> accum(num_channels * area_size, 0.0f);
+  Array<float> coverage(normalize_by_coverage ? num_channels * area_size : 0, 0.0f);
+
+  /* Coverage of blocks fully inside of the image is the same for all of them. */
+  const bool has_full_blocks = image_width >= block_width && image_height >= block_height;
+  Array<fREAL> full_block_coverage;
+  if (normalize_by_coverage && has_full_blocks) {
+    full_block_coverage = Array<fREAL>(num_channels * spectrum.fft_size(), 0.0f);
+    for (const int channel : IndexRange(num_channels)) {
+      fREAL *data = &full_block_coverage[channel * spectrum.fft_size()];
+      for (int y = 0; y < block_height; y++) {
+        std::fill_n(&data[y * spectrum.fft_width], block_width, 1.0f);
+      }
+      convolve_block(data, spectrum, channel, block_height);
+    }
+  }
+
+  /* Output footprints of blocks with the same parity in both axes never overlap, as blocks are
+   * at least as large as the kernel. Blocks of each parity are convolved in parallel. */
+  for (const int parity : IndexRange(4)) {
+    Vector<int2> blocks;
+    for (int block_y = parity / 2; block_y < num_blocks_y; block_y += 2) {
+      for (int block_x = parity % 2; block_x < num_blocks_x; block_x += 2) {
+        const int origin_x = image_rect.xmin + block_x * block_width - center_x;
+        const int origin_y = image_rect.ymin + block_y * block_height - center_y;
+        if (origin_x < area.xmax && origin_x + int(spectrum.fft_width) > area.xmin &&
+            origin_y < area.ymax && origin_y + int(spectrum.fft_height) > area.ymin)
+        {
+          blocks.append(int2(block_x, block_y));
+        }
+      }
+    }
+
+    const IndexRange all_tasks(blocks.size() * num_channels);
+    threading::parallel_for(all_tasks, 1, [&](const IndexRange tasks) {
+      Array<fREAL> data(spectrum.fft_size());
+      for (const int64_t task : tasks) {
+        const int2 block = blocks[task / num_channels];
+        const int channel = task % num_channels;
+        const int xmin = image_rect.xmin + block.x * block_width;
+        const int ymin = image_rect.ymin + block.y * block_height;
+        const int xmax = min_ii(xmin + block_width, image_rect.xmax);
+        const int ymax = min_ii(ymin + block_height, image_rect.ymax);
+        const int origin_x = xmin - center_x;
+        const int origin_y = ymin - center_y;
+
+        data.fill(0.0f);
+        for (int y = ymin; y < ymax; y++) {
+          fREAL *row = &data[(y - ymin) * spectrum.fft_width];
+          const float *elem = image.get_elem(xmin, y);
+          for (int x = xmin; x < xmax; x++) {
+            row[x - xmin] = elem[channel];
+            elem += image.elem_stride;
+          }
+        }
+        convolve_block(data.data(), spectrum, channel, block_height);
+        overlap_add(data.data(), spectrum, origin_x, origin_y, area, &accum[channel * area_size]);
+
+        if (!normalize_by_coverage) {
+          continue;
+        }
+        float *coverage_plane = &coverage[channel * area_size];
+        if (xmax - xmin == block_width && ymax - ymin == block_height) {
+          overlap_add(&full_block_coverage[channel * spectrum.fft_size()],
+                      spectrum,
+                      origin_x,
+                      origin_y,
+                      area,
+                      coverage_plane);
+          continue;
+        }
+        data.fill(0.0f);
+        for (int y = ymin; y < ymax; y++) {
+          std::fill_n(&data[(y - ymin) * spectrum.fft_width], xmax - xmin, 1.0f);
+        }
+        convolve_block(data.data(), spectrum, channel, block_height);
+        overlap_add(data.data(), spectrum, origin_x, origin_y, area, coverage_plane);
+      }
+    });
+  }
+
+  const int output_channels = output.get_num_channels();
+  threading::parallel_for(IndexRange(area_height), 32, [&](const IndexRange rows) {
+    for (const int64_t y : rows) {
+      float *out = output.get_elem(area.xmin, area.ymin + y);
+      for (int x = 0; x < area_width; x++) {
+        const int64_t index = y * area_width + x;
+        for (int channel = 0; channel < num_channels; channel++) {
+          float value = accum[channel * area_size + index];
+          if (normalize_by_coverage) {
+            /* Ignore round-off noise of the transform where the kernel doesn't reach the image. */
+            const float weight = coverage[channel * area_size + index];
+            value = weight > spectrum.weights[channel] * 1e-5f ? value / weight : 0.0f;
+          }
+          out[channel] = value;
+        }
+        for (int channel = num_channels; channel < output_channels; channel++) {
+          out[channel] = 0.0f;
+        }
+        out += output.elem_stride;
+      }
+    }
+  });
+}
+
+}  // namespace blender::compositor
@@ -0,0 +1,43 @@
+/* SPDX-FileCopyrightText: 2023 Blender Foundation
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+#include "BLI_rect.h"
+
+namespace blender::compositor {
+
+class MemoryBuffer;
+
+/**
+ * Convolution of color buffers in the frequency domain.
+ *
+ * Uses a 2D Fast Hartley Transform with block overlap-add, so the cost per pixel grows with the
+ * logarithm of the kernel size instead of its area. Blocks and channels are transformed in
+ * parallel. The transformed kernel is cached by content, convolving again with the same kernel
+ * (e.g. on every frame of an animation) skips the kernel transform.
+ *
+ * Kernel element `(kernel_width / 2, kernel_height / 2)` is the center tap, and the kernel is
+ * applied as a true convolution:
+ * `output(x, y) = sum(image(x + center_x - i, y + center_y - j) * kernel(i, j))`.
+ * Pixels outside of the image are treated as zero.
+ *
+ * \param num_channels: Number of leading channels to convolve, each with the matching kernel
+ * channel. Remaining output channels are set to zero.
+ * \param normalize_by_coverage: Divide each result by the sum of the kernel weights that overlap
+ * the image, which matches a direct gather that skips pixels outside of the image.
+ */
+void fft_convolve(const MemoryBuffer &image,
+                  const MemoryBuffer &kernel,
+                  int num_channels,
+                  bool normalize_by_coverage,
+                  MemoryBuffer &output,
+                  const rcti &area);
+
+/**
+ * Free all cached kernel spectra.
+ */
+void fft_convolution_free_cache();
+
+}  // namespace blender::compositor
@@ -2,6 +2,8 @@
  *
  * SPDX-License-Identifier: GPL-2.0-or-later */
 
+#include <atomic>
+
 #include "COM_MemoryBuffer.h"
 
 #include "COM_MemoryProxy.h"
@@ -30,15 +32,43 @@ static rcti create_rect(const int width, const int height)
   return rect;
 }
 
+/* Bytes allocated by buffers owning their data, and the highest value reached since the last
+ * reset. Used for compositor memory statistics. */
+static std::atomic<int64_t> g_allocated_bytes = 0;
+static std::atomic<int64_t> g_peak_allocated_bytes = 0;
+
+static void track_allocation(const int64_t bytes)
+{
+  const int64_t allocated = g_allocated_bytes.fetch_add(bytes) + bytes;
+  int64_t peak = g_peak_allocated_bytes.load();
+  while (allocated > peak && !g_peak_allocated_bytes.compare_exchange_weak(peak, allocated)) {
+  }
+}
+
+static void track_free(const int64_t bytes)
+{
+  g_allocated_bytes.fetch_sub(bytes);
+}
+
+int64_t MemoryBuffer::get_peak_allocated_bytes()
+{
+  return g_peak_allocated_bytes.load();
+}
+
+void MemoryBuffer::reset_peak_allocated_bytes()
+{
+  g_peak_allocated_bytes.store(g_allocated_bytes.load());
+}
+
 MemoryBuffer::MemoryBuffer(MemoryProxy *memory_proxy, const rcti &rect, MemoryBufferState state)
 {
   rect_ = rect;
   is_a_single_elem_ = false;
   memory_proxy_ = memory_proxy;
   num_channels_ = COM_data_type_num_channels(memory_proxy->get_data_type());
-  buffer_ = (float *)MEM_mallocN_aligned(
-      sizeof(float) * buffer_len() * num_channels_, 16, "COM_MemoryBuffer");
+  buffer_ = (float *)MEM_mallocN_aligned(get_allocated_bytes(), 16, "COM_MemoryBuffer");
   owns_data_ = true;
+  track_allocation(get_allocated_bytes());
   state_ = state;
   datatype_ = memory_proxy->get_data_type();
 
@@ -51,9 +81,9 @@ MemoryBuffer::MemoryBuffer(DataType data_type, const rcti &rect, bool is_a_singl
   is_a_single_elem_ = is_a_single_elem;
   memory_proxy_ = nullptr;
   num_channels_ = COM_data_type_num_channels(data_type);
-  buffer_ = (float *)MEM_mallocN_aligned(
-      sizeof(float) * buffer_len() * num_channels_, 16, "COM_MemoryBuffer");
+  buffer_ = (float *)MEM_mallocN_aligned(get_allocated_bytes(), 16, "COM_MemoryBuffer");
   owns_data_ = true;
+  track_allocation(get_allocated_bytes());
   state_ = MemoryBufferState::Temporary;
   datatype_ = data_type;
 
@@ -123,6 +153,15 @@ BuffersIterator<float> MemoryBuffer::iterate_with(Span<MemoryBuffer *> inputs, c
   return builder.build();
 }
 
+float *MemoryBuffer::release_ownership_buffer()
+{
+  if (owns_data_) {
+    track_free(get_allocated_bytes());
+  }
+  owns_data_ = false;
+  return buffer_;
+}
+
 MemoryBuffer *MemoryBuffer::inflate() const
 {
   BLI_assert(is_a_single_elem());
@@ -169,6 +208,7 @@ float MemoryBuffer::get_max_value(const rcti &rect) const
 MemoryBuffer::~MemoryBuffer()
 {
   if (buffer_ && owns_data_) {
+    track_free(get_allocated_bytes());
     MEM_freeN(buffer_);
     buffer_ = nullptr;
   }
@@ -366,11 +366,10 @@ class MemoryBuffer {
     return buffer_;
   }
 
-  float *release_ownership_buffer()
-  {
-    owns_data_ = false;
-    return buffer_;
-  }
+  /**
+   * Transfer ownership of the buffer data to the caller.
+   */
+  float *release_ownership_buffer();
 
   /**
    * Converts a single elem buffer to a full size buffer (allocates memory for all
@@ -662,6 +661,13 @@ class MemoryBuffer {
   float get_max_value() const;
   float get_max_value(const rcti &rect) const;
 
+  /**
+   * Highest number of bytes allocated by all memory buffers at the same time, since the last call
+   * to #reset_peak_allocated_bytes. Buffers wrapping external data are not counted.
+   */
+  static int64_t get_peak_allocated_bytes();
+  static void reset_peak_allocated_bytes();
+
  private:
   void set_strides();
   const int buffer_len() const
@@ -669,6 +675,11 @@ class MemoryBuffer {
     return get_memory_width() * get_memory_height();
   }
 
+  int64_t get_allocated_bytes() const
+  {
+    return int64_t(sizeof(float)) * buffer_len() * num_channels_;
+  }
+
   void clear_elem(float *out) const
   {
     memset(out, 0, num_channels_ * sizeof(float));
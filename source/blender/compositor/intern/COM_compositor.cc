@@ -2,15 +2,23 @@
  *
  * SPDX-License-Identifier: GPL-2.0-or-later */
 
+#include <cinttypes>
+
+#include "BLI_string.h"
 #include "BLI_threads.h"
 
+#include "PIL_time.h"
+
 #include "BLT_translation.h"
 
+#include "BKE_global.h"
 #include "BKE_node.hh"
 #include "BKE_node_runtime.hh"
 #include "BKE_scene.h"
 
 #include "COM_ExecutionSystem.h"
+#include "COM_FFTConvolution.h"
+#include "COM_MemoryBuffer.h"
 #include "COM_WorkScheduler.h"
 #include "COM_compositor.h"
 
@@ -43,6 +51,30 @@ static void compositor_init_node_previews(const RenderData *render_data, bNodeTr
   blender::bke::node_preview_init_tree(node_tree, preview_width, preview_height);
 }
 
+/* Print execution statistics, in a format that is easy to parse by benchmark scripts. */
+static void compositor_print_statistics(const RenderData *render_data,
+                                        const bNodeTree *node_tree,
+                                        const double elapsed_time)
+{
+  int width, height;
+  BKE_render_resolution(render_data, false, &width, &height);
+  const double megapixels = double(width) * double(height) / 1e6;
+  const int64_t peak_bytes = blender::compositor::MemoryBuffer::get_peak_allocated_bytes();
+
+  char peak_str[BLI_STR_FORMAT_INT64_BYTE_UNIT_SIZE];
+  BLI_str_format_byte_unit(peak_str, peak_bytes, false);
+
+  printf("Compositor: %s %dx%d in %.4f s (%.2f Mpix/s), peak buffer memory %s (%" PRId64
+         " bytes)\n",
+         node_tree->execution_mode == NTREE_EXECUTION_MODE_FULL_FRAME ? "full-frame" : "tiled",
+         width,
+         height,
+         elapsed_time,
+         elapsed_time > 0.0 ? megapixels / elapsed_time : 0.0,
+         peak_str,
+         peak_bytes);
+}
+
 static void compositor_reset_node_tree_status(bNodeTree *node_tree)
 {
   node_tree->runtime->progress(node_tree->runtime->prh, 0.0);
@@ -90,6 +122,12 @@ void COM_execute(Render *render,
     blender::compositor::WorkScheduler::initialize(use_opencl,
                                                    BKE_render_num_threads(render_data));
 
+    const bool print_statistics = (G.debug & G_DEBUG_COMPOSITOR) != 0;
+    const double start_time = print_statistics ? PIL_check_seconds_timer() : 0.0;
+    if (print_statistics) {
+      blender::compositor::MemoryBuffer::reset_peak_allocated_bytes();
+    }
+
     /* Execute. */
     const bool twopass = (node_tree->flag & NTREE_TWO_PASS) && !rendering;
     if (twopass) {
@@ -103,9 +141,16 @@ void COM_execute(Render *render,
       }
     }
 
-    blender::compositor::ExecutionSystem system(
-        render_data, scene, node_tree, rendering, false, view_name);
-    system.execute();
+    {
+      blender::compositor::ExecutionSystem system(
+          render_data, scene, node_tree, rendering, false, view_name);
+      system.execute();
+    }
+
+    if (print_statistics && !node_tree->runtime->test_break(node_tree->runtime->tbh)) {
+      compositor_print_statistics(
+          render_data, node_tree, PIL_check_seconds_timer() - start_time);
+    }
   }
 
   BLI_mutex_unlock(&g_compositor.mutex);
@@ -120,4 +165,5 @@ void COM_deinitialize()
     BLI_mutex_unlock(&g_compositor.mutex);
     BLI_mutex_end(&g_compositor.mutex);
   }
+  blender::compositor::fft_convolution_free_cache();
 }
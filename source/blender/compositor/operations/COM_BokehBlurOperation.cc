@@ -4,6 +4,7 @@
 
 #include "COM_BokehBlurOperation.h"
 #include "COM_ConstantOperation.h"
+#include "COM_FFTConvolution.h"
 
 #include "COM_OpenCLDevice.h"
 
@@ -32,6 +33,7 @@ BokehBlurOperation::BokehBlurOperation()
   input_bounding_box_reader_ = nullptr;
 
   extend_bounds_ = false;
+  use_fft_ = false;
 }
 
 void BokehBlurOperation::init_data()
@@ -307,10 +309,64 @@ void BokehBlurOperation::get_area_of_interest(const int input_idx,
   }
 }
 
+bool BokehBlurOperation::can_use_fft(const int pixel_size, Span<MemoryBuffer *> inputs)
+{
+  /* Lower qualities skip pixels, keep their faster and coarser result. */
+  if (pixel_size < FFT_MIN_RADIUS || get_step() != 1) {
+    return false;
+  }
+  if (inputs[IMAGE_INPUT_INDEX]->is_a_single_elem()) {
+    return false;
+  }
+  /* The whole area has to be blurred. */
+  const MemoryBuffer *bounding_input = inputs[BOUNDING_BOX_INPUT_INDEX];
+  return bounding_input->is_a_single_elem() && *bounding_input->get_elem(0, 0) > 0.0f;
+}
+
+void BokehBlurOperation::update_memory_buffer_started(MemoryBuffer *output,
+                                                      const rcti &area,
+                                                      Span<MemoryBuffer *> inputs)
+{
+  const float max_dim = MAX2(this->get_width(), this->get_height());
+  const int pixel_size = size_ * max_dim / 100.0f;
+  use_fft_ = can_use_fft(pixel_size, inputs);
+  if (!use_fft_) {
+    return;
+  }
+
+  /* Same weights as the direct convolution below, gathering from offsets `[-pixel_size,
+   * pixel_size)`. The kernel is mirrored, its first row and column stay empty. */
+  const float m = bokehDimension_ / pixel_size;
+  const MemoryBuffer *bokeh_input = inputs[BOKEH_INPUT_INDEX];
+  const int kernel_size = 2 * pixel_size + 1;
+  rcti kernel_rect;
+  BLI_rcti_init(&kernel_rect, 0, kernel_size, 0, kernel_size);
+  MemoryBuffer kernel(DataType::Color, kernel_rect);
+  for (int y = 0; y < kernel_size; y++) {
+    const float v = bokeh_mid_y_ - (pixel_size - y) * m;
+    for (int x = 0; x < kernel_size; x++) {
+      const float u = bokeh_mid_x_ - (pixel_size - x) * m;
+      float *elem = kernel.get_elem(x, y);
+      if (x == 0 || y == 0) {
+        zero_v4(elem);
+        continue;
+      }
+      bokeh_input->read_elem_checked(u, v, elem);
+    }
+  }
+
+  fft_convolve(
+      *inputs[IMAGE_INPUT_INDEX], kernel, COM_DATA_TYPE_COLOR_CHANNELS, true, *output, area);
+}
+
 void BokehBlurOperation::update_memory_buffer_partial(MemoryBuffer *output,
                                                       const rcti &area,
                                                       Span<MemoryBuffer *> inputs)
 {
+  if (use_fft_) {
+    return;
+  }
+
   const float max_dim = MAX2(this->get_width(), this->get_height());
   const int pixel_size = size_ * max_dim / 100.0f;
   const float m = bokehDimension_ / pixel_size;
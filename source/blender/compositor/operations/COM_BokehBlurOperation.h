@@ -23,6 +23,16 @@ class BokehBlurOperation : public MultiThreadedOperation, public QualityStepHelp
   float bokehDimension_;
   bool extend_bounds_;
 
+  /**
+   * Blur radius in pixels from which full frame execution convolves in the frequency domain,
+   * direct convolution cost grows with the square of the radius.
+   */
+  static constexpr int FFT_MIN_RADIUS = 16;
+  /** Whether the current area was computed with #fft_convolve. */
+  bool use_fft_;
+
+  bool can_use_fft(int pixel_size, Span<MemoryBuffer *> inputs);
+
  public:
   BokehBlurOperation();
 
@@ -69,6 +79,9 @@ class BokehBlurOperation : public MultiThreadedOperation, public QualityStepHelp
   void determine_canvas(const rcti &preferred_area, rcti &r_area) override;
 
   void get_area_of_interest(int input_idx, const rcti &output_area, rcti &r_input_area) override;
+  void update_memory_buffer_started(MemoryBuffer *output,
+                                    const rcti &area,
+                                    Span<MemoryBuffer *> inputs) override;
   void update_memory_buffer_partial(MemoryBuffer *output,
                                     const rcti &area,
                                     Span<MemoryBuffer *> inputs) override;
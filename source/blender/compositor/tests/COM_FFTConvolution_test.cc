@@ -0,0 +1,117 @@
+/* SPDX-FileCopyrightText: 2023 Blender Foundation
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BLI_rand.hh"
+
+#include "COM_FFTConvolution.h"
+#include "COM_MemoryBuffer.h"
+
+namespace blender::compositor::tests {
+
+static void fill_random(MemoryBuffer &buf, RandomNumberGenerator &rng)
+{
+  const int64_t size = int64_t(buf.get_width()) * buf.get_height() * buf.get_num_channels();
+  for (float &value : MutableSpan<float>(buf.get_buffer(), size)) {
+    value = rng.get_float();
+  }
+}
+
+/* Reference direct convolution, skipping image pixels outside of the image. */
+static void convolve_direct(const MemoryBuffer &image,
+                            const MemoryBuffer &kernel,
+                            const int x,
+                            const int y,
+                            const int channel,
+                            const bool normalize,
+                            float *r_value)
+{
+  const int center_x = kernel.get_width() / 2;
+  const int center_y = kernel.get_height() / 2;
+  const rcti &image_rect = image.get_rect();
+  float sum = 0.0f;
+  float weight = 0.0f;
+  for (int j = 0; j < kernel.get_height(); j++) {
+    for (int i = 0; i < kernel.get_width(); i++) {
+      const int image_x = x + center_x - i;
+      const int image_y = y + center_y - j;
+      if (image_x < image_rect.xmin || image_x >= image_rect.xmax || image_y < image_rect.ymin ||
+          image_y >= image_rect.ymax)
+      {
+        continue;
+      }
+      const float kernel_value = kernel.get_elem(i, j)[channel];
+      sum += image.get_elem(image_x, image_y)[channel] * kernel_value;
+      weight += kernel_value;
+    }
+  }
+  *r_value = normalize ? (weight > 0.0f ? sum / weight : 0.0f) : sum;
+}
+
+static void test_convolution(const rcti &image_rect,
+                             const int kernel_width,
+                             const int kernel_height)
+{
+  RandomNumberGenerator rng(kernel_width * kernel_height);
+  MemoryBuffer image(DataType::Color, image_rect);
+  rcti kernel_rect;
+  BLI_rcti_init(&kernel_rect, 0, kernel_width, 0, kernel_height);
+  MemoryBuffer kernel(DataType::Color, kernel_rect);
+  fill_random(image, rng);
+  fill_random(kernel, rng);
+
+  /* Include pixels outside of the image reached by the kernel. */
+  rcti area = image_rect;
+  BLI_rcti_pad(&area, 3, 2);
+  MemoryBuffer output(DataType::Color, area);
+
+  for (const bool normalize : {false, true}) {
+    fft_convolve(image, kernel, 3, normalize, output, area);
+    for (int y = area.ymin; y < area.ymax; y++) {
+      for (int x = area.xmin; x < area.xmax; x++) {
+        const float *result = output.get_elem(x, y);
+        for (int channel = 0; channel < 3; channel++) {
+          float expected;
+          convolve_direct(image, kernel, x, y, channel, normalize, &expected);
+          EXPECT_NEAR(result[channel], expected, 1e-4f * std::max(1.0f, expected));
+        }
+        EXPECT_EQ(result[3], 0.0f);
+      }
+    }
+  }
+}
+
+TEST(FFTConvolution, SmallKernel)
+{
+  rcti image_rect;
+  BLI_rcti_init(&image_rect, 0, 37, 0, 23);
+  test_convolution(image_rect, 5, 7);
+}
+
+TEST(FFTConvolution, ImageOffset)
+{
+  rcti image_rect;
+  BLI_rcti_init(&image_rect, -3, 47, 2, 33);
+  test_convolution(image_rect, 9, 4);
+}
+
+TEST(FFTConvolution, KernelLargerThanImage)
+{
+  rcti image_rect;
+  BLI_rcti_init(&image_rect, 0, 10, 0, 10);
+  test_convolution(image_rect, 21, 21);
+}
+
+TEST(FFTConvolution, CachedKernel)
+{
+  rcti image_rect;
+  BLI_rcti_init(&image_rect, 0, 64, 0, 48);
+  test_convolution(image_rect, 16, 16);
+  /* Second run with the same random kernel uses the cached spectrum. */
+  test_convolution(image_rect, 16, 16);
+  fft_convolution_free_cache();
+}
+
+}  // namespace blender::compositor::tests
@@ -149,7 +149,8 @@ static void eyedropper_exit(bContext *C, wmOperator *op)
 
 /* *** eyedropper_color_ helper functions *** */
 
-static bool eyedropper_cryptomatte_sample_renderlayer_fl(RenderLayer *render_layer,
+static bool eyedropper_cryptomatte_sample_renderlayer_fl(RenderResult *render_result,
+                                                         RenderLayer *render_layer,
                                                          const char *prefix,
                                                          const float fpos[2],
                                                          float r_col[3])
@@ -177,6 +178,9 @@ static bool eyedropper_cryptomatte_sample_renderlayer_fl(RenderLayer *render_lay
     if (STRPREFIX(render_pass->name, render_pass_name_prefix) &&
         !STREQLEN(render_pass->name, render_pass_name_prefix, sizeof(render_pass->name)))
     {
+      if (!RE_RenderPassEnsureLoaded(render_pass)) {
+        return false;
+      }
       BLI_assert(render_pass->channels == 4);
       const int x = int(fpos[0] * render_pass->rectx);
       const int y = int(fpos[1] * render_pass->recty);
@@ -204,7 +208,8 @@ static bool eyedropper_cryptomatte_sample_render_fl(const bNode *node,
     if (rr) {
       LISTBASE_FOREACH (ViewLayer *, view_layer, &scene->view_layers) {
         RenderLayer *render_layer = RE_GetRenderLayer(rr, view_layer->name);
-        success = eyedropper_cryptomatte_sample_renderlayer_fl(render_layer, prefix, fpos, r_col);
+        success = eyedropper_cryptomatte_sample_renderlayer_fl(
+            rr, render_layer, prefix, fpos, r_col);
         if (success) {
           break;
         }
@@ -230,7 +235,8 @@ static bool eyedropper_cryptomatte_sample_image_fl(const bNode *node,
     ImBuf *ibuf = BKE_image_acquire_ibuf(image, iuser, nullptr);
     if (image->rr) {
       LISTBASE_FOREACH (RenderLayer *, render_layer, &image->rr->layers) {
-        success = eyedropper_cryptomatte_sample_renderlayer_fl(render_layer, prefix, fpos, r_col);
+        success = eyedropper_cryptomatte_sample_renderlayer_fl(
+            image->rr, render_layer, prefix, fpos, r_col);
         if (success) {
           break;
         }
@@ -25,7 +25,6 @@
 #include "BKE_context.h"
 #include "BKE_icons.h"
 #include "BKE_lib_id.h"
-#include "BKE_lib_query.h"
 #include "BKE_main.h"
 #include "BKE_node.hh"
 #include "BKE_scene.h"
@@ -97,38 +96,31 @@ static bool memfile_undosys_step_encode(bContext * /*C*/, Main *bmain, UndoStep
   return true;
 }
 
-static int memfile_undosys_step_id_reused_cb(LibraryIDLinkCallbackData *cb_data)
+/**
+ * Update an unchanged ID re-used from the old Main, for the changes of re-read IDs it uses.
+ */
+static void memfile_undosys_step_id_reused_update(ID *id)
 {
-  ID *self_id = cb_data->self_id;
-  ID **id_pointer = cb_data->id_pointer;
-  BLI_assert((self_id->tag & LIB_TAG_UNDO_OLD_ID_REUSED_UNCHANGED) != 0);
+  BLI_assert((id->tag & LIB_TAG_UNDO_OLD_ID_REUSED_UNCHANGED) != 0);
 
-  ID *id = *id_pointer;
-  if (id != nullptr && !ID_IS_LINKED(id) && (id->tag & LIB_TAG_UNDO_OLD_ID_REUSED_UNCHANGED) == 0)
+  /* Only armature objects need this, checking their data directly is much cheaper than looping
+   * over the ID pointers of every unchanged ID. */
+  if (GS(id->name) != ID_OB) {
+    return;
+  }
+  Object *ob = (Object *)id;
+  if (ob->type != OB_ARMATURE || ob->pose == nullptr) {
+    return;
+  }
+  ID *id_data = static_cast<ID *>(ob->data);
+  if (id_data != nullptr && !ID_IS_LINKED(id_data) &&
+      (id_data->tag & LIB_TAG_UNDO_OLD_ID_REUSED_UNCHANGED) == 0)
   {
-    bool do_stop_iter = true;
-    if (GS(self_id->name) == ID_OB) {
-      Object *ob_self = (Object *)self_id;
-      if (ob_self->type == OB_ARMATURE) {
-        if (ob_self->data == id) {
-          BLI_assert(GS(id->name) == ID_AR);
-          if (ob_self->pose != nullptr) {
-            /* We have a changed/re-read armature used by an unchanged armature object: our beloved
-             * Bone pointers from the object's pose need their usual special treatment. */
-            ob_self->pose->flag |= POSE_RECALC;
-          }
-        }
-        else {
-          /* Cannot stop iteration until we checked ob_self->data pointer... */
-          do_stop_iter = false;
-        }
-      }
-    }
-
-    return do_stop_iter ? IDWALK_RET_STOP_ITER : IDWALK_RET_NOP;
+    BLI_assert(GS(id_data->name) == ID_AR);
+    /* We have a changed/re-read armature used by an unchanged armature object: our beloved
+     * Bone pointers from the object's pose need their usual special treatment. */
+    ob->pose->flag |= POSE_RECALC;
   }
-
-  return IDWALK_RET_NOP;
 }
 
 /**
@@ -233,8 +225,7 @@ static void memfile_undosys_step_decode(
     ID *id = nullptr;
     FOREACH_MAIN_ID_BEGIN (bmain, id) {
       if (id->tag & LIB_TAG_UNDO_OLD_ID_REUSED_UNCHANGED) {
-        BKE_library_foreach_ID_link(
-            bmain, id, memfile_undosys_step_id_reused_cb, nullptr, IDWALK_READONLY);
+        memfile_undosys_step_id_reused_update(id);
       }
 
       /* NOTE: Tagging `ID_RECALC_COPY_ON_WRITE` here should not be needed in practice, since
@@ -491,9 +491,29 @@ void IMB_filtery(struct ImBuf *ibuf);
  */
 struct ImBuf *IMB_onehalf(struct ImBuf *ibuf1);
 
+/** Filter used by #IMB_scale. */
+typedef enum eIMBScaleFilter {
+  /** Average of the covered pixels when scaling down, linear interpolation when scaling up. */
+  IMB_SCALE_FILTER_BOX,
+  IMB_SCALE_FILTER_BILINEAR,
+  /** Mitchell-Netravali cubic, sharper than bilinear without much ringing. */
+  IMB_SCALE_FILTER_MITCHELL,
+  /** Sharpest, may ring around high contrast edges. */
+  IMB_SCALE_FILTER_LANCZOS3,
+} eIMBScaleFilter;
+
+/**
+ * \attention Defined in scaling.c
+ *
+ * Scale byte and float buffers with a separable filter, rows are processed in parallel.
+ * Return true if \a ibuf is modified.
+ */
+bool IMB_scale(struct ImBuf *ibuf, unsigned int newx, unsigned int newy, eIMBScaleFilter filter);
+
 /**
  * \attention Defined in scaling.c
  *
+ * Same as #IMB_scale with #IMB_SCALE_FILTER_BOX.
  * Return true if \a ibuf is modified.
  */
 bool IMB_scaleImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy);
@@ -508,6 +528,8 @@ bool IMB_scalefastImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy
 
 /**
  * \attention Defined in scaling.c
+ *
+ * Same as #IMB_scale with #IMB_SCALE_FILTER_BILINEAR.
  */
 void IMB_scaleImBuf_threaded(struct ImBuf *ibuf, unsigned int newx, unsigned int newy);
 
@@ -22,6 +22,7 @@
 extern "C" {
 #endif
 
+struct ImBuf;
 struct StampData;
 
 void *IMB_exr_get_handle(void);
@@ -78,7 +79,25 @@ float *IMB_exr_channel_rect(void *handle,
                             const char *passname,
                             const char *view);
 
+/**
+ * Read all channels, allocating buffers for passes of a handle opened with `parse_channels`.
+ */
 void IMB_exr_read_channels(void *handle);
+/**
+ * Read a single pass of a handle opened with `parse_channels`, without decoding other channels.
+ *
+ * \param row_min, row_max: Only read rows in `[row_min, row_max)`, bottom to top like #ImBuf.
+ * All rows are read when `row_max <= row_min`.
+ * \return Buffer of `width * rows * r_totchan` floats owned by the caller, or null when the pass
+ * does not exist or could not be read.
+ */
+float *IMB_exr_read_pass(void *handle,
+                         const char *layname,
+                         const char *passname,
+                         const char *viewname,
+                         int row_min,
+                         int row_max,
+                         int *r_totchan);
 void IMB_exr_write_channels(void *handle);
 /**
  * Temporary function, used for FSA and Save Buffers.
@@ -105,6 +124,11 @@ void IMB_exr_close(void *handle);
 void IMB_exr_add_view(void *handle, const char *name);
 
 bool IMB_exr_has_multilayer(void *handle);
+/**
+ * Copy the string attributes of the file header of a handle opened for reading into
+ * the metadata of \a ibuf.
+ */
+void IMB_exr_metadata_to_imbuf(void *handle, struct ImBuf *ibuf);
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -30,6 +30,16 @@ extern float imbuf_rec709_to_scene_linear[3][3];
 #define MAX_COLORSPACE_NAME 64
 #define MAX_COLORSPACE_DESCRIPTION 512
 
+/** Transforms with a fast path, see #colormanage_fast_transform_detect. */
+typedef enum eColormanageFastTransform {
+  COLORMANAGE_FAST_TRANSFORM_NONE = 0,
+  COLORMANAGE_FAST_TRANSFORM_IDENTITY,
+  COLORMANAGE_FAST_TRANSFORM_SRGB_TO_LINEAR,
+  COLORMANAGE_FAST_TRANSFORM_LINEAR_TO_SRGB,
+  COLORMANAGE_FAST_TRANSFORM_REC709_TO_LINEAR,
+  COLORMANAGE_FAST_TRANSFORM_LINEAR_TO_REC709,
+} eColormanageFastTransform;
+
 typedef struct ColorSpace {
   struct ColorSpace *next, *prev;
   int index;
@@ -119,6 +129,40 @@ void colorspace_set_default_role(char *colorspace, int size, int role);
 void colormanage_imbuf_set_default_spaces(struct ImBuf *ibuf);
 void colormanage_imbuf_make_linear(struct ImBuf *ibuf, const char *from_colorspace);
 
+/* ** Fast Transforms ** */
+
+/**
+ * Detect whether the processor does one of the transforms with a fast path, by comparing the
+ * results of both for a range of values.
+ */
+eColormanageFastTransform colormanage_fast_transform_detect(
+    OCIO_ConstCPUProcessorRcPtr *processor);
+/**
+ * Apply a transform detected for \a processor to RGB or RGBA pixels. Pixels outside of the
+ * range in which the transform was detected are transformed by \a processor.
+ */
+void colormanage_fast_transform_apply(eColormanageFastTransform transform,
+                                      OCIO_ConstCPUProcessorRcPtr *processor,
+                                      float *buffer,
+                                      size_t num_pixels,
+                                      int channels,
+                                      bool predivide);
+/** Apply a transform to RGBA byte pixels, alpha is left unchanged. */
+void colormanage_fast_transform_apply_byte(eColormanageFastTransform transform,
+                                           uchar *buffer,
+                                           size_t num_pixels);
+/** Convert RGBA float pixels to bytes, same as #rgba_float_to_uchar. */
+void colormanage_fast_float_to_byte(uchar *byte_buffer,
+                                    const float *float_buffer,
+                                    size_t num_pixels);
+/**
+ * Convert the float buffer of \a ibuf into its byte buffer in a single multi-threaded pass.
+ * Returns false when the transform between the color spaces has no fast path.
+ */
+bool colormanage_fast_rect_from_float(struct ImBuf *ibuf,
+                                      const char *from_colorspace,
+                                      const char *to_colorspace);
+
 #ifdef __cplusplus
 }
 #endif
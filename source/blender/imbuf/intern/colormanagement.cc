@@ -11,6 +11,7 @@
 
 #include <math.h>
 #include <string.h>
+#include <string>
 
 #include "DNA_color_types.h"
 #include "DNA_image_types.h"
@@ -27,12 +28,15 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_array.hh"
 #include "BLI_blenlib.h"
+#include "BLI_map.hh"
 #include "BLI_math.h"
 #include "BLI_math_color.h"
 #include "BLI_rect.h"
 #include "BLI_string.h"
 #include "BLI_task.h"
+#include "BLI_task.hh"
 #include "BLI_threads.h"
 
 #include "BKE_appdir.h"
@@ -90,8 +94,14 @@ float imbuf_aces_to_scene_linear[3][3] = {{0.0f}};
  */
 static pthread_mutex_t processor_lock = BLI_MUTEX_INITIALIZER;
 
+/* Fast transforms detected for processors, by color spaces or view settings. Detection is done
+ * once, since it runs the processor for many values. */
+static blender::Map<std::string, eColormanageFastTransform> global_fast_transforms;
+static pthread_mutex_t fast_transforms_lock = BLI_MUTEX_INITIALIZER;
+
 struct ColormanageProcessor {
   OCIO_ConstCPUProcessorRcPtr *cpu_processor;
+  eColormanageFastTransform fast_transform;
   CurveMapping *curve_mapping;
   bool is_data_result;
 };
@@ -727,6 +737,8 @@ void colormanagement_exit()
   memset(&global_gpu_state, 0, sizeof(global_gpu_state));
   memset(&global_color_picking_state, 0, sizeof(global_color_picking_state));
 
+  global_fast_transforms.clear_and_shrink();
+
   colormanage_free_config();
 }
 
@@ -867,6 +879,27 @@ static OCIO_ConstProcessorRcPtr *create_colorspace_transform_processor(const cha
   return processor;
 }
 
+static eColormanageFastTransform colormanage_fast_transform_get(
+    const std::string &key, OCIO_ConstCPUProcessorRcPtr *cpu_processor)
+{
+  if (cpu_processor == nullptr) {
+    return COLORMANAGE_FAST_TRANSFORM_NONE;
+  }
+
+  BLI_mutex_lock(&fast_transforms_lock);
+  const eColormanageFastTransform transform = global_fast_transforms.lookup_or_add_cb(
+      key, [&]() { return colormanage_fast_transform_detect(cpu_processor); });
+  BLI_mutex_unlock(&fast_transforms_lock);
+
+  return transform;
+}
+
+static std::string colormanage_fast_transform_key(const char *from_colorspace,
+                                                  const char *to_colorspace)
+{
+  return std::string(from_colorspace) + '\n' + to_colorspace;
+}
+
 static OCIO_ConstCPUProcessorRcPtr *colorspace_to_scene_linear_cpu_processor(
     ColorSpace *colorspace)
 {
@@ -1960,6 +1993,56 @@ static void colormanagement_transform_ex(uchar *byte_buffer,
   IMB_colormanagement_processor_free(cm_processor);
 }
 
+bool colormanage_fast_rect_from_float(ImBuf *ibuf,
+                                      const char *from_colorspace,
+                                      const char *to_colorspace)
+{
+  using namespace blender;
+
+  /* Dithering and other channel counts use the generic conversion. */
+  if (ibuf->channels != 4 || ibuf->dither != 0.0f) {
+    return false;
+  }
+
+  ColormanageProcessor *cm_processor = nullptr;
+  eColormanageFastTransform fast_transform = COLORMANAGE_FAST_TRANSFORM_IDENTITY;
+  if (!STREQ(from_colorspace, to_colorspace)) {
+    cm_processor = IMB_colormanagement_colorspace_processor_new(from_colorspace, to_colorspace);
+    fast_transform = cm_processor->fast_transform;
+    if (fast_transform == COLORMANAGE_FAST_TRANSFORM_NONE) {
+      IMB_colormanagement_processor_free(cm_processor);
+      return false;
+    }
+  }
+
+  OCIO_ConstCPUProcessorRcPtr *cpu_processor = cm_processor ? cm_processor->cpu_processor :
+                                                              nullptr;
+  const bool predivide = IMB_alpha_affects_rgb(ibuf);
+  const int width = ibuf->x;
+
+  threading::parallel_for(IndexRange(ibuf->y), 32, [&](const IndexRange rows) {
+    Array<float> row(int64_t(width) * 4, NoInitialization());
+
+    for (const int64_t y : rows) {
+      const size_t offset = size_t(y) * width * 4;
+      memcpy(row.data(), ibuf->float_buffer.data + offset, sizeof(float[4]) * width);
+
+      /* Byte buffers have straight alpha, unpremultiply before the transform instead of
+       * dividing and multiplying by alpha around it, and dividing again after. */
+      if (predivide) {
+        IMB_unpremultiply_rect_float(row.data(), 4, width, 1);
+      }
+      colormanage_fast_transform_apply(fast_transform, cpu_processor, row.data(), width, 4, false);
+      colormanage_fast_float_to_byte(ibuf->byte_buffer.data + offset, row.data(), width);
+    }
+  });
+
+  if (cm_processor) {
+    IMB_colormanagement_processor_free(cm_processor);
+  }
+  return true;
+}
+
 void IMB_colormanagement_transform(float *buffer,
                                    int width,
                                    int height,
@@ -2155,7 +2238,13 @@ void IMB_colormanagement_colorspace_to_scene_linear(
 
   processor = colorspace_to_scene_linear_cpu_processor(colorspace);
 
-  if (processor != nullptr) {
+  const eColormanageFastTransform fast_transform = colormanage_fast_transform_get(
+      colormanage_fast_transform_key(colorspace->name, global_role_scene_linear), processor);
+  if (fast_transform != COLORMANAGE_FAST_TRANSFORM_NONE && channels >= 3) {
+    colormanage_fast_transform_apply(
+        fast_transform, processor, buffer, size_t(width) * height, channels, predivide);
+  }
+  else if (processor != nullptr) {
     OCIO_PackedImageDesc *img;
 
     img = OCIO_createOCIO_PackedImageDesc(buffer,
@@ -3771,6 +3860,15 @@ ColormanageProcessor *IMB_colormanagement_display_processor_new(
       applied_view_settings->gamma,
       global_role_scene_linear);
 
+  /* Exposure and gamma can have any value, only detect fast transforms for the defaults. */
+  if (applied_view_settings->exposure == 0.0f && applied_view_settings->gamma == 1.0f) {
+    const std::string key = std::string(applied_view_settings->look) + '\n' +
+                            applied_view_settings->view_transform + '\n' +
+                            display_settings->display_device + '\n' + global_role_scene_linear;
+    cm_processor->fast_transform = colormanage_fast_transform_get(key,
+                                                                  cm_processor->cpu_processor);
+  }
+
   if (applied_view_settings->flag & COLORMANAGE_VIEW_USE_CURVES) {
     cm_processor->curve_mapping = BKE_curvemapping_copy(applied_view_settings->curve_mapping);
     BKE_curvemapping_premultiply(cm_processor->curve_mapping, false);
@@ -3797,6 +3895,9 @@ ColormanageProcessor *IMB_colormanagement_colorspace_processor_new(const char *f
   }
   OCIO_processorRelease(processor);
 
+  cm_processor->fast_transform = colormanage_fast_transform_get(
+      colormanage_fast_transform_key(from_colorspace, to_colorspace), cm_processor->cpu_processor);
+
   return cm_processor;
 }
 
@@ -3875,7 +3976,17 @@ void IMB_colormanagement_processor_apply(ColormanageProcessor *cm_processor,
     }
   }
 
-  if (cm_processor->cpu_processor && channels >= 3) {
+  if (cm_processor->cpu_processor && channels >= 3 &&
+      cm_processor->fast_transform != COLORMANAGE_FAST_TRANSFORM_NONE)
+  {
+    colormanage_fast_transform_apply(cm_processor->fast_transform,
+                                     cm_processor->cpu_processor,
+                                     buffer,
+                                     size_t(width) * height,
+                                     channels,
+                                     predivide);
+  }
+  else if (cm_processor->cpu_processor && channels >= 3) {
     OCIO_PackedImageDesc *img;
 
     /* apply OCIO processor */
@@ -3905,6 +4016,15 @@ void IMB_colormanagement_processor_apply_byte(
    * but for now it's not so important.
    */
   BLI_assert(channels == 4);
+
+  if (cm_processor->curve_mapping == nullptr &&
+      cm_processor->fast_transform != COLORMANAGE_FAST_TRANSFORM_NONE)
+  {
+    colormanage_fast_transform_apply_byte(
+        cm_processor->fast_transform, buffer, size_t(width) * height);
+    return;
+  }
+
   float pixel[4];
   for (int y = 0; y < height; y++) {
     for (int x = 0; x < width; x++) {
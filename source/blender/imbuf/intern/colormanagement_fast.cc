@@ -0,0 +1,449 @@
+/* SPDX-FileCopyrightText: 2023 Blender Foundation
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup imbuf
+ *
+ * Fast paths for common color space transforms.
+ *
+ * Transforms like sRGB to linear are applied with SIMD code instead of OpenColorIO. Which
+ * transform an OpenColorIO processor does is detected by comparing its results with the fast
+ * path, so any configuration works and only transforms which match take the fast path. Pixels
+ * outside of the compared range are still transformed by OpenColorIO.
+ */
+
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math_base.h"
+#include "BLI_math_color.h"
+#include "BLI_simd.h"
+#include "BLI_task.hh"
+#include "BLI_utildefines.h"
+
+#include "IMB_colormanagement_intern.h"
+
+#include <ocio_capi.h>
+
+/* -------------------------------------------------------------------- */
+/** \name Transform Curves
+ * \{ */
+
+struct FastTransformRange {
+  float min, max;
+};
+
+/* Input range in which a transform is compared with OpenColorIO. Look-up tables of configurations
+ * usually cover a limited range, outside of it results may differ. */
+static FastTransformRange fast_transform_range(const eColormanageFastTransform transform)
+{
+  switch (transform) {
+    case COLORMANAGE_FAST_TRANSFORM_NONE:
+      break;
+    case COLORMANAGE_FAST_TRANSFORM_IDENTITY:
+      /* Same as the range sampled by #fast_transform_matches. */
+      return {-1.0f, 1024.0f};
+    case COLORMANAGE_FAST_TRANSFORM_SRGB_TO_LINEAR:
+      return {-0.125f, 4.5f};
+    case COLORMANAGE_FAST_TRANSFORM_LINEAR_TO_SRGB:
+      return {-0.0096f, 32.0f};
+    case COLORMANAGE_FAST_TRANSFORM_REC709_TO_LINEAR:
+      return {-0.1f, 1.1f};
+    case COLORMANAGE_FAST_TRANSFORM_LINEAR_TO_REC709:
+      return {-0.02f, 1.2f};
+  }
+  return {-FLT_MAX, FLT_MAX};
+}
+
+/* Same as the SIMD curves, used when SSE2 is not available. Negative values continue the linear
+ * segment, as is common for these transforms in OpenColorIO configurations. */
+template<eColormanageFastTransform Transform> static float fast_transform_curve(const float v)
+{
+  switch (Transform) {
+    case COLORMANAGE_FAST_TRANSFORM_SRGB_TO_LINEAR:
+      return (v < 0.04045f) ? v * (1.0f / 12.92f) : powf((v + 0.055f) * (1.0f / 1.055f), 2.4f);
+    case COLORMANAGE_FAST_TRANSFORM_LINEAR_TO_SRGB:
+      return (v < 0.0031308f) ? v * 12.92f : 1.055f * powf(v, 1.0f / 2.4f) - 0.055f;
+    case COLORMANAGE_FAST_TRANSFORM_REC709_TO_LINEAR:
+      return (v < 0.081f) ? v * (1.0f / 4.5f) : powf((v + 0.099f) * (1.0f / 1.099f), 1.0f / 0.45f);
+    case COLORMANAGE_FAST_TRANSFORM_LINEAR_TO_REC709:
+      return (v < 0.018f) ? v * 4.5f : 1.099f * powf(v, 0.45f) - 0.099f;
+    default:
+      return v;
+  }
+}
+
+#if BLI_HAVE_SSE2
+BLI_INLINE __m128 select_ps(const __m128 mask, const __m128 a, const __m128 b)
+{
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+/* Logarithm base 2 of positive normalized values, relative error is below 1e-7. */
+BLI_INLINE __m128 fast_log2_ps(const __m128 x)
+{
+  const __m128i bits = _mm_castps_si128(x);
+  __m128i exponent = _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127));
+  __m128 mantissa = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)),
+                                                  _mm_set1_epi32(0x3f800000)));
+  /* Center the mantissa around one, for faster convergence of the series. */
+  const __m128 is_large = _mm_cmpgt_ps(mantissa, _mm_set1_ps(float(M_SQRT2)));
+  mantissa = select_ps(is_large, _mm_mul_ps(mantissa, _mm_set1_ps(0.5f)), mantissa);
+  exponent = _mm_sub_epi32(exponent, _mm_castps_si128(is_large));
+
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 t = _mm_div_ps(_mm_sub_ps(mantissa, one), _mm_add_ps(mantissa, one));
+  const __m128 t2 = _mm_mul_ps(t, t);
+  __m128 series = _mm_set1_ps(1.0f / 9.0f);
+  series = _mm_add_ps(_mm_mul_ps(series, t2), _mm_set1_ps(1.0f / 7.0f));
+  series = _mm_add_ps(_mm_mul_ps(series, t2), _mm_set1_ps(1.0f / 5.0f));
+  series = _mm_add_ps(_mm_mul_ps(series, t2), _mm_set1_ps(1.0f / 3.0f));
+  series = _mm_add_ps(_mm_mul_ps(series, t2), one);
+  series = _mm_mul_ps(_mm_mul_ps(series, t), _mm_set1_ps(float(2.0 / M_LN2)));
+
+  return _mm_add_ps(series, _mm_cvtepi32_ps(exponent));
+}
+
+/* Power of 2, relative error is below 1e-7. */
+BLI_INLINE __m128 fast_exp2_ps(__m128 x)
+{
+  x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-126.0f)), _mm_set1_ps(126.0f));
+  const __m128i exponent = _mm_cvtps_epi32(x);
+  const __m128 f = _mm_mul_ps(_mm_sub_ps(x, _mm_cvtepi32_ps(exponent)), _mm_set1_ps(float(M_LN2)));
+
+  /* Taylor series of `exp(f)` for `|f| <= ln(2) / 2`. */
+  __m128 series = _mm_set1_ps(1.0f / 720.0f);
+  series = _mm_add_ps(_mm_mul_ps(series, f), _mm_set1_ps(1.0f / 120.0f));
+  series = _mm_add_ps(_mm_mul_ps(series, f), _mm_set1_ps(1.0f / 24.0f));
+  series = _mm_add_ps(_mm_mul_ps(series, f), _mm_set1_ps(1.0f / 6.0f));
+  series = _mm_add_ps(_mm_mul_ps(series, f), _mm_set1_ps(0.5f));
+  series = _mm_add_ps(_mm_mul_ps(series, f), _mm_set1_ps(1.0f));
+  series = _mm_add_ps(_mm_mul_ps(series, f), _mm_set1_ps(1.0f));
+
+  const __m128i scale = _mm_slli_epi32(_mm_add_epi32(exponent, _mm_set1_epi32(127)), 23);
+  return _mm_mul_ps(series, _mm_castsi128_ps(scale));
+}
+
+/* Only valid for positive values, other lanes are replaced by the linear segment. */
+BLI_INLINE __m128 fast_pow_ps(const __m128 x, const float exponent)
+{
+  return fast_exp2_ps(_mm_mul_ps(fast_log2_ps(x), _mm_set1_ps(exponent)));
+}
+
+template<eColormanageFastTransform Transform> BLI_INLINE __m128 fast_transform_curve_ps(__m128 v)
+{
+  switch (Transform) {
+    case COLORMANAGE_FAST_TRANSFORM_SRGB_TO_LINEAR: {
+      const __m128 linear = _mm_mul_ps(v, _mm_set1_ps(1.0f / 12.92f));
+      const __m128 curve = fast_pow_ps(
+          _mm_mul_ps(_mm_add_ps(v, _mm_set1_ps(0.055f)), _mm_set1_ps(1.0f / 1.055f)), 2.4f);
+      return select_ps(_mm_cmplt_ps(v, _mm_set1_ps(0.04045f)), linear, curve);
+    }
+    case COLORMANAGE_FAST_TRANSFORM_LINEAR_TO_SRGB: {
+      const __m128 linear = _mm_mul_ps(v, _mm_set1_ps(12.92f));
+      const __m128 curve = _mm_sub_ps(
+          _mm_mul_ps(fast_pow_ps(v, 1.0f / 2.4f), _mm_set1_ps(1.055f)), _mm_set1_ps(0.055f));
+      return select_ps(_mm_cmplt_ps(v, _mm_set1_ps(0.0031308f)), linear, curve);
+    }
+    case COLORMANAGE_FAST_TRANSFORM_REC709_TO_LINEAR: {
+      const __m128 linear = _mm_mul_ps(v, _mm_set1_ps(1.0f / 4.5f));
+      const __m128 curve = fast_pow_ps(
+          _mm_mul_ps(_mm_add_ps(v, _mm_set1_ps(0.099f)), _mm_set1_ps(1.0f / 1.099f)),
+          1.0f / 0.45f);
+      return select_ps(_mm_cmplt_ps(v, _mm_set1_ps(0.081f)), linear, curve);
+    }
+    case COLORMANAGE_FAST_TRANSFORM_LINEAR_TO_REC709: {
+      const __m128 linear = _mm_mul_ps(v, _mm_set1_ps(4.5f));
+      const __m128 curve = _mm_sub_ps(_mm_mul_ps(fast_pow_ps(v, 0.45f), _mm_set1_ps(1.099f)),
+                                      _mm_set1_ps(0.099f));
+      return select_ps(_mm_cmplt_ps(v, _mm_set1_ps(0.018f)), linear, curve);
+    }
+    default:
+      return v;
+  }
+}
+#endif
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Buffer Transform
+ * \{ */
+
+static void fast_transform_fallback(OCIO_ConstCPUProcessorRcPtr *processor,
+                                    float *pixel,
+                                    const int channels,
+                                    const bool predivide)
+{
+  if (processor == nullptr) {
+    return;
+  }
+  if (channels == 4) {
+    if (predivide) {
+      OCIO_cpuProcessorApplyRGBA_predivide(processor, pixel);
+    }
+    else {
+      OCIO_cpuProcessorApplyRGBA(processor, pixel);
+    }
+  }
+  else {
+    OCIO_cpuProcessorApplyRGB(processor, pixel);
+  }
+}
+
+template<eColormanageFastTransform Transform>
+static void fast_transform_apply(OCIO_ConstCPUProcessorRcPtr *processor,
+                                 float *buffer,
+                                 const size_t num_pixels,
+                                 const int channels,
+                                 const bool predivide)
+{
+  const FastTransformRange range = fast_transform_range(Transform);
+
+#if BLI_HAVE_SSE2
+  const __m128 range_min = _mm_set1_ps(range.min);
+  const __m128 range_max = _mm_set1_ps(range.max);
+  const __m128 alpha_mask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+
+  for (size_t i = 0; i < num_pixels; i++) {
+    float *pixel = buffer + i * channels;
+    const __m128 input = (channels == 4) ? _mm_loadu_ps(pixel) :
+                                           _mm_set_ps(1.0f, pixel[2], pixel[1], pixel[0]);
+    const __m128 alpha = _mm_shuffle_ps(input, input, _MM_SHUFFLE(3, 3, 3, 3));
+    /* Same as OpenColorIO predivide, which leaves zero and one alpha untouched. */
+    const bool use_predivide = predivide && channels == 4 && pixel[3] != 0.0f &&
+                               pixel[3] != 1.0f;
+
+    __m128 value = use_predivide ? _mm_div_ps(input, alpha) : input;
+    /* Also catches NaN. */
+    const __m128 outside = _mm_or_ps(_mm_cmpnge_ps(value, range_min),
+                                     _mm_cmpnle_ps(value, range_max));
+    if (_mm_movemask_ps(outside) & 0x7) {
+      fast_transform_fallback(processor, pixel, channels, predivide);
+      continue;
+    }
+
+    value = fast_transform_curve_ps<Transform>(value);
+    if (use_predivide) {
+      value = _mm_mul_ps(value, alpha);
+    }
+    value = select_ps(alpha_mask, input, value);
+
+    if (channels == 4) {
+      _mm_storeu_ps(pixel, value);
+    }
+    else {
+      float result[4];
+      _mm_storeu_ps(result, value);
+      pixel[0] = result[0];
+      pixel[1] = result[1];
+      pixel[2] = result[2];
+    }
+  }
+#else
+  for (size_t i = 0; i < num_pixels; i++) {
+    float *pixel = buffer + i * channels;
+    const bool use_predivide = predivide && channels == 4 && pixel[3] != 0.0f &&
+                               pixel[3] != 1.0f;
+    const float alpha = use_predivide ? pixel[3] : 1.0f;
+    const float inv_alpha = 1.0f / alpha;
+    const float value[3] = {pixel[0] * inv_alpha, pixel[1] * inv_alpha, pixel[2] * inv_alpha};
+
+    bool is_inside = true;
+    for (int c = 0; c < 3; c++) {
+      is_inside &= (value[c] >= range.min && value[c] <= range.max);
+    }
+    if (!is_inside) {
+      fast_transform_fallback(processor, pixel, channels, predivide);
+      continue;
+    }
+
+    for (int c = 0; c < 3; c++) {
+      pixel[c] = fast_transform_curve<Transform>(value[c]) * alpha;
+    }
+  }
+#endif
+}
+
+static void fast_transform_apply_range(eColormanageFastTransform transform,
+                                       OCIO_ConstCPUProcessorRcPtr *processor,
+                                       float *buffer,
+                                       size_t num_pixels,
+                                       int channels,
+                                       bool predivide)
+{
+  switch (transform) {
+    case COLORMANAGE_FAST_TRANSFORM_NONE:
+      BLI_assert_unreachable();
+      break;
+    case COLORMANAGE_FAST_TRANSFORM_IDENTITY:
+      /* Without a processor the color spaces are the same, so any value is unchanged. Otherwise
+       * the processor was only compared in a limited range, pixels outside of it still need to
+       * be transformed. */
+      if (processor != nullptr) {
+        fast_transform_apply<COLORMANAGE_FAST_TRANSFORM_IDENTITY>(
+            processor, buffer, num_pixels, channels, predivide);
+      }
+      break;
+    case COLORMANAGE_FAST_TRANSFORM_SRGB_TO_LINEAR:
+      fast_transform_apply<COLORMANAGE_FAST_TRANSFORM_SRGB_TO_LINEAR>(
+          processor, buffer, num_pixels, channels, predivide);
+      break;
+    case COLORMANAGE_FAST_TRANSFORM_LINEAR_TO_SRGB:
+      fast_transform_apply<COLORMANAGE_FAST_TRANSFORM_LINEAR_TO_SRGB>(
+          processor, buffer, num_pixels, channels, predivide);
+      break;
+    case COLORMANAGE_FAST_TRANSFORM_REC709_TO_LINEAR:
+      fast_transform_apply<COLORMANAGE_FAST_TRANSFORM_REC709_TO_LINEAR>(
+          processor, buffer, num_pixels, channels, predivide);
+      break;
+    case COLORMANAGE_FAST_TRANSFORM_LINEAR_TO_REC709:
+      fast_transform_apply<COLORMANAGE_FAST_TRANSFORM_LINEAR_TO_REC709>(
+          processor, buffer, num_pixels, channels, predivide);
+      break;
+  }
+}
+
+void colormanage_fast_transform_apply(eColormanageFastTransform transform,
+                                      OCIO_ConstCPUProcessorRcPtr *processor,
+                                      float *buffer,
+                                      size_t num_pixels,
+                                      int channels,
+                                      bool predivide)
+{
+  using namespace blender;
+  BLI_assert(channels >= 3);
+
+  threading::parallel_for(IndexRange(int64_t(num_pixels)), 16384, [&](const IndexRange range) {
+    fast_transform_apply_range(transform,
+                               processor,
+                               buffer + size_t(range.start()) * channels,
+                               size_t(range.size()),
+                               channels,
+                               predivide);
+  });
+}
+
+void colormanage_fast_transform_apply_byte(eColormanageFastTransform transform,
+                                           uchar *buffer,
+                                           size_t num_pixels)
+{
+  if (transform == COLORMANAGE_FAST_TRANSFORM_IDENTITY) {
+    return;
+  }
+
+  /* Channels are transformed independently, so a table covers all byte values. Byte values are
+   * always inside of the compared range. */
+  float table_input[256 * 3];
+  for (int i = 0; i < 256; i++) {
+    table_input[i * 3 + 0] = table_input[i * 3 + 1] = table_input[i * 3 + 2] = float(i) / 255.0f;
+  }
+  colormanage_fast_transform_apply(transform, nullptr, table_input, 256, 3, false);
+
+  uchar table[256];
+  for (int i = 0; i < 256; i++) {
+    table[i] = unit_float_to_uchar_clamp(table_input[i * 3]);
+  }
+
+  for (size_t i = 0; i < num_pixels; i++) {
+    uchar *pixel = buffer + i * 4;
+    pixel[0] = table[pixel[0]];
+    pixel[1] = table[pixel[1]];
+    pixel[2] = table[pixel[2]];
+  }
+}
+
+void colormanage_fast_float_to_byte(uchar *byte_buffer,
+                                    const float *float_buffer,
+                                    size_t num_pixels)
+{
+#if BLI_HAVE_SSE2
+  /* Same rounding as #unit_float_to_uchar_clamp, packing saturates to the byte range. */
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 scale = _mm_set1_ps(255.0f);
+  const __m128 half = _mm_set1_ps(0.5f);
+  for (size_t i = 0; i < num_pixels; i++) {
+    const __m128 value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(float_buffer + i * 4), zero), one);
+    __m128i bytes = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, scale), half));
+    bytes = _mm_packs_epi32(bytes, bytes);
+    bytes = _mm_packus_epi16(bytes, bytes);
+    const int32_t packed = _mm_cvtsi128_si32(bytes);
+    memcpy(byte_buffer + i * 4, &packed, sizeof(packed));
+  }
+#else
+  for (size_t i = 0; i < num_pixels; i++) {
+    rgba_float_to_uchar(byte_buffer + i * 4, float_buffer + i * 4);
+  }
+#endif
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Detection
+ * \{ */
+
+static bool fast_transform_matches(OCIO_ConstCPUProcessorRcPtr *processor,
+                                   const eColormanageFastTransform transform)
+{
+  const FastTransformRange range = fast_transform_range(transform);
+  const float range_min = max_ff(range.min, -1.0f);
+  const float range_max = min_ff(range.max, 1024.0f);
+
+  /* Samples are denser near the lower end, where the curves bend the most. Channels get
+   * different values to detect crosstalk between them, alpha must be left unchanged. */
+  const int num_samples = 2048;
+  float *samples = static_cast<float *>(MEM_mallocN(sizeof(float[4]) * num_samples, __func__));
+  float *expected = static_cast<float *>(MEM_mallocN(sizeof(float[4]) * num_samples, __func__));
+  for (int i = 0; i < num_samples; i++) {
+    for (int c = 0; c < 3; c++) {
+      const float t = float((i + c * num_samples / 3) % num_samples) / float(num_samples - 1);
+      samples[i * 4 + c] = range_min + (range_max - range_min) * t * t;
+    }
+    samples[i * 4 + 3] = 0.5f;
+  }
+  memcpy(expected, samples, sizeof(float[4]) * num_samples);
+
+  for (int i = 0; i < num_samples; i++) {
+    OCIO_cpuProcessorApplyRGBA(processor, &expected[i * 4]);
+  }
+  colormanage_fast_transform_apply(transform, nullptr, samples, num_samples, 4, false);
+
+  bool matches = true;
+  for (int i = 0; i < num_samples * 4 && matches; i++) {
+    const float tolerance = 1e-4f * max_ff(1.0f, fabsf(expected[i]));
+    matches = fabsf(samples[i] - expected[i]) <= tolerance;
+  }
+
+  MEM_freeN(samples);
+  MEM_freeN(expected);
+  return matches;
+}
+
+eColormanageFastTransform colormanage_fast_transform_detect(OCIO_ConstCPUProcessorRcPtr *processor)
+{
+  if (processor == nullptr) {
+    return COLORMANAGE_FAST_TRANSFORM_NONE;
+  }
+
+  const eColormanageFastTransform candidates[] = {
+      COLORMANAGE_FAST_TRANSFORM_IDENTITY,
+      COLORMANAGE_FAST_TRANSFORM_SRGB_TO_LINEAR,
+      COLORMANAGE_FAST_TRANSFORM_LINEAR_TO_SRGB,
+      COLORMANAGE_FAST_TRANSFORM_REC709_TO_LINEAR,
+      COLORMANAGE_FAST_TRANSFORM_LINEAR_TO_REC709,
+  };
+  for (const eColormanageFastTransform transform : candidates) {
+    if (fast_transform_matches(processor, transform)) {
+      return transform;
+    }
+  }
+  return COLORMANAGE_FAST_TRANSFORM_NONE;
+}
+
+/** \} */
@@ -717,6 +717,11 @@ void IMB_rect_from_float(ImBuf *ibuf)
                                       COLOR_ROLE_DEFAULT_BYTE) :
                                   ibuf->byte_buffer.colorspace->name;
 
+  if (colormanage_fast_rect_from_float(ibuf, from_colorspace, to_colorspace)) {
+    ibuf->userflags &= ~IB_RECT_INVALID;
+    return;
+  }
+
   float *buffer = static_cast<float *>(MEM_dupallocN(ibuf->float_buffer.data));
 
   /* first make float buffer in byte space */
@@ -11,6 +11,7 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_math_base.h"
+#include "BLI_simd.h"
 #include "BLI_utildefines.h"
 
 #include "IMB_filter.h"
@@ -641,19 +642,29 @@ void IMB_premultiply_rect(uint8_t *rect, char planes, int w, int h)
 
 void IMB_premultiply_rect_float(float *rect_float, int channels, int w, int h)
 {
-  float val, *cp;
-  int x, y;
+  if (channels != 4) {
+    return;
+  }
 
-  if (channels == 4) {
-    cp = rect_float;
-    for (y = 0; y < h; y++) {
-      for (x = 0; x < w; x++, cp += 4) {
-        val = cp[3];
-        cp[0] = cp[0] * val;
-        cp[1] = cp[1] * val;
-        cp[2] = cp[2] * val;
-      }
-    }
+  const size_t num_pixels = size_t(w) * h;
+  float *cp = rect_float;
+  size_t i = 0;
+#if BLI_HAVE_SSE2
+  /* Multiply by (alpha, alpha, alpha, 1). */
+  const __m128 alpha_mask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+  const __m128 one = _mm_set1_ps(1.0f);
+  for (; i < num_pixels; i++, cp += 4) {
+    const __m128 pixel = _mm_loadu_ps(cp);
+    __m128 factor = _mm_shuffle_ps(pixel, pixel, _MM_SHUFFLE(3, 3, 3, 3));
+    factor = _mm_or_ps(_mm_and_ps(alpha_mask, one), _mm_andnot_ps(alpha_mask, factor));
+    _mm_storeu_ps(cp, _mm_mul_ps(pixel, factor));
+  }
+#endif
+  for (; i < num_pixels; i++, cp += 4) {
+    const float val = cp[3];
+    cp[0] = cp[0] * val;
+    cp[1] = cp[1] * val;
+    cp[2] = cp[2] * val;
   }
 }
 
@@ -703,19 +714,31 @@ void IMB_unpremultiply_rect(uint8_t *rect, char planes, int w, int h)
 
 void IMB_unpremultiply_rect_float(float *rect_float, int channels, int w, int h)
 {
-  float val, *fp;
-  int x, y;
+  if (channels != 4) {
+    return;
+  }
 
-  if (channels == 4) {
-    fp = rect_float;
-    for (y = 0; y < h; y++) {
-      for (x = 0; x < w; x++, fp += 4) {
-        val = fp[3] != 0.0f ? 1.0f / fp[3] : 1.0f;
-        fp[0] = fp[0] * val;
-        fp[1] = fp[1] * val;
-        fp[2] = fp[2] * val;
-      }
-    }
+  const size_t num_pixels = size_t(w) * h;
+  float *fp = rect_float;
+  size_t i = 0;
+#if BLI_HAVE_SSE2
+  /* Multiply by (1 / alpha, 1 / alpha, 1 / alpha, 1), or by one when alpha is zero. */
+  const __m128 alpha_mask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+  const __m128 one = _mm_set1_ps(1.0f);
+  for (; i < num_pixels; i++, fp += 4) {
+    const __m128 pixel = _mm_loadu_ps(fp);
+    const __m128 alpha = _mm_shuffle_ps(pixel, pixel, _MM_SHUFFLE(3, 3, 3, 3));
+    const __m128 keep = _mm_or_ps(alpha_mask, _mm_cmpeq_ps(alpha, _mm_setzero_ps()));
+    const __m128 factor = _mm_or_ps(_mm_and_ps(keep, one),
+                                    _mm_andnot_ps(keep, _mm_div_ps(one, alpha)));
+    _mm_storeu_ps(fp, _mm_mul_ps(pixel, factor));
+  }
+#endif
+  for (; i < num_pixels; i++, fp += 4) {
+    const float val = fp[3] != 0.0f ? 1.0f / fp[3] : 1.0f;
+    fp[0] = fp[0] * val;
+    fp[1] = fp[1] * val;
+    fp[2] = fp[2] * val;
   }
 }
 
@@ -7,6 +7,7 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <cerrno>
 #include <cstddef>
 #include <cstdio>
@@ -79,6 +80,7 @@
 #include "BLI_math_color.h"
 #include "BLI_mmap.h"
 #include "BLI_string_utils.h"
+#include "BLI_task.hh"
 #include "BLI_threads.h"
 
 #include "BKE_idprop.h"
@@ -695,6 +697,7 @@ struct ExrChannel {
   MultiViewChannelName *m;        /* struct to store all multipart channel info */
   int xstride, ystride;           /* step to next pixel, to next scan-line. */
   float *rect;                    /* first pointer to write in */
+  int pass_offset;                /* offset of first element in the buffer of its pass */
   char chan_id;                   /* quick lookup of channel char */
   int view_id;                    /* quick lookup of channel view */
   bool use_half_float;            /* when saving use half float for file storage */
@@ -1267,9 +1270,109 @@ void IMB_exrtile_write_channels(
   }
 }
 
-void IMB_exr_read_channels(void *handle)
+/* Point the channels of a pass into the given buffer, or clear them when it is null. */
+static void imb_exr_pass_set_rect(ExrPass *pass, float *rect)
+{
+  pass->rect = rect;
+  for (int a = 0; a < pass->totchan; a++) {
+    ExrChannel *echan = pass->chan[a];
+    echan->rect = rect ? rect + echan->pass_offset : nullptr;
+  }
+}
+
+/* Read one part of the file, see #imb_exr_read_rows. Returns false on read errors. */
+static bool imb_exr_read_part(
+    ExrHandle *data, const int part, const bool flip, const int row_min, const int row_max)
+{
+  /* Read part header. */
+  InputPart in(*data->ifile, part);
+  Header header = in.header();
+  Box2i dw = header.dataWindow();
+
+  /* Insert all matching channel into frame-buffer. */
+  FrameBuffer frameBuffer;
+  ExrChannel *echan;
+  bool has_channels = false;
+
+  for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
+    if (echan->m->part_number != part) {
+      continue;
+    }
+
+    exr_printf("%d %-6s %-22s \"%s\"\n",
+               echan->m->part_number,
+               echan->m->view.c_str(),
+               echan->m->name.c_str(),
+               echan->m->internal_name.c_str());
+
+    if (echan->rect) {
+      float *rect = echan->rect;
+      size_t xstride = echan->xstride * sizeof(float);
+      size_t ystride = echan->ystride * sizeof(float);
+
+      if (!flip) {
+        /* Inverse correct first pixel for data-window coordinates. */
+        rect -= echan->xstride * dw.min.x - echan->ystride * (dw.min.y - row_min);
+        /* Move to last scan-line to flip to Blender convention. */
+        rect += echan->ystride * (data->height - 1);
+        ystride = -ystride;
+      }
+      else {
+        /* Inverse correct first pixel for data-window coordinates. */
+        rect -= echan->xstride * dw.min.x + echan->ystride * (dw.min.y + row_min);
+      }
+
+      frameBuffer.insert(echan->m->internal_name,
+                         Slice(Imf::FLOAT, (char *)rect, xstride, ystride));
+      has_channels = true;
+    }
+  }
+
+  if (!has_channels) {
+    return true;
+  }
+
+  /* Scan-lines of the requested rows. */
+  int line_min, line_max;
+  if (!flip) {
+    line_min = dw.min.y + data->height - row_max;
+    line_max = dw.min.y + data->height - 1 - row_min;
+  }
+  else {
+    line_min = dw.min.y + row_min;
+    line_max = dw.min.y + row_max - 1;
+  }
+  line_min = std::max(line_min, dw.min.y);
+  line_max = std::min(line_max, dw.max.y);
+  if (line_min > line_max) {
+    return true;
+  }
+
+  /* Read pixels. */
+  try {
+    in.setFrameBuffer(frameBuffer);
+    exr_printf("readPixels:readPixels[%d]: min.y: %d, max.y: %d\n", part, line_min, line_max);
+    in.readPixels(line_min, line_max);
+  }
+  catch (const std::exception &exc) {
+    std::cerr << "OpenEXR-readPixels: ERROR: " << exc.what() << std::endl;
+    return false;
+  }
+  catch (...) { /* Catch-all for edge cases or compiler bugs. */
+    std::cerr << "OpenEXR-readPixels: UNKNOWN ERROR: " << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Read all channels which have a buffer assigned, limited to Blender rows `[row_min, row_max)`.
+ * Channel buffers start at `row_min`. Parts are read in parallel, OpenEXR decodes the chunks of
+ * each part on its own thread pool as well. Parts not started yet are skipped after a read error,
+ * returns false in that case.
+ */
+static bool imb_exr_read_rows(ExrHandle *data, const int row_min, const int row_max)
 {
-  ExrHandle *data = (ExrHandle *)handle;
   int numparts = data->ifile->parts();
 
   /* Check if EXR was saved with previous versions of blender which flipped images. */
@@ -1277,7 +1380,7 @@ void IMB_exr_read_channels(void *handle)
       "BlenderMultiChannel");
 
   /* 'previous multilayer attribute, flipped. */
-  short flip = (ta && STRPREFIX(ta->value().c_str(), "Blender V2.43"));
+  const bool flip = (ta && STRPREFIX(ta->value().c_str(), "Blender V2.43"));
 
   exr_printf(
       "\nIMB_exr_read_channels\n%s %-6s %-22s "
@@ -1287,64 +1390,94 @@ void IMB_exr_read_channels(void *handle)
       "name",
       "internal_name");
 
-  for (int i = 0; i < numparts; i++) {
-    /* Read part header. */
-    InputPart in(*data->ifile, i);
-    Header header = in.header();
-    Box2i dw = header.dataWindow();
+  using namespace blender;
+  std::atomic<bool> read_error = false;
+  threading::parallel_for(IndexRange(numparts), 1, [&](const IndexRange parts) {
+    for (const int64_t part : parts) {
+      if (read_error) {
+        break;
+      }
+      if (!imb_exr_read_part(data, int(part), flip, row_min, row_max)) {
+        read_error = true;
+      }
+    }
+  });
+  return !read_error;
+}
 
-    /* Insert all matching channel into frame-buffer. */
-    FrameBuffer frameBuffer;
-    ExrChannel *echan;
+void IMB_exr_read_channels(void *handle)
+{
+  ExrHandle *data = (ExrHandle *)handle;
 
-    for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
-      if (echan->m->part_number != i) {
-        continue;
+  /* Pass buffers are allocated on demand, read all passes. */
+  LISTBASE_FOREACH (ExrLayer *, lay, &data->layers) {
+    LISTBASE_FOREACH (ExrPass *, pass, &lay->passes) {
+      if (pass->totchan && pass->rect == nullptr) {
+        imb_exr_pass_set_rect(pass,
+                              (float *)MEM_callocN(size_t(data->width) * data->height *
+                                                       pass->totchan * sizeof(float),
+                                                   "pass rect"));
       }
+    }
+  }
 
-      exr_printf("%d %-6s %-22s \"%s\"\n",
-                 echan->m->part_number,
-                 echan->m->view.c_str(),
-                 echan->m->name.c_str(),
-                 echan->m->internal_name.c_str());
+  imb_exr_read_rows(data, 0, data->height);
+}
 
-      if (echan->rect) {
-        float *rect = echan->rect;
-        size_t xstride = echan->xstride * sizeof(float);
-        size_t ystride = echan->ystride * sizeof(float);
-
-        if (!flip) {
-          /* Inverse correct first pixel for data-window coordinates. */
-          rect -= echan->xstride * (dw.min.x - dw.min.y * data->width);
-          /* Move to last scan-line to flip to Blender convention. */
-          rect += echan->xstride * (data->height - 1) * data->width;
-          ystride = -ystride;
-        }
-        else {
-          /* Inverse correct first pixel for data-window coordinates. */
-          rect -= echan->xstride * (dw.min.x + dw.min.y * data->width);
-        }
+float *IMB_exr_read_pass(void *handle,
+                         const char *layname,
+                         const char *passname,
+                         const char *viewname,
+                         int row_min,
+                         int row_max,
+                         int *r_totchan)
+{
+  ExrHandle *data = (ExrHandle *)handle;
 
-        frameBuffer.insert(echan->m->internal_name,
-                           Slice(Imf::FLOAT, (char *)rect, xstride, ystride));
-      }
-    }
+  if (row_max <= row_min) {
+    row_min = 0;
+    row_max = data->height;
+  }
+  row_min = std::max(row_min, 0);
+  row_max = std::min(row_max, data->height);
+  if (row_max <= row_min) {
+    return nullptr;
+  }
 
-    /* Read pixels. */
-    try {
-      in.setFrameBuffer(frameBuffer);
-      exr_printf("readPixels:readPixels[%d]: min.y: %d, max.y: %d\n", i, dw.min.y, dw.max.y);
-      in.readPixels(dw.min.y, dw.max.y);
-    }
-    catch (const std::exception &exc) {
-      std::cerr << "OpenEXR-readPixels: ERROR: " << exc.what() << std::endl;
-      break;
-    }
-    catch (...) { /* Catch-all for edge cases or compiler bugs. */
-      std::cerr << "OpenEXR-readPixels: UNKNOWN ERROR: " << std::endl;
+  ExrLayer *lay = (ExrLayer *)BLI_findstring(&data->layers, layname, offsetof(ExrLayer, name));
+  if (lay == nullptr) {
+    return nullptr;
+  }
+  ExrPass *pass = nullptr;
+  LISTBASE_FOREACH (ExrPass *, pass_iter, &lay->passes) {
+    if (STREQ(pass_iter->internal_name, passname) && STREQ(pass_iter->view, viewname)) {
+      pass = pass_iter;
       break;
     }
   }
+  if (pass == nullptr || pass->totchan == 0) {
+    return nullptr;
+  }
+
+  /* Only assign this pass, so other channels are skipped when decoding. */
+  LISTBASE_FOREACH (ExrChannel *, echan, &data->channels) {
+    echan->rect = nullptr;
+  }
+  float *rect = (float *)MEM_callocN(
+      size_t(data->width) * (row_max - row_min) * pass->totchan * sizeof(float), __func__);
+  imb_exr_pass_set_rect(pass, rect);
+
+  const bool success = imb_exr_read_rows(data, row_min, row_max);
+
+  imb_exr_pass_set_rect(pass, nullptr);
+  if (!success) {
+    MEM_freeN(rect);
+    return nullptr;
+  }
+
+  /* Ownership goes to the caller. */
+  *r_totchan = pass->totchan;
+  return rect;
 }
 
 void IMB_exr_multilayer_convert(void *handle,
@@ -1642,11 +1775,10 @@ static bool imb_exr_multilayer_parse_channels_from_file(ExrHandle *data)
   for (ExrLayer *lay = (ExrLayer *)data->layers.first; lay; lay = lay->next) {
     for (ExrPass *pass = (ExrPass *)lay->passes.first; pass; pass = pass->next) {
       if (pass->totchan) {
-        pass->rect = (float *)MEM_callocN(
-            data->width * data->height * pass->totchan * sizeof(float), "pass rect");
+        /* Buffers are allocated when reading, only set up the channel layout here. */
         if (pass->totchan == 1) {
           ExrChannel *echan = pass->chan[0];
-          echan->rect = pass->rect;
+          echan->pass_offset = 0;
           echan->xstride = 1;
           echan->ystride = data->width;
           pass->chan_id[0] = echan->chan_id;
@@ -1681,7 +1813,7 @@ static bool imb_exr_multilayer_parse_channels_from_file(ExrHandle *data)
             }
             for (int a = 0; a < pass->totchan; a++) {
               echan = pass->chan[a];
-              echan->rect = pass->rect + lookup[uint(echan->chan_id)];
+              echan->pass_offset = lookup[uint(echan->chan_id)];
               echan->xstride = pass->totchan;
               echan->ystride = data->width * pass->totchan;
               pass->chan_id[uint(lookup[uint(echan->chan_id)])] = echan->chan_id;
@@ -1690,7 +1822,7 @@ static bool imb_exr_multilayer_parse_channels_from_file(ExrHandle *data)
           else { /* unknown */
             for (int a = 0; a < pass->totchan; a++) {
               ExrChannel *echan = pass->chan[a];
-              echan->rect = pass->rect + a;
+              echan->pass_offset = a;
               echan->xstride = pass->totchan;
               echan->ystride = data->width * pass->totchan;
               pass->chan_id[a] = echan->chan_id;
@@ -1947,6 +2079,28 @@ static bool imb_exr_is_multi(MultiPartInputFile &file)
   return false;
 }
 
+static void imb_exr_header_metadata_to_imbuf(const Header &header, ImBuf *ibuf)
+{
+  Header::ConstIterator iter;
+
+  IMB_metadata_ensure(&ibuf->metadata);
+  for (iter = header.begin(); iter != header.end(); iter++) {
+    const StringAttribute *attr = header.findTypedAttribute<StringAttribute>(iter.name());
+
+    /* not all attributes are string attributes so we might get some NULLs here */
+    if (attr) {
+      IMB_metadata_set_field(ibuf->metadata, iter.name(), attr->value().c_str());
+      ibuf->flags |= IB_metadata;
+    }
+  }
+}
+
+void IMB_exr_metadata_to_imbuf(void *handle, ImBuf *ibuf)
+{
+  ExrHandle *data = (ExrHandle *)handle;
+  imb_exr_header_metadata_to_imbuf(data->ifile->header(0), ibuf);
+}
+
 bool IMB_exr_has_multilayer(void *handle)
 {
   ExrHandle *data = (ExrHandle *)handle;
@@ -2005,20 +2159,7 @@ ImBuf *imb_load_openexr(const uchar *mem, size_t size, int flags, char colorspac
       if (!(flags & IB_test)) {
 
         if (flags & IB_metadata) {
-          const Header &header = file->header(0);
-          Header::ConstIterator iter;
-
-          IMB_metadata_ensure(&ibuf->metadata);
-          for (iter = header.begin(); iter != header.end(); iter++) {
-            const StringAttribute *attr = file->header(0).findTypedAttribute<StringAttribute>(
-                iter.name());
-
-            /* not all attributes are string attributes so we might get some NULLs here */
-            if (attr) {
-              IMB_metadata_set_field(ibuf->metadata, iter.name(), attr->value().c_str());
-              ibuf->flags |= IB_metadata;
-            }
-          }
+          imb_exr_header_metadata_to_imbuf(file->header(0), ibuf);
         }
 
         /* Only enters with IB_multilayer flag set. */
@@ -74,6 +74,16 @@ float *IMB_exr_channel_rect(void * /*handle*/,
 }
 
 void IMB_exr_read_channels(void * /*handle*/) {}
+float *IMB_exr_read_pass(void * /*handle*/,
+                         const char * /*layname*/,
+                         const char * /*passname*/,
+                         const char * /*viewname*/,
+                         int /*row_min*/,
+                         int /*row_max*/,
+                         int * /*r_totchan*/)
+{
+  return nullptr;
+}
 void IMB_exr_write_channels(void * /*handle*/) {}
 void IMB_exrtile_write_channels(void * /*handle*/,
                                 int /*partx*/,
@@ -106,3 +116,5 @@ bool IMB_exr_has_multilayer(void * /*handle*/)
 {
   return false;
 }
+
+void IMB_exr_metadata_to_imbuf(void * /*handle*/, ImBuf * /*ibuf*/) {}
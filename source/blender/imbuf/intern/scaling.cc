@@ -6,10 +6,15 @@
  * \ingroup imbuf
  */
 
+#include <algorithm>
+#include <cstring>
 #include <math.h>
 
+#include "BLI_array.hh"
+#include "BLI_math_base.h"
 #include "BLI_math_color.h"
-#include "BLI_math_interp.h"
+#include "BLI_simd.h"
+#include "BLI_task.hh"
 #include "BLI_utildefines.h"
 #include "MEM_guardedalloc.h"
 
@@ -460,1113 +465,345 @@ ImBuf *IMB_onehalf(ImBuf *ibuf1)
   return ibuf2;
 }
 
-/* q_scale_linear_interpolation helper functions */
-
-static void enlarge_picture_byte(
-    uchar *src, uchar *dst, int src_width, int src_height, int dst_width, int dst_height)
-{
-  double ratiox = double(dst_width - 1.0) / double(src_width - 1.001);
-  double ratioy = double(dst_height - 1.0) / double(src_height - 1.001);
-  uintptr_t x_src, dx_src, x_dst;
-  uintptr_t y_src, dy_src, y_dst;
-
-  dx_src = 65536.0 / ratiox;
-  dy_src = 65536.0 / ratioy;
-
-  y_src = 0;
-  for (y_dst = 0; y_dst < dst_height; y_dst++) {
-    uchar *line1 = src + (y_src >> 16) * 4 * src_width;
-    uchar *line2 = line1 + 4 * src_width;
-    uintptr_t weight1y = 65536 - (y_src & 0xffff);
-    uintptr_t weight2y = 65536 - weight1y;
-
-    if ((y_src >> 16) == src_height - 1) {
-      line2 = line1;
-    }
-
-    x_src = 0;
-    for (x_dst = 0; x_dst < dst_width; x_dst++) {
-      uintptr_t weight1x = 65536 - (x_src & 0xffff);
-      uintptr_t weight2x = 65536 - weight1x;
-
-      ulong x = (x_src >> 16) * 4;
-
-      *dst++ = ((((line1[x] * weight1y) >> 16) * weight1x) >> 16) +
-               ((((line2[x] * weight2y) >> 16) * weight1x) >> 16) +
-               ((((line1[4 + x] * weight1y) >> 16) * weight2x) >> 16) +
-               ((((line2[4 + x] * weight2y) >> 16) * weight2x) >> 16);
-
-      *dst++ = ((((line1[x + 1] * weight1y) >> 16) * weight1x) >> 16) +
-               ((((line2[x + 1] * weight2y) >> 16) * weight1x) >> 16) +
-               ((((line1[4 + x + 1] * weight1y) >> 16) * weight2x) >> 16) +
-               ((((line2[4 + x + 1] * weight2y) >> 16) * weight2x) >> 16);
-
-      *dst++ = ((((line1[x + 2] * weight1y) >> 16) * weight1x) >> 16) +
-               ((((line2[x + 2] * weight2y) >> 16) * weight1x) >> 16) +
-               ((((line1[4 + x + 2] * weight1y) >> 16) * weight2x) >> 16) +
-               ((((line2[4 + x + 2] * weight2y) >> 16) * weight2x) >> 16);
+/* -------------------------------------------------------------------- */
+/** \name Separable Scaling
+ *
+ * Scaling is done in two passes, one for each axis. For every destination pixel of an axis the
+ * contributing source pixels and their normalized weights are computed once, each pass then
+ * only has to accumulate weighted source pixels. Rows are processed in parallel.
+ * \{ */
+
+namespace blender::imbuf::scale {
+
+/** Source pixels and weights contributing to each destination pixel along one axis. */
+struct ScaleWeights {
+  /** Maximum number of source pixels for a single destination pixel. */
+  int taps = 0;
+  /** First contributing source pixel, for every destination pixel. */
+  Array<int> first;
+  /** Number of contributing source pixels, for every destination pixel. */
+  Array<int> count;
+  /** `taps` weights for every destination pixel. */
+  Array<float> weights;
+};
 
-      *dst++ = ((((line1[x + 3] * weight1y) >> 16) * weight1x) >> 16) +
-               ((((line2[x + 3] * weight2y) >> 16) * weight1x) >> 16) +
-               ((((line1[4 + x + 3] * weight1y) >> 16) * weight2x) >> 16) +
-               ((((line2[4 + x + 3] * weight2y) >> 16) * weight2x) >> 16);
+/* Rows per task, scaling small images such as icons is not worth threading. */
+static constexpr int64_t scale_grain_size = 16;
 
-      x_src += dx_src;
-    }
-    y_src += dy_src;
-  }
+static float filter_triangle(float x)
+{
+  x = fabsf(x);
+  return (x < 1.0f) ? 1.0f - x : 0.0f;
 }
 
-struct scale_outpix_byte {
-  uintptr_t r;
-  uintptr_t g;
-  uintptr_t b;
-  uintptr_t a;
-
-  uintptr_t weight;
-};
-
-static void shrink_picture_byte(
-    uchar *src, uchar *dst, int src_width, int src_height, int dst_width, int dst_height)
+/* Mitchell-Netravali filter with B = C = 1/3. */
+static float filter_mitchell(float x)
 {
-  double ratiox = double(dst_width) / double(src_width);
-  double ratioy = double(dst_height) / double(src_height);
-  uintptr_t x_src, dx_dst, x_dst;
-  uintptr_t y_src, dy_dst, y_dst;
-  intptr_t y_counter;
-  uchar *dst_begin = dst;
-
-  scale_outpix_byte *dst_line1 = nullptr;
-  scale_outpix_byte *dst_line2 = nullptr;
-
-  dst_line1 = (scale_outpix_byte *)MEM_callocN((dst_width + 1) * sizeof(scale_outpix_byte),
-                                               "shrink_picture_byte 1");
-  dst_line2 = (scale_outpix_byte *)MEM_callocN((dst_width + 1) * sizeof(scale_outpix_byte),
-                                               "shrink_picture_byte 2");
-
-  dx_dst = 65536.0 * ratiox;
-  dy_dst = 65536.0 * ratioy;
-
-  y_dst = 0;
-  y_counter = 65536;
-  for (y_src = 0; y_src < src_height; y_src++) {
-    uchar *line = src + y_src * 4 * src_width;
-    uintptr_t weight1y = 65535 - (y_dst & 0xffff);
-    uintptr_t weight2y = 65535 - weight1y;
-    x_dst = 0;
-    for (x_src = 0; x_src < src_width; x_src++) {
-      uintptr_t weight1x = 65535 - (x_dst & 0xffff);
-      uintptr_t weight2x = 65535 - weight1x;
-
-      uintptr_t x = x_dst >> 16;
-
-      uintptr_t w;
-
-      w = (weight1y * weight1x) >> 16;
-
-      /* Ensure correct rounding, without this you get ugly banding,
-       * or too low color values (ton). */
-      dst_line1[x].r += (line[0] * w + 32767) >> 16;
-      dst_line1[x].g += (line[1] * w + 32767) >> 16;
-      dst_line1[x].b += (line[2] * w + 32767) >> 16;
-      dst_line1[x].a += (line[3] * w + 32767) >> 16;
-      dst_line1[x].weight += w;
-
-      w = (weight2y * weight1x) >> 16;
-
-      dst_line2[x].r += (line[0] * w + 32767) >> 16;
-      dst_line2[x].g += (line[1] * w + 32767) >> 16;
-      dst_line2[x].b += (line[2] * w + 32767) >> 16;
-      dst_line2[x].a += (line[3] * w + 32767) >> 16;
-      dst_line2[x].weight += w;
-
-      w = (weight1y * weight2x) >> 16;
-
-      dst_line1[x + 1].r += (line[0] * w + 32767) >> 16;
-      dst_line1[x + 1].g += (line[1] * w + 32767) >> 16;
-      dst_line1[x + 1].b += (line[2] * w + 32767) >> 16;
-      dst_line1[x + 1].a += (line[3] * w + 32767) >> 16;
-      dst_line1[x + 1].weight += w;
-
-      w = (weight2y * weight2x) >> 16;
-
-      dst_line2[x + 1].r += (line[0] * w + 32767) >> 16;
-      dst_line2[x + 1].g += (line[1] * w + 32767) >> 16;
-      dst_line2[x + 1].b += (line[2] * w + 32767) >> 16;
-      dst_line2[x + 1].a += (line[3] * w + 32767) >> 16;
-      dst_line2[x + 1].weight += w;
-
-      x_dst += dx_dst;
-      line += 4;
-    }
-
-    y_dst += dy_dst;
-    y_counter -= dy_dst;
-    if (y_counter < 0) {
-      int val;
-      uintptr_t x;
-      scale_outpix_byte *temp;
-
-      y_counter += 65536;
-
-      for (x = 0; x < dst_width; x++) {
-        uintptr_t f = 0x80000000UL / dst_line1[x].weight;
-        *dst++ = (val = (dst_line1[x].r * f) >> 15) > 255 ? 255 : val;
-        *dst++ = (val = (dst_line1[x].g * f) >> 15) > 255 ? 255 : val;
-        *dst++ = (val = (dst_line1[x].b * f) >> 15) > 255 ? 255 : val;
-        *dst++ = (val = (dst_line1[x].a * f) >> 15) > 255 ? 255 : val;
-      }
-      memset(dst_line1, 0, dst_width * sizeof(scale_outpix_byte));
-      temp = dst_line1;
-      dst_line1 = dst_line2;
-      dst_line2 = temp;
-    }
-  }
-  if (dst - dst_begin < dst_width * dst_height * 4) {
-    int val;
-    uintptr_t x;
-    for (x = 0; x < dst_width; x++) {
-      uintptr_t f = 0x80000000UL / dst_line1[x].weight;
-      *dst++ = (val = (dst_line1[x].r * f) >> 15) > 255 ? 255 : val;
-      *dst++ = (val = (dst_line1[x].g * f) >> 15) > 255 ? 255 : val;
-      *dst++ = (val = (dst_line1[x].b * f) >> 15) > 255 ? 255 : val;
-      *dst++ = (val = (dst_line1[x].a * f) >> 15) > 255 ? 255 : val;
-    }
-  }
-  MEM_freeN(dst_line1);
-  MEM_freeN(dst_line2);
+  const float b = 1.0f / 3.0f;
+  const float c = 1.0f / 3.0f;
+  x = fabsf(x);
+  if (x < 1.0f) {
+    return ((12.0f - 9.0f * b - 6.0f * c) * x * x * x +
+            (-18.0f + 12.0f * b + 6.0f * c) * x * x + (6.0f - 2.0f * b)) /
+           6.0f;
+  }
+  if (x < 2.0f) {
+    return ((-b - 6.0f * c) * x * x * x + (6.0f * b + 30.0f * c) * x * x +
+            (-12.0f * b - 48.0f * c) * x + (8.0f * b + 24.0f * c)) /
+           6.0f;
+  }
+  return 0.0f;
 }
 
-static void q_scale_byte(
-    uchar *in, uchar *out, int in_width, int in_height, int dst_width, int dst_height)
+static float filter_lanczos3(float x)
 {
-  if (dst_width > in_width && dst_height > in_height) {
-    enlarge_picture_byte(in, out, in_width, in_height, dst_width, dst_height);
+  x = fabsf(x);
+  if (x < 1e-6f) {
+    return 1.0f;
   }
-  else if (dst_width < in_width && dst_height < in_height) {
-    shrink_picture_byte(in, out, in_width, in_height, dst_width, dst_height);
+  if (x >= 3.0f) {
+    return 0.0f;
   }
+  const float px = float(M_PI) * x;
+  return 3.0f * sinf(px) * sinf(px / 3.0f) / (px * px);
 }
 
-static void enlarge_picture_float(
-    float *src, float *dst, int src_width, int src_height, int dst_width, int dst_height)
+static ScaleWeights compute_weights(const int src_size,
+                                    const int dst_size,
+                                    const eIMBScaleFilter filter)
 {
-  double ratiox = double(dst_width - 1.0) / double(src_width - 1.001);
-  double ratioy = double(dst_height - 1.0) / double(src_height - 1.001);
-  uintptr_t x_dst;
-  uintptr_t y_dst;
-  double x_src, dx_src;
-  double y_src, dy_src;
-
-  dx_src = 1.0 / ratiox;
-  dy_src = 1.0 / ratioy;
-
-  y_src = 0;
-  for (y_dst = 0; y_dst < dst_height; y_dst++) {
-    float *line1 = src + int(y_src) * 4 * src_width;
-    const float *line2 = line1 + 4 * src_width;
-    const float weight1y = float(1.0 - (y_src - int(y_src)));
-    const float weight2y = 1.0f - weight1y;
-
-    if (int(y_src) == src_height - 1) {
-      line2 = line1;
-    }
-
-    x_src = 0;
-    for (x_dst = 0; x_dst < dst_width; x_dst++) {
-      const float weight1x = float(1.0 - (x_src - int(x_src)));
-      const float weight2x = float(1.0f - weight1x);
-
-      const float w11 = weight1y * weight1x;
-      const float w21 = weight2y * weight1x;
-      const float w12 = weight1y * weight2x;
-      const float w22 = weight2y * weight2x;
-
-      uintptr_t x = int(x_src) * 4;
-
-      *dst++ = line1[x] * w11 + line2[x] * w21 + line1[4 + x] * w12 + line2[4 + x] * w22;
-
-      *dst++ = line1[x + 1] * w11 + line2[x + 1] * w21 + line1[4 + x + 1] * w12 +
-               line2[4 + x + 1] * w22;
-
-      *dst++ = line1[x + 2] * w11 + line2[x + 2] * w21 + line1[4 + x + 2] * w12 +
-               line2[4 + x + 2] * w22;
-
-      *dst++ = line1[x + 3] * w11 + line2[x + 3] * w21 + line1[4 + x + 3] * w12 +
-               line2[4 + x + 3] * w22;
-
-      x_src += dx_src;
-    }
-    y_src += dy_src;
-  }
+  const float ratio = float(src_size) / float(dst_size);
+  /* When scaling down the filter is stretched to cover all source pixels. */
+  const float filter_scale = max_ff(ratio, 1.0f);
+  /* Box filtering computes the exact area of source pixels covered by a destination pixel, when
+   * scaling up that is nearest neighbor, so interpolate linearly instead. */
+  const bool use_area = (filter == IMB_SCALE_FILTER_BOX && ratio > 1.0f);
+
+  float (*filter_fn)(float) = filter_triangle;
+  float support = 1.0f;
+  switch (filter) {
+    case IMB_SCALE_FILTER_BOX:
+    case IMB_SCALE_FILTER_BILINEAR:
+      break;
+    case IMB_SCALE_FILTER_MITCHELL:
+      filter_fn = filter_mitchell;
+      support = 2.0f;
+      break;
+    case IMB_SCALE_FILTER_LANCZOS3:
+      filter_fn = filter_lanczos3;
+      support = 3.0f;
+      break;
+  }
+
+  const float radius = use_area ? ratio * 0.5f : support * filter_scale;
+
+  ScaleWeights result;
+  result.taps = int(ceilf(radius * 2.0f)) + 2;
+  result.first.reinitialize(dst_size);
+  result.count.reinitialize(dst_size);
+  result.weights = Array<float>(int64_t(dst_size) * result.taps, 0.0f);
+
+  for (const int i : IndexRange(dst_size)) {
+    const float center = (float(i) + 0.5f) * ratio;
+    const int first = max_ii(int(floorf(center - radius)), 0);
+    const int last = min_ii(int(ceilf(center + radius)), src_size - 1);
+    float *weights = &result.weights[int64_t(i) * result.taps];
+
+    int count = 0;
+    float weight_sum = 0.0f;
+    for (int j = first; j <= last && count < result.taps; j++) {
+      float weight;
+      if (use_area) {
+        weight = min_ff(center + radius, float(j + 1)) - max_ff(center - radius, float(j));
+        weight = max_ff(weight, 0.0f);
+      }
+      else {
+        weight = filter_fn((float(j) + 0.5f - center) / filter_scale);
+      }
+      weights[count++] = weight;
+      weight_sum += weight;
+    }
+
+    /* Skip source pixels that do not contribute. */
+    int skip = 0;
+    while (skip < count - 1 && weights[skip] == 0.0f) {
+      skip++;
+    }
+    while (count - 1 > skip && weights[count - 1] == 0.0f) {
+      count--;
+    }
+    if (skip) {
+      memmove(weights, weights + skip, sizeof(float) * (count - skip));
+      std::fill(weights + count - skip, weights + count, 0.0f);
+    }
+    count -= skip;
+
+    if (weight_sum != 0.0f) {
+      for (int j = 0; j < count; j++) {
+        weights[j] /= weight_sum;
+      }
+      result.first[i] = first + skip;
+      result.count[i] = count;
+    }
+    else {
+      weights[0] = 1.0f;
+      result.first[i] = clamp_i(int(center), 0, src_size - 1);
+      result.count[i] = 1;
+    }
+  }
+
+  return result;
 }
 
-struct scale_outpix_float {
-  float r;
-  float g;
-  float b;
-  float a;
-
-  float weight;
-};
-
-static void shrink_picture_float(
-    const float *src, float *dst, int src_width, int src_height, int dst_width, int dst_height)
+BLI_INLINE void store_value(const float value, float *dst)
 {
-  double ratiox = double(dst_width) / double(src_width);
-  double ratioy = double(dst_height) / double(src_height);
-  uintptr_t x_src;
-  uintptr_t y_src;
-  float dx_dst, x_dst;
-  float dy_dst, y_dst;
-  float y_counter;
-  const float *dst_begin = dst;
-
-  scale_outpix_float *dst_line1;
-  scale_outpix_float *dst_line2;
-
-  dst_line1 = (scale_outpix_float *)MEM_callocN((dst_width + 1) * sizeof(scale_outpix_float),
-                                                "shrink_picture_float 1");
-  dst_line2 = (scale_outpix_float *)MEM_callocN((dst_width + 1) * sizeof(scale_outpix_float),
-                                                "shrink_picture_float 2");
-
-  dx_dst = ratiox;
-  dy_dst = ratioy;
-
-  y_dst = 0;
-  y_counter = 1.0;
-  for (y_src = 0; y_src < src_height; y_src++) {
-    const float *line = src + y_src * 4 * src_width;
-    uintptr_t weight1y = 1.0f - (y_dst - int(y_dst));
-    uintptr_t weight2y = 1.0f - weight1y;
-    x_dst = 0;
-    for (x_src = 0; x_src < src_width; x_src++) {
-      uintptr_t weight1x = 1.0f - (x_dst - int(x_dst));
-      uintptr_t weight2x = 1.0f - weight1x;
-
-      uintptr_t x = int(x_dst);
-
-      float w;
-
-      w = weight1y * weight1x;
-
-      dst_line1[x].r += line[0] * w;
-      dst_line1[x].g += line[1] * w;
-      dst_line1[x].b += line[2] * w;
-      dst_line1[x].a += line[3] * w;
-      dst_line1[x].weight += w;
-
-      w = weight2y * weight1x;
-
-      dst_line2[x].r += line[0] * w;
-      dst_line2[x].g += line[1] * w;
-      dst_line2[x].b += line[2] * w;
-      dst_line2[x].a += line[3] * w;
-      dst_line2[x].weight += w;
-
-      w = weight1y * weight2x;
-
-      dst_line1[x + 1].r += line[0] * w;
-      dst_line1[x + 1].g += line[1] * w;
-      dst_line1[x + 1].b += line[2] * w;
-      dst_line1[x + 1].a += line[3] * w;
-      dst_line1[x + 1].weight += w;
-
-      w = weight2y * weight2x;
-
-      dst_line2[x + 1].r += line[0] * w;
-      dst_line2[x + 1].g += line[1] * w;
-      dst_line2[x + 1].b += line[2] * w;
-      dst_line2[x + 1].a += line[3] * w;
-      dst_line2[x + 1].weight += w;
-
-      x_dst += dx_dst;
-      line += 4;
-    }
-
-    y_dst += dy_dst;
-    y_counter -= dy_dst;
-    if (y_counter < 0) {
-      uintptr_t x;
-      scale_outpix_float *temp;
-
-      y_counter += 1.0f;
-
-      for (x = 0; x < dst_width; x++) {
-        float f = 1.0f / dst_line1[x].weight;
-        *dst++ = dst_line1[x].r * f;
-        *dst++ = dst_line1[x].g * f;
-        *dst++ = dst_line1[x].b * f;
-        *dst++ = dst_line1[x].a * f;
-      }
-      memset(dst_line1, 0, dst_width * sizeof(scale_outpix_float));
-      temp = dst_line1;
-      dst_line1 = dst_line2;
-      dst_line2 = temp;
-    }
-  }
-  if (dst - dst_begin < dst_width * dst_height * 4) {
-    uintptr_t x;
-    for (x = 0; x < dst_width; x++) {
-      float f = 1.0f / dst_line1[x].weight;
-      *dst++ = dst_line1[x].r * f;
-      *dst++ = dst_line1[x].g * f;
-      *dst++ = dst_line1[x].b * f;
-      *dst++ = dst_line1[x].a * f;
-    }
-  }
-  MEM_freeN(dst_line1);
-  MEM_freeN(dst_line2);
+  *dst = value;
 }
 
-static void q_scale_float(
-    float *in, float *out, int in_width, int in_height, int dst_width, int dst_height)
+BLI_INLINE void store_value(const float value, uchar *dst)
 {
-  if (dst_width > in_width && dst_height > in_height) {
-    enlarge_picture_float(in, out, in_width, in_height, dst_width, dst_height);
-  }
-  else if (dst_width < in_width && dst_height < in_height) {
-    shrink_picture_float(in, out, in_width, in_height, dst_width, dst_height);
-  }
+  *dst = round_fl_to_uchar_clamp(value);
 }
 
-/**
- * q_scale_linear_interpolation (derived from `ppmqscale`, http://libdv.sf.net)
- *
- * q stands for quick _and_ quality :)
- *
- * only handles common cases when we either
- *
- * scale both, x and y or
- * shrink both, x and y
- *
- * but that is pretty fast:
- * - does only blit once instead of two passes like the old code
- *   (fewer cache misses)
- * - uses fixed point integer arithmetic for byte buffers
- * - doesn't branch in tight loops
- *
- * Should be comparable in speed to the ImBuf ..._fast functions at least
- * for byte-buffers.
- *
- * NOTE: disabled, due to unacceptable inaccuracy and quality loss, see bug #18609 (ton)
- */
-static bool q_scale_linear_interpolation(ImBuf *ibuf, int newx, int newy)
+#if BLI_HAVE_SSE2
+BLI_INLINE __m128 load_pixel(const float *src)
 {
-  if ((newx >= ibuf->x && newy <= ibuf->y) || (newx <= ibuf->x && newy >= ibuf->y)) {
-    return false;
-  }
-
-  if (ibuf->byte_buffer.data) {
-    uchar *newrect = static_cast<uchar *>(MEM_mallocN(sizeof(int) * newx * newy, "q_scale rect"));
-    q_scale_byte(ibuf->byte_buffer.data, newrect, ibuf->x, ibuf->y, newx, newy);
-
-    IMB_assign_byte_buffer(ibuf, newrect, IB_TAKE_OWNERSHIP);
-  }
-  if (ibuf->float_buffer.data) {
-    float *newrect = static_cast<float *>(
-        MEM_mallocN(sizeof(float[4]) * newx * newy, "q_scale rectfloat"));
-    q_scale_float(ibuf->float_buffer.data, newrect, ibuf->x, ibuf->y, newx, newy);
-
-    IMB_assign_float_buffer(ibuf, newrect, IB_TAKE_OWNERSHIP);
-  }
-
-  ibuf->x = newx;
-  ibuf->y = newy;
-
-  return true;
+  return _mm_loadu_ps(src);
 }
 
-static ImBuf *scaledownx(ImBuf *ibuf, int newx)
+BLI_INLINE __m128 load_pixel(const uchar *src)
 {
-  const bool do_rect = (ibuf->byte_buffer.data != nullptr);
-  const bool do_float = (ibuf->float_buffer.data != nullptr);
-  const size_t rect_size = IMB_get_rect_len(ibuf) * 4;
-
-  uchar *rect, *_newrect, *newrect;
-  float *rectf, *_newrectf, *newrectf;
-  float sample, add, val[4], nval[4], valf[4], nvalf[4];
-  int x, y;
-
-  rectf = _newrectf = newrectf = nullptr;
-  rect = _newrect = newrect = nullptr;
-  nval[0] = nval[1] = nval[2] = nval[3] = 0.0f;
-  nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
-
-  if (!do_rect && !do_float) {
-    return ibuf;
-  }
-
-  if (do_rect) {
-    _newrect = static_cast<uchar *>(MEM_mallocN(sizeof(uchar[4]) * newx * ibuf->y, "scaledownx"));
-    if (_newrect == nullptr) {
-      return ibuf;
-    }
-  }
-  if (do_float) {
-    _newrectf = static_cast<float *>(
-        MEM_mallocN(sizeof(float[4]) * newx * ibuf->y, "scaledownxf"));
-    if (_newrectf == nullptr) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return ibuf;
-    }
-  }
-
-  add = (ibuf->x - 0.01) / newx;
-
-  if (do_rect) {
-    rect = ibuf->byte_buffer.data;
-    newrect = _newrect;
-  }
-  if (do_float) {
-    rectf = ibuf->float_buffer.data;
-    newrectf = _newrectf;
-  }
-
-  for (y = ibuf->y; y > 0; y--) {
-    sample = 0.0f;
-    val[0] = val[1] = val[2] = val[3] = 0.0f;
-    valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
-
-    for (x = newx; x > 0; x--) {
-      if (do_rect) {
-        nval[0] = -val[0] * sample;
-        nval[1] = -val[1] * sample;
-        nval[2] = -val[2] * sample;
-        nval[3] = -val[3] * sample;
-      }
-      if (do_float) {
-        nvalf[0] = -valf[0] * sample;
-        nvalf[1] = -valf[1] * sample;
-        nvalf[2] = -valf[2] * sample;
-        nvalf[3] = -valf[3] * sample;
-      }
-
-      sample += add;
-
-      while (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          nval[0] += rect[0];
-          nval[1] += rect[1];
-          nval[2] += rect[2];
-          nval[3] += rect[3];
-          rect += 4;
-        }
-        if (do_float) {
-          nvalf[0] += rectf[0];
-          nvalf[1] += rectf[1];
-          nvalf[2] += rectf[2];
-          nvalf[3] += rectf[3];
-          rectf += 4;
-        }
-      }
-
-      if (do_rect) {
-        val[0] = rect[0];
-        val[1] = rect[1];
-        val[2] = rect[2];
-        val[3] = rect[3];
-        rect += 4;
-
-        newrect[0] = roundf((nval[0] + sample * val[0]) / add);
-        newrect[1] = roundf((nval[1] + sample * val[1]) / add);
-        newrect[2] = roundf((nval[2] + sample * val[2]) / add);
-        newrect[3] = roundf((nval[3] + sample * val[3]) / add);
-
-        newrect += 4;
-      }
-      if (do_float) {
-
-        valf[0] = rectf[0];
-        valf[1] = rectf[1];
-        valf[2] = rectf[2];
-        valf[3] = rectf[3];
-        rectf += 4;
-
-        newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-        newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-        newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-        newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
-
-        newrectf += 4;
-      }
-
-      sample -= 1.0f;
-    }
-  }
-
-  if (do_rect) {
-    // printf("%ld %ld\n", (uchar *)rect - ibuf->byte_buffer.data, rect_size);
-    BLI_assert((uchar *)rect - ibuf->byte_buffer.data == rect_size); /* see bug #26502. */
-
-    imb_freerectImBuf(ibuf);
-    IMB_assign_byte_buffer(ibuf, _newrect, IB_TAKE_OWNERSHIP);
-  }
-  if (do_float) {
-    // printf("%ld %ld\n", rectf - ibuf->float_buffer.data, rect_size);
-    BLI_assert((rectf - ibuf->float_buffer.data) == rect_size); /* see bug #26502. */
-
-    imb_freerectfloatImBuf(ibuf);
-    IMB_assign_float_buffer(ibuf, _newrectf, IB_TAKE_OWNERSHIP);
-  }
-
-  (void)rect_size; /* UNUSED in release builds */
-
-  ibuf->x = newx;
-  return ibuf;
+  int32_t packed;
+  memcpy(&packed, src, sizeof(packed));
+  const __m128i zero = _mm_setzero_si128();
+  __m128i values = _mm_cvtsi32_si128(packed);
+  values = _mm_unpacklo_epi8(values, zero);
+  values = _mm_unpacklo_epi16(values, zero);
+  return _mm_cvtepi32_ps(values);
 }
 
-static ImBuf *scaledowny(ImBuf *ibuf, int newy)
+BLI_INLINE void store_pixel(const __m128 value, float *dst)
 {
-  const bool do_rect = (ibuf->byte_buffer.data != nullptr);
-  const bool do_float = (ibuf->float_buffer.data != nullptr);
-  const size_t rect_size = IMB_get_rect_len(ibuf) * 4;
-
-  uchar *rect, *_newrect, *newrect;
-  float *rectf, *_newrectf, *newrectf;
-  float sample, add, val[4], nval[4], valf[4], nvalf[4];
-  int x, y, skipx;
-
-  rectf = _newrectf = newrectf = nullptr;
-  rect = _newrect = newrect = nullptr;
-  nval[0] = nval[1] = nval[2] = nval[3] = 0.0f;
-  nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
-
-  if (!do_rect && !do_float) {
-    return ibuf;
-  }
-
-  if (do_rect) {
-    _newrect = static_cast<uchar *>(MEM_mallocN(sizeof(uchar[4]) * newy * ibuf->x, "scaledowny"));
-    if (_newrect == nullptr) {
-      return ibuf;
-    }
-  }
-  if (do_float) {
-    _newrectf = static_cast<float *>(
-        MEM_mallocN(sizeof(float[4]) * newy * ibuf->x, "scaledownyf"));
-    if (_newrectf == nullptr) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return ibuf;
-    }
-  }
-
-  add = (ibuf->y - 0.01) / newy;
-  skipx = 4 * ibuf->x;
-
-  for (x = skipx - 4; x >= 0; x -= 4) {
-    if (do_rect) {
-      rect = ibuf->byte_buffer.data + x;
-      newrect = _newrect + x;
-    }
-    if (do_float) {
-      rectf = ibuf->float_buffer.data + x;
-      newrectf = _newrectf + x;
-    }
-
-    sample = 0.0f;
-    val[0] = val[1] = val[2] = val[3] = 0.0f;
-    valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
-
-    for (y = newy; y > 0; y--) {
-      if (do_rect) {
-        nval[0] = -val[0] * sample;
-        nval[1] = -val[1] * sample;
-        nval[2] = -val[2] * sample;
-        nval[3] = -val[3] * sample;
-      }
-      if (do_float) {
-        nvalf[0] = -valf[0] * sample;
-        nvalf[1] = -valf[1] * sample;
-        nvalf[2] = -valf[2] * sample;
-        nvalf[3] = -valf[3] * sample;
-      }
-
-      sample += add;
-
-      while (sample >= 1.0f) {
-        sample -= 1.0f;
+  _mm_storeu_ps(dst, value);
+}
 
-        if (do_rect) {
-          nval[0] += rect[0];
-          nval[1] += rect[1];
-          nval[2] += rect[2];
-          nval[3] += rect[3];
-          rect += skipx;
+BLI_INLINE void store_pixel(const __m128 value, uchar *dst)
+{
+  /* Round like #round_fl_to_uchar_clamp, packing saturates to the byte range. */
+  __m128i values = _mm_cvttps_epi32(_mm_add_ps(value, _mm_set1_ps(0.5f)));
+  values = _mm_packs_epi32(values, values);
+  values = _mm_packus_epi16(values, values);
+  const int32_t packed = _mm_cvtsi128_si32(values);
+  memcpy(dst, &packed, sizeof(packed));
+}
+#endif
+
+/** Scale rows of `src` to `dst_width` pixels, the number of rows stays the same. */
+template<typename SrcT, typename DstT>
+static void scale_x(const SrcT *src,
+                    DstT *dst,
+                    const int src_width,
+                    const int dst_width,
+                    const int height,
+                    const int channels,
+                    const ScaleWeights &weights)
+{
+  threading::parallel_for(IndexRange(height), scale_grain_size, [&](const IndexRange rows) {
+    for (const int64_t y : rows) {
+      const SrcT *src_row = src + y * src_width * channels;
+      DstT *dst_row = dst + y * dst_width * channels;
+
+      for (const int x : IndexRange(dst_width)) {
+        const float *weight = &weights.weights[int64_t(x) * weights.taps];
+        const SrcT *src_pixel = src_row + int64_t(weights.first[x]) * channels;
+        const int count = weights.count[x];
+        DstT *dst_pixel = dst_row + int64_t(x) * channels;
+
+#if BLI_HAVE_SSE2
+        if (channels == 4) {
+          __m128 sum = _mm_setzero_ps();
+          for (int i = 0; i < count; i++) {
+            const __m128 value = load_pixel(src_pixel + i * 4);
+            sum = _mm_add_ps(sum, _mm_mul_ps(value, _mm_set1_ps(weight[i])));
+          }
+          store_pixel(sum, dst_pixel);
+          continue;
         }
-        if (do_float) {
-          nvalf[0] += rectf[0];
-          nvalf[1] += rectf[1];
-          nvalf[2] += rectf[2];
-          nvalf[3] += rectf[3];
-          rectf += skipx;
+#endif
+        float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (int i = 0; i < count; i++) {
+          for (int c = 0; c < channels; c++) {
+            sum[c] += float(src_pixel[i * channels + c]) * weight[i];
+          }
+        }
+        for (int c = 0; c < channels; c++) {
+          store_value(sum[c], &dst_pixel[c]);
         }
       }
-
-      if (do_rect) {
-        val[0] = rect[0];
-        val[1] = rect[1];
-        val[2] = rect[2];
-        val[3] = rect[3];
-        rect += skipx;
-
-        newrect[0] = roundf((nval[0] + sample * val[0]) / add);
-        newrect[1] = roundf((nval[1] + sample * val[1]) / add);
-        newrect[2] = roundf((nval[2] + sample * val[2]) / add);
-        newrect[3] = roundf((nval[3] + sample * val[3]) / add);
-
-        newrect += skipx;
-      }
-      if (do_float) {
-
-        valf[0] = rectf[0];
-        valf[1] = rectf[1];
-        valf[2] = rectf[2];
-        valf[3] = rectf[3];
-        rectf += skipx;
-
-        newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-        newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-        newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-        newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
-
-        newrectf += skipx;
-      }
-
-      sample -= 1.0f;
     }
-  }
-
-  if (do_rect) {
-    // printf("%ld %ld\n", (uchar *)rect - byte_buffer.data, rect_size);
-    BLI_assert((uchar *)rect - ibuf->byte_buffer.data == rect_size); /* see bug #26502. */
-
-    imb_freerectImBuf(ibuf);
-    IMB_assign_byte_buffer(ibuf, _newrect, IB_TAKE_OWNERSHIP);
-  }
-  if (do_float) {
-    // printf("%ld %ld\n", rectf - ibuf->float_buffer.data, rect_size);
-    BLI_assert((rectf - ibuf->float_buffer.data) == rect_size); /* see bug #26502. */
-
-    imb_freerectfloatImBuf(ibuf);
-    IMB_assign_float_buffer(ibuf, _newrectf, IB_TAKE_OWNERSHIP);
-  }
-
-  (void)rect_size; /* UNUSED in release builds */
-
-  ibuf->y = newy;
-  return ibuf;
+  });
 }
 
-static ImBuf *scaleupx(ImBuf *ibuf, int newx)
+/** Scale columns of `src` to `dst_height` pixels, the number of columns stays the same. */
+template<typename SrcT, typename DstT>
+static void scale_y(const SrcT *src,
+                    DstT *dst,
+                    const int width,
+                    const int dst_height,
+                    const int channels,
+                    const ScaleWeights &weights)
 {
-  uchar *rect, *_newrect = nullptr, *newrect;
-  float *rectf, *_newrectf = nullptr, *newrectf;
-  int x, y;
-  bool do_rect = false, do_float = false;
-
-  if (ibuf == nullptr) {
-    return nullptr;
-  }
-  if (ibuf->byte_buffer.data == nullptr && ibuf->float_buffer.data == nullptr) {
-    return ibuf;
-  }
-
-  if (ibuf->byte_buffer.data) {
-    do_rect = true;
-    _newrect = static_cast<uchar *>(MEM_mallocN(newx * ibuf->y * sizeof(int), "scaleupx"));
-    if (_newrect == nullptr) {
-      return ibuf;
-    }
-  }
-  if (ibuf->float_buffer.data) {
-    do_float = true;
-    _newrectf = static_cast<float *>(MEM_mallocN(sizeof(float[4]) * newx * ibuf->y, "scaleupxf"));
-    if (_newrectf == nullptr) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return ibuf;
-    }
-  }
-
-  rect = ibuf->byte_buffer.data;
-  rectf = ibuf->float_buffer.data;
-  newrect = _newrect;
-  newrectf = _newrectf;
-
-  /* Special case, copy all columns, needed since the scaling logic assumes there is at least
-   * two rows to interpolate between causing out of bounds read for 1px images, see #70356. */
-  if (UNLIKELY(ibuf->x == 1)) {
-    if (do_rect) {
-      for (y = ibuf->y; y > 0; y--) {
-        for (x = newx; x > 0; x--) {
-          memcpy(newrect, rect, sizeof(char[4]));
-          newrect += 4;
+  /* Whole rows are accumulated at once, so memory is accessed linearly. */
+  const int64_t row_size = int64_t(width) * channels;
+
+  threading::parallel_for(IndexRange(dst_height), scale_grain_size, [&](const IndexRange rows) {
+    Array<float> sum(row_size, NoInitialization());
+
+    for (const int64_t y : rows) {
+      const float *weight = &weights.weights[y * weights.taps];
+      std::fill(sum.begin(), sum.end(), 0.0f);
+
+      for (int i = 0; i < weights.count[y]; i++) {
+        const SrcT *src_row = src + int64_t(weights.first[y] + i) * row_size;
+        int64_t index = 0;
+#if BLI_HAVE_SSE2
+        const __m128 weight_4 = _mm_set1_ps(weight[i]);
+        for (; index + 4 <= row_size; index += 4) {
+          const __m128 value = _mm_mul_ps(load_pixel(src_row + index), weight_4);
+          _mm_storeu_ps(&sum[index], _mm_add_ps(_mm_loadu_ps(&sum[index]), value));
         }
-        rect += 4;
-      }
-    }
-    if (do_float) {
-      for (y = ibuf->y; y > 0; y--) {
-        for (x = newx; x > 0; x--) {
-          memcpy(newrectf, rectf, sizeof(float[4]));
-          newrectf += 4;
+#endif
+        for (; index < row_size; index++) {
+          sum[index] += float(src_row[index]) * weight[i];
         }
-        rectf += 4;
       }
-    }
-  }
-  else {
-    const float add = (ibuf->x - 1.001) / (newx - 1.0);
-    float sample;
-
-    float val_a, nval_a, diff_a;
-    float val_b, nval_b, diff_b;
-    float val_g, nval_g, diff_g;
-    float val_r, nval_r, diff_r;
-    float val_af, nval_af, diff_af;
-    float val_bf, nval_bf, diff_bf;
-    float val_gf, nval_gf, diff_gf;
-    float val_rf, nval_rf, diff_rf;
-
-    val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-    val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-    val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-    val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
-
-    for (y = ibuf->y; y > 0; y--) {
 
-      sample = 0;
-
-      if (do_rect) {
-        val_a = rect[0];
-        nval_a = rect[4];
-        diff_a = nval_a - val_a;
-        val_a += 0.5f;
-
-        val_b = rect[1];
-        nval_b = rect[5];
-        diff_b = nval_b - val_b;
-        val_b += 0.5f;
-
-        val_g = rect[2];
-        nval_g = rect[6];
-        diff_g = nval_g - val_g;
-        val_g += 0.5f;
-
-        val_r = rect[3];
-        nval_r = rect[7];
-        diff_r = nval_r - val_r;
-        val_r += 0.5f;
-
-        rect += 8;
+      DstT *dst_row = dst + y * row_size;
+      int64_t index = 0;
+#if BLI_HAVE_SSE2
+      for (; index + 4 <= row_size; index += 4) {
+        store_pixel(_mm_loadu_ps(&sum[index]), dst_row + index);
       }
-      if (do_float) {
-        val_af = rectf[0];
-        nval_af = rectf[4];
-        diff_af = nval_af - val_af;
-
-        val_bf = rectf[1];
-        nval_bf = rectf[5];
-        diff_bf = nval_bf - val_bf;
-
-        val_gf = rectf[2];
-        nval_gf = rectf[6];
-        diff_gf = nval_gf - val_gf;
-
-        val_rf = rectf[3];
-        nval_rf = rectf[7];
-        diff_rf = nval_rf - val_rf;
-
-        rectf += 8;
-      }
-      for (x = newx; x > 0; x--) {
-        if (sample >= 1.0f) {
-          sample -= 1.0f;
-
-          if (do_rect) {
-            val_a = nval_a;
-            nval_a = rect[0];
-            diff_a = nval_a - val_a;
-            val_a += 0.5f;
-
-            val_b = nval_b;
-            nval_b = rect[1];
-            diff_b = nval_b - val_b;
-            val_b += 0.5f;
-
-            val_g = nval_g;
-            nval_g = rect[2];
-            diff_g = nval_g - val_g;
-            val_g += 0.5f;
-
-            val_r = nval_r;
-            nval_r = rect[3];
-            diff_r = nval_r - val_r;
-            val_r += 0.5f;
-            rect += 4;
-          }
-          if (do_float) {
-            val_af = nval_af;
-            nval_af = rectf[0];
-            diff_af = nval_af - val_af;
-
-            val_bf = nval_bf;
-            nval_bf = rectf[1];
-            diff_bf = nval_bf - val_bf;
-
-            val_gf = nval_gf;
-            nval_gf = rectf[2];
-            diff_gf = nval_gf - val_gf;
-
-            val_rf = nval_rf;
-            nval_rf = rectf[3];
-            diff_rf = nval_rf - val_rf;
-            rectf += 4;
-          }
-        }
-        if (do_rect) {
-          newrect[0] = val_a + sample * diff_a;
-          newrect[1] = val_b + sample * diff_b;
-          newrect[2] = val_g + sample * diff_g;
-          newrect[3] = val_r + sample * diff_r;
-          newrect += 4;
-        }
-        if (do_float) {
-          newrectf[0] = val_af + sample * diff_af;
-          newrectf[1] = val_bf + sample * diff_bf;
-          newrectf[2] = val_gf + sample * diff_gf;
-          newrectf[3] = val_rf + sample * diff_rf;
-          newrectf += 4;
-        }
-        sample += add;
+#endif
+      for (; index < row_size; index++) {
+        store_value(sum[index], &dst_row[index]);
       }
     }
-  }
-
-  if (do_rect) {
-    imb_freerectImBuf(ibuf);
-    IMB_assign_byte_buffer(ibuf, _newrect, IB_TAKE_OWNERSHIP);
-  }
-  if (do_float) {
-    imb_freerectfloatImBuf(ibuf);
-    IMB_assign_float_buffer(ibuf, _newrectf, IB_TAKE_OWNERSHIP);
-  }
-
-  ibuf->x = newx;
-  return ibuf;
+  });
 }
 
-static ImBuf *scaleupy(ImBuf *ibuf, int newy)
+template<typename T>
+static T *scale_buffer(const T *src,
+                       const int src_width,
+                       const int src_height,
+                       const int channels,
+                       const int dst_width,
+                       const int dst_height,
+                       const eIMBScaleFilter filter)
 {
-  uchar *rect, *_newrect = nullptr, *newrect;
-  float *rectf, *_newrectf = nullptr, *newrectf;
-  int x, y, skipx;
-  bool do_rect = false, do_float = false;
-
-  if (ibuf == nullptr) {
-    return nullptr;
-  }
-  if (ibuf->byte_buffer.data == nullptr && ibuf->float_buffer.data == nullptr) {
-    return ibuf;
-  }
+  T *dst = static_cast<T *>(MEM_mallocN(
+      sizeof(T) * size_t(dst_width) * size_t(dst_height) * channels, "scaled image buffer"));
 
-  if (ibuf->byte_buffer.data) {
-    do_rect = true;
-    _newrect = static_cast<uchar *>(MEM_mallocN(ibuf->x * newy * sizeof(int), "scaleupy"));
-    if (_newrect == nullptr) {
-      return ibuf;
-    }
+  if (src_width == dst_width) {
+    const ScaleWeights weights_y = compute_weights(src_height, dst_height, filter);
+    scale_y(src, dst, dst_width, dst_height, channels, weights_y);
+    return dst;
   }
-  if (ibuf->float_buffer.data) {
-    do_float = true;
-    _newrectf = static_cast<float *>(MEM_mallocN(sizeof(float[4]) * ibuf->x * newy, "scaleupyf"));
-    if (_newrectf == nullptr) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return ibuf;
-    }
+  if (src_height == dst_height) {
+    const ScaleWeights weights_x = compute_weights(src_width, dst_width, filter);
+    scale_x(src, dst, src_width, dst_width, dst_height, channels, weights_x);
+    return dst;
   }
 
-  rect = ibuf->byte_buffer.data;
-  rectf = ibuf->float_buffer.data;
-  newrect = _newrect;
-  newrectf = _newrectf;
+  const ScaleWeights weights_x = compute_weights(src_width, dst_width, filter);
+  const ScaleWeights weights_y = compute_weights(src_height, dst_height, filter);
 
-  skipx = 4 * ibuf->x;
+  /* Both orders give the same result, pick the one doing the least work. */
+  const int64_t final_pass_cost = int64_t(dst_width) * dst_height;
+  const int64_t cost_x_first = int64_t(dst_width) * src_height * weights_x.taps +
+                               final_pass_cost * weights_y.taps;
+  const int64_t cost_y_first = int64_t(src_width) * dst_height * weights_y.taps +
+                               final_pass_cost * weights_x.taps;
 
-  /* Special case, copy all rows, needed since the scaling logic assumes there is at least
-   * two rows to interpolate between causing out of bounds read for 1px images, see #70356. */
-  if (UNLIKELY(ibuf->y == 1)) {
-    if (do_rect) {
-      for (y = newy; y > 0; y--) {
-        memcpy(newrect, rect, sizeof(char) * skipx);
-        newrect += skipx;
-      }
-    }
-    if (do_float) {
-      for (y = newy; y > 0; y--) {
-        memcpy(newrectf, rectf, sizeof(float) * skipx);
-        newrectf += skipx;
-      }
-    }
+  if (cost_x_first <= cost_y_first) {
+    Array<float> temp(int64_t(dst_width) * src_height * channels, NoInitialization());
+    scale_x(src, temp.data(), src_width, dst_width, src_height, channels, weights_x);
+    scale_y(temp.data(), dst, dst_width, dst_height, channels, weights_y);
   }
   else {
-    const float add = (ibuf->y - 1.001) / (newy - 1.0);
-    float sample;
-
-    float val_a, nval_a, diff_a;
-    float val_b, nval_b, diff_b;
-    float val_g, nval_g, diff_g;
-    float val_r, nval_r, diff_r;
-    float val_af, nval_af, diff_af;
-    float val_bf, nval_bf, diff_bf;
-    float val_gf, nval_gf, diff_gf;
-    float val_rf, nval_rf, diff_rf;
-
-    val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-    val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-    val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-    val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
-
-    for (x = ibuf->x; x > 0; x--) {
-      sample = 0;
-      if (do_rect) {
-        rect = ibuf->byte_buffer.data + 4 * (x - 1);
-        newrect = _newrect + 4 * (x - 1);
-
-        val_a = rect[0];
-        nval_a = rect[skipx];
-        diff_a = nval_a - val_a;
-        val_a += 0.5f;
-
-        val_b = rect[1];
-        nval_b = rect[skipx + 1];
-        diff_b = nval_b - val_b;
-        val_b += 0.5f;
-
-        val_g = rect[2];
-        nval_g = rect[skipx + 2];
-        diff_g = nval_g - val_g;
-        val_g += 0.5f;
-
-        val_r = rect[3];
-        nval_r = rect[skipx + 3];
-        diff_r = nval_r - val_r;
-        val_r += 0.5f;
-
-        rect += 2 * skipx;
-      }
-      if (do_float) {
-        rectf = ibuf->float_buffer.data + 4 * (x - 1);
-        newrectf = _newrectf + 4 * (x - 1);
-
-        val_af = rectf[0];
-        nval_af = rectf[skipx];
-        diff_af = nval_af - val_af;
-
-        val_bf = rectf[1];
-        nval_bf = rectf[skipx + 1];
-        diff_bf = nval_bf - val_bf;
-
-        val_gf = rectf[2];
-        nval_gf = rectf[skipx + 2];
-        diff_gf = nval_gf - val_gf;
-
-        val_rf = rectf[3];
-        nval_rf = rectf[skipx + 3];
-        diff_rf = nval_rf - val_rf;
-
-        rectf += 2 * skipx;
-      }
-
-      for (y = newy; y > 0; y--) {
-        if (sample >= 1.0f) {
-          sample -= 1.0f;
-
-          if (do_rect) {
-            val_a = nval_a;
-            nval_a = rect[0];
-            diff_a = nval_a - val_a;
-            val_a += 0.5f;
-
-            val_b = nval_b;
-            nval_b = rect[1];
-            diff_b = nval_b - val_b;
-            val_b += 0.5f;
-
-            val_g = nval_g;
-            nval_g = rect[2];
-            diff_g = nval_g - val_g;
-            val_g += 0.5f;
-
-            val_r = nval_r;
-            nval_r = rect[3];
-            diff_r = nval_r - val_r;
-            val_r += 0.5f;
-            rect += skipx;
-          }
-          if (do_float) {
-            val_af = nval_af;
-            nval_af = rectf[0];
-            diff_af = nval_af - val_af;
-
-            val_bf = nval_bf;
-            nval_bf = rectf[1];
-            diff_bf = nval_bf - val_bf;
-
-            val_gf = nval_gf;
-            nval_gf = rectf[2];
-            diff_gf = nval_gf - val_gf;
-
-            val_rf = nval_rf;
-            nval_rf = rectf[3];
-            diff_rf = nval_rf - val_rf;
-            rectf += skipx;
-          }
-        }
-        if (do_rect) {
-          newrect[0] = val_a + sample * diff_a;
-          newrect[1] = val_b + sample * diff_b;
-          newrect[2] = val_g + sample * diff_g;
-          newrect[3] = val_r + sample * diff_r;
-          newrect += skipx;
-        }
-        if (do_float) {
-          newrectf[0] = val_af + sample * diff_af;
-          newrectf[1] = val_bf + sample * diff_bf;
-          newrectf[2] = val_gf + sample * diff_gf;
-          newrectf[3] = val_rf + sample * diff_rf;
-          newrectf += skipx;
-        }
-        sample += add;
-      }
-    }
+    Array<float> temp(int64_t(src_width) * dst_height * channels, NoInitialization());
+    scale_y(src, temp.data(), src_width, dst_height, channels, weights_y);
+    scale_x(temp.data(), dst, src_width, dst_width, dst_height, channels, weights_x);
   }
 
-  if (do_rect) {
-    imb_freerectImBuf(ibuf);
-    IMB_assign_byte_buffer(ibuf, _newrect, IB_TAKE_OWNERSHIP);
-  }
-  if (do_float) {
-    imb_freerectfloatImBuf(ibuf);
-    IMB_assign_float_buffer(ibuf, _newrectf, IB_TAKE_OWNERSHIP);
-  }
-
-  ibuf->y = newy;
-  return ibuf;
+  return dst;
 }
 
-bool IMB_scaleImBuf(ImBuf *ibuf, uint newx, uint newy)
+}  // namespace blender::imbuf::scale
+
+bool IMB_scale(ImBuf *ibuf, uint newx, uint newy, eIMBScaleFilter filter)
 {
+  using namespace blender::imbuf::scale;
   BLI_assert_msg(newx > 0 && newy > 0, "Images must be at least 1 on both dimensions!");
 
   if (ibuf == nullptr) {
@@ -1580,28 +817,32 @@ bool IMB_scaleImBuf(ImBuf *ibuf, uint newx, uint newy)
     return false;
   }
 
-  /* try to scale common cases in a fast way */
-  /* disabled, quality loss is unacceptable, see report #18609  (ton) */
-  if (0 && q_scale_linear_interpolation(ibuf, newx, newy)) {
-    return true;
-  }
-
-  if (newx && (newx < ibuf->x)) {
-    scaledownx(ibuf, newx);
-  }
-  if (newy && (newy < ibuf->y)) {
-    scaledowny(ibuf, newy);
-  }
-  if (newx && (newx > ibuf->x)) {
-    scaleupx(ibuf, newx);
+  if (ibuf->byte_buffer.data) {
+    uchar *rect = scale_buffer(
+        ibuf->byte_buffer.data, ibuf->x, ibuf->y, 4, int(newx), int(newy), filter);
+    imb_freerectImBuf(ibuf);
+    IMB_assign_byte_buffer(ibuf, rect, IB_TAKE_OWNERSHIP);
   }
-  if (newy && (newy > ibuf->y)) {
-    scaleupy(ibuf, newy);
+  if (ibuf->float_buffer.data) {
+    float *rect_float = scale_buffer(
+        ibuf->float_buffer.data, ibuf->x, ibuf->y, ibuf->channels, int(newx), int(newy), filter);
+    imb_freerectfloatImBuf(ibuf);
+    IMB_assign_float_buffer(ibuf, rect_float, IB_TAKE_OWNERSHIP);
   }
 
+  ibuf->x = newx;
+  ibuf->y = newy;
+
   return true;
 }
 
+bool IMB_scaleImBuf(ImBuf *ibuf, uint newx, uint newy)
+{
+  return IMB_scale(ibuf, newx, newy, IMB_SCALE_FILTER_BOX);
+}
+
+/** \} */
+
 struct imbufRGBA {
   float r, g, b, a;
 };
@@ -1701,118 +942,7 @@ bool IMB_scalefastImBuf(ImBuf *ibuf, uint newx, uint newy)
   return true;
 }
 
-/* ******** threaded scaling ******** */
-
-struct ScaleTreadInitData {
-  ImBuf *ibuf;
-
-  uint newx;
-  uint newy;
-
-  uchar *byte_buffer;
-  float *float_buffer;
-};
-
-struct ScaleThreadData {
-  ImBuf *ibuf;
-
-  uint newx;
-  uint newy;
-
-  int start_line;
-  int tot_line;
-
-  uchar *byte_buffer;
-  float *float_buffer;
-};
-
-static void scale_thread_init(void *data_v, int start_line, int tot_line, void *init_data_v)
-{
-  ScaleThreadData *data = (ScaleThreadData *)data_v;
-  ScaleTreadInitData *init_data = (ScaleTreadInitData *)init_data_v;
-
-  data->ibuf = init_data->ibuf;
-
-  data->newx = init_data->newx;
-  data->newy = init_data->newy;
-
-  data->start_line = start_line;
-  data->tot_line = tot_line;
-
-  data->byte_buffer = init_data->byte_buffer;
-  data->float_buffer = init_data->float_buffer;
-}
-
-static void *do_scale_thread(void *data_v)
-{
-  ScaleThreadData *data = (ScaleThreadData *)data_v;
-  ImBuf *ibuf = data->ibuf;
-  int i;
-  float factor_x = float(ibuf->x) / data->newx;
-  float factor_y = float(ibuf->y) / data->newy;
-
-  for (i = 0; i < data->tot_line; i++) {
-    int y = data->start_line + i;
-    int x;
-
-    for (x = 0; x < data->newx; x++) {
-      float u = float(x) * factor_x;
-      float v = float(y) * factor_y;
-      int offset = y * data->newx + x;
-
-      if (data->byte_buffer) {
-        uchar *pixel = data->byte_buffer + 4 * offset;
-        BLI_bilinear_interpolation_char(ibuf->byte_buffer.data, pixel, ibuf->x, ibuf->y, 4, u, v);
-      }
-
-      if (data->float_buffer) {
-        float *pixel = data->float_buffer + ibuf->channels * offset;
-        BLI_bilinear_interpolation_fl(
-            ibuf->float_buffer.data, pixel, ibuf->x, ibuf->y, ibuf->channels, u, v);
-      }
-    }
-  }
-
-  return nullptr;
-}
-
 void IMB_scaleImBuf_threaded(ImBuf *ibuf, uint newx, uint newy)
 {
-  BLI_assert_msg(newx > 0 && newy > 0, "Images must be at least 1 on both dimensions!");
-
-  ScaleTreadInitData init_data = {nullptr};
-
-  /* prepare initialization data */
-  init_data.ibuf = ibuf;
-
-  init_data.newx = newx;
-  init_data.newy = newy;
-
-  if (ibuf->byte_buffer.data) {
-    init_data.byte_buffer = static_cast<uchar *>(
-        MEM_mallocN(4 * newx * newy * sizeof(char), "threaded scale byte buffer"));
-  }
-
-  if (ibuf->float_buffer.data) {
-    init_data.float_buffer = static_cast<float *>(
-        MEM_mallocN(ibuf->channels * newx * newy * sizeof(float), "threaded scale float buffer"));
-  }
-
-  /* actual scaling threads */
-  IMB_processor_apply_threaded(
-      newy, sizeof(ScaleThreadData), &init_data, scale_thread_init, do_scale_thread);
-
-  /* alter image buffer */
-  ibuf->x = newx;
-  ibuf->y = newy;
-
-  if (ibuf->byte_buffer.data) {
-    imb_freerectImBuf(ibuf);
-    IMB_assign_byte_buffer(ibuf, init_data.byte_buffer, IB_TAKE_OWNERSHIP);
-  }
-
-  if (ibuf->float_buffer.data) {
-    imb_freerectfloatImBuf(ibuf);
-    IMB_assign_float_buffer(ibuf, init_data.float_buffer, IB_TAKE_OWNERSHIP);
-  }
+  IMB_scale(ibuf, newx, newy, IMB_SCALE_FILTER_BILINEAR);
 }
@@ -198,7 +198,7 @@ static void *imb_gpu_get_data(const ImBuf *ibuf,
     float *rect_float = (is_float_rect) ? (float *)data_rect : nullptr;
 
     ImBuf *scale_ibuf = IMB_allocFromBuffer(rect, rect_float, ibuf->x, ibuf->y, 4);
-    IMB_scaleImBuf(scale_ibuf, UNPACK2(rescale_size));
+    IMB_scale(scale_ibuf, UNPACK2(rescale_size), IMB_SCALE_FILTER_BOX);
 
     if (freedata) {
       MEM_freeN(data_rect);
@@ -13,6 +13,8 @@
 #include "DNA_defs.h"
 #include "DNA_listBase.h"
 
+#include "BLI_implicit_sharing.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -600,6 +602,11 @@ typedef struct PreviewImage {
 
   /* Runtime-only data. */
   struct GPUTexture *gputexture[2];
+  /**
+   * Owns `rect` when it is used in place from the memory-mapped file it was read from, see
+   * #BLO_read_shared_data. Null when `rect` is a regular allocation.
+   */
+  const ImplicitSharingInfoHandle *rect_sharing_info[2];
   /** Used by previews outside of ID context. */
   int icon_id;
 
@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include "BLI_implicit_sharing.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -16,6 +18,11 @@ typedef struct PackedFile {
   int size;
   int seek;
   void *data;
+  /**
+   * Run-time data that owns `data` when it is used in place from the memory-mapped file it was
+   * read from, see #BLO_read_shared_data. Null when `data` is a regular allocation.
+   */
+  const ImplicitSharingInfoHandle *sharing_info;
 } PackedFile;
 
 #ifdef __cplusplus
@@ -501,7 +501,9 @@ static void rna_RenderPass_rect_get(PointerRNA *ptr, float *values)
 {
   RenderPass *rpass = (RenderPass *)ptr->data;
   const size_t size_in_bytes = sizeof(float) * rpass->rectx * rpass->recty * rpass->channels;
-  const float *buffer = rpass->ibuf ? rpass->ibuf->float_buffer.data : nullptr;
+  /* Passes of multilayer images are read on first access. */
+  const float *buffer = RE_RenderPassEnsureLoaded(rpass) ? rpass->ibuf->float_buffer.data :
+                                                           nullptr;
 
   if (!buffer) {
     /* No float buffer to read from, initialize to all zeroes. */
@@ -437,6 +437,11 @@ static PyGetSetDef bpy_app_getsets[] = {
      bpy_app_debug_doc,
      (void *)G_DEBUG_SIMDATA},
     {"debug_io", bpy_app_debug_get, bpy_app_debug_set, bpy_app_debug_doc, (void *)G_DEBUG_IO},
+    {"debug_compositor",
+     bpy_app_debug_get,
+     bpy_app_debug_set,
+     bpy_app_debug_doc,
+     (void *)G_DEBUG_COMPOSITOR},
 
     {"use_event_simulate",
      bpy_app_global_flag_get,
@@ -73,7 +73,10 @@ typedef struct RenderPass {
   char view[64];     /* EXR_VIEW_MAXNAME */
   int view_id;       /* quick lookup */
 
-  char _pad0[4];
+  /* Set once the pixels of a pass from #RE_MultilayerOpen are read, accessed atomically. */
+  int exr_loaded;
+  /* Render result of #RE_MultilayerOpen to read the pixels from, null for other passes. */
+  struct RenderResult *exr_result;
 } RenderPass;
 
 /**
@@ -136,6 +139,9 @@ typedef struct RenderResult {
   struct StampData *stamp_data;
 
   bool passes_allocated;
+
+  /* Multilayer file to read passes from on first access, see #RE_MultilayerOpen. */
+  struct RenderResultExrSource *exr_source;
 } RenderResult;
 
 typedef struct RenderStats {
@@ -387,6 +393,24 @@ bool RE_ReadRenderResult(struct Scene *scene, struct Scene *scenode);
 
 struct RenderResult *RE_MultilayerConvert(
     void *exrhandle, const char *colorspace, bool predivide, int rectx, int recty);
+/**
+ * Open a multilayer EXR file without decoding pixels, passes are read on first access with
+ * #RE_RenderPassEnsureLoaded. Returns null when the file is not a multilayer EXR.
+ */
+struct RenderResult *RE_MultilayerOpen(const char *filepath,
+                                       const char *colorspace,
+                                       bool predivide);
+/**
+ * Read the pixels of a pass of a render result from #RE_MultilayerOpen, if not read yet.
+ * The file is opened again for the read and fails when it changed on disk since it was opened.
+ * Thread safe, returns false when the pass has no pixels.
+ */
+bool RE_RenderPassEnsureLoaded(struct RenderPass *rpass);
+/**
+ * Read the pixels of all passes that were not read yet, for code that accesses the pass buffers
+ * directly, like saving or copying the render result. Thread safe.
+ */
+void RE_RenderResultEnsurePassesLoaded(struct RenderResult *rr);
 
 /* Display and event callbacks. */
 
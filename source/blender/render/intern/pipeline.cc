@@ -262,6 +262,21 @@ RenderResult *RE_MultilayerConvert(
   return render_result_new_from_exr(exrhandle, colorspace, predivide, rectx, recty);
 }
 
+RenderResult *RE_MultilayerOpen(const char *filepath, const char *colorspace, bool predivide)
+{
+  return render_result_open_exr(filepath, colorspace, predivide);
+}
+
+bool RE_RenderPassEnsureLoaded(RenderPass *rpass)
+{
+  return render_result_pass_ensure_loaded(rpass);
+}
+
+void RE_RenderResultEnsurePassesLoaded(RenderResult *rr)
+{
+  render_result_passes_ensure_loaded(rr);
+}
+
 RenderLayer *render_get_single_layer(Render *re, RenderResult *rr)
 {
   if (re->single_view_layer[0]) {
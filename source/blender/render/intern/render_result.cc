@@ -13,6 +13,9 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
+#include "BLI_fileops.h"
 #include "BLI_ghash.h"
 #include "BLI_hash_md5.h"
 #include "BLI_implicit_sharing.hh"
@@ -62,6 +65,34 @@ static void render_result_views_free(RenderResult *rr)
   rr->have_combined = false;
 }
 
+/* The file a render result from #render_result_open_exr reads its passes from. The file is only
+ * kept open while reading, size and modification time detect when it was rewritten since. */
+struct RenderResultExrSource {
+  char filepath[FILE_MAX];
+  int64_t size;
+  int64_t mtime;
+  char colorspace[64];
+  bool predivide;
+  ThreadMutex *lock;
+};
+
+static bool exr_source_stat(const char *filepath, int64_t *r_size, int64_t *r_mtime)
+{
+  BLI_stat_t st;
+  if (BLI_stat(filepath, &st) != 0) {
+    return false;
+  }
+  *r_size = int64_t(st.st_size);
+  *r_mtime = int64_t(st.st_mtime);
+  return true;
+}
+
+static void exr_source_free(RenderResultExrSource *source)
+{
+  BLI_mutex_free(source->lock);
+  MEM_freeN(source);
+}
+
 void render_result_free(RenderResult *rr)
 {
   if (rr == nullptr) {
@@ -95,6 +126,10 @@ void render_result_free(RenderResult *rr)
 
   BKE_stamp_data_free(rr->stamp_data);
 
+  if (rr->exr_source) {
+    exr_source_free(rr->exr_source);
+  }
+
   MEM_freeN(rr);
 }
 
@@ -686,7 +721,8 @@ RenderResult *render_result_new_from_exr(
       rpass->rectx = rectx;
       rpass->recty = recty;
 
-      if (rpass->channels >= 3) {
+      /* Passes of files opened with #RE_MultilayerOpen are transformed when read. */
+      if (rpass->channels >= 3 && rpass->ibuf->float_buffer.data) {
         IMB_colormanagement_transform(rpass->ibuf->float_buffer.data,
                                       rpass->rectx,
                                       rpass->recty,
@@ -701,6 +737,153 @@ RenderResult *render_result_new_from_exr(
   return rr;
 }
 
+RenderResult *render_result_open_exr(const char *filepath,
+                                     const char *colorspace,
+                                     bool predivide)
+{
+  int64_t size, mtime;
+  if (!exr_source_stat(filepath, &size, &mtime)) {
+    return nullptr;
+  }
+
+  void *exrhandle = IMB_exr_get_handle();
+  int rectx, recty;
+
+  /* Channels are parsed into passes, but no pass buffers are allocated or read. */
+  if (!IMB_exr_begin_read(exrhandle, filepath, &rectx, &recty, true) ||
+      !IMB_exr_has_multilayer(exrhandle))
+  {
+    IMB_exr_close(exrhandle);
+    return nullptr;
+  }
+
+  RenderResult *rr = render_result_new_from_exr(exrhandle, colorspace, predivide, rectx, recty);
+
+  ImBuf *metadata_ibuf = IMB_allocImBuf(0, 0, 0, 0);
+  IMB_exr_metadata_to_imbuf(exrhandle, metadata_ibuf);
+  BKE_stamp_info_from_imbuf(rr, metadata_ibuf);
+  IMB_freeImBuf(metadata_ibuf);
+
+  /* Don't keep the file open, passes open it again when read. */
+  IMB_exr_close(exrhandle);
+
+  RenderResultExrSource *source = MEM_cnew<RenderResultExrSource>(__func__);
+  STRNCPY(source->filepath, filepath);
+  source->size = size;
+  source->mtime = mtime;
+  STRNCPY(source->colorspace, colorspace);
+  source->predivide = predivide;
+  source->lock = BLI_mutex_alloc();
+  rr->exr_source = source;
+
+  LISTBASE_FOREACH (RenderLayer *, rl, &rr->layers) {
+    LISTBASE_FOREACH (RenderPass *, rpass, &rl->passes) {
+      rpass->exr_result = rr;
+    }
+  }
+
+  return rr;
+}
+
+static bool render_pass_has_pixels(const RenderPass *rpass)
+{
+  return rpass->ibuf && rpass->ibuf->float_buffer.data;
+}
+
+static void render_pass_exr_read(RenderResult *rr, RenderPass *rpass)
+{
+  RenderResultExrSource *source = rr->exr_source;
+
+  RenderLayer *rl = nullptr;
+  LISTBASE_FOREACH (RenderLayer *, rl_iter, &rr->layers) {
+    if (BLI_findindex(&rl_iter->passes, rpass) != -1) {
+      rl = rl_iter;
+      break;
+    }
+  }
+  if (rl == nullptr) {
+    return;
+  }
+
+  /* Don't mix passes of different versions of the file, the image has to be reloaded. */
+  int64_t size, mtime;
+  if (!exr_source_stat(source->filepath, &size, &mtime) || size != source->size ||
+      mtime != source->mtime)
+  {
+    printf("Multilayer file \"%s\" changed on disk, reload the image to read its passes\n",
+           source->filepath);
+    return;
+  }
+
+  void *exrhandle = IMB_exr_get_handle();
+  int rectx, recty;
+  if (!IMB_exr_begin_read(exrhandle, source->filepath, &rectx, &recty, true) ||
+      rectx != rr->rectx || recty != rr->recty)
+  {
+    IMB_exr_close(exrhandle);
+    return;
+  }
+
+  int totchan = 0;
+  float *rect = IMB_exr_read_pass(exrhandle, rl->name, rpass->name, rpass->view, 0, 0, &totchan);
+  IMB_exr_close(exrhandle);
+
+  if (rect == nullptr) {
+    return;
+  }
+  if (totchan != rpass->channels) {
+    MEM_freeN(rect);
+    return;
+  }
+
+  if (rpass->channels >= 3) {
+    IMB_colormanagement_transform(
+        rect,
+        rpass->rectx,
+        rpass->recty,
+        rpass->channels,
+        source->colorspace,
+        IMB_colormanagement_role_colorspace_name_get(COLOR_ROLE_SCENE_LINEAR),
+        source->predivide);
+  }
+  RE_pass_set_buffer_data(rpass, rect);
+}
+
+bool render_result_pass_ensure_loaded(RenderPass *rpass)
+{
+  RenderResult *rr = rpass->exr_result;
+  if (rr == nullptr || atomic_load_int32(&rpass->exr_loaded)) {
+    return render_pass_has_pixels(rpass);
+  }
+
+  BLI_mutex_lock(rr->exr_source->lock);
+  if (!atomic_load_int32(&rpass->exr_loaded)) {
+    if (!render_pass_has_pixels(rpass)) {
+      render_pass_exr_read(rr, rpass);
+    }
+    /* Only mark a pass loaded once its buffer is set, so other threads see it complete.
+     * A failed read is attempted again on next access. */
+    if (render_pass_has_pixels(rpass)) {
+      atomic_store_int32(&rpass->exr_loaded, 1);
+    }
+  }
+  BLI_mutex_unlock(rr->exr_source->lock);
+
+  return render_pass_has_pixels(rpass);
+}
+
+void render_result_passes_ensure_loaded(RenderResult *rr)
+{
+  if (rr == nullptr || rr->exr_source == nullptr) {
+    return;
+  }
+  LISTBASE_FOREACH (RenderLayer *, rl, &rr->layers) {
+    LISTBASE_FOREACH (RenderPass *, rpass, &rl->passes) {
+      render_result_pass_ensure_loaded(rpass);
+    }
+  }
+}
+
 void render_result_view_new(RenderResult *rr, const char *viewname)
 {
   RenderView *rv = MEM_cnew<RenderView>("new render view");
@@ -1224,6 +1407,8 @@ static RenderPass *duplicate_render_pass(RenderPass *rpass)
   new_rpass->next = new_rpass->prev = nullptr;
 
   new_rpass->ibuf = IMB_dupImBuf(rpass->ibuf);
+  new_rpass->exr_loaded = 0;
+  new_rpass->exr_result = nullptr;
 
   return new_rpass;
 }
@@ -1252,6 +1437,9 @@ static RenderView *duplicate_render_view(RenderView *rview)
 
 RenderResult *RE_DuplicateRenderResult(RenderResult *rr)
 {
+  /* The copy doesn't read from the file, so read all passes that were not read yet. */
+  render_result_passes_ensure_loaded(rr);
+
   RenderResult *new_rr = MEM_cnew<RenderResult>("new duplicated render result", *rr);
   new_rr->next = new_rr->prev = nullptr;
   new_rr->layers.first = new_rr->layers.last = nullptr;
@@ -1268,6 +1456,7 @@ RenderResult *RE_DuplicateRenderResult(RenderResult *rr)
   new_rr->ibuf = IMB_dupImBuf(rr->ibuf);
 
   new_rr->stamp_data = BKE_stamp_data_copy(new_rr->stamp_data);
+  new_rr->exr_source = nullptr;
   return new_rr;
 }
 
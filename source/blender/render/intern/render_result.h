@@ -49,6 +49,14 @@ void render_result_passes_allocated_ensure(struct RenderResult *rr);
  */
 struct RenderResult *render_result_new_from_exr(
     void *exrhandle, const char *colorspace, bool predivide, int rectx, int recty);
+/**
+ * Render result with passes read on demand from a multilayer EXR file.
+ */
+struct RenderResult *render_result_open_exr(const char *filepath,
+                                            const char *colorspace,
+                                            bool predivide);
+bool render_result_pass_ensure_loaded(struct RenderPass *rpass);
+void render_result_passes_ensure_loaded(struct RenderResult *rr);
 
 void render_result_view_new(struct RenderResult *rr, const char *viewname);
 void render_result_views_new(struct RenderResult *rr, const struct RenderData *rd);
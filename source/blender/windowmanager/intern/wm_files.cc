@@ -1970,6 +1970,8 @@ static bool wm_file_write(bContext *C,
   blend_write_params.remap_mode = remap_mode;
   blend_write_params.use_save_versions = true;
   blend_write_params.use_save_as_copy = use_save_as_copy;
+  /* Saving large compressed files again is much faster when only few data-blocks changed. */
+  blend_write_params.use_incremental = true;
   blend_write_params.thumb = thumb;
 
   const bool success = BLO_write_file(bmain, filepath, fileflags, &blend_write_params, reports);
@@ -2056,6 +2058,93 @@ static void wm_autosave_location(char filepath[FILE_MAX])
   BLI_path_join(filepath, FILE_MAX, tempdir_base, filename);
 }
 
+/**
+ * Limit the rate at which auto-save writes, so the disk remains responsive for other access
+ * (in bytes of uncompressed data per second).
+ */
+#define AUTOSAVE_WRITE_RATE_MAX (64 * 1024 * 1024)
+
+struct AutosaveJob {
+  char filepath[FILE_MAX];
+  /** Copy of the undo memfile, the undo stack may free its chunks while writing. */
+  void *data;
+  size_t data_len;
+
+  double time_start;
+  size_t file_size;
+  bool success;
+};
+
+static void wm_autosave_job_free(void *customdata)
+{
+  AutosaveJob *job = static_cast<AutosaveJob *>(customdata);
+  MEM_SAFE_FREE(job->data);
+  MEM_freeN(job);
+}
+
+static void wm_autosave_job_startjob(void *customdata,
+                                     bool *stop,
+                                     bool * /*do_update*/,
+                                     float * /*progress*/)
+{
+  AutosaveJob *job = static_cast<AutosaveJob *>(customdata);
+  job->success = BLO_write_file_raw(job->data,
+                                    job->data_len,
+                                    job->filepath,
+                                    true,
+                                    AUTOSAVE_WRITE_RATE_MAX,
+                                    stop,
+                                    &job->file_size);
+  /* Free early, the job data is only freed when the job is removed. */
+  MEM_SAFE_FREE(job->data);
+}
+
+static void wm_autosave_job_endjob(void *customdata)
+{
+  AutosaveJob *job = static_cast<AutosaveJob *>(customdata);
+  if (job->success) {
+    CLOG_INFO(&LOG,
+              1,
+              "auto-saved \"%s\" in %.3f seconds (%zu bytes written, %zu uncompressed)",
+              job->filepath,
+              PIL_check_seconds_timer() - job->time_start,
+              job->file_size,
+              job->data_len);
+  }
+  else {
+    CLOG_WARN(&LOG, "auto-save to \"%s\" failed or was cancelled", job->filepath);
+  }
+}
+
+/**
+ * Write the undo memfile from a job, only blocking the main thread to take a copy of it.
+ */
+static void wm_autosave_write_memfile_async(wmWindowManager *wm,
+                                            MemFile *memfile,
+                                            const char *filepath)
+{
+  AutosaveJob *job = static_cast<AutosaveJob *>(MEM_callocN(sizeof(*job), __func__));
+  STRNCPY(job->filepath, filepath);
+  job->time_start = PIL_check_seconds_timer();
+
+  LISTBASE_FOREACH (MemFileChunk *, chunk, &memfile->chunks) {
+    job->data_len += chunk->size;
+  }
+  job->data = MEM_mallocN(job->data_len, __func__);
+  char *data = static_cast<char *>(job->data);
+  LISTBASE_FOREACH (MemFileChunk *, chunk, &memfile->chunks) {
+    memcpy(data, chunk->buf, chunk->size);
+    data += chunk->size;
+  }
+
+  wmJob *wm_job = WM_jobs_get(
+      wm, wm->winactive, wm, "Auto-Saving", eWM_JobFlag(0), WM_JOB_TYPE_AUTOSAVE);
+  WM_jobs_customdata_set(wm_job, job, wm_autosave_job_free);
+  WM_jobs_timer(wm_job, 0.5, 0, 0);
+  WM_jobs_callbacks(wm_job, wm_autosave_job_startjob, nullptr, nullptr, wm_autosave_job_endjob);
+  WM_jobs_start(wm, wm_job);
+}
+
 static void wm_autosave_write(Main *bmain, wmWindowManager *wm)
 {
   char filepath[FILE_MAX];
@@ -2066,7 +2155,12 @@ static void wm_autosave_write(Main *bmain, wmWindowManager *wm)
   const bool use_memfile = (U.uiflag & USER_GLOBALUNDO) != 0;
   MemFile *memfile = use_memfile ? ED_undosys_stack_memfile_get_active(wm->undo_stack) : nullptr;
   if (memfile != nullptr) {
-    BLO_memfile_write_file(memfile, filepath);
+    if (G.background) {
+      BLO_memfile_write_file(memfile, filepath);
+    }
+    else {
+      wm_autosave_write_memfile_async(wm, memfile, filepath);
+    }
   }
   else {
     if (use_memfile) {
@@ -2116,6 +2210,12 @@ void wm_autosave_timer(Main *bmain, wmWindowManager *wm, wmTimer * /*wt*/)
 {
   wm_autosave_timer_end(wm);
 
+  /* The previous auto-save is still being written, try again later. */
+  if (WM_jobs_test(wm, wm, WM_JOB_TYPE_AUTOSAVE)) {
+    wm_autosave_timer_begin_ex(wm, 1.0);
+    return;
+  }
+
   /* If a modal operator is running, don't autosave because we might not be in
    * a valid state to save. But try again in 10ms. */
   LISTBASE_FOREACH (wmWindow *, win, &wm->windows) {
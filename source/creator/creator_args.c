@@ -654,6 +654,7 @@ static void print_help(bArgs *ba, bool all)
   }
   BLI_args_print_arg_doc(ba, "--debug-memory");
   BLI_args_print_arg_doc(ba, "--debug-jobs");
+  BLI_args_print_arg_doc(ba, "--debug-compositor");
   BLI_args_print_arg_doc(ba, "--debug-python");
   BLI_args_print_arg_doc(ba, "--debug-depsgraph");
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-eval");
@@ -1106,6 +1107,9 @@ static const char arg_handle_debug_mode_generic_set_doc_xr_time[] =
 static const char arg_handle_debug_mode_generic_set_doc_jobs[] =
     "\n\t"
     "Enable time profiling for background jobs.";
+static const char arg_handle_debug_mode_generic_set_doc_compositor[] =
+    "\n\t"
+    "Enable time and memory statistics for the compositor.";
 static const char arg_handle_debug_mode_generic_set_doc_depsgraph[] =
     "\n\t"
     "Enable all debug messages from dependency graph.";
@@ -2478,6 +2482,11 @@ void main_args_setup(bContext *C, bArgs *ba, bool all)
                "--debug-jobs",
                CB_EX(arg_handle_debug_mode_generic_set, jobs),
                (void *)G_DEBUG_JOBS);
+  BLI_args_add(ba,
+               NULL,
+               "--debug-compositor",
+               CB_EX(arg_handle_debug_mode_generic_set, compositor),
+               (void *)G_DEBUG_COMPOSITOR);
   BLI_args_add(ba, NULL, "--debug-gpu", CB(arg_handle_debug_gpu_set), NULL);
   if (defs.with_renderdoc) {
     BLI_args_add(ba, NULL, "--debug-gpu-renderdoc", CB(arg_handle_debug_gpu_renderdoc_set), NULL);
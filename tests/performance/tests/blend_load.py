@@ -24,6 +24,25 @@ def _run(filepath):
     return result
 
 
+def _profile_times(lines):
+    # Breakdown of the last file read, as logged by the "blo.readfile.profile" category. Phases
+    # are summed over their details (ID types, versioning blocks, libraries).
+    prefix = "phase \""
+    times = {}
+    for line in lines:
+        if line.find("Read profile of ") != -1:
+            times = {}
+            continue
+        offset = line.find(prefix)
+        if offset == -1:
+            continue
+        phase, _, value = line[offset + len(prefix):].rpartition("\" ")
+        phase = phase.split(":")[0]
+        key = 'time_' + phase
+        times[key] = times.get(key, 0.0) + float(value.split()[0])
+    return times
+
+
 class BlendLoadTest(api.Test):
     def __init__(self, filepath):
         self.filepath = filepath
@@ -36,6 +55,9 @@ class BlendLoadTest(api.Test):
 
     def run(self, env, device_id):
         result, _ = env.run_in_blender(_run, str(self.filepath))
+        # Profiling adds overhead to loading, so the breakdown comes from a separate run.
+        _, lines = env.run_in_blender(_run, str(self.filepath), ['--log', 'blo.readfile.profile'])
+        result.update(_profile_times(lines))
         return result
 
 
@@ -0,0 +1,197 @@
+# SPDX-FileCopyrightText: 2023 Blender Foundation
+#
+# SPDX-License-Identifier: Apache-2.0
+
+import api
+
+
+def _run(args):
+    import bpy
+
+    graph, execution_mode, (width, height), num_iterations = args
+
+    scene = bpy.context.scene
+    scene.render.resolution_x = width
+    scene.render.resolution_y = height
+    scene.render.resolution_percentage = 100
+    scene.render.use_compositing = True
+    scene.render.use_sequencer = False
+    scene.use_nodes = True
+
+    tree = scene.node_tree
+    tree.execution_mode = execution_mode
+    tree.use_opencl = False
+    tree.use_two_pass = False
+    nodes = tree.nodes
+    links = tree.links
+    nodes.clear()
+
+    def new_image(name, generated_type='COLOR_GRID'):
+        image = bpy.data.images.new(name, width, height, alpha=True, float_buffer=True)
+        image.generated_type = generated_type
+        node = nodes.new('CompositorNodeImage')
+        node.image = image
+        return node
+
+    def new_channel(image_node, channel):
+        # Use one channel of an image as depth or matte input.
+        node = nodes.new('CompositorNodeSeparateColor')
+        links.new(image_node.outputs['Image'], node.inputs['Image'])
+        return node.outputs[channel]
+
+    # Graphs representative of common production setups, all built from generated images so no
+    # benchmark files are needed.
+    if graph == 'keying':
+        plate = new_image("plate")
+        screen = nodes.new('CompositorNodeMixRGB')
+        screen.blend_type = 'MULTIPLY'
+        screen.inputs['Fac'].default_value = 0.75
+        screen.inputs[2].default_value = (0.1, 0.9, 0.15, 1.0)
+        links.new(plate.outputs['Image'], screen.inputs[1])
+
+        keying = nodes.new('CompositorNodeKeying')
+        keying.inputs['Key Color'].default_value = (0.1, 0.9, 0.15, 1.0)
+        keying.blur_pre = 4
+        keying.edge_kernel_radius = 6
+        keying.feather_distance = 8
+        links.new(screen.outputs['Image'], keying.inputs['Image'])
+
+        background = new_image("background", 'UV_GRID')
+        over = nodes.new('CompositorNodeAlphaOver')
+        links.new(background.outputs['Image'], over.inputs[1])
+        links.new(keying.outputs['Image'], over.inputs[2])
+        result = over.outputs['Image']
+    elif graph == 'glare':
+        image = new_image("image")
+        glare = nodes.new('CompositorNodeGlare')
+        glare.glare_type = 'FOG_GLOW'
+        glare.quality = 'HIGH'
+        glare.size = 9
+        glare.threshold = 0.5
+        links.new(image.outputs['Image'], glare.inputs['Image'])
+
+        streaks = nodes.new('CompositorNodeGlare')
+        streaks.glare_type = 'STREAKS'
+        streaks.quality = 'MEDIUM'
+        streaks.streaks = 4
+        streaks.threshold = 0.5
+        links.new(glare.outputs['Image'], streaks.inputs['Image'])
+        result = streaks.outputs['Image']
+    elif graph == 'defocus':
+        image = new_image("image")
+        depth = new_image("depth", 'UV_GRID')
+        defocus = nodes.new('CompositorNodeDefocus')
+        defocus.use_zbuffer = True
+        defocus.f_stop = 2.0
+        defocus.blur_max = 32.0
+        links.new(image.outputs['Image'], defocus.inputs['Image'])
+        links.new(new_channel(depth, 'Red'), defocus.inputs['Z'])
+        result = defocus.outputs['Image']
+    elif graph == 'vector_blur':
+        image = new_image("image")
+        motion = new_image("motion", 'UV_GRID')
+        speed = nodes.new('CompositorNodeMixRGB')
+        speed.blend_type = 'MULTIPLY'
+        speed.inputs['Fac'].default_value = 1.0
+        speed.inputs[2].default_value = (16.0, 8.0, 16.0, 8.0)
+        links.new(motion.outputs['Image'], speed.inputs[1])
+
+        blur = nodes.new('CompositorNodeVecBlur')
+        blur.samples = 32
+        blur.speed_max = 64
+        links.new(image.outputs['Image'], blur.inputs['Image'])
+        links.new(new_channel(motion, 'Blue'), blur.inputs['Z'])
+        links.new(speed.outputs['Image'], blur.inputs['Speed'])
+        result = blur.outputs['Image']
+    elif graph == 'multilayer_merge':
+        # Merge layers as from a multi-layer render: depth composite, then alpha over and additive
+        # light passes.
+        layers = [new_image("layer_%d" % i, 'COLOR_GRID' if i % 2 else 'UV_GRID') for i in range(6)]
+        zcombine = nodes.new('CompositorNodeZcombine')
+        zcombine.use_alpha = True
+        links.new(layers[0].outputs['Image'], zcombine.inputs[0])
+        links.new(new_channel(layers[1], 'Red'), zcombine.inputs[1])
+        links.new(layers[1].outputs['Image'], zcombine.inputs[2])
+        links.new(new_channel(layers[0], 'Green'), zcombine.inputs[3])
+        result = zcombine.outputs['Image']
+        for i, layer in enumerate(layers[2:]):
+            if i % 2:
+                merge = nodes.new('CompositorNodeAlphaOver')
+                links.new(result, merge.inputs[1])
+                links.new(layer.outputs['Image'], merge.inputs[2])
+            else:
+                merge = nodes.new('CompositorNodeMixRGB')
+                merge.blend_type = 'ADD'
+                merge.inputs['Fac'].default_value = 0.5
+                links.new(result, merge.inputs[1])
+                links.new(layer.outputs['Image'], merge.inputs[2])
+            result = merge.outputs['Image']
+    else:
+        raise Exception("Unknown compositor graph " + graph)
+
+    composite = nodes.new('CompositorNodeComposite')
+    links.new(result, composite.inputs['Image'])
+
+    # First execution loads the generated images, it is not measured.
+    for _ in range(num_iterations + 1):
+        bpy.ops.render.render()
+
+    return None
+
+
+class CompositorTest(api.Test):
+    def __init__(self, graph, execution_mode, resolution_name, resolution):
+        self.graph = graph
+        self.execution_mode = execution_mode
+        self.resolution_name = resolution_name
+        self.resolution = resolution
+        self.num_iterations = 3
+
+    def name(self):
+        return f"{self.graph}_{self.execution_mode.lower()}_{self.resolution_name}"
+
+    def category(self):
+        return "compositor"
+
+    def run(self, env, device_id):
+        args = (self.graph, self.execution_mode, self.resolution, self.num_iterations)
+        _, lines = env.run_in_blender(_run, args, ['--factory-startup', '--debug-compositor'])
+
+        # Parse statistics printed after every compositor execution, for example:
+        # "Compositor: full-frame 1920x1080 in 0.1234 s (16.80 Mpix/s), peak buffer memory ...
+        # (123456 bytes)".
+        prefix = "Compositor: "
+        times = []
+        peak_memory = 0.0
+        for line in lines:
+            line = line.strip()
+            if not line.startswith(prefix):
+                continue
+            tokens = line.split()
+            times.append(float(tokens[tokens.index("in") + 1]))
+            peak_memory = max(peak_memory, float(tokens[-2].lstrip('(')))
+
+        # Skip the warm-up execution.
+        times = times[1:]
+        if len(times) != self.num_iterations:
+            raise Exception("Error parsing compositor statistics output")
+
+        time = sum(times) / len(times)
+        megapixels = self.resolution[0] * self.resolution[1] / 1e6
+        return {'time': time, 'mpix_per_second': megapixels / time, 'peak_memory': peak_memory}
+
+
+def generate(env):
+    graphs = ('keying', 'glare', 'defocus', 'vector_blur', 'multilayer_merge')
+    execution_modes = ('TILED', 'FULL_FRAME')
+    resolutions = (
+        ('2k', (2048, 1080)),
+        ('4k', (4096, 2160)),
+        ('8k', (8192, 4320)),
+    )
+    tests = []
+    for graph in graphs:
+        for execution_mode in execution_modes:
+            for resolution_name, resolution in resolutions:
+                tests.append(CompositorTest(graph, execution_mode, resolution_name, resolution))
+    return tests
@@ -0,0 +1,76 @@
+# SPDX-FileCopyrightText: 2023 Blender Foundation
+#
+# SPDX-License-Identifier: Apache-2.0
+
+import api
+
+
+def _run(args):
+    import bpy
+    import imbuf
+    import time
+
+    src_size, dst_size, use_float = args
+
+    if use_float:
+        image = bpy.data.images.new("scale_test", src_size[0], src_size[1], float_buffer=True)
+        image.generated_type = 'COLOR_GRID'
+
+        def prepare():
+            # Regenerate the image at its original size.
+            image.reload()
+            image.update()
+
+        def scale():
+            image.scale(dst_size[0], dst_size[1])
+    else:
+        ibuf = None
+
+        def prepare():
+            nonlocal ibuf
+            ibuf = imbuf.new(src_size)
+
+        def scale():
+            ibuf.resize(dst_size, method='BILINEAR')
+
+    num_iterations = 5
+    elapsed_time = 0.0
+    for _ in range(num_iterations):
+        prepare()
+        start_time = time.time()
+        scale()
+        elapsed_time += time.time() - start_time
+
+    result = {'time': elapsed_time / num_iterations}
+    return result
+
+
+class ImbufScaleTest(api.Test):
+    def __init__(self, name, src_size, dst_size, use_float):
+        self.test_name = name
+        self.args = (src_size, dst_size, use_float)
+
+    def name(self):
+        return self.test_name
+
+    def category(self):
+        return "imbuf_scale"
+
+    def run(self, env, device_id):
+        result, _ = env.run_in_blender(_run, self.args, ['--factory-startup'])
+        return result
+
+
+def generate(env):
+    # Thumbnail generation, texture size limits and proxy building, for byte and float images.
+    cases = (
+        ("thumbnail", (4096, 4096), (256, 256)),
+        ("texture_downscale", (8192, 4096), (2048, 1024)),
+        ("proxy_50", (3840, 2160), (1920, 1080)),
+        ("upscale", (1920, 1080), (3840, 2160)),
+    )
+    tests = []
+    for name, src_size, dst_size in cases:
+        tests.append(ImbufScaleTest(name + "_byte", src_size, dst_size, False))
+        tests.append(ImbufScaleTest(name + "_float", src_size, dst_size, True))
+    return tests
@@ -5,6 +5,7 @@
 # ./blender.bin --background -noaudio --python tests/python/bl_blendfile_io.py
 import bpy
 import os
+import stat
 import sys
 
 sys.path.append(os.path.dirname(os.path.realpath(__file__)))
@@ -49,6 +50,223 @@ class TestBlendFileSaveLoadBasic(TestHelper):
         assert orig_data == read_data
 
 
+def set_file_read_only(filepath, read_only):
+    # Data is only used directly from memory-mapped files which can't be written to.
+    if os.path.exists(filepath):
+        os.chmod(filepath, stat.S_IREAD if read_only else stat.S_IREAD | stat.S_IWRITE)
+
+
+class TestBlendFileSaveLoadLargeAttributes(TestHelper):
+    """
+    Large attribute arrays of uncompressed read-only files can be used directly from the
+    memory-mapped file, check that modifying them after loading doesn't affect the file.
+    """
+
+    def __init__(self, args):
+        self.args = args
+
+    def test_modify_after_load(self):
+        bpy.ops.wm.read_homefile(use_empty=True, use_factory_startup=True)
+
+        # Large enough for its attribute arrays to not be copied on load.
+        mesh = bpy.data.meshes.new("LargeMesh")
+        mesh.vertices.add(100_000)
+        mesh.use_fake_user = True
+        values = [float(i) for i in range(len(mesh.vertices))]
+        mesh.attributes.new("values", 'FLOAT', 'POINT').data.foreach_set("value", values)
+
+        output_dir = self.args.output_dir
+        self.ensure_path(output_dir)
+        output_path = os.path.join(output_dir, "blendfile_io_large_attributes.blend")
+        output_modified_path = os.path.join(output_dir, "blendfile_io_large_attributes_modified.blend")
+
+        set_file_read_only(output_path, False)
+        bpy.ops.wm.save_as_mainfile(filepath=output_path, check_existing=False, compress=False)
+        set_file_read_only(output_path, True)
+        bpy.ops.wm.open_mainfile(filepath=output_path, load_ui=False)
+
+        def read_values():
+            attribute = bpy.data.meshes["LargeMesh"].attributes["values"]
+            read = [0.0] * len(attribute.data)
+            attribute.data.foreach_get("value", read)
+            return read
+
+        assert read_values() == values
+
+        modified_values = [-value for value in values]
+        bpy.data.meshes["LargeMesh"].attributes["values"].data.foreach_set("value", modified_values)
+        assert read_values() == modified_values
+
+        bpy.ops.wm.save_as_mainfile(filepath=output_modified_path, check_existing=False, compress=False)
+
+        bpy.ops.wm.open_mainfile(filepath=output_path, load_ui=False)
+        assert read_values() == values
+
+        bpy.ops.wm.open_mainfile(filepath=output_modified_path, load_ui=False)
+        assert read_values() == modified_values
+
+
+class TestBlendFileSaveLoadLargePackedFile(TestHelper):
+    """
+    Large packed files of uncompressed read-only files can be used directly from the memory-mapped
+    file, check that they can be copied, freed and restored by undo after loading.
+    """
+
+    def __init__(self, args):
+        self.args = args
+
+    def save_and_load(self, filename):
+        bpy.ops.wm.read_homefile(use_factory_startup=True)
+
+        import random
+        rng = random.Random(0)
+        # Large enough for the packed data to not be copied on load.
+        data = bytes(rng.getrandbits(8) for _ in range(1 << 20))
+
+        image = bpy.data.images.new("PackedImage", 4, 4)
+        image.pack(data=data, data_len=len(data))
+        image.use_fake_user = True
+
+        output_dir = self.args.output_dir
+        self.ensure_path(output_dir)
+        output_path = os.path.join(output_dir, filename)
+
+        set_file_read_only(output_path, False)
+        bpy.ops.wm.save_as_mainfile(filepath=output_path, check_existing=False, compress=False)
+        set_file_read_only(output_path, True)
+        bpy.ops.wm.open_mainfile(filepath=output_path, load_ui=False)
+
+        assert bpy.data.images["PackedImage"].packed_file.data == data
+        return data
+
+    def test_copy_after_load(self):
+        data = self.save_and_load("blendfile_io_large_packed_file.blend")
+        output_copy_path = os.path.join(self.args.output_dir, "blendfile_io_large_packed_file_copy.blend")
+
+        image = bpy.data.images["PackedImage"]
+        image_copy = image.copy()
+        image_copy.use_fake_user = True
+        image_copy_name = image_copy.name
+        bpy.data.images.remove(image)
+        assert image_copy.packed_file.data == data
+
+        bpy.ops.wm.save_as_mainfile(filepath=output_copy_path, check_existing=False, compress=False)
+        bpy.ops.wm.open_mainfile(filepath=output_copy_path, load_ui=False)
+
+        assert "PackedImage" not in bpy.data.images
+        assert bpy.data.images[image_copy_name].packed_file.data == data
+
+    def test_undo_after_load(self):
+        data = self.save_and_load("blendfile_io_large_packed_file_undo.blend")
+
+        # Undo keeps the packed data of the current images, which is used from the mapped file.
+        bpy.ops.ed.undo_push(message="Loaded")
+        bpy.data.meshes.new("UndoMesh").use_fake_user = True
+        bpy.ops.ed.undo_push(message="Add mesh")
+
+        bpy.ops.ed.undo()
+        assert "UndoMesh" not in bpy.data.meshes
+        assert bpy.data.images["PackedImage"].packed_file.data == data
+
+        bpy.ops.ed.redo()
+        assert "UndoMesh" in bpy.data.meshes
+        assert bpy.data.images["PackedImage"].packed_file.data == data
+
+        # Undo to a state where the packed file doesn't exist anymore, and back.
+        bpy.data.images.remove(bpy.data.images["PackedImage"])
+        bpy.ops.ed.undo_push(message="Remove image")
+        bpy.ops.ed.undo()
+        assert bpy.data.images["PackedImage"].packed_file.data == data
+        bpy.ops.ed.redo()
+        assert "PackedImage" not in bpy.data.images
+        bpy.ops.ed.undo()
+        assert bpy.data.images["PackedImage"].packed_file.data == data
+
+
+class TestBlendFileSaveCompressedIncremental(TestHelper):
+    """
+    Saving over a compressed file copies the frames of data that didn't change,
+    check that the result matches the current data.
+    """
+
+    def __init__(self, args):
+        self.args = args
+
+    def test_save_over_compressed(self):
+        bpy.ops.wm.read_homefile(use_empty=True, use_factory_startup=True)
+
+        for i in range(32):
+            mesh = bpy.data.meshes.new("Mesh%d" % i)
+            mesh.vertices.add(10_000 * (i + 1))
+            mesh.vertices.foreach_set("co", [float(i)] * (len(mesh.vertices) * 3))
+            mesh.use_fake_user = True
+
+        output_dir = self.args.output_dir
+        self.ensure_path(output_dir)
+        output_path = os.path.join(output_dir, "blendfile_io_compressed_incremental.blend")
+
+        bpy.ops.wm.save_as_mainfile(filepath=output_path, check_existing=False, compress=True)
+
+        # Change some meshes, the others should be reused from the existing file.
+        for i in (3, 17):
+            mesh = bpy.data.meshes["Mesh%d" % i]
+            mesh.vertices.foreach_set("co", [-1.0] * (len(mesh.vertices) * 3))
+        bpy.data.meshes.new("NewMesh").use_fake_user = True
+
+        orig_data = self.blender_data_to_tuple(bpy.data, "orig_data")
+        orig_coords = {}
+        for mesh in bpy.data.meshes:
+            coords = [0.0] * (len(mesh.vertices) * 3)
+            mesh.vertices.foreach_get("co", coords)
+            orig_coords[mesh.name] = coords
+
+        bpy.ops.wm.save_as_mainfile(filepath=output_path, check_existing=False, compress=True)
+        bpy.ops.wm.open_mainfile(filepath=output_path, load_ui=False)
+
+        read_data = self.blender_data_to_tuple(bpy.data, "read_data")
+        assert orig_data == read_data
+        for mesh in bpy.data.meshes:
+            coords = [0.0] * (len(mesh.vertices) * 3)
+            mesh.vertices.foreach_get("co", coords)
+            assert coords == orig_coords[mesh.name]
+
+    def test_frames_reused(self):
+        import re
+        import subprocess
+
+        output_dir = self.args.output_dir
+        self.ensure_path(output_dir)
+        output_path = os.path.join(output_dir, "blendfile_io_compressed_reused.blend")
+        if os.path.exists(output_path):
+            os.remove(output_path)
+
+        # Frames are only reused within a session, and the number of reused frames is only logged,
+        # so save twice in another Blender process and check its log.
+        script = (
+            "import bpy\n"
+            "for i in range(32):\n"
+            "    mesh = bpy.data.meshes.new('Mesh%d' % i)\n"
+            "    mesh.vertices.add(10_000 * (i + 1))\n"
+            "    mesh.vertices.foreach_set('co', [float(i)] * (len(mesh.vertices) * 3))\n"
+            "    mesh.use_fake_user = True\n"
+            "bpy.ops.wm.save_as_mainfile(filepath={0!r}, check_existing=False, compress=True)\n"
+            "bpy.data.meshes['Mesh17'].vertices[0].co = (-1.0, -1.0, -1.0)\n"
+            "bpy.ops.wm.save_as_mainfile(filepath={0!r}, check_existing=False, compress=True)\n"
+        ).format(output_path)
+        result = subprocess.run(
+            [bpy.app.binary_path, "--background", "--factory-startup",
+             "--log", "blo.writefile", "--log-level", "1", "--python-expr", script],
+            stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+        assert result.returncode == 0, result.stdout
+
+        # Only the second save has a file to reuse frames from.
+        reused = re.findall(r"Reused (\d+) of (\d+) frames", result.stdout)
+        assert len(reused) == 1, result.stdout
+        frames_reused, frames_num = (int(value) for value in reused[0])
+        # Most frames didn't change, the ones of the modified mesh have to be compressed again.
+        assert 0 < frames_reused < frames_num, result.stdout
+
+
 # NOTE: Technically this should rather be in `bl_id_management.py` test, but that file uses `unittest` module,
 #       which makes mixing it with tests system used here and passing extra parameters complicated.
 #       Since the main effect of 'RUNTIME' ID tag is on file save, it can as well be here for now.
@@ -146,6 +364,9 @@ class TestIdRuntimeTag(TestHelper):
 
 TESTS = (
     TestBlendFileSaveLoadBasic,
+    TestBlendFileSaveLoadLargeAttributes,
+    TestBlendFileSaveLoadLargePackedFile,
+    TestBlendFileSaveCompressedIncremental,
 
     TestIdRuntimeTag,
 )
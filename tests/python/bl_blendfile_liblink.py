@@ -275,6 +275,65 @@ class TestBlendLibLinkIndirect(TestBlendLibLinkHelper):
         assert mesh.is_library_indirect is False
 
 
+class TestBlendLibLinkCompressed(TestBlendLibLinkHelper):
+
+    def __init__(self, args):
+        self.args = args
+
+    def init_lib_data_multiple(self, compress):
+        self.reset_blender()
+
+        # Several collections, so that the linked one and its dependencies are spread over the file.
+        for i in range(8):
+            ma = bpy.data.materials.new("LibMaterial%d" % i)
+            me = bpy.data.meshes.new("LibMesh%d" % i)
+            me.materials.append(ma)
+            ob = bpy.data.objects.new("LibMesh%d" % i, me)
+            coll = bpy.data.collections.new("LibMesh%d" % i)
+            coll.objects.link(ob)
+            bpy.context.scene.collection.children.link(coll)
+
+        output_dir = self.args.output_dir
+        self.ensure_path(output_dir)
+        # Take care to keep the name unique so multiple test jobs can run at once.
+        output_lib_path = os.path.join(output_dir, self.unique_blendfile_name("blendlib_multiple"))
+
+        bpy.ops.wm.save_as_mainfile(filepath=output_lib_path, check_existing=False, compress=compress)
+
+        return output_lib_path
+
+    def link_collection(self, output_lib_path):
+        self.reset_blender()
+
+        link_dir = os.path.join(output_lib_path, "Collection")
+        bpy.ops.wm.link(directory=link_dir, filename="LibMesh5", instance_collections=False)
+
+        assert len(bpy.data.materials) == 1
+        assert bpy.data.materials[0].name == "LibMaterial5"
+        assert len(bpy.data.meshes) == 1
+        assert len(bpy.data.objects) == 1
+        assert len(bpy.data.collections) == 1  # Scene's master collection is not listed here
+
+        return self.blender_data_to_tuple(bpy.data, "linked_data")
+
+    def test_link_compressed(self):
+        # Compressed files are read using their block index, the result must be the same as when
+        # reading uncompressed files. Both are saved to the same path to get the same library name.
+        output_lib_path = self.init_lib_data_multiple(compress=False)
+        linked_data = self.link_collection(output_lib_path)
+
+        output_lib_path = self.init_lib_data_multiple(compress=True)
+        linked_data_compress = self.link_collection(output_lib_path)
+
+        assert linked_data == linked_data_compress
+
+        # Listing the content of the library only needs the blocks in the index.
+        with bpy.data.libraries.load(output_lib_path) as (data_from, data_to):
+            assert len(data_from.collections) == 8
+            assert len(data_from.materials) == 8
+            assert "LibMesh5" in data_from.objects
+
+
 class TestBlendLibAppendBasic(TestBlendLibLinkHelper):
 
     def __init__(self, args):
@@ -709,6 +768,7 @@ class TestBlendLibDataLibrariesLoadLibOverride(TestBlendLibDataLibrariesLoad):
 TESTS = (
     TestBlendLibLinkSaveLoadBasic,
     TestBlendLibLinkIndirect,
+    TestBlendLibLinkCompressed,
 
     TestBlendLibAppendBasic,
     TestBlendLibAppendReuseID,